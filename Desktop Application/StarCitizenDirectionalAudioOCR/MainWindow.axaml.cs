@@ -5,6 +5,7 @@ using Avalonia.Threading;
 using System;
 using System.Diagnostics;
 using System.IO;
+using System.Linq;
 using System.Threading;
 using System.Threading.Tasks;
 
@@ -15,6 +16,7 @@ public partial class MainWindow : Avalonia.Controls.Window
     private readonly RoiStore _roi = new();
     private readonly CaptureService _cap = new();
     private readonly OcrService _ocr = new();
+    private PoseChannel? _poses;
     private CancellationTokenSource? _cts;
 
     // Output targets (bind whatever your XAML actually uses)
@@ -122,7 +124,7 @@ public partial class MainWindow : Avalonia.Controls.Window
             var bot = new OpenCvSharp.Mat(testFrame, new OpenCvSharp.Rect(0, mid, testFrame.Cols, h - mid));
 
             // For one-shot show both lines too (parsed-only)
-            string parsedBoth = TryParseBoth(eng, top, bot, out var rawTop, out var rawBot);
+            string parsedBoth = TryParseBoth(eng, top, bot, out var rawTop, out var rawBot, out _);
             SetOutput(parsedBoth);
 
             Log.Info($"One-shot TOP raw: '{TrimForLog(rawTop, 160)}'");
@@ -131,6 +133,13 @@ public partial class MainWindow : Avalonia.Controls.Window
         }
         catch (Exception ex) { Log.Info("One-shot OCR failed: " + ex); }
 
+        // Shared-memory channel to the TeamSpeak plugin (kept open across Start/Stop)
+        if (_poses == null)
+        {
+            try { _poses = new PoseChannel(); Log.Info("Pose channel open."); }
+            catch (Exception ex) { Log.Info("Pose channel unavailable: " + ex.Message); }
+        }
+
         // ---- Background OCR loop on a dedicated STA thread ----
         Log.Info("Starting background OCR loop (STA)...");
         var staThread = new Thread(() =>
@@ -148,6 +157,7 @@ public partial class MainWindow : Avalonia.Controls.Window
                     int tps = Math.Clamp(_tickRate, 1, 60);
                     int delayMs = Math.Max(1, 1000 / tps);
 
+                    ulong captureUs = PoseChannel.NowUs();
                     using var frame = _cap.CaptureScreenRect(absRoi);
                     if (frame.Empty())
                     {
@@ -162,7 +172,8 @@ public partial class MainWindow : Avalonia.Controls.Window
                     using var botTick = new OpenCvSharp.Mat(frame, new OpenCvSharp.Rect(0, midTick, frame.Cols, hTick - midTick));
 
                     // OCR and parse both lines independently; prefer parsed
-                    string parsed = TryParseBoth(engine, topTick, botTick, out var rawTop, out var rawBot);
+                    string parsed = TryParseBoth(engine, topTick, botTick, out var rawTop, out var rawBot, out var pos);
+                    if (pos != null) _poses?.Publish(pos, captureUs);
 
                     // UI update (parsed-only) + stale indicator
                     Dispatcher.UIThread.Post(() =>
@@ -215,13 +226,14 @@ public partial class MainWindow : Avalonia.Controls.Window
     // OCR both lines using multiple preprocess variants per line.
     // Returns combined parsed text (may be one or two lines).
     private string TryParseBoth(Tesseract.TesseractEngine engine, OpenCvSharp.Mat top, OpenCvSharp.Mat bot,
-                                out string rawTopBest, out string rawBotBest)
+                                out string rawTopBest, out string rawBotBest, out ParsedPos? pos)
     {
-        var (rawT, parsedT) = OcrBestOfVariants(engine, top);
-        var (rawB, parsedB) = OcrBestOfVariants(engine, bot);
+        var (rawT, parsedT, posT) = OcrBestOfVariants(engine, top);
+        var (rawB, parsedB, posB) = OcrBestOfVariants(engine, bot);
 
         rawTopBest = rawT;
         rawBotBest = rawB;
+        pos = posT ?? posB;
 
         return CombineLines(parsedT, parsedB);
     }
@@ -308,10 +320,11 @@ public partial class MainWindow : Avalonia.Controls.Window
     }
 
     // Try several preprocess variants for one line, pick the best by parse-count then length.
-    private (string raw, string parsed) OcrBestOfVariants(Tesseract.TesseractEngine eng, OpenCvSharp.Mat line)
+    private (string raw, string parsed, ParsedPos? pos) OcrBestOfVariants(Tesseract.TesseractEngine eng, OpenCvSharp.Mat line)
     {
         var bestRaw = "";
         var bestParsed = "";
+        ParsedPos? bestPos = null;
         int bestMatches = -1;
         int bestLen = -1;
 
@@ -332,10 +345,11 @@ public partial class MainWindow : Avalonia.Controls.Window
                     bestLen = len;
                     bestRaw = txt;
                     bestParsed = parsed;
+                    bestPos = items.FirstOrDefault();
                 }
             }
         }
-        return (bestRaw, bestParsed);
+        return (bestRaw, bestParsed, bestPos);
     }
 
 }
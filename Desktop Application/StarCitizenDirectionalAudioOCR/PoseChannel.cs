@@ -0,0 +1,116 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+using System.Threading;
+
+namespace StarCitizenDirectionalAudioOCR;
+
+// Writer side of the shared-memory pose channel read by the TeamSpeak plugin.
+// Layout and seqlock protocol must match pose_channel.h in the plugin sources.
+public sealed class PoseChannel : IDisposable
+{
+    private const uint Magic = 0x41444353; // "SCDA"
+    private const ushort Version = 1;
+    private const int RegionSize = 4096;
+    private const int HeaderSize = 64;
+    private const int SlotOffset = 64;
+    private const int SlotSize = 128;
+    private const int ZoneLen = 48;
+
+    // Slot field offsets (relative to SlotOffset)
+    private const int OffSeq = 0, OffZoneId = 4, OffSequence = 8, OffCapture = 16;
+    private const int OffX = 24, OffY = 32, OffZ = 40, OffZone = 48;
+
+    private readonly MemoryMappedFile _map;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly EventWaitHandle? _ready; // wakes the plugin's ingest thread (Windows only)
+    private readonly byte[] _zoneBuf = new byte[ZoneLen];
+    private ulong _sequence;
+
+    public PoseChannel()
+    {
+        if (OperatingSystem.IsWindows())
+        {
+            _map = MemoryMappedFile.CreateOrOpen(@"Local\SCTS3DA.Pose", RegionSize);
+            _ready = new EventWaitHandle(false, EventResetMode.AutoReset, @"Local\SCTS3DA.PoseReady");
+        }
+        else
+        {
+            // Named maps are Windows-only in .NET; shm_open("/scts3da.pose") lives here.
+            _map = MemoryMappedFile.CreateFromFile("/dev/shm/scts3da.pose", FileMode.OpenOrCreate,
+                                                   null, RegionSize, MemoryMappedFileAccess.ReadWrite);
+        }
+        _view = _map.CreateViewAccessor(0, RegionSize);
+
+        _view.Write(4, Version);
+        _view.Write(6, (ushort)HeaderSize);
+        _view.Write(8, (uint)SlotOffset);
+        _view.Write(12, (uint)SlotSize);
+        _view.Write(16, (uint)Environment.ProcessId);
+        _sequence = _view.ReadUInt64(SlotOffset + OffSequence);
+        Thread.MemoryBarrier();
+        _view.Write(0, Magic); // plugin treats the channel as attached from here on
+    }
+
+    // Monotonic microseconds in the same clock domain as monoNowUs() in the plugin.
+    public static ulong NowUs() => (ulong)(Stopwatch.GetTimestamp() * (1_000_000.0 / Stopwatch.Frequency));
+
+    public void Publish(ParsedPos pos, ulong captureUs)
+    {
+        int len = EncodeZone(pos.Zone);
+        uint zoneId = ZoneId(_zoneBuf, len);
+
+        uint seq = _view.ReadUInt32(SlotOffset + OffSeq);
+        if ((seq & 1) != 0) seq++; // a previous helper died mid-write
+        _view.Write(SlotOffset + OffSeq, seq + 1);
+        Thread.MemoryBarrier();
+
+        _view.Write(SlotOffset + OffZoneId, zoneId);
+        _view.Write(SlotOffset + OffSequence, ++_sequence);
+        _view.Write(SlotOffset + OffCapture, captureUs);
+        _view.Write(SlotOffset + OffX, pos.X_m);
+        _view.Write(SlotOffset + OffY, pos.Y_m);
+        _view.Write(SlotOffset + OffZ, pos.Z_m);
+        _view.WriteArray(SlotOffset + OffZone, _zoneBuf, 0, ZoneLen);
+
+        Thread.MemoryBarrier();
+        _view.Write(SlotOffset + OffSeq, seq + 2);
+        _ready?.Set();
+    }
+
+    // Trimmed UTF-8, truncated to fit with a terminating NUL.
+    private int EncodeZone(string zone)
+    {
+        Array.Clear(_zoneBuf);
+        var bytes = Encoding.UTF8.GetBytes((zone ?? "").Trim());
+        int len = Math.Min(bytes.Length, ZoneLen - 1);
+        // Don't cut a multi-byte sequence in half
+        while (len > 0 && len < bytes.Length && (bytes[len] & 0xC0) == 0x80) len--;
+        Array.Copy(bytes, _zoneBuf, len);
+        return len;
+    }
+
+    // FNV-1a over ASCII-lower-cased UTF-8 bytes; twin of zoneIdFromName() in zones.cpp.
+    private static uint ZoneId(byte[] bytes, int len)
+    {
+        if (len == 0) return 0;
+        uint h = 2166136261;
+        for (int i = 0; i < len; i++)
+        {
+            uint c = bytes[i];
+            if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+            h ^= c;
+            h *= 16777619;
+        }
+        return h != 0 ? h : 1;
+    }
+
+    public void Dispose()
+    {
+        _ready?.Dispose();
+        _view.Dispose();
+        _map.Dispose();
+    }
+}
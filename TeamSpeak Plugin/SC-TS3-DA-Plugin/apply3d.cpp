@@ -0,0 +1,182 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "apply3d.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "latency.h"
+#include "peer_pose.h"
+
+#define APPLY3D_PERIOD_US  (1000000ull / APPLY3D_RATE_HZ)
+
+/* What TeamSpeak currently has for a slot; ingest thread only. */
+struct Applied {
+    uint32_t seq;         /* peerPoseSeq() last looked at */
+    bool     valid;
+    bool     followsListener;
+    uint16_t clientID;
+    uint64_t sch;
+    float    pos[3];
+};
+
+static Applied applied[APPLY3D_MAX_CLIENTS];
+
+/* Ingest-thread state */
+static uint64_t listenerSch = 0;
+static bool     haveListener = false;
+static Pose     listener;
+static bool     haveOrigin = false;
+static uint32_t originZone = 0;
+static double   origin[3];
+static bool     listenerApplied = false;
+static float    appliedListener[3];
+static float    appliedHeading = 0.0f;
+static uint64_t appliedListenerSch = 0;
+static uint64_t nextTickUs = 0;
+static uint64_t windowStartUs = 0;
+static uint64_t windowCalls = 0;
+
+static std::atomic<uint64_t> statTicks(0);
+static std::atomic<uint64_t> statClientCalls(0);
+static std::atomic<uint64_t> statListenerCalls(0);
+static std::atomic<uint64_t> statBelow(0);
+static std::atomic<uint64_t> statRebases(0);
+static std::atomic<double>   statCallsPerSec(0.0);
+
+/* ---- ingest thread ---- */
+
+void apply3dSetListener(uint64_t sch, const Pose& pose)
+{
+    listenerSch = sch;
+    listener = pose;
+    haveListener = sch != 0;
+}
+
+static float dist3(const float a[3], const float b[3])
+{
+    const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/* Returns true if the listener was (re)applied this tick. */
+static bool applyListener(const Apply3dOps& ops, uint64_t nowUs, bool* rebased)
+{
+    *rebased = false;
+    if (!haveListener) return false;
+
+    if (!haveOrigin || listener.zoneId != originZone
+        || std::fabs(listener.x - origin[0]) > APPLY3D_REBASE_M
+        || std::fabs(listener.y - origin[1]) > APPLY3D_REBASE_M
+        || std::fabs(listener.z - origin[2]) > APPLY3D_REBASE_M) {
+        origin[0] = listener.x;
+        origin[1] = listener.y;
+        origin[2] = listener.z;
+        originZone = listener.zoneId;
+        haveOrigin = true;
+        *rebased = true;
+        statRebases.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const float pos[3] = {
+        (float)(listener.x - origin[0]),
+        (float)(listener.y - origin[1]),
+        (float)(listener.z - origin[2]),
+    };
+    const float heading = (listener.flags & POSE_HAS_HEADING) ? listener.heading : 0.0f;
+    if (listenerApplied && !*rebased && appliedListenerSch == listenerSch
+        && dist3(pos, appliedListener) < APPLY3D_MIN_MOVE_M
+        && std::fabs(heading - appliedHeading) < APPLY3D_MIN_TURN_RAD) {
+        return false;
+    }
+
+    /* Star Citizen is z-up; heading runs clockwise from +y in the horizontal plane. */
+    const float forward[3] = { std::sin(heading), std::cos(heading), 0.0f };
+    const float up[3] = { 0.0f, 0.0f, 1.0f };
+    ops.setListener(listenerSch, pos, forward, up);
+    latencyStamp(LATENCY_LOCAL_APPLY, listener.captureUs, nowUs);
+    appliedListener[0] = pos[0];
+    appliedListener[1] = pos[1];
+    appliedListener[2] = pos[2];
+    appliedHeading = heading;
+    appliedListenerSch = listenerSch;
+    listenerApplied = true;
+    statListenerCalls.fetch_add(1, std::memory_order_relaxed);
+    windowCalls++;
+    return true;
+}
+
+void apply3dTick(uint64_t nowUs, const Apply3dOps& ops)
+{
+    if (nowUs < nextTickUs) return;
+    /* Fixed rate, but never try to catch up after a stall. */
+    nextTickUs = nextTickUs + APPLY3D_PERIOD_US > nowUs ? nextTickUs + APPLY3D_PERIOD_US : nowUs + APPLY3D_PERIOD_US;
+    statTicks.fetch_add(1, std::memory_order_relaxed);
+
+    bool rebased;
+    const bool listenerMoved = applyListener(ops, nowUs, &rebased);
+
+    if (haveOrigin) {
+        PeerPoseSnap snap;
+        for (int i = 0; i < APPLY3D_MAX_CLIENTS; i++) {
+            Applied& a = applied[i];
+            const bool dirty = peerPoseSeq(i) != a.seq
+                || (a.valid && (rebased || (a.followsListener && listenerMoved)));
+            if (!dirty || !peerPoseRead(i, &snap)) continue;
+            a.seq = snap.seq;
+
+            if (!snap.live) {
+                a.valid = false;
+                continue;
+            }
+
+            /* Peers in another zone share no coordinate frame with us: keep them at the listener. */
+            float pos[3];
+            a.followsListener = snap.pose.zoneId != originZone;
+            if (a.followsListener) {
+                pos[0] = appliedListener[0];
+                pos[1] = appliedListener[1];
+                pos[2] = appliedListener[2];
+            }
+            else {
+                pos[0] = (float)(snap.pose.x - origin[0]);
+                pos[1] = (float)(snap.pose.y - origin[1]);
+                pos[2] = (float)(snap.pose.z - origin[2]);
+            }
+
+            if (a.valid && !rebased && a.sch == snap.sch && a.clientID == snap.clientID
+                && dist3(pos, a.pos) < APPLY3D_MIN_MOVE_M) {
+                statBelow.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            ops.setClient(snap.sch, snap.clientID, pos);
+            latencyStamp(LATENCY_PEER_APPLY, snap.pose.receiveUs, nowUs);
+            a.valid = true;
+            a.sch = snap.sch;
+            a.clientID = snap.clientID;
+            a.pos[0] = pos[0];
+            a.pos[1] = pos[1];
+            a.pos[2] = pos[2];
+            statClientCalls.fetch_add(1, std::memory_order_relaxed);
+            windowCalls++;
+        }
+    }
+
+    if (!windowStartUs) windowStartUs = nowUs;
+    if (nowUs - windowStartUs >= 1000000ull) {
+        statCallsPerSec.store((double)windowCalls * 1e6 / (double)(nowUs - windowStartUs), std::memory_order_relaxed);
+        windowStartUs = nowUs;
+        windowCalls = 0;
+    }
+}
+
+void apply3dGetStats(Apply3dStats* out)
+{
+    out->ticks = statTicks.load(std::memory_order_relaxed);
+    out->clientCalls = statClientCalls.load(std::memory_order_relaxed);
+    out->listenerCalls = statListenerCalls.load(std::memory_order_relaxed);
+    out->belowThreshold = statBelow.load(std::memory_order_relaxed);
+    out->rebases = statRebases.load(std::memory_order_relaxed);
+    out->callsPerSec = statCallsPerSec.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * 3D apply stage: the only place that calls channelset3DAttributes and
+ * systemset3DListenerAttributes. Runs at APPLY3D_RATE_HZ on the ingest thread
+ * and only touches what changed audibly since the last tick:
+ *
+ *  - peer positions come from peer_pose.h; an unchanged slot sequence number
+ *    is the dirty bit,
+ *  - a dirty client whose position moved less than APPLY3D_MIN_MOVE_M from
+ *    what TeamSpeak already has is skipped (and stays dirty-free until it has
+ *    drifted far enough),
+ *  - the listener is applied at most once per tick, again only past the
+ *    move/turn thresholds.
+ *
+ * TeamSpeak takes float vectors, so positions are sent relative to an origin
+ * near the listener that is re-based when the listener changes zone or wanders
+ * APPLY3D_REBASE_M away from it (which re-applies everyone once).
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+#define APPLY3D_RATE_HZ       30
+#define APPLY3D_MAX_CLIENTS   CLIENT_TABLE_CAPACITY
+#define APPLY3D_MIN_MOVE_M    0.05f
+#define APPLY3D_MIN_TURN_RAD  0.02f     /* ~1 degree */
+#define APPLY3D_REBASE_M      1000.0
+
+struct Apply3dOps {
+    void (*setClient)(uint64_t sch, uint16_t clientID, const float pos[3]);
+    void (*setListener)(uint64_t sch, const float pos[3], const float forward[3], const float up[3]);
+};
+
+struct Apply3dStats {
+    uint64_t ticks;
+    uint64_t clientCalls;
+    uint64_t listenerCalls;
+    uint64_t belowThreshold;  /* dirty updates not worth a call */
+    uint64_t rebases;
+    double   callsPerSec;     /* over the last full second */
+};
+
+/* Ingest thread: our own pose and the connection it applies to (0 = none). */
+void apply3dSetListener(uint64_t sch, const Pose& pose);
+
+/* Ingest thread, as often as convenient; does work only when a tick is due. */
+void apply3dTick(uint64_t nowUs, const Apply3dOps& ops);
+
+void apply3dGetStats(Apply3dStats* out);
@@ -0,0 +1,1171 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "delay_pool.h"
+#include "doppler.h"
+#include "dsp.h"
+#include "master.h"
+#include "occlusion.h"
+#include "panner.h"
+#include "radio.h"
+#include "reverb.h"
+#include "peer_wire.h"
+#include "pose_filter.h"
+#include "pose_frame.h"
+#include "rolloff.h"
+#include "spatial_hash.h"
+#include "timebase.h"
+#include "trajectory.h"
+#include "teamspeak/public_definitions.h"
+#include "zones.h"
+
+/* ---- helpers ---- */
+
+static uint64_t benchNowNs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void benchf(BenchPrint print, void* ctx, const char* fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    print(ctx, buf);
+}
+
+/* Deterministic so runs are comparable. */
+static uint32_t benchRand(uint32_t* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+static double benchUniform(uint32_t* state, double lo, double hi)
+{
+    return lo + (hi - lo) * (benchRand(state) >> 8) * (1.0 / 16777216.0);
+}
+
+/* Keeps results observable so the optimiser cannot drop the work. */
+static volatile uint64_t benchSink;
+
+/* ---- pose frame codec ---- */
+
+#define CODEC_POOL 1024
+
+static void benchPoseCodec(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static Pose poses[CODEC_POOL];
+    static uint8_t frames[CODEC_POOL][POSE_FRAME_SIZE];
+    uint32_t rng = 12345;
+
+    for (int i = 0; i < CODEC_POOL; i++) {
+        Pose& p = poses[i];
+        memset(&p, 0, sizeof(p));
+        p.zoneId = zoneIdFromName(i & 1 ? "ANVL_Carrack" : "Stanton");
+        p.zoneClass = (uint8_t)(i & 1 ? ZONE_CLASS_SHIP : ZONE_CLASS_SPACE);
+        p.flags = POSE_HAS_VELOCITY | POSE_HAS_HEADING;
+        p.sequence = (uint64_t)i;
+        p.captureUs = 1000000ull + (uint64_t)i * 16667ull;
+        /* Half ship-interior scale, half system scale, to exercise posShift. */
+        double range = (i & 1) ? 50.0 : 2.0e10;
+        p.x = benchUniform(&rng, -range, range);
+        p.y = benchUniform(&rng, -range, range);
+        p.z = benchUniform(&rng, -range, range);
+        p.vx = (float)benchUniform(&rng, -300.0, 300.0);
+        p.vy = (float)benchUniform(&rng, -300.0, 300.0);
+        p.vz = (float)benchUniform(&rng, -300.0, 300.0);
+        p.heading = (float)benchUniform(&rng, 0.0, 6.28);
+    }
+
+    uint64_t t0 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        poseFrameEncode(poses[it & (CODEC_POOL - 1)], frames[it & (CODEC_POOL - 1)]);
+    }
+    uint64_t t1 = benchNowNs();
+
+    Pose out;
+    uint64_t acc = 0;
+    for (unsigned it = 0; it < iterations; it++) {
+        if (poseFrameDecode(frames[it & (CODEC_POOL - 1)], POSE_FRAME_SIZE, &out)) acc += out.sequence;
+    }
+    uint64_t t2 = benchNowNs();
+    benchSink = acc;
+
+    /* Round-trip error on the interior-scale half, where precision matters. */
+    double maxErr = 0.0;
+    for (int i = 1; i < CODEC_POOL; i += 2) {
+        poseFrameDecode(frames[i], POSE_FRAME_SIZE, &out);
+        double e = std::fabs(out.x - poses[i].x);
+        if (e > maxErr) maxErr = e;
+    }
+
+    double encNs = (double)(t1 - t0) / iterations;
+    double decNs = (double)(t2 - t1) / iterations;
+    benchf(print, ctx, "posecodec: %d bytes/frame, %u frames", POSE_FRAME_SIZE, iterations);
+    benchf(print, ctx, "posecodec: encode %.1f Mframes/s (%.1f ns/frame)", 1e3 / encNs, encNs);
+    benchf(print, ctx, "posecodec: decode %.1f Mframes/s (%.1f ns/frame)", 1e3 / decNs, decNs);
+    benchf(print, ctx, "posecodec: interior round-trip error %.2f mm", maxErr * 1000.0);
+}
+
+/* ---- peer message parser ---- */
+
+#define PARSE_PEERS   64
+#define PARSE_PER     16   /* one keyframe then deltas, per peer */
+#define PARSE_POOL    (PARSE_PEERS * PARSE_PER)
+
+/*
+ * Messages as a sender walking around a ship produces them, interleaved the
+ * way several peers' commands arrive on the event thread.
+ */
+static void benchPeerParse(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static char msgs[PARSE_POOL][PEER_WIRE_MAX_LEN];
+    static PeerWireState states[PARSE_PEERS];
+    uint32_t rng = 777;
+    size_t bytes = 0;
+
+    for (int peer = 0; peer < PARSE_PEERS; peer++) {
+        Pose p;
+        memset(&p, 0, sizeof(p));
+        p.zoneId = zoneIdFromName("RSI_Constellation_Andromeda");
+        p.zoneClass = ZONE_CLASS_SHIP;
+        p.flags = POSE_HAS_VELOCITY;
+        p.x = benchUniform(&rng, -30.0, 30.0);
+        p.y = benchUniform(&rng, -30.0, 30.0);
+        p.z = benchUniform(&rng, -5.0, 5.0);
+        p.captureUs = 5000000ull;
+        PeerKey key;
+        for (int k = 0; k < PARSE_PER; k++) {
+            char* out = msgs[k * PARSE_PEERS + peer];
+            size_t len;
+            if (k == 0) {
+                len = peerWireKeyframe(p, (uint8_t)peer, out, PEER_WIRE_MAX_LEN);
+                peerKeyFromPose(p, (uint8_t)peer, &key);
+            }
+            else {
+                len = peerWireDelta(key, p, out, PEER_WIRE_MAX_LEN);
+            }
+            bytes += len;
+            p.sequence++;
+            p.captureUs += 50000;
+            p.vx = (float)benchUniform(&rng, -1.5, 1.5);
+            p.vy = (float)benchUniform(&rng, -1.5, 1.5);
+            p.x += p.vx * 0.05;
+            p.y += p.vy * 0.05;
+        }
+    }
+
+    unsigned ok = 0;
+    uint64_t t0 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        const unsigned m = it % PARSE_POOL;
+        ok += peerWireDecode(msgs[m], it, &states[m % PARSE_PEERS]) == PEER_WIRE_OK;
+    }
+    uint64_t t1 = benchNowNs();
+
+    /* Rejection cost for commands that belong to other plugins. */
+    static const char* foreign = "ts3-position-plugin v2 x=12.5 y=3.25 z=-7.0";
+    uint64_t t2 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        ok += peerWireDecode(foreign, it, &states[0]) == PEER_WIRE_OK;
+    }
+    uint64_t t3 = benchNowNs();
+    benchSink = ok;
+
+    double ns = (double)(t1 - t0) / iterations;
+    benchf(print, ctx, "peerparse: %u messages, avg %.1f chars, %u decoded", iterations, (double)bytes / PARSE_POOL, ok);
+    benchf(print, ctx, "peerparse: %.1f ns/message (%.1f M/s)", ns, 1e3 / ns);
+    benchf(print, ctx, "peerparse: foreign reject %.1f ns/message", (double)(t3 - t2) / iterations);
+}
+
+/* ---- rolloff: lookup table vs analytic ---- */
+
+#define ROLLOFF_POOL 4096
+
+static void benchRolloff(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static float dist[ROLLOFF_POOL];
+    static int cls[ROLLOFF_POOL];
+    uint32_t rng = 4242;
+    /* Measure whatever is live (inside the client); bake defaults standalone. */
+    RolloffCurve curves[ZONE_CLASS_COUNT];
+    if (!rolloffGetCurves(curves)) {
+        rolloffDefaults(curves);
+        rolloffBake(curves);
+    }
+
+    /* Log-uniform 0.1 m .. 10 km, as clients spread from the same room to EVA range. */
+    for (int i = 0; i < ROLLOFF_POOL; i++) {
+        dist[i] = (float)std::exp(benchUniform(&rng, std::log(0.1), std::log(10000.0)));
+        cls[i] = (int)(benchRand(&rng) % ZONE_CLASS_COUNT);
+    }
+
+    float acc = 0.0f;
+    uint64_t t0 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        const unsigned k = it & (ROLLOFF_POOL - 1);
+        acc += rolloffAnalytic(curves[cls[k]], dist[k]);
+    }
+    uint64_t t1 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        const unsigned k = it & (ROLLOFF_POOL - 1);
+        acc += rolloffGain(cls[k], dist[k]);
+    }
+    uint64_t t2 = benchNowNs();
+    benchSink = (uint64_t)acc;
+
+    double maxErr = 0.0;
+    for (int i = 0; i < ROLLOFF_POOL; i++) {
+        double e = std::fabs(rolloffGain(cls[i], dist[i]) - rolloffAnalytic(curves[cls[i]], dist[i]));
+        if (e > maxErr) maxErr = e;
+    }
+
+    benchf(print, ctx, "rolloff: %u evaluations, 0.1 m .. 10 km, all zone classes", iterations);
+    benchf(print, ctx, "rolloff: analytic %.2f ns/eval", (double)(t1 - t0) / iterations);
+    benchf(print, ctx, "rolloff: table    %.2f ns/eval", (double)(t2 - t1) / iterations);
+    benchf(print, ctx, "rolloff: max table error %.5f (linear gain)", maxErr);
+}
+
+/* ---- spatial panner ---- */
+
+#define PANNER_BENCH_FRAMES   480  /* 10 ms at 48 kHz */
+#define PANNER_BENCH_CLIENTS  16
+
+static void benchPanner(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static short input[PANNER_BENCH_FRAMES * 2];
+    static short block[PANNER_BENCH_FRAMES * 2];
+    static const unsigned int speakers[2] = { SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT };
+    static Pose sources[PANNER_BENCH_CLIENTS];
+    uint32_t rng = 777;
+
+    for (int i = 0; i < PANNER_BENCH_FRAMES * 2; i++) input[i] = (short)(benchRand(&rng) >> 17) - 16384;
+    Pose listener;
+    memset(&listener, 0, sizeof(listener));
+    listener.flags = POSE_HAS_HEADING;
+    for (int c = 0; c < PANNER_BENCH_CLIENTS; c++) {
+        memset(&sources[c], 0, sizeof(sources[c]));
+        sources[c].x = benchUniform(&rng, -30.0, 30.0);
+        sources[c].y = benchUniform(&rng, -30.0, 30.0);
+        delayPoolAcquire(c, (uint64_t)c + 1);
+    }
+
+    const DspLevel was = dspKernels()->level;
+    benchf(print, ctx, "panner: %u blocks of %d stereo frames (10 ms), %d clients, detected %s",
+        iterations, PANNER_BENCH_FRAMES, PANNER_BENCH_CLIENTS, dspLevelName(dspDetect()));
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        if (!dspSelect((DspLevel)level)) continue;
+        uint64_t acc = 0, geomNs = 0;
+        const uint64_t t0 = benchNowNs();
+        for (unsigned it = 0; it < iterations; it++) {
+            const int c = (int)(it % PANNER_BENCH_CLIENTS);
+            /* the listener turns slowly so gains and delays keep moving */
+            listener.heading = (float)(it / PANNER_BENCH_CLIENTS) * 0.01f;
+            memcpy(block, input, sizeof(block));
+            unsigned int fill = 3u;
+            PannerParams params;
+            const uint64_t g0 = benchNowNs();
+            pannerGeometry(listener, sources[c], &params);
+            geomNs += benchNowNs() - g0;
+            pannerRender(c, (uint64_t)c + 1, params, block, PANNER_BENCH_FRAMES, 2, speakers, &fill);
+            acc += (uint16_t)block[it % (PANNER_BENCH_FRAMES * 2)];
+            if (c == PANNER_BENCH_CLIENTS - 1) delayPoolAudioTick(monoNowUs());
+        }
+        const uint64_t t1 = benchNowNs();
+        benchSink = acc;
+        const double perBlock = (double)(t1 - t0) / iterations;
+        benchf(print, ctx, "panner: %-6s %7.0f ns/client/block (geometry %.0f ns), %.0f talkers per 1%% of a 10 ms block",
+            dspLevelName((DspLevel)level), perBlock, (double)geomNs / iterations, 100000.0 / perBlock);
+    }
+    dspSelect(was);
+    for (int c = 0; c < PANNER_BENCH_CLIENTS; c++) delayPoolRelease(c);
+}
+
+/* ---- pose filter: replay OCR traces ---- */
+
+#define PF_BENCH_MISREAD 3      /* percent of readings with one wrong digit */
+
+struct PfBenchTrace {
+    const char* name;
+    uint8_t     zoneClass;
+    double      speed;          /* m/s while moving */
+    double      accel;          /* m/s^2 when starting, stopping and turning */
+    double      extent;         /* waypoints within +-extent (x, y) */
+    double      origin;         /* zone-relative offset of the area */
+    double      noise;          /* OCR jitter, m */
+    double      quantum;        /* readout resolution, m */
+    double      firstDigit;     /* lowest digit a misread can hit, m */
+    int         digits;         /* ...and how many above it */
+    uint64_t    periodUs;
+};
+
+static const PfBenchTrace pfTraces[] = {
+    { "ship interior, on foot", ZONE_CLASS_SHIP,   1.4,  4.0, 20.0,  0.0,     0.08, 0.001, 0.1, 3, 100000 },
+    { "planet surface, rover",  ZONE_CLASS_PLANET, 20.0, 4.0, 800.0, 35000.0, 0.3,  1.0,   1.0, 4, 100000 },
+};
+
+static double benchGauss(uint32_t* rng)
+{
+    const double u1 = benchUniform(rng, 1e-9, 1.0), u2 = benchUniform(rng, 0.0, 1.0);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307 * u2);
+}
+
+/* Replace one decimal digit of |v| at `place` with another: what a misread glyph does to a readout. */
+static double pfMisread(double v, double place, uint32_t* rng)
+{
+    const double a = std::fabs(v);
+    const int digit = (int)std::fmod(std::floor(a / place + 0.5), 10.0);
+    int other = (int)((benchRand(rng) >> 16) % 9);
+    if (other >= digit) other++;
+    const double changed = a + (other - digit) * place;
+    return v < 0.0 ? -changed : changed;
+}
+
+static void benchPoseFilter(unsigned iterations, BenchPrint print, void* ctx)
+{
+    PoseFilterConfig cfg;
+    poseFilterGetConfig(&cfg);
+    PoseFilterConfig on = cfg;
+    on.enabled = true;
+    poseFilterConfigure(on);
+
+    const uint64_t keyBase = 0x70660000ull + benchNowNs() % 100000 * 16;
+    benchf(print, ctx, "posefilter: %u poses per trace, %d%% misread digits", iterations, PF_BENCH_MISREAD);
+    for (size_t tr = 0; tr < sizeof(pfTraces) / sizeof(pfTraces[0]); tr++) {
+        const PfBenchTrace& T = pfTraces[tr];
+        uint32_t rng = 777 + (uint32_t)tr;
+        double pos[2] = { 0.0, 0.0 }, vel[2] = { 0.0, 0.0 }, goal[2] = { 0.0, 0.0 };
+        uint64_t tUs = 1000000, pauseUntil = 0;
+        double rawSum = 0.0, outSum = 0.0, rawClean = 0.0;
+        unsigned accepted = 0, misreads = 0, caught = 0, falseRejects = 0, clean = 0;
+        uint64_t ns = 0;
+        PoseFilterStats before;
+        poseFilterGetStats(&before);
+        for (unsigned i = 0; i < iterations; i++) {
+            /* Head for random waypoints with limited acceleration, pausing now and then. */
+            const uint64_t stepUs = T.periodUs + (uint64_t)benchUniform(&rng, 0.0, 20000.0);
+            const double dt = (double)stepUs * 1e-6;
+            double want[2] = { 0.0, 0.0 };
+            const double dx = goal[0] - pos[0], dy = goal[1] - pos[1], d = std::sqrt(dx * dx + dy * dy);
+            if (tUs >= pauseUntil) {
+                if (d < T.speed) {
+                    goal[0] = benchUniform(&rng, -T.extent, T.extent);
+                    goal[1] = benchUniform(&rng, -T.extent, T.extent);
+                    if ((benchRand(&rng) >> 16) % 4 == 0) pauseUntil = tUs + (uint64_t)benchUniform(&rng, 5e5, 3e6);
+                }
+                else {
+                    want[0] = dx / d * T.speed;
+                    want[1] = dy / d * T.speed;
+                }
+            }
+            const double ax = want[0] - vel[0], ay = want[1] - vel[1], dv = std::sqrt(ax * ax + ay * ay);
+            const double k = dv > T.accel * dt ? T.accel * dt / dv : 1.0;
+            vel[0] += ax * k;
+            vel[1] += ay * k;
+            pos[0] += vel[0] * dt;
+            pos[1] += vel[1] * dt;
+            tUs += stepUs;
+
+            Pose p;
+            memset(&p, 0, sizeof(p));
+            p.zoneId = 1;
+            p.zoneClass = T.zoneClass;
+            p.captureUs = tUs;
+            const double truth[3] = { T.origin + pos[0], T.origin + pos[1], 2.0 };
+            double read[3];
+            for (int a = 0; a < 3; a++) read[a] = std::floor((truth[a] + T.noise * benchGauss(&rng)) / T.quantum + 0.5) * T.quantum;
+            const bool misread = (benchRand(&rng) >> 16) % 100 < PF_BENCH_MISREAD;
+            if (misread) {
+                const int a = (int)((benchRand(&rng) >> 16) % 3);
+                read[a] = pfMisread(read[a], T.firstDigit * std::pow(10.0, (double)((benchRand(&rng) >> 16) % T.digits)), &rng);
+                misreads++;
+            }
+            p.x = read[0];
+            p.y = read[1];
+            p.z = read[2];
+            double rawErr = 0.0;
+            for (int a = 0; a < 3; a++) rawErr += (read[a] - truth[a]) * (read[a] - truth[a]);
+            rawSum += rawErr;
+            if (!misread) {
+                rawClean += rawErr;
+                clean++;
+            }
+
+            const uint64_t t0 = benchNowNs();
+            const bool ok = poseFilterApply((int)tr, keyBase + tr, &p);
+            ns += benchNowNs() - t0;
+            if (!ok) {
+                if (misread) caught++;
+                else falseRejects++;
+                continue;
+            }
+            accepted++;
+            outSum += (p.x - truth[0]) * (p.x - truth[0]) + (p.y - truth[1]) * (p.y - truth[1]) + (p.z - truth[2]) * (p.z - truth[2]);
+        }
+        PoseFilterStats after;
+        poseFilterGetStats(&after);
+        benchf(print, ctx, "posefilter: %-24s %5.0f ns/pose, rms jitter %.3f m raw (%.3f m without misreads) -> %.3f m filtered",
+            T.name, (double)ns / iterations, std::sqrt(rawSum / iterations), std::sqrt(rawClean / (clean ? clean : 1)),
+            std::sqrt(outSum / (accepted ? accepted : 1)));
+        benchf(print, ctx, "posefilter: %-24s misreads %u, rejected %u (%u genuine poses), restarts %llu",
+            T.name, misreads, caught, falseRejects, (unsigned long long)(after.resets - before.resets));
+    }
+    poseFilterConfigure(cfg);
+}
+
+/* ---- trajectory: sparse peer poses to audio-rate positions ---- */
+
+#define TRAJ_BENCH_CLIENTS 64
+#define TRAJ_BENCH_SPEED   8.0      /* m/s, on circles 10..73 m across */
+#define TRAJ_BENCH_DROP    10       /* percent of poses lost */
+#define TRAJ_BENCH_START_US 10000000ll
+
+struct TrajBenchPeer {
+    double   radius;
+    double   phase;
+    int64_t  clockUs;     /* sender clock minus ours */
+    uint64_t nextCapture; /* sender clock */
+    uint64_t pendingAt;   /* our clock; 0 if nothing in flight */
+    Pose     pending;
+    Pose     latest;
+    bool     haveLatest;
+    bool     haveLast;
+    double   lastOut[2], lastRaw[2];
+};
+
+static void trajBenchPath(const TrajBenchPeer& p, uint64_t senderUs, double pos[2], double vel[2])
+{
+    const double w = TRAJ_BENCH_SPEED / p.radius;
+    const double a = p.phase + w * (double)senderUs * 1e-6;
+    pos[0] = p.radius * std::cos(a);
+    pos[1] = p.radius * std::sin(a);
+    vel[0] = -TRAJ_BENCH_SPEED * std::sin(a);
+    vel[1] = TRAJ_BENCH_SPEED * std::cos(a);
+}
+
+static void benchTrajectory(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static TrajBenchPeer peers[TRAJ_BENCH_CLIENTS];
+    uint32_t rng = 4242;
+    const uint64_t keyBase = 0x7472616a00000000ull + benchNowNs() % 100000 * 1000;
+    for (int c = 0; c < TRAJ_BENCH_CLIENTS; c++) {
+        TrajBenchPeer& p = peers[c];
+        memset(&p, 0, sizeof(p));
+        p.radius = 10.0 + c;
+        p.phase = benchUniform(&rng, 0.0, 6.28);
+        p.clockUs = (int64_t)benchUniform(&rng, -5e6, 5e6);
+        p.nextCapture = (uint64_t)(TRAJ_BENCH_START_US + p.clockUs);
+    }
+
+    const unsigned blocks = iterations / TRAJ_BENCH_CLIENTS;
+    benchf(print, ctx, "trajectory: %d peers at %.0f m/s, poses every 50..150 ms, 30..90 ms latency, %d%% lost, %u blocks of 10 ms",
+        TRAJ_BENCH_CLIENTS, TRAJ_BENCH_SPEED, TRAJ_BENCH_DROP, blocks);
+    double errSum = 0.0, rawSum = 0.0, maxStep = 0.0, maxRawStep = 0.0;
+    uint64_t evals = 0, evalNs = 0;
+    for (unsigned b = 0; b < blocks; b++) {
+        const uint64_t nowUs = (uint64_t)TRAJ_BENCH_START_US + (uint64_t)b * 10000ull;
+        /* Stand-in event thread: deliver what has arrived, capture what is due. */
+        for (int c = 0; c < TRAJ_BENCH_CLIENTS; c++) {
+            TrajBenchPeer& p = peers[c];
+            if (p.pendingAt && p.pendingAt <= nowUs) {
+                p.pending.receiveUs = p.pendingAt;
+                trajectoryPush(c, keyBase + c, p.pending);
+                p.latest = p.pending;
+                p.haveLatest = true;
+                p.pendingAt = 0;
+            }
+            const uint64_t senderNow = (uint64_t)((int64_t)nowUs + p.clockUs);
+            if (senderNow >= p.nextCapture && !p.pendingAt) {
+                double pos[2], vel[2];
+                trajBenchPath(p, p.nextCapture, pos, vel);
+                memset(&p.pending, 0, sizeof(p.pending));
+                p.pending.flags = POSE_HAS_VELOCITY;
+                p.pending.captureUs = p.nextCapture;
+                p.pending.x = pos[0];
+                p.pending.y = pos[1];
+                p.pending.vx = (float)vel[0];
+                p.pending.vy = (float)vel[1];
+                if ((benchRand(&rng) >> 16) % 100 >= TRAJ_BENCH_DROP) {
+                    p.pendingAt = (uint64_t)((int64_t)p.nextCapture - p.clockUs) + (uint64_t)benchUniform(&rng, 30000.0, 90000.0);
+                }
+                p.nextCapture += (uint64_t)benchUniform(&rng, 50000.0, 150000.0);
+            }
+        }
+
+        const uint64_t t0 = benchNowNs();
+        for (int c = 0; c < TRAJ_BENCH_CLIENTS; c++) {
+            TrajBenchPeer& p = peers[c];
+            if (!p.haveLatest) continue;
+            Pose out = p.latest;
+            if (!trajectoryEval(c, keyBase + c, nowUs, &out)) continue;
+            evals++;
+            /* Against the path at the time each method claims to show; steps are what the ear hears jump. */
+            double truth[2], vel[2];
+            trajBenchPath(p, out.captureUs, truth, vel);
+            errSum += (out.x - truth[0]) * (out.x - truth[0]) + (out.y - truth[1]) * (out.y - truth[1]);
+            const double rawX = p.latest.x, rawY = p.latest.y;
+            trajBenchPath(p, (uint64_t)((int64_t)nowUs + p.clockUs), truth, vel);
+            rawSum += (rawX - truth[0]) * (rawX - truth[0]) + (rawY - truth[1]) * (rawY - truth[1]);
+            if (p.haveLast) {
+                maxStep = std::fmax(maxStep, std::hypot(out.x - p.lastOut[0], out.y - p.lastOut[1]));
+                maxRawStep = std::fmax(maxRawStep, std::hypot(rawX - p.lastRaw[0], rawY - p.lastRaw[1]));
+            }
+            p.lastOut[0] = out.x;
+            p.lastOut[1] = out.y;
+            p.lastRaw[0] = rawX;
+            p.lastRaw[1] = rawY;
+            p.haveLast = true;
+        }
+        evalNs += benchNowNs() - t0;
+    }
+    if (!evals) return;
+    TrajectoryStats st;
+    trajectoryGetStats(&st);
+    benchf(print, ctx, "trajectory: %.0f ns/peer/block (incl. error bookkeeping), 64 peers = %.3f%% of the 10 ms budget",
+        (double)evalNs / evals, (double)evalNs / blocks / 100000.0);
+    benchf(print, ctx, "trajectory: rms error %.3f m (latest pose: %.3f m), largest step per block %.3f m (latest pose: %.3f m)",
+        std::sqrt(errSum / evals), std::sqrt(rawSum / evals), maxStep, maxRawStep);
+    benchf(print, ctx, "trajectory: totals interpolated=%llu extrapolated=%llu held=%llu blends=%llu",
+        (unsigned long long)st.interpolated, (unsigned long long)st.extrapolated, (unsigned long long)st.held,
+        (unsigned long long)st.blends);
+}
+
+/* ---- spatial hash vs brute-force scan ---- */
+
+#define SPATIAL_BENCH_CLIENTS 1000
+#define SPATIAL_BENCH_ZONES   4
+#define SPATIAL_BENCH_AREA    1000.0   /* m, square per zone */
+#define SPATIAL_BENCH_RADIUS  50.0f
+#define SPATIAL_BENCH_K       8
+#define SPATIAL_BENCH_KNN_M   500.0f
+#define SPATIAL_BENCH_TICK_S  (1.0 / 30.0)
+
+struct SpatialBenchClient {
+    uint32_t zoneId;
+    double   pos[3];
+    double   vel[2];
+};
+
+static int spatialBruteRadius(const SpatialBenchClient* cl, int self, SpatialHit* out, int max)
+{
+    const double r2 = (double)SPATIAL_BENCH_RADIUS * SPATIAL_BENCH_RADIUS;
+    int n = 0;
+    for (int i = 0; i < SPATIAL_BENCH_CLIENTS && n < max; i++) {
+        if (i == self || cl[i].zoneId != cl[self].zoneId) continue;
+        const double dx = cl[i].pos[0] - cl[self].pos[0], dy = cl[i].pos[1] - cl[self].pos[1], dz = cl[i].pos[2] - cl[self].pos[2];
+        const double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 <= r2) {
+            out[n].id = i;
+            out[n].dist = (float)std::sqrt(d2);
+            n++;
+        }
+    }
+    return n;
+}
+
+static int spatialBruteNearest(const SpatialBenchClient* cl, int self, SpatialHit* out)
+{
+    const double r2 = (double)SPATIAL_BENCH_KNN_M * SPATIAL_BENCH_KNN_M;
+    double best[SPATIAL_BENCH_K];
+    int n = 0;
+    for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) {
+        if (i == self || cl[i].zoneId != cl[self].zoneId) continue;
+        const double dx = cl[i].pos[0] - cl[self].pos[0], dy = cl[i].pos[1] - cl[self].pos[1], dz = cl[i].pos[2] - cl[self].pos[2];
+        const double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > r2 || (n == SPATIAL_BENCH_K && d2 >= best[n - 1])) continue;
+        int j = n < SPATIAL_BENCH_K ? n++ : n - 1;
+        for (; j > 0 && best[j - 1] > d2; j--) {
+            best[j] = best[j - 1];
+            out[j] = out[j - 1];
+        }
+        best[j] = d2;
+        out[j].id = i;
+        out[j].dist = (float)std::sqrt(d2);
+    }
+    return n;
+}
+
+static void benchSpatial(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static SpatialHash hash;
+    static SpatialBenchClient cl[SPATIAL_BENCH_CLIENTS];
+    static SpatialHit hits[SPATIAL_BENCH_CLIENTS];
+    uint32_t rng = 8086;
+    spatialHashInit(&hash, 2.0f * SPATIAL_BENCH_RADIUS);
+    for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) {
+        cl[i].zoneId = 1 + (uint32_t)(i % SPATIAL_BENCH_ZONES);
+        cl[i].pos[0] = benchUniform(&rng, 0.0, SPATIAL_BENCH_AREA);
+        cl[i].pos[1] = benchUniform(&rng, 0.0, SPATIAL_BENCH_AREA);
+        cl[i].pos[2] = benchUniform(&rng, 0.0, 30.0);
+        cl[i].vel[0] = benchUniform(&rng, -6.0, 6.0);
+        cl[i].vel[1] = benchUniform(&rng, -6.0, 6.0);
+        spatialHashUpdate(&hash, i, cl[i].zoneId, cl[i].pos);
+    }
+
+    benchf(print, ctx, "spatial: %d clients in %d zones of %.0f m, moving at up to 8 m/s, %u ticks at 30 Hz, %.0f m cells",
+        SPATIAL_BENCH_CLIENTS, SPATIAL_BENCH_ZONES, SPATIAL_BENCH_AREA, iterations, 2.0f * SPATIAL_BENCH_RADIUS);
+    uint64_t updateNs = 0, hashRadiusNs = 0, bruteRadiusNs = 0, hashKnnNs = 0, bruteKnnNs = 0;
+    uint64_t hashHits = 0, bruteHits = 0, knnMismatch = 0;
+    for (unsigned it = 0; it < iterations; it++) {
+        /* Everyone moves and bounces off the zone edges, as poses arrive. */
+        uint64_t t0 = benchNowNs();
+        for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) {
+            for (int a = 0; a < 2; a++) {
+                cl[i].pos[a] += cl[i].vel[a] * SPATIAL_BENCH_TICK_S;
+                if (cl[i].pos[a] < 0.0 || cl[i].pos[a] > SPATIAL_BENCH_AREA) cl[i].vel[a] = -cl[i].vel[a];
+            }
+            spatialHashUpdate(&hash, i, cl[i].zoneId, cl[i].pos);
+        }
+        uint64_t t1 = benchNowNs();
+        updateNs += t1 - t0;
+
+        t0 = benchNowNs();
+        for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) {
+            hashHits += (uint64_t)spatialHashRadius(&hash, cl[i].zoneId, cl[i].pos, SPATIAL_BENCH_RADIUS, i, hits, SPATIAL_BENCH_CLIENTS);
+        }
+        t1 = benchNowNs();
+        hashRadiusNs += t1 - t0;
+        for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) bruteHits += (uint64_t)spatialBruteRadius(cl, i, hits, SPATIAL_BENCH_CLIENTS);
+        bruteRadiusNs += benchNowNs() - t1;
+
+        /* k-nearest: time each side separately, then compare on a sample. */
+        SpatialHit a[SPATIAL_BENCH_K], b[SPATIAL_BENCH_K];
+        t0 = benchNowNs();
+        for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) {
+            benchSink += (uint64_t)spatialHashNearest(&hash, cl[i].zoneId, cl[i].pos, SPATIAL_BENCH_K, SPATIAL_BENCH_KNN_M, i, a);
+        }
+        t1 = benchNowNs();
+        hashKnnNs += t1 - t0;
+        for (int i = 0; i < SPATIAL_BENCH_CLIENTS; i++) benchSink += (uint64_t)spatialBruteNearest(cl, i, b);
+        bruteKnnNs += benchNowNs() - t1;
+        for (int i = (int)(it % 16); i < SPATIAL_BENCH_CLIENTS; i += 16) {
+            const int na = spatialHashNearest(&hash, cl[i].zoneId, cl[i].pos, SPATIAL_BENCH_K, SPATIAL_BENCH_KNN_M, i, a);
+            const int nb = spatialBruteNearest(cl, i, b);
+            bool same = na == nb;
+            for (int j = 0; same && j < na; j++) same = a[j].dist == b[j].dist;
+            if (!same) knnMismatch++;
+        }
+    }
+
+    SpatialHashStats st;
+    spatialHashGetStats(&hash, &st);
+    const double q = (double)iterations * SPATIAL_BENCH_CLIENTS;
+    benchf(print, ctx, "spatial: update %6.0f ns/client (%llu cell changes, %llu in place), %d cells, max probe %u",
+        (double)updateNs / q, (unsigned long long)st.moves, (unsigned long long)st.updates, st.cells, st.maxProbe);
+    benchf(print, ctx, "spatial: radius %.0f m  hash %7.0f ns/query   brute %7.0f ns/query   %.1fx, hits %llu vs %llu",
+        SPATIAL_BENCH_RADIUS, (double)hashRadiusNs / q, (double)bruteRadiusNs / q, (double)bruteRadiusNs / (double)hashRadiusNs,
+        (unsigned long long)hashHits, (unsigned long long)bruteHits);
+    benchf(print, ctx, "spatial: %d-nearest  hash %7.0f ns/query   brute %7.0f ns/query   %.1fx, %llu fallbacks, %s",
+        SPATIAL_BENCH_K, (double)hashKnnNs / q, (double)bruteKnnNs / q, (double)bruteKnnNs / (double)hashKnnNs,
+        (unsigned long long)st.fallbacks, knnMismatch ? "MISMATCH" : "results identical");
+    benchf(print, ctx, "spatial: per tick (update + one radius and one k-nearest query per client): hash %.2f ms, brute %.2f ms",
+        (double)(updateNs + hashRadiusNs + hashKnnNs) / iterations * 1e-6, (double)(bruteRadiusNs + bruteKnnNs) / iterations * 1e-6);
+}
+
+/* ---- Doppler: full voice chain with fly-bys ---- */
+
+#define DOPPLER_BENCH_CLIENTS 12
+#define DOPPLER_BENCH_SPEED   150.0   /* m/s */
+#define DOPPLER_BENCH_POSE_US 100000ull  /* peers update at 10 Hz */
+
+static void benchDoppler(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static short input[PANNER_BENCH_FRAMES * 2];
+    static short block[PANNER_BENCH_FRAMES * 2];
+    static const unsigned int speakers[2] = { SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT };
+    uint32_t rng = 2024;
+    for (int i = 0; i < PANNER_BENCH_FRAMES * 2; i++) input[i] = (short)(benchRand(&rng) >> 17) - 16384;
+
+    Pose listener;
+    memset(&listener, 0, sizeof(listener));
+    listener.flags = POSE_HAS_HEADING;
+    listener.captureUs = 1;
+
+    const DspLevel was = dspKernels()->level;
+    const unsigned blocks = iterations / DOPPLER_BENCH_CLIENTS;
+    benchf(print, ctx, "doppler: %d talkers flying past at %.0f m/s, poses at 10 Hz, %u blocks of 10 ms",
+        DOPPLER_BENCH_CLIENTS, DOPPLER_BENCH_SPEED, blocks);
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        if (!dspSelect((DspLevel)level)) continue;
+        /* Fresh keys per level so every run starts from idle Doppler state. */
+        const uint64_t keyBase = (uint64_t)level * 1000 + 1;
+        for (int c = 0; c < DOPPLER_BENCH_CLIENTS; c++) delayPoolAcquire(c, keyBase + c);
+
+        float minShift = 0.0f, maxShift = 0.0f, prevDelay[DOPPLER_BENCH_CLIENTS];
+        uint64_t acc = 0;
+        const uint64_t t0 = benchNowNs();
+        for (unsigned b = 0; b < blocks; b++) {
+            const uint64_t nowUs = 1000000ull + (uint64_t)b * 10000ull;
+            for (int c = 0; c < DOPPLER_BENCH_CLIENTS; c++) {
+                /* Parallel tracks 20..130 m to the side, each passing abeam every 4 s. */
+                Pose src;
+                memset(&src, 0, sizeof(src));
+                src.captureUs = nowUs - nowUs % DOPPLER_BENCH_POSE_US;
+                const double t = (double)(src.captureUs % 4000000ull) * 1e-6 - 2.0 + c * 0.1;
+                src.x = 20.0 + 10.0 * c;
+                src.y = DOPPLER_BENCH_SPEED * t;
+
+                memcpy(block, input, sizeof(block));
+                unsigned int fill = 3u;
+                PannerParams params;
+                pannerGeometry(listener, src, &params);
+                params.commonDelay = dopplerAdvance(c, keyBase + c, listener, src, PANNER_BENCH_FRAMES);
+                pannerRender(c, keyBase + c, params, block, PANNER_BENCH_FRAMES, 2, speakers, &fill);
+                acc += (uint16_t)block[b % (PANNER_BENCH_FRAMES * 2)];
+
+                if (b > 0) {
+                    const float shift = (params.commonDelay - prevDelay[c]) / PANNER_BENCH_FRAMES;
+                    if (shift < minShift) minShift = shift;
+                    if (shift > maxShift) maxShift = shift;
+                }
+                prevDelay[c] = params.commonDelay;
+            }
+            delayPoolAudioTick(nowUs);
+        }
+        const uint64_t t1 = benchNowNs();
+        benchSink = acc;
+        for (int c = 0; c < DOPPLER_BENCH_CLIENTS; c++) delayPoolRelease(c);
+
+        const double perClient = (double)(t1 - t0) / ((double)blocks * DOPPLER_BENCH_CLIENTS);
+        benchf(print, ctx, "doppler: %-6s %6.0f ns/client/block, 10 talkers = %.2f%% of the 10 ms budget, pitch %+.1f%% .. %+.1f%%",
+            dspLevelName((DspLevel)level), perClient, perClient * 10.0 / 100000.0, -100.0 * maxShift, -100.0 * minShift);
+    }
+    dspSelect(was);
+}
+
+/* ---- occlusion: SoA biquad banks ---- */
+
+#define OCC_BENCH_FRAMES 480
+#define OCC_BENCH_MAX    64
+
+static void benchOcclusion(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static float blocks[OCC_BENCH_MAX][OCC_BENCH_FRAMES];
+    float* ptrs[OCC_BENCH_MAX];
+    int slots[OCC_BENCH_MAX];
+    uint64_t keys[OCC_BENCH_MAX];
+    OcclusionParams params[OCC_BENCH_MAX];
+    uint32_t rng = 5150;
+    for (int v = 0; v < OCC_BENCH_MAX; v++) {
+        for (int i = 0; i < OCC_BENCH_FRAMES; i++) blocks[v][i] = (float)benchUniform(&rng, -8000.0, 8000.0);
+        ptrs[v] = blocks[v];
+    }
+
+    static const int counts[] = { 8, 32, 64 };
+    const DspLevel was = dspKernels()->level;
+    benchf(print, ctx, "occlusion: low-pass + air shelf per voice, %d-lane banks, %u voice-blocks per case",
+        DSP_BANK_LANES, iterations);
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        if (!dspSelect((DspLevel)level)) continue;
+        for (int ci = 0; ci < 4; ci++) {
+            /* last case: 8 voices with slots DSP_BANK_LANES apart, as talkers usually are */
+            const bool spread = ci == 3;
+            const int n = spread ? 8 : counts[ci];
+            for (int v = 0; v < n; v++) {
+                slots[v] = spread ? v * DSP_BANK_LANES : v;
+                keys[v] = (uint64_t)level * 1000 + (uint64_t)ci * 100 + (uint64_t)v + 1;
+            }
+            const unsigned cycles = iterations / (unsigned)n;
+            const uint64_t t0 = benchNowNs();
+            for (unsigned it = 0; it < cycles; it++) {
+                /* walls coming and going keep the coefficient ramps busy */
+                for (int v = 0; v < n; v++) {
+                    params[v].cutoffHz = ((it + (unsigned)v) & 16) ? 800.0f : OCCLUSION_OPEN_HZ;
+                    params[v].airDb = -(float)((it + (unsigned)v) % 24);
+                }
+                occlusionProcess(slots, keys, params, ptrs, n, OCC_BENCH_FRAMES);
+            }
+            const uint64_t t1 = benchNowNs();
+            benchf(print, ctx, "occlusion: %-6s %2d voices%s %6.0f ns/voice/block",
+                dspLevelName((DspLevel)level), n, spread ? " (sparse slots)" : "               ",
+                (double)(t1 - t0) / ((double)cycles * n));
+        }
+    }
+    benchSink = (uint64_t)(int64_t)blocks[0][0];
+    dspSelect(was);
+}
+
+/* ---- radio: fused band-pass / clip / noise chain ---- */
+
+static void benchRadio(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static float blocks[OCC_BENCH_MAX][OCC_BENCH_FRAMES];
+    static float source[OCC_BENCH_FRAMES];
+    float* ptrs[OCC_BENCH_MAX];
+    int slots[OCC_BENCH_MAX];
+    uint64_t keys[OCC_BENCH_MAX];
+    uint32_t rng = 1701;
+    for (int i = 0; i < OCC_BENCH_FRAMES; i++) source[i] = (float)benchUniform(&rng, -12000.0, 12000.0);
+    for (int v = 0; v < OCC_BENCH_MAX; v++) ptrs[v] = blocks[v];
+
+    static const int counts[] = { 1, 8, 32, 64 };
+    const DspLevel was = dspKernels()->level;
+    benchf(print, ctx, "radio: band-pass + soft clip + noise per voice, %d-lane banks, %u voice-blocks per case",
+        DSP_BANK_LANES, iterations);
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        if (!dspSelect((DspLevel)level)) continue;
+        for (int ci = 0; ci < 5; ci++) {
+            /* last case: 8 voices with slots DSP_BANK_LANES apart, as talkers usually are */
+            const bool spread = ci == 4;
+            const int n = spread ? 8 : counts[ci];
+            for (int v = 0; v < n; v++) {
+                slots[v] = spread ? v * DSP_BANK_LANES : v;
+                keys[v] = (uint64_t)level * 1000 + (uint64_t)ci * 100 + (uint64_t)v + 1;
+            }
+            const unsigned cycles = iterations / (unsigned)n;
+            const uint64_t t0 = benchNowNs();
+            for (unsigned it = 0; it < cycles; it++) {
+                /* somebody keys up every few blocks, so the squelch ramps run too */
+                if (!(it & 7)) radioTalkStatus((int)(it / 8 % (unsigned)n), (it & 8) != 0);
+                for (int v = 0; v < n; v++) memcpy(blocks[v], source, sizeof(source));
+                radioProcess(slots, keys, ptrs, n, OCC_BENCH_FRAMES);
+            }
+            const uint64_t t1 = benchNowNs();
+            benchf(print, ctx, "radio: %-6s %2d voices%s %6.0f ns/voice/block",
+                dspLevelName((DspLevel)level), n, spread ? " (sparse slots)" : "               ",
+                (double)(t1 - t0) / ((double)cycles * n));
+        }
+    }
+    benchSink = (uint64_t)(int64_t)blocks[0][0];
+    dspSelect(was);
+}
+
+/* ---- reverb: one shared network ---- */
+
+#define REVERB_BENCH_FRAMES 480
+#define REVERB_BENCH_MAX    64
+
+static void benchReverb(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static float blocks[REVERB_BENCH_MAX][REVERB_BENCH_FRAMES];
+    alignas(32) static float busL[REVERB_BENCH_FRAMES], busR[REVERB_BENCH_FRAMES];
+    uint32_t rng = 2718;
+    for (int v = 0; v < REVERB_BENCH_MAX; v++) {
+        for (int i = 0; i < REVERB_BENCH_FRAMES; i++) blocks[v][i] = (float)benchUniform(&rng, -8000.0, 8000.0);
+    }
+
+    benchf(print, ctx, "reverb: %d-line FDN, %d-frame blocks, %u blocks per case", REVERB_LINES, REVERB_BENCH_FRAMES, iterations);
+    reverbSetZoneClass(ZONE_CLASS_HANGAR);
+    static const int counts[] = { 1, 8, 32, 64 };
+    for (int ci = 0; ci < 4; ci++) {
+        const int n = counts[ci];
+        const uint64_t t0 = benchNowNs();
+        for (unsigned it = 0; it < iterations; it++) {
+            for (int v = 0; v < n; v++) reverbSend(1, blocks[v], REVERB_BENCH_FRAMES, 0.2f);
+            reverbRender(1, REVERB_BENCH_FRAMES, busL, busR);
+        }
+        const uint64_t t1 = benchNowNs();
+        benchf(print, ctx, "reverb: %2d talkers  %7.0f ns/block", n, (double)(t1 - t0) / iterations);
+    }
+
+    /* Let the tail ring out: the network must stop by itself and then cost nothing. */
+    unsigned tail = 0;
+    while (reverbRender(1, REVERB_BENCH_FRAMES, busL, busR) && tail < 100000) tail++;
+    const uint64_t t0 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) reverbRender(1, REVERB_BENCH_FRAMES, busL, busR);
+    const uint64_t t1 = benchNowNs();
+    benchf(print, ctx, "reverb: tail stopped after %u blocks (%.2f s), idle %.0f ns/block",
+        tail, tail * (double)REVERB_BENCH_FRAMES / 48000.0, (double)(t1 - t0) / iterations);
+    benchSink = (uint64_t)(int64_t)busL[0];
+}
+
+/* ---- master bus: look-ahead limiter ---- */
+
+#define MASTER_BENCH_FRAMES 480
+
+static void benchMaster(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static short block[MASTER_BENCH_FRAMES * 8];
+    static const unsigned int stereo[2] = { SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT };
+    static const unsigned int surround[8] = {
+        SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT, SPEAKER_FRONT_CENTER, SPEAKER_LOW_FREQUENCY,
+        SPEAKER_BACK_LEFT, SPEAKER_BACK_RIGHT, SPEAKER_SIDE_LEFT, SPEAKER_SIDE_RIGHT,
+    };
+    MasterConfig saved, cfg;
+    masterGetConfig(&saved);
+    masterDefaults(&cfg);
+    uint32_t rng = 4242;
+
+    benchf(print, ctx, "master: %d-frame blocks, %d-sample look-ahead, %u blocks per case", MASTER_BENCH_FRAMES, MASTER_LOOKAHEAD, iterations);
+    for (int c = 0; c < 4; c++) {
+        const int channels = c & 1 ? 8 : 2;
+        cfg.compressor = c >= 2;
+        masterConfigure(cfg);
+        uint64_t total = 0;
+        MasterCost cost;
+        masterTakeCost(&cost);
+        for (unsigned it = 0; it < iterations; it++) {
+            /* hot enough that the limiter works on every block */
+            for (int i = 0; i < MASTER_BENCH_FRAMES * channels; i++) block[i] = (short)benchUniform(&rng, -30000.0, 30000.0);
+            unsigned int fill = channels == 8 ? 0xFFu : 0x3u;
+            const uint64_t b0 = benchNowNs();
+            if (masterBegin(0x5CDA, block, MASTER_BENCH_FRAMES, channels, channels == 8 ? surround : stereo, &fill)) {
+                float* const* planes = masterPlanes();
+                for (int i = 0; i < MASTER_BENCH_FRAMES; i++) planes[0][i] += 12000.0f;
+                masterEnd(0x5CDA, block, MASTER_BENCH_FRAMES, channels, channels == 8 ? surround : stereo, &fill);
+            }
+            total += benchNowNs() - b0;
+        }
+        /* the module's own counter, as logged by the mixed callback */
+        masterTakeCost(&cost);
+        benchf(print, ctx, "master: %d ch, %-20s %7.0f ns/block, self-reported %.2f us avg, %.1f us max",
+            channels, cfg.compressor ? "limiter + compressor" : "limiter", (double)total / iterations, cost.avgUs, cost.maxUs);
+    }
+    masterConfigure(saved);
+    benchSink = (uint64_t)block[0];
+}
+
+/* ---- delay lines: interpolated reads ---- */
+
+#define DELAY_BENCH_FRAMES 480
+
+static void benchDelayLine(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static float ring[DELAY_LINE_LEN];
+    alignas(32) static float out[DELAY_BENCH_FRAMES];
+    uint32_t rng = 99;
+    for (int i = 0; i < DELAY_LINE_LEN; i++) ring[i] = (float)benchUniform(&rng, -16384.0, 16384.0);
+
+    benchf(print, ctx, "delayline: %u reads of %d frames, Catmull-Rom, delay ramping by up to 4 samples/block",
+        iterations, DELAY_BENCH_FRAMES);
+    float ref[DELAY_BENCH_FRAMES];
+    dspKernelsFor(DSP_SCALAR)->delayRead(ring, DELAY_LINE_LEN - 1, 1234.25f, 1.003f, DELAY_BENCH_FRAMES, ref);
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        const DspKernels* k = dspKernelsFor((DspLevel)level);
+        if (!k) continue;
+        k->delayRead(ring, DELAY_LINE_LEN - 1, 1234.25f, 1.003f, DELAY_BENCH_FRAMES, out);
+        double maxDiff = 0.0;
+        for (int i = 0; i < DELAY_BENCH_FRAMES; i++) maxDiff = std::fmax(maxDiff, std::fabs(out[i] - ref[i]));
+
+        float acc = 0.0f;
+        const uint64_t t0 = benchNowNs();
+        for (unsigned it = 0; it < iterations; it++) {
+            const float start = (float)((it * 997u) & (DELAY_LINE_LEN - 1));
+            const float step = 1.0f + (float)((int)(it & 7) - 4) * (1.0f / DELAY_BENCH_FRAMES);
+            k->delayRead(ring, DELAY_LINE_LEN - 1, start, step, DELAY_BENCH_FRAMES, out);
+            acc += out[it % DELAY_BENCH_FRAMES];
+        }
+        const uint64_t t1 = benchNowNs();
+        benchSink = (uint64_t)(int64_t)acc;
+        benchf(print, ctx, "delayline: %-6s %6.0f ns/block, %.2f ns/sample, max diff vs scalar %.4f",
+            dspLevelName((DspLevel)level), (double)(t1 - t0) / iterations,
+            (double)(t1 - t0) / iterations / DELAY_BENCH_FRAMES, maxDiff);
+    }
+}
+
+/* ---- delay pool: churn clients while audio runs ---- */
+
+#define CHURN_SLOTS   (DELAY_POOL_LINES + 32)  /* more clients than lines, so the pool runs dry */
+#define CHURN_FRAMES  480
+
+static std::atomic<uint64_t> churnKeys[CHURN_SLOTS];
+static std::atomic<bool> churnRunning;
+
+struct ChurnAudioResult {
+    uint64_t blocks;
+    uint64_t withLine;
+    uint64_t mismatches;
+    uint64_t maxBlockNs;
+};
+
+/*
+ * Stand-in playback thread: every client writes a constant derived from its
+ * key and reads back one block later. Anything other than its own constant
+ * (or the zeros of a freshly handed out line) means two clients shared a
+ * line or a line was reused while still in use.
+ */
+static void churnAudio(ChurnAudioResult* r)
+{
+    static float in[CHURN_FRAMES];
+    static float out[CHURN_FRAMES];
+    memset(r, 0, sizeof(*r));
+    while (churnRunning.load(std::memory_order_acquire)) {
+        const uint64_t t0 = benchNowNs();
+        for (int s = 0; s < CHURN_SLOTS; s++) {
+            const uint64_t key = churnKeys[s].load(std::memory_order_acquire);
+            if (!key) continue;
+            DelayLine* line = delayPoolGet(s, key);
+            r->blocks++;
+            if (!line) continue;
+            r->withLine++;
+            const float v = (float)(key % 30000 + 1);
+            for (int i = 0; i < CHURN_FRAMES; i++) in[i] = v;
+            delayLineWrite(line, in, CHURN_FRAMES);
+            delayLineRead(line, CHURN_FRAMES + DELAY_MIN, CHURN_FRAMES + DELAY_MIN, CHURN_FRAMES, out);
+            for (int i = 2; i < CHURN_FRAMES - 2; i++) {
+                if (out[i] != v && out[i] != 0.0f) {
+                    r->mismatches++;
+                    break;
+                }
+            }
+        }
+        const uint64_t ns = benchNowNs() - t0;
+        if (ns > r->maxBlockNs) r->maxBlockNs = ns;
+        delayPoolAudioTick(monoNowUs());
+    }
+}
+
+static void benchDelayChurn(unsigned iterations, BenchPrint print, void* ctx)
+{
+    uint32_t rng = 31337;
+    uint64_t nextKey = 1;
+    for (int s = 0; s < CHURN_SLOTS; s++) churnKeys[s].store(0);
+
+    DelayPoolStats before;
+    delayPoolGetStats(&before);
+    ChurnAudioResult audio;
+    churnRunning.store(true);
+    std::thread t(churnAudio, &audio);
+
+    /* Stand-in event thread: clients join and leave at random. */
+    const uint64_t t0 = benchNowNs();
+    for (unsigned it = 0; it < iterations; it++) {
+        const int s = (int)(benchRand(&rng) % CHURN_SLOTS);
+        if (churnKeys[s].load(std::memory_order_relaxed)) {
+            churnKeys[s].store(0, std::memory_order_release);
+            delayPoolRelease(s);
+        }
+        else {
+            const uint64_t key = nextKey++;
+            delayPoolAcquire(s, key);
+            churnKeys[s].store(key, std::memory_order_release);
+        }
+        if ((it & 63) == 0) std::this_thread::yield();
+    }
+    const uint64_t t1 = benchNowNs();
+    churnRunning.store(false);
+    t.join();
+    for (int s = 0; s < CHURN_SLOTS; s++) {
+        if (churnKeys[s].load()) delayPoolRelease(s);
+    }
+
+    DelayPoolStats after;
+    delayPoolGetStats(&after);
+    benchf(print, ctx, "delaychurn: %u join/leave ops over %d slots, %d lines, %.0f ns/op",
+        iterations, CHURN_SLOTS, DELAY_POOL_LINES, (double)(t1 - t0) / iterations);
+    benchf(print, ctx, "delaychurn: audio blocks=%llu with line=%llu worst pass=%.1f us",
+        (unsigned long long)audio.blocks, (unsigned long long)audio.withLine, (double)audio.maxBlockNs / 1000.0);
+    benchf(print, ctx, "delaychurn: acquired=%llu released=%llu exhausted=%llu parked now=%u",
+        (unsigned long long)(after.acquired - before.acquired), (unsigned long long)(after.released - before.released),
+        (unsigned long long)(after.exhausted - before.exhausted), after.parked);
+    benchf(print, ctx, "delaychurn: %s (%llu blocks saw another client's samples)",
+        audio.mismatches ? "FAILED" : "ok", (unsigned long long)audio.mismatches);
+}
+
+/* ---- the voice chain's kernels, on private state ---- */
+
+#define CHAIN_BENCH_FRAMES  480    /* 10 ms at 48 kHz */
+#define CHAIN_BENCH_RING    4096   /* power of two */
+#define CHAIN_BENCH_VOICES  32     /* talkers in the block the summary line scales to */
+
+/*
+ * What one talker costs through the kernels the live chain uses: down-mix,
+ * two interpolated delay reads (ITD), an occlusion bank share, pan into the
+ * bus, and per DSP_BANK_LANES voices the bank pass and the final mix. Every
+ * buffer and bank is local and the kernels come from dspKernelsFor(), so
+ * nothing the running plugin uses is touched, not even the selected level.
+ */
+static void benchDspChain(unsigned iterations, BenchPrint print, void* ctx)
+{
+    static short input[CHAIN_BENCH_FRAMES * 2];
+    static short output[CHAIN_BENCH_FRAMES * 2];
+    static float mono[CHAIN_BENCH_FRAMES];
+    static float ring[CHAIN_BENCH_RING];
+    static float left[CHAIN_BENCH_FRAMES], right[CHAIN_BENCH_FRAMES];
+    static float busL[CHAIN_BENCH_FRAMES], busR[CHAIN_BENCH_FRAMES];
+    static float lanes[CHAIN_BENCH_FRAMES * DSP_BANK_LANES];
+    static DspBiquadBank bank;
+    uint32_t rng = 4242;
+
+    for (int i = 0; i < CHAIN_BENCH_FRAMES * 2; i++) input[i] = (short)(benchRand(&rng) >> 17) - 16384;
+    /* A gentle low-pass in every lane and section; stable, and the same at both ends of the ramp. */
+    static const float coefs[DSP_COEFS] = { 0.2f, 0.4f, 0.2f, -0.3f, 0.1f };
+
+    benchf(print, ctx, "dspchain: %u voice-blocks of %d stereo frames (10 ms), detected %s",
+        iterations, CHAIN_BENCH_FRAMES, dspLevelName(dspDetect()));
+    for (int level = DSP_SCALAR; level < DSP_LEVEL_COUNT; level++) {
+        const DspKernels* k = dspKernelsFor((DspLevel)level);
+        if (!k) continue;
+        memset(&bank, 0, sizeof(bank));
+        for (int c = 0; c < DSP_COEFS; c++) {
+            for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+                for (int l = 0; l < DSP_BANK_LANES; l++) bank.cur[c][s][l] = bank.target[c][s][l] = coefs[c];
+            }
+        }
+        memset(ring, 0, sizeof(ring));
+        memset(busL, 0, sizeof(busL));
+        memset(busR, 0, sizeof(busR));
+        unsigned int head = 0;
+
+        const uint64_t t0 = benchNowNs();
+        for (unsigned it = 0; it < iterations; it++) {
+            const int lane = (int)(it % DSP_BANK_LANES);
+            k->toMono(input, CHAIN_BENCH_FRAMES, 2, 3u, mono);
+            for (int i = 0; i < CHAIN_BENCH_FRAMES; i++) ring[(head + (unsigned)i) & (CHAIN_BENCH_RING - 1)] = mono[i];
+            /* the source drifts a little, so both reads resample */
+            const float base = (float)(head + CHAIN_BENCH_RING - 64);
+            head = (head + CHAIN_BENCH_FRAMES) & (CHAIN_BENCH_RING - 1);
+            const float step = 1.0f + 0.001f * (float)(it % 5);
+            k->delayRead(ring, CHAIN_BENCH_RING - 1, base, step, CHAIN_BENCH_FRAMES, left);
+            k->delayRead(ring, CHAIN_BENCH_RING - 1, base - 23.5f, step, CHAIN_BENCH_FRAMES, right);
+            for (int i = 0; i < CHAIN_BENCH_FRAMES; i++) lanes[i * DSP_BANK_LANES + lane] = left[i];
+            k->panAccumulate(left, right, CHAIN_BENCH_FRAMES, 0.7f, 0.72f, 0.5f, 0.48f, busL, busR);
+            if (lane == DSP_BANK_LANES - 1) {
+                k->biquadBank(&bank, lanes, CHAIN_BENCH_FRAMES);
+                memcpy(output, input, sizeof(output));
+                k->mixStereo(busL, busR, CHAIN_BENCH_FRAMES, output, 2, 0, 1);
+                memset(busL, 0, sizeof(busL));
+                memset(busR, 0, sizeof(busR));
+            }
+        }
+        const uint64_t t1 = benchNowNs();
+        benchSink = (uint64_t)(uint16_t)output[iterations % (CHAIN_BENCH_FRAMES * 2)];
+        const double perVoice = (double)(t1 - t0) / iterations;
+        benchf(print, ctx, "dspchain: %-6s %6.0f ns/voice/block, %d talkers %.1f us = %.2f%% of a 10 ms block",
+            dspLevelName((DspLevel)level), perVoice, CHAIN_BENCH_VOICES, perVoice * CHAIN_BENCH_VOICES / 1000.0,
+            perVoice * CHAIN_BENCH_VOICES / 100000.0);
+    }
+}
+
+/* ---- registry ---- */
+
+const BenchEntry benchEntries[] = {
+    { "posecodec", "binary pose frame encode/decode", 10000000, benchPoseCodec, true },
+    { "peerparse", "plugin-command position message parser", 1000000, benchPeerParse, true },
+    { "posefilter", "per-peer Kalman filter replaying OCR traces with misreads", 200000, benchPoseFilter, false },
+    { "trajectory", "peer trajectory interpolation/extrapolation per block", 1280000, benchTrajectory, false },
+    { "spatial",   "spatial hash radius/k-nearest queries vs brute force, 1000 moving clients", 300, benchSpatial, true },
+    { "rolloff",   "custom 3D rolloff: lookup table vs analytic", 10000000, benchRolloff, true },
+    { "panner",    "per-client ILD/ITD panner, 10 ms stereo block", 200000, benchPanner, false },
+    { "doppler",   "panner + Doppler resampling on fly-bys, 10 ms blocks", 120000, benchDoppler, false },
+    { "occlusion", "occlusion/air biquad banks, 10 ms blocks", 200000, benchOcclusion, false },
+    { "radio",     "radio comms chain (fused SIMD pass), 10 ms blocks", 200000, benchRadio, false },
+    { "reverb",    "shared zone reverb (FDN) against talker count, 10 ms blocks", 20000, benchReverb, false },
+    { "master",    "master bus look-ahead limiter/compressor, 10 ms blocks", 100000, benchMaster, false },
+    { "delayline", "fractional delay-line read, 10 ms block", 200000, benchDelayLine, false },
+    { "delaychurn", "delay-line pool under client churn with audio running", 2000000, benchDelayChurn, false },
+    { "dspchain",  "voice chain kernels per talker (mono, ITD reads, bank, pan, mix), private state", 200000, benchDspChain, true },
+};
+const size_t benchEntryCount = sizeof(benchEntries) / sizeof(benchEntries[0]);
+
+const BenchEntry* benchFind(const char* name)
+{
+    for (size_t i = 0; i < benchEntryCount; i++) {
+        if (strcmp(benchEntries[i].name, name) == 0) return &benchEntries[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ * Micro-benchmarks for the plugin's hot paths.
+ *
+ * Each entry runs a self-contained workload and reports one or more lines
+ * through the supplied print callback, so the same code backs the console
+ * runner in bench/ and any in-client reporting.
+ */
+
+#include <cstddef>
+
+typedef void (*BenchPrint)(void* ctx, const char* line);
+
+struct BenchEntry {
+    const char* name;
+    const char* what;
+    unsigned    defaultIterations;
+    void (*run)(unsigned iterations, BenchPrint print, void* ctx);
+    /*
+     * Works on its own data only, so it may run inside the client while audio
+     * plays. The others drive the plugin's per-slot state, the delay pool, the
+     * master bus or the selected DSP level, and belong in the bench/ runner.
+     */
+    bool        inClient;
+};
+
+extern const BenchEntry benchEntries[];
+extern const size_t     benchEntryCount;
+
+/* NULL if no benchmark has that name. */
+const BenchEntry* benchFind(const char* name);
@@ -0,0 +1,48 @@
+/*
+ * Console runner for the plugin micro-benchmarks (bench.cpp).
+ *
+ *   scda_bench                 run everything with default iteration counts
+ *   scda_bench <name> [iters]  run one benchmark
+ *   scda_bench --list
+ *
+ * Build from the plugin directory, e.g.
+ *   g++ -O2 -std=c++14 -I. -Its3client-pluginsdk-26/include bench/scda_bench.cpp bench.cpp delay_pool.cpp doppler.cpp dsp.cpp dsp_sse2.cpp dsp_avx2.cpp master.cpp occlusion.cpp panner.cpp radio.cpp reverb.cpp peer_wire.cpp pose_filter.cpp pose_frame.cpp rolloff.cpp spatial_hash.cpp trajectory.cpp zones.cpp -o scda_bench
+ *   cl /O2 /EHsc /I. /Its3client-pluginsdk-26\include bench\scda_bench.cpp bench.cpp delay_pool.cpp doppler.cpp dsp.cpp dsp_sse2.cpp dsp_avx2.cpp master.cpp occlusion.cpp panner.cpp radio.cpp reverb.cpp peer_wire.cpp pose_filter.cpp pose_frame.cpp rolloff.cpp spatial_hash.cpp trajectory.cpp zones.cpp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+
+static void printLine(void* ctx, const char* line)
+{
+    fprintf((FILE*)ctx, "%s\n", line);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--list") == 0) {
+        for (size_t i = 0; i < benchEntryCount; i++) {
+            printf("%-12s %s\n", benchEntries[i].name, benchEntries[i].what);
+        }
+        return 0;
+    }
+
+    if (argc > 1) {
+        const BenchEntry* e = benchFind(argv[1]);
+        if (!e) {
+            fprintf(stderr, "unknown benchmark '%s' (try --list)\n", argv[1]);
+            return 1;
+        }
+        unsigned iters = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : e->defaultIterations;
+        e->run(iters ? iters : e->defaultIterations, printLine, stdout);
+        return 0;
+    }
+
+    for (size_t i = 0; i < benchEntryCount; i++) {
+        benchEntries[i].run(benchEntries[i].defaultIterations, printLine, stdout);
+    }
+    return 0;
+}
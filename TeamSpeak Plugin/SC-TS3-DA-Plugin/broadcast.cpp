@@ -0,0 +1,67 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "broadcast.h"
+
+#include <atomic>
+
+#include "peer_wire.h"
+#include "send_scheduler.h"
+
+/* Ingest-thread state */
+static PeerKey key;
+static bool haveKey = false;
+static uint8_t nextTag = 0;
+static uint64_t lastKeyUs = 0;
+
+static std::atomic<bool> keyframeRequested(false);
+
+static std::atomic<uint64_t> statKeyframes(0);
+static std::atomic<uint64_t> statDeltas(0);
+static std::atomic<uint64_t> statBytes(0);
+
+size_t broadcastPose(const Pose& in, uint64_t nowUs, char* out, size_t cap)
+{
+    Pose pose = in;
+    sendSchedulerObserve(&pose);
+
+    /* A pending request survives suppression/throttling until a keyframe goes out. */
+    const bool forceKey = !haveKey || keyframeRequested.load(std::memory_order_acquire);
+    const SendDecision decision = sendSchedulerDecide(pose, nowUs, forceKey);
+    if (decision == SEND_SUPPRESS || decision == SEND_THROTTLE) return 0;
+
+    size_t len = 0;
+    const bool wantKey = forceKey || nowUs - lastKeyUs >= BROADCAST_KEYFRAME_US;
+
+    if (!wantKey) len = peerWireDelta(key, pose, out, cap);
+
+    if (len) {
+        statDeltas.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        /* Explicit keyframe, or the delta was not representable. */
+        len = peerWireKeyframe(pose, nextTag, out, cap);
+        if (!len) return 0;
+        peerKeyFromPose(pose, nextTag, &key);
+        nextTag++;
+        haveKey = true;
+        lastKeyUs = nowUs;
+        keyframeRequested.store(false, std::memory_order_release);
+        statKeyframes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    sendSchedulerCommit(pose, nowUs);
+    statBytes.fetch_add(len, std::memory_order_relaxed);
+    return len;
+}
+
+void broadcastRequestKeyframe()
+{
+    keyframeRequested.store(true, std::memory_order_release);
+}
+
+void broadcastGetStats(BroadcastStats* out)
+{
+    out->keyframes = statKeyframes.load(std::memory_order_relaxed);
+    out->deltas = statDeltas.load(std::memory_order_relaxed);
+    out->bytes = statBytes.load(std::memory_order_relaxed);
+}
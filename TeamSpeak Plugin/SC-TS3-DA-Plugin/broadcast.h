@@ -0,0 +1,36 @@
+#pragma once
+
+/*
+ * Outgoing pose broadcaster. Turns our validated local poses into peer wire
+ * messages (peer_wire.h). Whether a pose goes out at all is up to the send
+ * scheduler (send_scheduler.h); what goes out is a keyframe on zone changes,
+ * on request (someone joined our channel) and once BROADCAST_KEYFRAME_US has
+ * passed, a delta otherwise.
+ *
+ * broadcastPose() is called from the ingest thread only; the request/reset
+ * and stats functions are safe from any thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pose.h"
+
+#define BROADCAST_KEYFRAME_US  2000000ull  /* late joiners wait at most this long */
+
+struct BroadcastStats {
+    uint64_t keyframes;
+    uint64_t deltas;
+    uint64_t bytes;      /* message characters handed to sendPluginCommand */
+};
+
+/*
+ * Returns the length of the message written to `out` (PEER_WIRE_MAX_LEN is
+ * always enough), or 0 if nothing should be sent for this pose.
+ */
+size_t broadcastPose(const Pose& pose, uint64_t nowUs, char* out, size_t cap);
+
+/* Next broadcast will be a keyframe. */
+void broadcastRequestKeyframe();
+
+void broadcastGetStats(BroadcastStats* out);
@@ -0,0 +1,195 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "client_table.h"
+
+#include <cstring>
+
+static_assert((CLIENT_TABLE_BUCKETS & (CLIENT_TABLE_BUCKETS - 1)) == 0, "bucket count must be a power of two");
+static_assert(CLIENT_TABLE_CAPACITY < 0xFFFF, "value index must fit the bucket word");
+
+#define BUCKET_MASK  (CLIENT_TABLE_BUCKETS - 1)
+#define MAX_SCH      0xFFFFFFFFull
+
+/* Bucket word: key (48 bits) << 16 | (value index + 1); 0 = empty. */
+static std::atomic<uint64_t> buckets[CLIENT_TABLE_BUCKETS];
+static ClientState values[CLIENT_TABLE_CAPACITY];
+
+/* Event-thread state: free values are either on the stack or above highWater. */
+static uint16_t freeStack[CLIENT_TABLE_CAPACITY];
+static int freeCount = 0;
+static int highWater = 0;
+static size_t used = 0;
+
+/* Our own client per connection; event thread. sch 0 = free. */
+struct SelfEntry {
+    uint64_t sch;
+    uint64_t channelID;
+    uint16_t clientID;
+};
+static SelfEntry selves[CLIENT_TABLE_SELVES];
+
+static std::atomic<uint64_t> statInserts(0);
+static std::atomic<uint64_t> statRemoves(0);
+static std::atomic<uint64_t> statFull(0);
+static std::atomic<unsigned> statMaxProbe(0);
+static std::atomic<size_t>   statSize(0);
+
+static inline unsigned bucketOf(uint64_t key)
+{
+    /* Fibonacci hashing: client IDs are sequential, this spreads them. */
+    return (unsigned)((key * 0x9E3779B97F4A7C15ull) >> 40) & BUCKET_MASK;
+}
+
+static inline uint64_t wordKey(uint64_t w) { return w >> 16; }
+static inline int wordIndex(uint64_t w) { return (int)(w & 0xFFFF) - 1; }
+
+/* Bucket holding `key`, or -1. */
+static int findBucket(uint64_t key)
+{
+    unsigned b = bucketOf(key);
+    for (int n = 0; n < CLIENT_TABLE_BUCKETS; n++) {
+        const uint64_t w = buckets[b].load(std::memory_order_acquire);
+        if (!w) return -1;
+        if (wordKey(w) == key) return (int)b;
+        b = (b + 1) & BUCKET_MASK;
+    }
+    return -1;
+}
+
+int clientTableFind(uint64_t sch, uint16_t clientID)
+{
+    if (sch > MAX_SCH) return -1;
+    const int b = findBucket(clientTableKey(sch, clientID));
+    return b < 0 ? -1 : wordIndex(buckets[b].load(std::memory_order_acquire));
+}
+
+int clientTableInsert(uint64_t sch, uint16_t clientID, bool* created)
+{
+    *created = false;
+    if (sch > MAX_SCH) return -1;
+    const uint64_t key = clientTableKey(sch, clientID);
+
+    unsigned b = bucketOf(key);
+    unsigned probe = 0;
+    for (;; b = (b + 1) & BUCKET_MASK, probe++) {
+        const uint64_t w = buckets[b].load(std::memory_order_relaxed);
+        if (!w) break;
+        if (wordKey(w) == key) return wordIndex(w);
+    }
+
+    int index;
+    if (freeCount) index = freeStack[--freeCount];
+    else if (highWater < CLIENT_TABLE_CAPACITY) index = highWater++;
+    else {
+        statFull.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    /* Fill the value before publishing the bucket that points at it. */
+    ClientState& v = values[index];
+    v.sch = sch;
+    v.clientID = clientID;
+    v.talking = false;
+    v.whisper = false;
+    v.havePose = false;
+    v.zoneClass.store(0, std::memory_order_relaxed);
+    v.nickname[0] = '\0';
+    memset(&v.wire, 0, sizeof(v.wire));
+    v.key.store(key, std::memory_order_release);
+    buckets[b].store((key << 16) | (uint64_t)(index + 1), std::memory_order_release);
+
+    used++;
+    statSize.store(used, std::memory_order_relaxed);
+    statInserts.fetch_add(1, std::memory_order_relaxed);
+    if (probe > statMaxProbe.load(std::memory_order_relaxed)) statMaxProbe.store(probe, std::memory_order_relaxed);
+    *created = true;
+    return index;
+}
+
+int clientTableRemove(uint64_t sch, uint16_t clientID)
+{
+    if (sch > MAX_SCH) return -1;
+    int b = findBucket(clientTableKey(sch, clientID));
+    if (b < 0) return -1;
+    const int index = wordIndex(buckets[b].load(std::memory_order_relaxed));
+
+    /* Backward-shift deletion: no tombstones, probe chains stay short. */
+    unsigned hole = (unsigned)b;
+    unsigned j = hole;
+    for (;;) {
+        j = (j + 1) & BUCKET_MASK;
+        const uint64_t w = buckets[j].load(std::memory_order_relaxed);
+        if (!w) break;
+        const unsigned home = bucketOf(wordKey(w));
+        /* Move w into the hole unless its home lies cyclically in (hole, j]. */
+        const bool stays = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+        if (!stays) {
+            buckets[hole].store(w, std::memory_order_release);
+            hole = j;
+        }
+    }
+    buckets[hole].store(0, std::memory_order_release);
+
+    values[index].key.store(0, std::memory_order_release);
+    freeStack[freeCount++] = (uint16_t)index;
+    used--;
+    statSize.store(used, std::memory_order_relaxed);
+    statRemoves.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void clientTableRemoveConnection(uint64_t sch)
+{
+    for (int i = 0; i < highWater; i++) {
+        const uint64_t key = values[i].key.load(std::memory_order_relaxed);
+        if (key && values[i].sch == sch) clientTableRemove(sch, values[i].clientID);
+    }
+    for (int i = 0; i < CLIENT_TABLE_SELVES; i++) {
+        if (selves[i].sch == sch) selves[i].sch = 0;
+    }
+}
+
+void clientTableSetSelf(uint64_t sch, uint16_t clientID, uint64_t channelID)
+{
+    if (!sch) return;
+    SelfEntry* e = NULL;
+    for (int i = 0; i < CLIENT_TABLE_SELVES; i++) {
+        if (selves[i].sch == sch) {
+            e = &selves[i];
+            break;
+        }
+        if (!e && !selves[i].sch) e = &selves[i];
+    }
+    if (!e) return;  /* more connections than we cache; callers fall back to the SDK */
+    e->sch = sch;
+    e->clientID = clientID;
+    e->channelID = channelID;
+}
+
+bool clientTableSelf(uint64_t sch, uint16_t* clientID, uint64_t* channelID)
+{
+    for (int i = 0; i < CLIENT_TABLE_SELVES; i++) {
+        if (sch && selves[i].sch == sch) {
+            *clientID = selves[i].clientID;
+            *channelID = selves[i].channelID;
+            return true;
+        }
+    }
+    return false;
+}
+
+ClientState* clientTableAt(int index)
+{
+    if (index < 0 || index >= CLIENT_TABLE_CAPACITY) return NULL;
+    return values[index].key.load(std::memory_order_acquire) ? &values[index] : NULL;
+}
+
+void clientTableGetStats(ClientTableStats* out)
+{
+    out->size = statSize.load(std::memory_order_relaxed);
+    out->capacity = CLIENT_TABLE_CAPACITY;
+    out->inserts = statInserts.load(std::memory_order_relaxed);
+    out->removes = statRemoves.load(std::memory_order_relaxed);
+    out->full = statFull.load(std::memory_order_relaxed);
+    out->maxProbe = statMaxProbe.load(std::memory_order_relaxed);
+}
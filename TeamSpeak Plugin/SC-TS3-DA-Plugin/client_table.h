@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+ * Per-client state, keyed by (server connection, client ID) exactly as the
+ * callbacks hand them to us.
+ *
+ * Open addressing with linear probing over a power-of-two bucket array; each
+ * bucket is a single 64-bit word (key + value index), so a probe touches one
+ * cache line in the common case and never chases a pointer. Values live in
+ * one contiguous array and keep their index for as long as the client is
+ * known, so other modules (3D apply, DSP state) index their own arrays by it.
+ *
+ * Insert/remove run on the client event thread only. clientTableFind() may
+ * be called from any thread (audio callbacks included): it never allocates or
+ * blocks, and a lookup racing with a removal either finds the entry or
+ * misses it for that one call; it never returns another client's index.
+ * Callers on other threads should still check ClientState::key.
+ *
+ * Connection handles are small integers in practice; handles that do not fit
+ * in 32 bits are simply not tracked.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "peer_wire.h"
+
+#define CLIENT_TABLE_CAPACITY  256   /* clients across all connections */
+#define CLIENT_TABLE_BUCKETS   512   /* power of two, load factor <= 0.5 */
+#define CLIENT_NICK_LEN        128   /* display name, UTF-8, NUL-terminated */
+#define CLIENT_TABLE_SELVES    16    /* connections we remember our own client on */
+
+struct ClientState {
+    std::atomic<uint64_t> key;      /* clientTableKey(sch, clientID); 0 while free */
+    uint64_t sch;
+    uint16_t clientID;
+    bool     talking;
+    bool     whisper;
+    bool     havePose;              /* wire.pose holds a decoded peer pose */
+    std::atomic<uint8_t> zoneClass; /* of the last peer pose; read by audio callbacks */
+    char     nickname[CLIENT_NICK_LEN];
+    PeerWireState wire;             /* peer position receive state */
+};
+
+struct ClientTableStats {
+    size_t   size;
+    size_t   capacity;
+    uint64_t inserts;
+    uint64_t removes;
+    uint64_t full;                  /* inserts refused */
+    unsigned maxProbe;              /* longest probe sequence seen by insert */
+};
+
+static inline uint64_t clientTableKey(uint64_t sch, uint16_t clientID)
+{
+    return (sch << 16) | clientID;
+}
+
+/* Value index, or -1 if the client is unknown. Any thread. */
+int clientTableFind(uint64_t sch, uint16_t clientID);
+
+/*
+ * Event thread. Returns the existing or newly created (zeroed) entry's index,
+ * or -1 if the table is full. `created` tells which.
+ */
+int clientTableInsert(uint64_t sch, uint16_t clientID, bool* created);
+
+/* Event thread. Return the removed index, or -1 if it was not there. */
+int  clientTableRemove(uint64_t sch, uint16_t clientID);
+void clientTableRemoveConnection(uint64_t sch);
+
+/*
+ * Our own client ID and channel on each connection, so event handlers compare
+ * against a cached value instead of asking the SDK per event. Event thread:
+ * set on connect and when we move; clientTableRemoveConnection() forgets it.
+ * clientTableSelf() returns false if nothing is cached for `sch`.
+ */
+void clientTableSetSelf(uint64_t sch, uint16_t clientID, uint64_t channelID);
+bool clientTableSelf(uint64_t sch, uint16_t* clientID, uint64_t* channelID);
+
+/* Entry by index; NULL for out-of-range or free entries. */
+ClientState* clientTableAt(int index);
+
+void clientTableGetStats(ClientTableStats* out);
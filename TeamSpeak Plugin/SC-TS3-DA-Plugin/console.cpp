@@ -0,0 +1,440 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "console.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "apply3d.h"
+#include "bench.h"
+#include "client_table.h"
+#include "delay_pool.h"
+#include "ingest.h"
+#include "latency.h"
+#include "log_ring.h"
+#include "master.h"
+#include "peers.h"
+#include "profile.h"
+#include "send_scheduler.h"
+#include "timebase.h"
+#include "voice_bus.h"
+
+#define CONSOLE_LINE      512
+#define CONSOLE_PATH      512
+#define CONSOLE_WORD      32
+#define CONSOLE_BENCH_DIV 10   /* in the client, benchmarks run a tenth of their default iterations */
+
+struct ConsoleCommand {
+    const char* name;
+    const char* usage;
+    const char* help;
+    void (*run)(const char* args, ConsolePrint print);
+};
+
+/* Counters "stats" turns into rates: what they were at the previous "stats". */
+struct StatsMark {
+    uint64_t     us;
+    uint64_t     localPoses;
+    uint64_t     peerPoses;
+    uint64_t     calls3d;
+    ProfileEntry post;
+    ProfileEntry mixed;
+};
+
+static char configDir[CONSOLE_PATH] = { 0 };
+static StatsMark lastMark;
+static uint64_t profileSinceUs = 0;
+
+static void consolef(ConsolePrint print, const char* fmt, ...)
+{
+    char buf[CONSOLE_LINE];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    print(buf);
+}
+
+/* Copies the next blank-separated word of `s` into `word` and returns what follows it. */
+static const char* nextWord(const char* s, char* word, size_t len)
+{
+    while (*s == ' ' || *s == '\t') s++;
+    size_t n = 0;
+    while (*s && *s != ' ' && *s != '\t') {
+        if (n + 1 < len) word[n++] = *s;
+        s++;
+    }
+    word[n] = '\0';
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+/* "on" / "off"; false for anything else. */
+static bool parseSwitch(const char* word, bool* out)
+{
+    if (strcmp(word, "on") == 0) *out = true;
+    else if (strcmp(word, "off") == 0) *out = false;
+    else return false;
+    return true;
+}
+
+/* Whole word as a number; false for anything else (trailing junk included). */
+static bool parseNumber(const char* word, double* out)
+{
+    if (!word[0]) return false;
+    char* end;
+    *out = strtod(word, &end);
+    return *end == '\0';
+}
+
+static void takeMark(StatsMark* m)
+{
+    IngestStats is;
+    ingestGetStats(&is);
+    PeerStats ps;
+    peersGetStats(&ps);
+    Apply3dStats as;
+    apply3dGetStats(&as);
+    m->us = monoNowUs();
+    m->localPoses = is.frames - is.rejected;
+    m->peerPoses = ps.keyframes + ps.deltas;
+    m->calls3d = as.clientCalls + as.listenerCalls;
+    profileGet(PROFILE_POST_PROCESS, &m->post);
+    profileGet(PROFILE_MIXED_PLAYBACK, &m->mixed);
+}
+
+/* ---------------- subcommands ---------------- */
+
+/* Rates since the previous "stats" (or since load), then queue depths and everything dropped so far. */
+static void commandStats(const char* args, ConsolePrint print)
+{
+    StatsMark now;
+    takeMark(&now);
+    const double sec = now.us > lastMark.us ? (double)(now.us - lastMark.us) * 1e-6 : 0.0;
+    const double per = sec > 0.0 ? 1.0 / sec : 0.0;
+
+    IngestStats is;
+    ingestGetStats(&is);
+    PeerStats ps;
+    peersGetStats(&ps);
+    Apply3dStats as;
+    apply3dGetStats(&as);
+    ClientTableStats ts;
+    clientTableGetStats(&ts);
+    DelayPoolStats dps;
+    delayPoolGetStats(&dps);
+    VoiceBusStats vs;
+    voiceBusGetStats(&vs);
+    LogRingStats ls;
+    logRingGetStats(&ls);
+    MasterConfig mc;
+    masterGetConfig(&mc);
+    MasterStats ms;
+    masterGetStats(&ms);
+
+    const uint64_t blocks = now.mixed.calls - lastMark.mixed.calls;
+    const uint64_t voices = now.post.calls - lastMark.post.calls;
+    const uint64_t mixedNs = now.mixed.totalNs - lastMark.mixed.totalNs;
+    const uint64_t postNs = now.post.totalNs - lastMark.post.totalNs;
+
+    consolef(print, "[b]stats[/b] over the last %.1f s", sec);
+    consolef(print, "  poses/s: local %.1f, peers %.1f", (now.localPoses - lastMark.localPoses) * per,
+        (now.peerPoses - lastMark.peerPoses) * per);
+    consolef(print, "  3D calls/s: %.1f (client %llu, listener %llu, below threshold %llu in total)",
+        (now.calls3d - lastMark.calls3d) * per, (unsigned long long)as.clientCalls,
+        (unsigned long long)as.listenerCalls, (unsigned long long)as.belowThreshold);
+    if (blocks) {
+        consolef(print, "  DSP us/block: %.1f (mixed %.1f + post-process %.1f), %.1f voices/block, %.2f us/voice",
+            (double)(mixedNs + postNs) * 1e-3 / blocks, (double)mixedNs * 1e-3 / blocks, (double)postNs * 1e-3 / blocks,
+            (double)voices / blocks, voices ? (double)postNs * 1e-3 / voices : 0.0);
+    }
+    else {
+        consolef(print, SCDA_PROFILE ? "  DSP us/block: no audio blocks" : "  DSP us/block: needs SCDA_PROFILE");
+    }
+    consolef(print, "  master: limiter %s (%llu of %llu blocks limited, deepest %.1f dB), compressor %s (%.1f dB now)",
+        mc.limiter ? "on" : "off", (unsigned long long)ms.limited, (unsigned long long)ms.blocks, ms.maxReductionDb,
+        mc.compressor ? "on" : "off", ms.compReductionDb);
+    consolef(print, "  queues: ingest %zu, log %llu, clients %zu/%zu, delay lines %u in use + %u parked/%d, voice bus peak %u voices",
+        is.depth, (unsigned long long)(ls.records - ls.written), ts.size, ts.capacity, dps.inUse, dps.parked,
+        DELAY_POOL_LINES, vs.maxVoices);
+    consolef(print, "  drops: ingest rejected %llu overflow %llu, peers malformed %llu no keyframe %llu full %llu,"
+        " log %llu, voice bus %llu (fallbacks %llu), delay lines exhausted %llu",
+        (unsigned long long)is.rejected, (unsigned long long)is.overflows, (unsigned long long)ps.malformed,
+        (unsigned long long)ps.noKey, (unsigned long long)ps.full, (unsigned long long)ls.dropped,
+        (unsigned long long)vs.dropped, (unsigned long long)vs.fallbacks, (unsigned long long)dps.exhausted);
+    lastMark = now;
+}
+
+/* "trace start" / "trace stop [file]": Chrome trace-event JSON of every probe in between. */
+static void commandProfileTrace(const char* args, ConsolePrint print)
+{
+    char word[CONSOLE_WORD];
+    const char* rest = nextWord(args, word, sizeof(word));
+    if (strcmp(word, "start") == 0) {
+        if (profileTraceStart()) consolef(print, "profile: tracing, /scda profile trace stop to write it");
+        else consolef(print, "[color=red]profile: cannot start a trace (already running?)[/color]");
+        return;
+    }
+    if (strcmp(word, "stop") != 0) {
+        consolef(print, "usage: /scda profile trace start | stop [file]");
+        return;
+    }
+    char path[CONSOLE_PATH + 32];
+    if (*rest) snprintf(path, sizeof(path), "%s", rest);
+    else snprintf(path, sizeof(path), "%s%s", configDir, PROFILE_TRACE_FILE);
+    ProfileStats st;
+    profileGetStats(&st);
+    const long events = profileTraceStop(path);
+    if (events < 0) consolef(print, "[color=red]profile: nothing traced or cannot write %s[/color]", path);
+    else consolef(print, "profile: %ld events (%llu dropped) written to %s", events, (unsigned long long)st.traceDropped, path);
+}
+
+static void commandProfile(const char* args, ConsolePrint print)
+{
+    if (!SCDA_PROFILE) {
+        consolef(print, "profile: compiled out (build with SCDA_PROFILE=1)");
+        return;
+    }
+    char word[CONSOLE_WORD];
+    const char* rest = nextWord(args, word, sizeof(word));
+    if (strcmp(word, "reset") == 0) {
+        profileReset();
+        takeMark(&lastMark);
+        profileSinceUs = monoNowUs();
+        consolef(print, "profile: reset");
+        return;
+    }
+    if (strcmp(word, "dump") == 0) {
+        char path[CONSOLE_PATH + 32];
+        if (*rest) snprintf(path, sizeof(path), "%s", rest);
+        else snprintf(path, sizeof(path), "%s%s", configDir, PROFILE_DUMP_FILE);
+        if (profileWriteFile(path)) consolef(print, "profile: written to %s", path);
+        else consolef(print, "[color=red]profile: cannot write %s[/color]", path);
+        return;
+    }
+    if (strcmp(word, "trace") == 0) {
+        commandProfileTrace(rest, print);
+        return;
+    }
+    if (word[0]) {
+        consolef(print, "usage: /scda profile [reset | dump [file] | trace start | trace stop [file]]");
+        return;
+    }
+    ProfileStats st;
+    profileGetStats(&st);
+    const double sec = (double)(monoNowUs() - profileSinceUs) * 1e-6;
+    consolef(print, "[b]profile[/b] over %.1f s, %d threads, %.2f GHz ticks%s (calls, mean us, max us, share of one core)",
+        sec, st.threads, st.ticksPerNs, st.tracing ? ", tracing" : "");
+    for (int i = 0; i < PROFILE_PROBES; i++) {
+        ProfileEntry e;
+        profileGet((ProfileProbe)i, &e);
+        if (!e.calls) continue;
+        consolef(print, "  %s: %llu, %.2f, %.1f, %.3f%%", profileName((ProfileProbe)i), (unsigned long long)e.calls,
+            (double)e.totalNs * 1e-3 / e.calls, (double)e.maxNs * 1e-3, sec > 0.0 ? (double)e.totalNs * 1e-7 / sec : 0.0);
+    }
+}
+
+static void commandLatency(const char* args, ConsolePrint print)
+{
+    char word[CONSOLE_WORD];
+    const char* rest = nextWord(args, word, sizeof(word));
+    if (strcmp(word, "reset") == 0) {
+        latencyReset();
+        consolef(print, "latency: reset");
+        return;
+    }
+    if (strcmp(word, "dump") == 0) {
+        char path[CONSOLE_PATH + 32];
+        if (*rest) snprintf(path, sizeof(path), "%s", rest);
+        else snprintf(path, sizeof(path), "%s%s", configDir, LATENCY_DUMP_FILE);
+        if (latencyWriteFile(path)) consolef(print, "latency: written to %s", path);
+        else consolef(print, "[color=red]latency: cannot write %s[/color]", path);
+        return;
+    }
+    if (word[0]) {
+        consolef(print, "usage: /scda latency [reset | dump [file]]");
+        return;
+    }
+    consolef(print, "[b]latency[/b] (ms; local from HUD capture, peer from command receipt)");
+    for (int s = 0; s < LATENCY_STAGES; s++) {
+        LatencySummary ls;
+        latencySummary((LatencyStage)s, &ls);
+        if (!ls.count) {
+            consolef(print, "  %s: no samples", latencyStageName((LatencyStage)s));
+            continue;
+        }
+        consolef(print, "  %s: n=%llu mean %.2f p50 %.2f p90 %.2f p99 %.2f p99.9 %.2f max %.2f", latencyStageName((LatencyStage)s),
+            (unsigned long long)ls.count, ls.meanUs * 1e-3, ls.p50Us * 1e-3, ls.p90Us * 1e-3, ls.p99Us * 1e-3,
+            ls.p999Us * 1e-3, ls.maxUs * 1e-3);
+    }
+}
+
+/* Changes apply together once every pair parses; the ingest thread picks them up at its next pose. */
+static void commandSend(const char* args, ConsolePrint print)
+{
+    SendSchedulerConfig cfg;
+    sendSchedulerGetConfig(&cfg);
+    bool changed = false;
+    const char* rest = args;
+    while (*rest) {
+        char word[CONSOLE_WORD], value[CONSOLE_WORD];
+        rest = nextWord(rest, word, sizeof(word));
+        if (strcmp(word, "defaults") == 0) {
+            sendSchedulerDefaults(&cfg);
+            changed = true;
+            continue;
+        }
+        rest = nextWord(rest, value, sizeof(value));
+        double v = 0.0;
+        if (!parseNumber(value, &v) || v < 0.0) word[0] = '\0';
+        if (strcmp(word, "error") == 0 && v > 0.0) cfg.maxErrorM = (float)v;
+        else if (strcmp(word, "heartbeat") == 0) cfg.heartbeatUs = (uint64_t)(v * 1e3);
+        else if (strcmp(word, "gap") == 0) cfg.minGapUs = (uint64_t)(v * 1e3);
+        else {
+            consolef(print, "usage: /scda send [defaults] [error <m>] [heartbeat <ms>] [gap <ms>]");
+            return;
+        }
+        changed = true;
+    }
+    if (changed) {
+        sendSchedulerConfigure(cfg);
+        sendSchedulerGetConfig(&cfg);
+    }
+
+    SendSchedulerStats ss;
+    sendSchedulerGetStats(&ss);
+    consolef(print, "[b]send[/b]%s: error %.2f m, heartbeat %.0f ms, gap %.0f ms", changed ? " (changed)" : "",
+        cfg.maxErrorM, (double)cfg.heartbeatUs * 1e-3, (double)cfg.minGapUs * 1e-3);
+    consolef(print, "  sent %llu (error %llu, heartbeat %llu, keyframe %llu), suppressed %llu, throttled %llu",
+        (unsigned long long)ss.sent, (unsigned long long)ss.errorSends, (unsigned long long)ss.heartbeats,
+        (unsigned long long)ss.forced, (unsigned long long)ss.suppressed, (unsigned long long)ss.throttled);
+}
+
+#define MASTER_USAGE "master [defaults] [limiter on|off] [ceiling <dB>] [release <ms>] [comp on|off] [threshold <dB>]" \
+    " [ratio <r>] [attack <ms>] [comprelease <ms>] [makeup <dB>]"
+
+/* Master bus settings, applied together like "send"; the playback thread reads them at its next block. */
+static void commandMaster(const char* args, ConsolePrint print)
+{
+    MasterConfig cfg;
+    masterGetConfig(&cfg);
+    bool changed = false;
+    const char* rest = args;
+    while (*rest) {
+        char word[CONSOLE_WORD], value[CONSOLE_WORD];
+        rest = nextWord(rest, word, sizeof(word));
+        if (strcmp(word, "defaults") == 0) {
+            masterDefaults(&cfg);
+            changed = true;
+            continue;
+        }
+        rest = nextWord(rest, value, sizeof(value));
+        double v = 0.0;
+        bool ok;
+        if (strcmp(word, "limiter") == 0) ok = parseSwitch(value, &cfg.limiter);
+        else if (strcmp(word, "comp") == 0) ok = parseSwitch(value, &cfg.compressor);
+        else if (!parseNumber(value, &v)) ok = false;
+        else if ((ok = strcmp(word, "ceiling") == 0)) cfg.ceilingDb = (float)v;
+        else if ((ok = strcmp(word, "release") == 0)) cfg.releaseMs = (float)v;
+        else if ((ok = strcmp(word, "threshold") == 0)) cfg.thresholdDb = (float)v;
+        else if ((ok = strcmp(word, "ratio") == 0)) cfg.ratio = (float)v;
+        else if ((ok = strcmp(word, "attack") == 0)) cfg.attackMs = (float)v;
+        else if ((ok = strcmp(word, "comprelease") == 0)) cfg.compReleaseMs = (float)v;
+        else if ((ok = strcmp(word, "makeup") == 0)) cfg.makeupDb = (float)v;
+        if (!ok) {
+            consolef(print, "usage: /scda " MASTER_USAGE);
+            return;
+        }
+        changed = true;
+    }
+    if (changed) {
+        masterConfigure(cfg);
+        masterGetConfig(&cfg);
+    }
+
+    MasterStats ms;
+    masterGetStats(&ms);
+    consolef(print, "[b]master[/b]%s: limiter %s, ceiling %.1f dBFS, release %.0f ms; %llu of %llu blocks limited, deepest %.1f dB",
+        changed ? " (changed)" : "", cfg.limiter ? "on" : "off", cfg.ceilingDb, cfg.releaseMs,
+        (unsigned long long)ms.limited, (unsigned long long)ms.blocks, ms.maxReductionDb);
+    consolef(print, "  compressor %s: threshold %.1f dBFS, ratio %.1f:1, attack %.0f ms, release %.0f ms, makeup %+.1f dB;"
+        " %.1f dB gain reduction now", cfg.compressor ? "on" : "off", cfg.thresholdDb, cfg.ratio, cfg.attackMs,
+        cfg.compReleaseMs, cfg.makeupDb, ms.compReductionDb);
+}
+
+static void benchLine(void* ctx, const char* line)
+{
+    ((ConsolePrint)ctx)(line);
+}
+
+/* Runs on the calling (UI) thread, so iteration counts are kept small. */
+static void commandBench(const char* args, ConsolePrint print)
+{
+    char word[CONSOLE_WORD];
+    const char* rest = nextWord(args, word, sizeof(word));
+    if (!word[0] || strcmp(word, "list") == 0) {
+        consolef(print, "[b]bench[/b] (/scda bench <name> [iterations]; the rest need the bench/ runner)");
+        for (size_t i = 0; i < benchEntryCount; i++) {
+            const BenchEntry& e = benchEntries[i];
+            if (e.inClient) consolef(print, "  %s: %s", e.name, e.what);
+        }
+        return;
+    }
+    const BenchEntry* e = benchFind(word);
+    if (!e) {
+        consolef(print, "bench: no benchmark '%s' (/scda bench list)", word);
+        return;
+    }
+    if (!e->inClient) {
+        consolef(print, "bench: '%s' drives the live plugin's state; run it with the bench/ runner", word);
+        return;
+    }
+    unsigned iterations = (unsigned)strtoul(rest, NULL, 10);
+    if (!iterations) iterations = e->defaultIterations / CONSOLE_BENCH_DIV ? e->defaultIterations / CONSOLE_BENCH_DIV : 1;
+    e->run(iterations, benchLine, (void*)print);
+}
+
+static void commandHelp(const char* args, ConsolePrint print);
+
+static const ConsoleCommand commands[] = {
+    { "stats",   "stats",                         "rates since the last call, queue depths, drops", commandStats },
+    { "profile", "profile [reset | dump [file] | trace start | trace stop [file]]", "time spent in each callback", commandProfile },
+    { "latency", "latency [reset | dump [file]]", "pose latency per pipeline stage", commandLatency },
+    { "send",    "send [defaults] [error <m>] [heartbeat <ms>] [gap <ms>]", "outgoing pose thresholds and what they let through", commandSend },
+    { "master",  MASTER_USAGE, "master bus limiter and compressor", commandMaster },
+    { "bench",   "bench [list | <name> [iterations]]", "micro-benchmarks that are safe in the client", commandBench },
+    { "help",    "help",                          "this list", commandHelp },
+};
+
+static void commandHelp(const char* args, ConsolePrint print)
+{
+    consolef(print, "[b]/scda[/b] subcommands:");
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        consolef(print, "  %s: %s", commands[i].usage, commands[i].help);
+    }
+}
+
+/* ---------------- entry points ---------------- */
+
+void consoleInit(const char* dir)
+{
+    snprintf(configDir, sizeof(configDir), "%s", dir ? dir : "");
+    takeMark(&lastMark);
+    profileSinceUs = lastMark.us;
+}
+
+void consoleExecute(const char* command, ConsolePrint print)
+{
+    char word[CONSOLE_WORD];
+    const char* rest = nextWord(command ? command : "", word, sizeof(word));
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strcmp(word, commands[i].name) == 0) {
+            commands[i].run(rest, print);
+            return;
+        }
+    }
+    if (word[0]) consolef(print, "unknown subcommand '%s'", word);
+    commandHelp(rest, print);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/*
+ * The "/scda" chat command: a table of subcommands that report on the running
+ * plugin (stats, profile.h, latency.h), retune it (send_scheduler.h,
+ * master.h) or run the micro-benchmarks that are safe inside the client
+ * (bench.h). Output goes line by line to a print callback, the chat tab in
+ * the plugin.
+ *
+ * Runs on whichever client thread processes chat commands; the state kept
+ * here (the previous stats mark, the profile reset time) belongs to it.
+ */
+
+typedef void (*ConsolePrint)(const char* line);
+
+/* Where "latency dump" writes by default (TeamSpeak's config directory, with trailing separator). */
+void consoleInit(const char* configDir);
+
+/* Run `command` (everything after "/scda "); prints usage for anything unknown. */
+void consoleExecute(const char* command, ConsolePrint print);
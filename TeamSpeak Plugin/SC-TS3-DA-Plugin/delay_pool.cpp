@@ -0,0 +1,181 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "delay_pool.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "dsp.h"
+#include "timebase.h"
+
+static_assert((DELAY_LINE_LEN & (DELAY_LINE_LEN - 1)) == 0, "DELAY_LINE_LEN must be a power of two");
+static_assert(DELAY_POOL_LINES <= 32767, "line index must fit int16");
+
+/* A parked line may be reused once the playback thread went this many blocks past its release... */
+#define DELAY_PARK_EPOCHS  2
+/* ...or immediately if playback has been idle this long (no callback can be in flight). */
+#define DELAY_IDLE_US      200000ull
+
+struct alignas(64) DelayLine {
+    float    buf[DELAY_LINE_LEN];
+    std::atomic<uint32_t> gen;  /* bumped on every handover (event thread) */
+    uint32_t seenGen;           /* playback thread */
+    uint32_t writePos;          /* playback thread */
+};
+
+static DelayLine lines[DELAY_POOL_LINES];
+
+/* Slot map; written by the event thread, read by the playback thread. */
+static std::atomic<int16_t>  slotLine[CLIENT_TABLE_CAPACITY];
+static std::atomic<uint64_t> slotKey[CLIENT_TABLE_CAPACITY];
+
+/* Event-thread-only free list and parking lot. */
+static int16_t  freeList[DELAY_POOL_LINES];
+static int      freeCount = -1;           /* -1 until first use */
+static int16_t  parkedLine[DELAY_POOL_LINES];
+static uint64_t parkedEpoch[DELAY_POOL_LINES];
+static int      parkedCount = 0;
+
+static std::atomic<uint64_t> audioEpoch(0);
+static std::atomic<uint64_t> audioLastUs(0);
+
+static std::atomic<uint32_t> statInUse(0);
+static std::atomic<uint32_t> statParked(0);
+static std::atomic<uint64_t> statAcquired(0);
+static std::atomic<uint64_t> statReleased(0);
+static std::atomic<uint64_t> statExhausted(0);
+
+/* ---- event thread ---- */
+
+static void initOnce()
+{
+    if (freeCount >= 0) return;
+    for (int i = 0; i < DELAY_POOL_LINES; i++) freeList[i] = (int16_t)(DELAY_POOL_LINES - 1 - i);
+    freeCount = DELAY_POOL_LINES;
+    for (int i = 0; i < CLIENT_TABLE_CAPACITY; i++) slotLine[i].store(-1, std::memory_order_relaxed);
+}
+
+static void unpark()
+{
+    const uint64_t epoch = audioEpoch.load(std::memory_order_acquire);
+    const uint64_t last = audioLastUs.load(std::memory_order_relaxed);
+    const bool idle = !last || monoNowUs() - last > DELAY_IDLE_US;
+    int kept = 0;
+    for (int i = 0; i < parkedCount; i++) {
+        if (idle || epoch >= parkedEpoch[i] + DELAY_PARK_EPOCHS) {
+            freeList[freeCount++] = parkedLine[i];
+        }
+        else {
+            parkedLine[kept] = parkedLine[i];
+            parkedEpoch[kept] = parkedEpoch[i];
+            kept++;
+        }
+    }
+    parkedCount = kept;
+    statParked.store((uint32_t)parkedCount, std::memory_order_relaxed);
+}
+
+bool delayPoolAcquire(int slot, uint64_t key)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return false;
+    initOnce();
+    if (slotLine[slot].load(std::memory_order_relaxed) >= 0) delayPoolRelease(slot);
+    if (!freeCount && parkedCount) unpark();
+    if (!freeCount) {
+        statExhausted.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const int16_t l = freeList[--freeCount];
+    lines[l].gen.fetch_add(1, std::memory_order_relaxed);
+    slotKey[slot].store(key, std::memory_order_relaxed);
+    slotLine[slot].store(l, std::memory_order_release);
+    statInUse.fetch_add(1, std::memory_order_relaxed);
+    statAcquired.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void delayPoolRelease(int slot)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY || freeCount < 0) return;
+    const int16_t l = slotLine[slot].exchange(-1, std::memory_order_acq_rel);
+    if (l < 0) return;
+    slotKey[slot].store(0, std::memory_order_relaxed);
+    parkedLine[parkedCount] = l;
+    parkedEpoch[parkedCount] = audioEpoch.load(std::memory_order_acquire);
+    parkedCount++;
+    statParked.store((uint32_t)parkedCount, std::memory_order_relaxed);
+    statInUse.fetch_sub(1, std::memory_order_relaxed);
+    statReleased.fetch_add(1, std::memory_order_relaxed);
+}
+
+void delayPoolReleaseConnection(uint64_t sch)
+{
+    if (freeCount < 0) return;
+    for (int i = 0; i < CLIENT_TABLE_CAPACITY; i++) {
+        if (slotLine[i].load(std::memory_order_relaxed) >= 0 && slotKey[i].load(std::memory_order_relaxed) >> 16 == sch) {
+            delayPoolRelease(i);
+        }
+    }
+}
+
+/* ---- playback thread ---- */
+
+void delayPoolAudioTick(uint64_t nowUs)
+{
+    audioLastUs.store(nowUs, std::memory_order_relaxed);
+    audioEpoch.fetch_add(1, std::memory_order_release);
+}
+
+DelayLine* delayPoolGet(int slot, uint64_t key)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return NULL;
+    const int16_t l = slotLine[slot].load(std::memory_order_acquire);
+    if (l < 0 || slotKey[slot].load(std::memory_order_relaxed) != key) return NULL;
+
+    DelayLine* line = &lines[l];
+    const uint32_t gen = line->gen.load(std::memory_order_relaxed);
+    if (line->seenGen != gen) {
+        memset(line->buf, 0, sizeof(line->buf));
+        line->writePos = 0;
+        line->seenGen = gen;
+    }
+    return line;
+}
+
+void delayLineWrite(DelayLine* line, const float* in, int frames)
+{
+    if (frames > DELAY_MAX_BLOCK) frames = DELAY_MAX_BLOCK;
+    const uint32_t pos = line->writePos & (DELAY_LINE_LEN - 1);
+    const uint32_t first = DELAY_LINE_LEN - pos < (uint32_t)frames ? DELAY_LINE_LEN - pos : (uint32_t)frames;
+    memcpy(line->buf + pos, in, first * sizeof(float));
+    memcpy(line->buf, in + first, (frames - first) * sizeof(float));
+    line->writePos = pos + (uint32_t)frames;
+}
+
+static float clampDelay(float d)
+{
+    return d < DELAY_MIN ? DELAY_MIN : d > DELAY_MAX ? DELAY_MAX : d;
+}
+
+void delayLineRead(const DelayLine* line, float d0, float d1, int frames, float* out)
+{
+    if (frames <= 0) return;
+    if (frames > DELAY_MAX_BLOCK) frames = DELAY_MAX_BLOCK;
+    d0 = clampDelay(d0);
+    d1 = clampDelay(d1);
+    /* Output i reads input at (start of block + i) - delay(i); the block starts `frames` back from writePos. */
+    float start = (float)((line->writePos - (uint32_t)frames) & (DELAY_LINE_LEN - 1)) - d0;
+    if (start < 0.0f) start += (float)DELAY_LINE_LEN;
+    const float step = 1.0f - (d1 - d0) / (float)frames;
+    dspKernels()->delayRead(line->buf, DELAY_LINE_LEN - 1, start, step, frames, out);
+}
+
+void delayPoolGetStats(DelayPoolStats* out)
+{
+    out->inUse = statInUse.load(std::memory_order_relaxed);
+    out->parked = statParked.load(std::memory_order_relaxed);
+    out->acquired = statAcquired.load(std::memory_order_relaxed);
+    out->released = statReleased.load(std::memory_order_relaxed);
+    out->exhausted = statExhausted.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+ * Per-client delay lines for ITD and Doppler, handed out from a fixed pool.
+ *
+ * The client event thread acquires a line when a client table slot is
+ * created and releases it when the client leaves; the playback thread only
+ * looks lines up. Nothing allocates after static init. A released line is
+ * parked until the playback thread has finished at least one more full
+ * cycle (delayPoolAudioTick), so a callback that was already using it can
+ * never see it reassigned underneath; the first playback-thread access after
+ * a handover clears it.
+ *
+ * Reads are interpolated (4-point Catmull-Rom) at fractional delays that may
+ * ramp across the block, which is a time-varying resampler as far as the
+ * signal is concerned.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+
+#define DELAY_LINE_LEN     8192   /* samples, power of two (~170 ms at 48 kHz) */
+#define DELAY_POOL_LINES   128    /* clients beyond this get no line (no ITD/Doppler) */
+#define DELAY_MIN          2.0f   /* the interpolator needs two samples ahead */
+#define DELAY_MAX_BLOCK    2048   /* frames per write/read */
+#define DELAY_MAX          ((float)(DELAY_LINE_LEN - DELAY_MAX_BLOCK - 4))
+
+struct DelayLine;
+
+struct DelayPoolStats {
+    uint32_t inUse;
+    uint32_t parked;        /* released, waiting for the playback thread */
+    uint64_t acquired;
+    uint64_t released;
+    uint64_t exhausted;     /* acquire found no free line */
+};
+
+/* Event thread. */
+bool delayPoolAcquire(int slot, uint64_t key);
+void delayPoolRelease(int slot);
+void delayPoolReleaseConnection(uint64_t sch);
+
+/* Playback thread, once per mixed block: lets parked lines go back to the pool. */
+void delayPoolAudioTick(uint64_t nowUs);
+
+/* Playback thread: the line for `slot` if it belongs to `key`, else NULL. */
+DelayLine* delayPoolGet(int slot, uint64_t key);
+
+/* Append `frames` (<= DELAY_MAX_BLOCK) samples. */
+void delayLineWrite(DelayLine* line, const float* in, int frames);
+
+/*
+ * out[i] = input delayed by a delay ramping from d0 to d1 across the block,
+ * measured in samples back from the sample written at the same index by the
+ * last delayLineWrite(). Delays are clamped to [DELAY_MIN, DELAY_MAX].
+ */
+void delayLineRead(const DelayLine* line, float d0, float d1, int frames, float* out);
+
+void delayPoolGetStats(DelayPoolStats* out);
@@ -0,0 +1,139 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "doppler.h"
+
+#include <atomic>
+#include <cmath>
+
+#define DOPPLER_SPEED_OF_SOUND 343.0f
+#define DOPPLER_SMOOTH         0.3f    /* per-block one-pole on the shift */
+#define DOPPLER_LEAK           0.002f  /* per-block pull back towards DOPPLER_CENTER */
+#define DOPPLER_MIN_DIST_M     0.5f
+#define DOPPLER_NEGLIGIBLE     0.002f
+/* The panner's ITD rides on top of the common delay. */
+#define DOPPLER_DELAY_HI       (DELAY_MAX - 64.0f)
+
+/* Last few distinct poses of one side, newest at (head - 1). */
+struct PoseHistory {
+    uint32_t zoneId;
+    int      count;
+    int      head;
+    uint64_t tUs[DOPPLER_HISTORY];
+    double   pos[DOPPLER_HISTORY][3];
+};
+
+struct DopplerState {
+    uint64_t    key;
+    bool        primed;
+    float       shift;   /* smoothed pitch offset, + = receding (lower) */
+    float       delay;   /* common delay at the end of the last block */
+    PoseHistory hist;
+};
+
+static DopplerState states[CLIENT_TABLE_CAPACITY];
+static PoseHistory listenerHist;
+
+static std::atomic<uint64_t> statBlocks(0);
+static std::atomic<uint64_t> statShifted(0);
+static std::atomic<uint64_t> statLimited(0);
+
+static void historyPush(PoseHistory* h, const Pose& p)
+{
+    if (h->count) {
+        const int last = (h->head + DOPPLER_HISTORY - 1) % DOPPLER_HISTORY;
+        if (h->tUs[last] == p.captureUs) return;  /* same pose as last block */
+        if (h->zoneId != p.zoneId || p.captureUs < h->tUs[last] || p.captureUs - h->tUs[last] > DOPPLER_STALE_US) {
+            h->count = 0;
+        }
+    }
+    h->zoneId = p.zoneId;
+    h->tUs[h->head] = p.captureUs;
+    h->pos[h->head][0] = p.x;
+    h->pos[h->head][1] = p.y;
+    h->pos[h->head][2] = p.z;
+    h->head = (h->head + 1) % DOPPLER_HISTORY;
+    if (h->count < DOPPLER_HISTORY) h->count++;
+}
+
+/* Least-squares slope over the history; zero with fewer than two poses. */
+static void historyVelocity(const PoseHistory& h, float v[3])
+{
+    v[0] = v[1] = v[2] = 0.0f;
+    if (h.count < 2) return;
+    const int first = (h.head + DOPPLER_HISTORY - h.count) % DOPPLER_HISTORY;
+    double tMean = 0.0, pMean[3] = { 0.0, 0.0, 0.0 };
+    for (int k = 0; k < h.count; k++) {
+        const int i = (first + k) % DOPPLER_HISTORY;
+        tMean += (double)(h.tUs[i] - h.tUs[first]) * 1e-6;
+        for (int a = 0; a < 3; a++) pMean[a] += h.pos[i][a];
+    }
+    tMean /= h.count;
+    for (int a = 0; a < 3; a++) pMean[a] /= h.count;
+
+    double stt = 0.0, stp[3] = { 0.0, 0.0, 0.0 };
+    for (int k = 0; k < h.count; k++) {
+        const int i = (first + k) % DOPPLER_HISTORY;
+        const double dt = (double)(h.tUs[i] - h.tUs[first]) * 1e-6 - tMean;
+        stt += dt * dt;
+        for (int a = 0; a < 3; a++) stp[a] += dt * (h.pos[i][a] - pMean[a]);
+    }
+    if (stt <= 0.0) return;
+    for (int a = 0; a < 3; a++) v[a] = (float)(stp[a] / stt);
+}
+
+float dopplerAdvance(int slot, uint64_t key, const Pose& listener, const Pose& source, int frames)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return DOPPLER_CENTER;
+    statBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    DopplerState& st = states[slot];
+    if (!st.primed || st.key != key) {
+        st.key = key;
+        st.primed = true;
+        st.shift = 0.0f;
+        st.delay = DOPPLER_CENTER;
+        st.hist.count = 0;
+        st.hist.head = 0;
+    }
+    historyPush(&st.hist, source);
+    historyPush(&listenerHist, listener);
+
+    /* Radial velocity, + = separating. */
+    float target = 0.0f;
+    const float dx = (float)(source.x - listener.x);
+    const float dy = (float)(source.y - listener.y);
+    const float dz = (float)(source.z - listener.z);
+    const float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (d >= DOPPLER_MIN_DIST_M && source.zoneId == listener.zoneId) {
+        float vs[3], vl[3];
+        historyVelocity(st.hist, vs);
+        historyVelocity(listenerHist, vl);
+        const float vr = ((vs[0] - vl[0]) * dx + (vs[1] - vl[1]) * dy + (vs[2] - vl[2]) * dz) / d;
+        target = DOPPLER_FACTOR * vr / DOPPLER_SPEED_OF_SOUND;
+        if (target > DOPPLER_MAX_SHIFT) target = DOPPLER_MAX_SHIFT;
+        if (target < -DOPPLER_MAX_SHIFT) target = -DOPPLER_MAX_SHIFT;
+    }
+    st.shift += DOPPLER_SMOOTH * (target - st.shift);
+
+    /* Receding adds delay (reads slower, pitch down); approaching eats it. */
+    float step = st.shift * (float)frames;
+    const float room = step > 0.0f ? DOPPLER_DELAY_HI - st.delay : st.delay - DELAY_MIN;
+    if (std::fabs(st.shift) > DOPPLER_NEGLIGIBLE) {
+        statShifted.fetch_add(1, std::memory_order_relaxed);
+        if (room < DOPPLER_EDGE) {
+            step *= room > 0.0f ? room / DOPPLER_EDGE : 0.0f;
+            statLimited.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    st.delay += step + (DOPPLER_CENTER - st.delay) * DOPPLER_LEAK;
+    if (st.delay < DELAY_MIN) st.delay = DELAY_MIN;
+    if (st.delay > DOPPLER_DELAY_HI) st.delay = DOPPLER_DELAY_HI;
+    return st.delay;
+}
+
+void dopplerGetStats(DopplerStats* out)
+{
+    out->blocks = statBlocks.load(std::memory_order_relaxed);
+    out->shifted = statShifted.load(std::memory_order_relaxed);
+    out->limited = statLimited.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+ * Doppler for remote clients. Each client's voice already runs through its
+ * pooled delay line (delay_pool.h); Doppler is a common delay on both ears
+ * that grows while the source recedes and shrinks while it approaches, and
+ * the ramped interpolated read turns that into a smoothly varying resampling
+ * ratio.
+ *
+ * The radial velocity comes from each side's recent pose history (peer and
+ * listener), fitted over the last DOPPLER_HISTORY poses rather than taken
+ * from the sender, so a jittery OCR position cannot flip the pitch.
+ * Physical Doppler at ship speeds is comical and would need seconds of
+ * buffer, so the shift is scaled by DOPPLER_FACTOR and clamped; the delay
+ * idles at DOPPLER_CENTER (the latency this stage costs) and fades the shift
+ * out near either end of the line instead of hitting it.
+ *
+ * Playback thread only, indexed by client table slot.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "delay_pool.h"
+#include "pose.h"
+
+#define DOPPLER_FACTOR     0.25f     /* fraction of the physical shift */
+#define DOPPLER_MAX_SHIFT  0.1f      /* |pitch ratio - 1| */
+#define DOPPLER_HISTORY    4         /* poses per side in the velocity fit */
+#define DOPPLER_STALE_US   1000000ull /* history older than this is dropped */
+#define DOPPLER_CENTER     1200.0f   /* idle delay, samples (25 ms at 48 kHz) */
+#define DOPPLER_EDGE       480.0f    /* headroom over which the shift fades out */
+
+struct DopplerStats {
+    uint64_t blocks;
+    uint64_t shifted;       /* blocks with a non-negligible shift */
+    uint64_t limited;       /* ...that were faded because the line ran out */
+};
+
+/*
+ * Advance `slot` by one block of `frames` and return the common delay (in
+ * samples) to reach at its end. The first block of a client returns
+ * DOPPLER_CENTER.
+ */
+float dopplerAdvance(int slot, uint64_t key, const Pose& listener, const Pose& source, int frames);
+
+void dopplerGetStats(DopplerStats* out);
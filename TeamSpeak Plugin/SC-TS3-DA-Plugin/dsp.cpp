@@ -0,0 +1,259 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "dsp.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "dsp_impl.h"
+
+#if DSP_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* ---- scalar reference ---- */
+
+void dspToMonoScalar(const short* in, int frames, int channels, unsigned int mask, float* out)
+{
+    int idx[32];
+    int n = 0;
+    for (int c = 0; c < channels && c < 32; c++) {
+        if (mask & (1u << c)) idx[n++] = c;
+    }
+    if (!n) {
+        for (int i = 0; i < frames; i++) out[i] = 0.0f;
+        return;
+    }
+    const float scale = 1.0f / (float)n;
+    for (int i = 0; i < frames; i++) {
+        const short* f = in + (size_t)i * channels;
+        int sum = 0;
+        for (int k = 0; k < n; k++) sum += f[idx[k]];
+        out[i] = (float)sum * scale;
+    }
+}
+
+void dspPanStereoScalar(const float* srcL, const float* srcR, int frames,
+                        float gL0, float gL1, float gR0, float gR1,
+                        short* out, int channels, int chL, int chR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    for (int i = 0; i < frames; i++) {
+        short* f = out + (size_t)i * channels;
+        f[chL] = dspSat16(srcL[i] * (gL0 + dL * (float)i));
+        f[chR] = dspSat16(srcR[i] * (gR0 + dR * (float)i));
+    }
+}
+
+void dspDelayReadScalar(const float* ring, unsigned int mask, float start, float step, int frames, float* out)
+{
+    for (int i = 0; i < frames; i++) {
+        const float pos = start + step * (float)i;
+        const int base = (int)pos;
+        const float t = pos - (float)base;
+        out[i] = dspCubic(ring[(base - 1) & mask], ring[base & mask], ring[(base + 1) & mask], ring[(base + 2) & mask], t);
+    }
+}
+
+void dspPanAccumulateScalar(const float* srcL, const float* srcR, int frames,
+                            float gL0, float gL1, float gR0, float gR1,
+                            float* busL, float* busR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    for (int i = 0; i < frames; i++) {
+        busL[i] += srcL[i] * (gL0 + dL * (float)i);
+        busR[i] += srcR[i] * (gR0 + dR * (float)i);
+    }
+}
+
+void dspMixStereoScalar(const float* busL, const float* busR, int frames,
+                        short* out, int channels, int chL, int chR)
+{
+    for (int i = 0; i < frames; i++) {
+        short* f = out + (size_t)i * channels;
+        f[chL] = dspSat16((float)f[chL] + busL[i]);
+        f[chR] = dspSat16((float)f[chR] + busR[i]);
+    }
+}
+
+#define DSP_DENORMAL_FLUSH 1e-15f
+
+void dspBiquadBankFinish(DspBiquadBank* bank)
+{
+    memcpy(bank->cur, bank->target, sizeof(bank->cur));
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        for (int l = 0; l < DSP_BANK_LANES; l++) {
+            if (std::fabs(bank->z1[s][l]) < DSP_DENORMAL_FLUSH) bank->z1[s][l] = 0.0f;
+            if (std::fabs(bank->z2[s][l]) < DSP_DENORMAL_FLUSH) bank->z2[s][l] = 0.0f;
+        }
+    }
+}
+
+void dspBiquadBankScalar(DspBiquadBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    const float inv = 1.0f / (float)frames;
+    /* One section at a time over the whole block: its output is the next one's input. */
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        for (int l = 0; l < DSP_BANK_LANES; l++) {
+            float c[DSP_COEFS], d[DSP_COEFS];
+            for (int k = 0; k < DSP_COEFS; k++) {
+                c[k] = bank->cur[k][s][l];
+                d[k] = (bank->target[k][s][l] - c[k]) * inv;
+            }
+            float z1 = bank->z1[s][l], z2 = bank->z2[s][l];
+            for (int i = 0; i < frames; i++) {
+                for (int k = 0; k < DSP_COEFS; k++) c[k] += d[k];
+                float* v = x + (size_t)i * DSP_BANK_LANES + l;
+                const float in = *v;
+                const float y = c[DSP_B0] * in + z1;
+                z1 = c[DSP_B1] * in - c[DSP_A1] * y + z2;
+                z2 = c[DSP_B2] * in - c[DSP_A2] * y;
+                *v = y;
+            }
+            bank->z1[s][l] = z1;
+            bank->z2[s][l] = z2;
+        }
+    }
+    dspBiquadBankFinish(bank);
+}
+
+void dspRadioBankFinish(DspRadioBank* bank)
+{
+    memcpy(bank->noiseCur, bank->noiseTarget, sizeof(bank->noiseCur));
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        for (int l = 0; l < DSP_BANK_LANES; l++) {
+            if (std::fabs(bank->z1[s][l]) < DSP_DENORMAL_FLUSH) bank->z1[s][l] = 0.0f;
+            if (std::fabs(bank->z2[s][l]) < DSP_DENORMAL_FLUSH) bank->z2[s][l] = 0.0f;
+        }
+    }
+}
+
+void dspRadioBankScalar(DspRadioBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    const float inv = 1.0f / (float)frames;
+    for (int l = 0; l < DSP_BANK_LANES; l++) {
+        float z1[DSP_BANK_SECTIONS], z2[DSP_BANK_SECTIONS];
+        for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+            z1[s] = bank->z1[s][l];
+            z2[s] = bank->z2[s][l];
+        }
+        const float drive = bank->drive[l], level = bank->level[l];
+        float noise = bank->noiseCur[l];
+        const float dn = (bank->noiseTarget[l] - noise) * inv;
+        uint32_t rng = bank->rng[l];
+        for (int i = 0; i < frames; i++) {
+            float* v = x + (size_t)i * DSP_BANK_LANES + l;
+            float y = *v;
+            for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+                const float in = y;
+                y = bank->coef[DSP_B0][s][l] * in + z1[s];
+                z1[s] = bank->coef[DSP_B1][s][l] * in - bank->coef[DSP_A1][s][l] * y + z2[s];
+                z2[s] = bank->coef[DSP_B2][s][l] * in - bank->coef[DSP_A2][s][l] * y;
+            }
+            rng = dspXorshift(rng);
+            noise += dn;
+            *v = dspSoftClip(y * drive) * level + (float)(int32_t)rng * DSP_NOISE_SCALE * noise;
+        }
+        for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+            bank->z1[s][l] = z1[s];
+            bank->z2[s][l] = z2[s];
+        }
+        bank->rng[l] = rng;
+    }
+    dspRadioBankFinish(bank);
+}
+
+void dspPeakAbsScalar(const float* x, int frames, float* peak)
+{
+    for (int i = 0; i < frames; i++) {
+        const float a = std::fabs(x[i]);
+        if (a > peak[i]) peak[i] = a;
+    }
+}
+
+const DspKernels dspScalarKernels = {
+    DSP_SCALAR, dspToMonoScalar, dspPanStereoScalar, dspDelayReadScalar,
+    dspPanAccumulateScalar, dspMixStereoScalar, dspBiquadBankScalar,
+    dspRadioBankScalar, dspPeakAbsScalar,
+};
+
+/* ---- dispatch ---- */
+
+static bool cpuHasAvx2()
+{
+#if !DSP_X86
+    return false;
+#elif defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;  /* OS saves YMM state */
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static std::atomic<const DspKernels*> current(NULL);
+
+DspLevel dspDetect()
+{
+#if DSP_X86
+    static const DspLevel detected = cpuHasAvx2() ? DSP_AVX2 : DSP_SSE2;
+    return detected;
+#else
+    return DSP_SCALAR;
+#endif
+}
+
+const DspKernels* dspKernelsFor(DspLevel level)
+{
+    if (level > dspDetect()) return NULL;
+    switch (level) {
+#if DSP_X86
+    case DSP_AVX2: return &dspAvx2Kernels;
+    case DSP_SSE2: return &dspSse2Kernels;
+#endif
+    case DSP_SCALAR: return &dspScalarKernels;
+    default: return NULL;
+    }
+}
+
+const DspKernels* dspKernels()
+{
+    const DspKernels* k = current.load(std::memory_order_acquire);
+    if (!k) {
+        k = dspKernelsFor(dspDetect());
+        current.store(k, std::memory_order_release);
+    }
+    return k;
+}
+
+bool dspSelect(DspLevel level)
+{
+    const DspKernels* k = dspKernelsFor(level);
+    if (!k) return false;
+    current.store(k, std::memory_order_release);
+    return true;
+}
+
+const char* dspLevelName(DspLevel level)
+{
+    switch (level) {
+    case DSP_SCALAR: return "scalar";
+    case DSP_SSE2:   return "sse2";
+    case DSP_AVX2:   return "avx2";
+    default:         return "?";
+    }
+}
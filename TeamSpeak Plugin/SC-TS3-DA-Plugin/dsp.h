@@ -0,0 +1,119 @@
+#pragma once
+
+/*
+ * Audio kernels for the voice callbacks, with one implementation per
+ * instruction set picked at runtime: scalar reference, SSE2 (the x64
+ * baseline) and AVX2. Callers go through dspKernels(); nothing here
+ * allocates, and every kernel handles any frame count (SIMD bodies fall
+ * back to scalar for the tail).
+ *
+ * Samples are carried as float in int16 units (no 1/32768 scaling), so
+ * conversion is a plain cvt and the store saturates.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DSP_X86 1
+#else
+#define DSP_X86 0
+#endif
+
+/*
+ * A group of DSP_BANK_LANES independent filters, each DSP_BANK_SECTIONS
+ * cascaded biquads (transposed direct form II), stored structure-of-arrays
+ * so one register holds the same coefficient for every lane. Coefficients
+ * ramp per sample from `cur` to `target` across a block, then `cur` =
+ * `target`.
+ */
+#define DSP_BANK_LANES     8
+#define DSP_BANK_SECTIONS  2
+
+enum DspBiquadCoef { DSP_B0 = 0, DSP_B1, DSP_B2, DSP_A1, DSP_A2, DSP_COEFS };
+
+struct alignas(32) DspBiquadBank {
+    float cur[DSP_COEFS][DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float target[DSP_COEFS][DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float z1[DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float z2[DSP_BANK_SECTIONS][DSP_BANK_LANES];
+};
+
+/*
+ * Radio voice chain for DSP_BANK_LANES voices, fused into one pass per
+ * sample: band-pass (DSP_BANK_SECTIONS fixed biquads per lane), `drive` into
+ * a soft clipper scaled back by `level`, then a per-lane xorshift noise bed
+ * whose amplitude ramps from `noiseCur` to `noiseTarget` across the block.
+ * Same lane-interleaved layout as DspBiquadBank.
+ */
+struct alignas(32) DspRadioBank {
+    float    coef[DSP_COEFS][DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float    z1[DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float    z2[DSP_BANK_SECTIONS][DSP_BANK_LANES];
+    float    drive[DSP_BANK_LANES];        /* int16 units to clipper input */
+    float    level[DSP_BANK_LANES];        /* clipper output to int16 units */
+    float    noiseCur[DSP_BANK_LANES];     /* noise amplitude, int16 units */
+    float    noiseTarget[DSP_BANK_LANES];
+    uint32_t rng[DSP_BANK_LANES];          /* xorshift32 state; never 0 */
+};
+
+enum DspLevel {
+    DSP_SCALAR = 0,
+    DSP_SSE2,
+    DSP_AVX2,
+    DSP_LEVEL_COUNT
+};
+
+struct DspKernels {
+    DspLevel level;
+
+    /* Average of the channels set in `mask` of an interleaved block into `out`. */
+    void (*toMono)(const short* in, int frames, int channels, unsigned int mask, float* out);
+
+    /*
+     * out[ch L/R] = src * gain, with each gain ramped linearly from g0 to g1
+     * across the block; written into channels chL/chR of an interleaved
+     * `channels`-wide block, saturated to int16. Other channels are untouched.
+     */
+    void (*panStereo)(const float* srcL, const float* srcR, int frames,
+                      float gL0, float gL1, float gR0, float gR1,
+                      short* out, int channels, int chL, int chR);
+
+    /*
+     * out[i] = ring[start + step * i], 4-point Catmull-Rom interpolated;
+     * ring indices wrap with `mask` (ring size - 1). start >= 0.
+     */
+    void (*delayRead)(const float* ring, unsigned int mask, float start, float step, int frames, float* out);
+
+    /* busL/R[i] += srcL/R[i] * gain, gains ramped like panStereo. */
+    void (*panAccumulate)(const float* srcL, const float* srcR, int frames,
+                          float gL0, float gL1, float gR0, float gR1,
+                          float* busL, float* busR);
+
+    /* Add float busses into channels chL/chR of an interleaved int16 block, saturating. */
+    void (*mixStereo)(const float* busL, const float* busR, int frames,
+                      short* out, int channels, int chL, int chR);
+
+    /* Filter `x` (frames x DSP_BANK_LANES, lane-interleaved) in place. */
+    void (*biquadBank)(DspBiquadBank* bank, float* x, int frames);
+
+    /* Run the radio chain over `x` (same layout as biquadBank) in place. */
+    void (*radioBank)(DspRadioBank* bank, float* x, int frames);
+
+    /* peak[i] = max(peak[i], |x[i]|): level detection, one channel at a time. */
+    void (*peakAbs)(const float* x, int frames, float* peak);
+};
+
+/* Best level this CPU and OS support. */
+DspLevel dspDetect();
+
+/* The kernels in use; the detected level unless dspSelect() said otherwise. */
+const DspKernels* dspKernels();
+
+/* Switch to `level` (benchmarks); false if the CPU cannot run it. */
+bool dspSelect(DspLevel level);
+
+/* Kernels for one level without selecting them; NULL if unsupported. */
+const DspKernels* dspKernelsFor(DspLevel level);
+
+const char* dspLevelName(DspLevel level);
@@ -0,0 +1,230 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "dsp_impl.h"
+
+#if DSP_X86
+
+#include <immintrin.h>
+
+/* MSVC emits AVX2 intrinsics without a per-file switch; GCC/Clang need the target attribute. */
+#if defined(__GNUC__)
+#define DSP_AVX2_FN __attribute__((target("avx2")))
+#else
+#define DSP_AVX2_FN
+#endif
+
+DSP_AVX2_FN static void toMonoAvx2(const short* in, int frames, int channels, unsigned int mask, float* out)
+{
+    int i = 0;
+    if (channels == 2 && (mask & 3u) == 3u) {
+        const __m256i ones = _mm256_set1_epi16(1);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(in + 2 * i));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(v, ones)), half));
+        }
+    }
+    else if (channels == 1 && (mask & 1u)) {
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(v));
+        }
+    }
+    _mm256_zeroupper();
+    dspToMonoScalar(in + (size_t)i * channels, frames - i, channels, mask, out + i);
+}
+
+DSP_AVX2_FN static void panStereoAvx2(const float* srcL, const float* srcR, int frames,
+                                      float gL0, float gL1, float gR0, float gR1,
+                                      short* out, int channels, int chL, int chR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    int i = 0;
+    if (channels == 2 && chL == 0 && chR == 1) {
+        const __m256 ramp = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+        __m256 gL = _mm256_add_ps(_mm256_set1_ps(gL0), _mm256_mul_ps(ramp, _mm256_set1_ps(dL)));
+        __m256 gR = _mm256_add_ps(_mm256_set1_ps(gR0), _mm256_mul_ps(ramp, _mm256_set1_ps(dR)));
+        const __m256 stepL = _mm256_set1_ps(8.0f * dL), stepR = _mm256_set1_ps(8.0f * dR);
+        /* Per 128-bit lane: L0 L1 L2 L3 R0 R1 R2 R3 -> L0 R0 L1 R1 L2 R2 L3 R3 */
+        const __m256i interleave = _mm256_setr_epi8(
+            0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+            0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i l = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(srcL + i), gL));
+            const __m256i r = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(srcR + i), gR));
+            gL = _mm256_add_ps(gL, stepL);
+            gR = _mm256_add_ps(gR, stepR);
+            /* lane 0: L0-3 R0-3, lane 1: L4-7 R4-7, saturated */
+            const __m256i packed = _mm256_packs_epi32(l, r);
+            _mm256_storeu_si256((__m256i*)(out + 2 * i), _mm256_shuffle_epi8(packed, interleave));
+        }
+    }
+    _mm256_zeroupper();
+    dspPanStereoScalar(srcL + i, srcR + i, frames - i,
+                       gL0 + dL * (float)i, gL1, gR0 + dR * (float)i, gR1,
+                       out + (size_t)i * channels, channels, chL, chR);
+}
+
+DSP_AVX2_FN static void delayReadAvx2(const float* ring, unsigned int mask, float start, float step, int frames, float* out)
+{
+    const __m256 vstep = _mm256_set1_ps(step);
+    const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const __m256i vmask = _mm256_set1_epi32((int)mask), one = _mm256_set1_epi32(1), two_i = _mm256_set1_epi32(2);
+    const __m256 half = _mm256_set1_ps(0.5f), oneHalf = _mm256_set1_ps(1.5f), two = _mm256_set1_ps(2.0f), twoHalf = _mm256_set1_ps(2.5f);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 pos = _mm256_add_ps(_mm256_set1_ps(start), _mm256_mul_ps(vstep, _mm256_add_ps(_mm256_set1_ps((float)i), lane)));
+        const __m256i base = _mm256_cvttps_epi32(pos);
+        const __m256 t = _mm256_sub_ps(pos, _mm256_cvtepi32_ps(base));
+
+        const __m256 xm1 = _mm256_i32gather_ps(ring, _mm256_and_si256(_mm256_sub_epi32(base, one), vmask), 4);
+        const __m256 x0 = _mm256_i32gather_ps(ring, _mm256_and_si256(base, vmask), 4);
+        const __m256 x1 = _mm256_i32gather_ps(ring, _mm256_and_si256(_mm256_add_epi32(base, one), vmask), 4);
+        const __m256 x2 = _mm256_i32gather_ps(ring, _mm256_and_si256(_mm256_add_epi32(base, two_i), vmask), 4);
+
+        const __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x1, xm1));
+        const __m256 c2 = _mm256_sub_ps(_mm256_add_ps(xm1, _mm256_mul_ps(two, x1)), _mm256_add_ps(_mm256_mul_ps(twoHalf, x0), _mm256_mul_ps(half, x2)));
+        const __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(x2, xm1)), _mm256_mul_ps(oneHalf, _mm256_sub_ps(x0, x1)));
+        const __m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(c3, t), c2), t), c1), t), x0);
+        _mm256_storeu_ps(out + i, y);
+    }
+    _mm256_zeroupper();
+    dspDelayReadScalar(ring, mask, start + step * (float)i, step, frames - i, out + i);
+}
+
+DSP_AVX2_FN static void panAccumulateAvx2(const float* srcL, const float* srcR, int frames,
+                                          float gL0, float gL1, float gR0, float gR1,
+                                          float* busL, float* busR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    const __m256 ramp = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    __m256 gL = _mm256_add_ps(_mm256_set1_ps(gL0), _mm256_mul_ps(ramp, _mm256_set1_ps(dL)));
+    __m256 gR = _mm256_add_ps(_mm256_set1_ps(gR0), _mm256_mul_ps(ramp, _mm256_set1_ps(dR)));
+    const __m256 stepL = _mm256_set1_ps(8.0f * dL), stepR = _mm256_set1_ps(8.0f * dR);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        _mm256_storeu_ps(busL + i, _mm256_add_ps(_mm256_loadu_ps(busL + i), _mm256_mul_ps(_mm256_loadu_ps(srcL + i), gL)));
+        _mm256_storeu_ps(busR + i, _mm256_add_ps(_mm256_loadu_ps(busR + i), _mm256_mul_ps(_mm256_loadu_ps(srcR + i), gR)));
+        gL = _mm256_add_ps(gL, stepL);
+        gR = _mm256_add_ps(gR, stepR);
+    }
+    _mm256_zeroupper();
+    dspPanAccumulateScalar(srcL + i, srcR + i, frames - i, gL0 + dL * (float)i, gL1, gR0 + dR * (float)i, gR1, busL + i, busR + i);
+}
+
+DSP_AVX2_FN static void mixStereoAvx2(const float* busL, const float* busR, int frames,
+                                      short* out, int channels, int chL, int chR)
+{
+    int i = 0;
+    if (channels == 2 && chL == 0 && chR == 1) {
+        for (; i + 8 <= frames; i += 8) {
+            const __m256 l = _mm256_loadu_ps(busL + i), r = _mm256_loadu_ps(busR + i);
+            /* unpack works per 128-bit lane: lo = frames 0,1 | 4,5; hi = 2,3 | 6,7 */
+            const __m256 lr01 = _mm256_unpacklo_ps(l, r), lr23 = _mm256_unpackhi_ps(l, r);
+            const __m256 first = _mm256_permute2f128_ps(lr01, lr23, 0x20);   /* frames 0..3 */
+            const __m256 second = _mm256_permute2f128_ps(lr01, lr23, 0x31);  /* frames 4..7 */
+            const __m128i s0 = _mm_loadu_si128((const __m128i*)(out + 2 * i));
+            const __m128i s1 = _mm_loadu_si128((const __m128i*)(out + 2 * i + 8));
+            const __m256i a = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(s0)), first));
+            const __m256i b = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(s1)), second));
+            /* packs interleaves 128-bit lanes; restore order */
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+            _mm256_storeu_si256((__m256i*)(out + 2 * i), packed);
+        }
+    }
+    _mm256_zeroupper();
+    dspMixStereoScalar(busL + i, busR + i, frames - i, out + (size_t)i * channels, channels, chL, chR);
+}
+
+DSP_AVX2_FN static void biquadBankAvx2(DspBiquadBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    const __m256 inv = _mm256_set1_ps(1.0f / (float)frames);
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        __m256 c[DSP_COEFS], d[DSP_COEFS];
+        for (int k = 0; k < DSP_COEFS; k++) {
+            c[k] = _mm256_load_ps(bank->cur[k][s]);
+            d[k] = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(bank->target[k][s]), c[k]), inv);
+        }
+        __m256 z1 = _mm256_load_ps(bank->z1[s]), z2 = _mm256_load_ps(bank->z2[s]);
+        float* v = x;
+        for (int i = 0; i < frames; i++, v += DSP_BANK_LANES) {
+            for (int k = 0; k < DSP_COEFS; k++) c[k] = _mm256_add_ps(c[k], d[k]);
+            const __m256 in = _mm256_load_ps(v);
+            const __m256 y = _mm256_add_ps(_mm256_mul_ps(c[DSP_B0], in), z1);
+            z1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(c[DSP_B1], in), _mm256_mul_ps(c[DSP_A1], y)), z2);
+            z2 = _mm256_sub_ps(_mm256_mul_ps(c[DSP_B2], in), _mm256_mul_ps(c[DSP_A2], y));
+            _mm256_store_ps(v, y);
+        }
+        _mm256_store_ps(bank->z1[s], z1);
+        _mm256_store_ps(bank->z2[s], z2);
+    }
+    _mm256_zeroupper();
+    dspBiquadBankFinish(bank);
+}
+
+DSP_AVX2_FN static void radioBankAvx2(DspRadioBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    __m256 c[DSP_COEFS][DSP_BANK_SECTIONS], z1[DSP_BANK_SECTIONS], z2[DSP_BANK_SECTIONS];
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        for (int k = 0; k < DSP_COEFS; k++) c[k][s] = _mm256_load_ps(bank->coef[k][s]);
+        z1[s] = _mm256_load_ps(bank->z1[s]);
+        z2[s] = _mm256_load_ps(bank->z2[s]);
+    }
+    const __m256 drive = _mm256_load_ps(bank->drive), level = _mm256_load_ps(bank->level);
+    __m256 noise = _mm256_load_ps(bank->noiseCur);
+    const __m256 dn = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(bank->noiseTarget), noise), _mm256_set1_ps(1.0f / (float)frames));
+    __m256i rng = _mm256_load_si256((const __m256i*)bank->rng);
+    const __m256 lim = _mm256_set1_ps(3.0f), nlim = _mm256_set1_ps(-3.0f);
+    const __m256 k27 = _mm256_set1_ps(27.0f), k9 = _mm256_set1_ps(9.0f), scale = _mm256_set1_ps(DSP_NOISE_SCALE);
+    float* v = x;
+    for (int i = 0; i < frames; i++, v += DSP_BANK_LANES) {
+        __m256 y = _mm256_load_ps(v);
+        for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+            const __m256 in = y;
+            y = _mm256_add_ps(_mm256_mul_ps(c[DSP_B0][s], in), z1[s]);
+            z1[s] = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(c[DSP_B1][s], in), _mm256_mul_ps(c[DSP_A1][s], y)), z2[s]);
+            z2[s] = _mm256_sub_ps(_mm256_mul_ps(c[DSP_B2][s], in), _mm256_mul_ps(c[DSP_A2][s], y));
+        }
+        rng = _mm256_xor_si256(rng, _mm256_slli_epi32(rng, 13));
+        rng = _mm256_xor_si256(rng, _mm256_srli_epi32(rng, 17));
+        rng = _mm256_xor_si256(rng, _mm256_slli_epi32(rng, 5));
+        noise = _mm256_add_ps(noise, dn);
+        const __m256 u = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(y, drive), lim), nlim);
+        const __m256 u2 = _mm256_mul_ps(u, u);
+        const __m256 clip = _mm256_div_ps(_mm256_mul_ps(u, _mm256_add_ps(k27, u2)), _mm256_add_ps(k27, _mm256_mul_ps(k9, u2)));
+        const __m256 n = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(rng), scale), noise);
+        _mm256_store_ps(v, _mm256_add_ps(_mm256_mul_ps(clip, level), n));
+    }
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        _mm256_store_ps(bank->z1[s], z1[s]);
+        _mm256_store_ps(bank->z2[s], z2[s]);
+    }
+    _mm256_store_si256((__m256i*)bank->rng, rng);
+    _mm256_zeroupper();
+    dspRadioBankFinish(bank);
+}
+
+DSP_AVX2_FN static void peakAbsAvx2(const float* x, int frames, float* peak)
+{
+    const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        _mm256_storeu_ps(peak + i, _mm256_max_ps(_mm256_loadu_ps(peak + i), _mm256_and_ps(_mm256_loadu_ps(x + i), abs)));
+    }
+    _mm256_zeroupper();
+    dspPeakAbsScalar(x + i, frames - i, peak + i);
+}
+
+const DspKernels dspAvx2Kernels = {
+    DSP_AVX2, toMonoAvx2, panStereoAvx2, delayReadAvx2,
+    panAccumulateAvx2, mixStereoAvx2, biquadBankAvx2,
+    radioBankAvx2, peakAbsAvx2,
+};
+
+#endif
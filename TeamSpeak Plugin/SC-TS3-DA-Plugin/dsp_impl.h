@@ -0,0 +1,66 @@
+#pragma once
+
+/* Kernel tables shared between dsp*.cpp; not for use outside the DSP layer. */
+
+#include "dsp.h"
+
+extern const DspKernels dspScalarKernels;
+#if DSP_X86
+extern const DspKernels dspSse2Kernels;
+extern const DspKernels dspAvx2Kernels;
+#endif
+
+static inline short dspSat16(float v)
+{
+    if (v >= 32767.0f) return 32767;
+    if (v <= -32768.0f) return -32768;
+    return (short)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+/* Catmull-Rom through xm1, x0, x1, x2 at t in [0, 1) between x0 and x1. */
+static inline float dspCubic(float xm1, float x0, float x1, float x2, float t)
+{
+    const float c1 = 0.5f * (x1 - xm1);
+    const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * t + c2) * t + c1) * t + x0;
+}
+
+/* Scalar bodies, also used by the SIMD versions for tails and odd layouts. */
+void dspToMonoScalar(const short* in, int frames, int channels, unsigned int mask, float* out);
+void dspPanStereoScalar(const float* srcL, const float* srcR, int frames,
+                        float gL0, float gL1, float gR0, float gR1,
+                        short* out, int channels, int chL, int chR);
+void dspDelayReadScalar(const float* ring, unsigned int mask, float start, float step, int frames, float* out);
+void dspPanAccumulateScalar(const float* srcL, const float* srcR, int frames,
+                            float gL0, float gL1, float gR0, float gR1,
+                            float* busL, float* busR);
+void dspMixStereoScalar(const float* busL, const float* busR, int frames,
+                        short* out, int channels, int chL, int chR);
+void dspBiquadBankScalar(DspBiquadBank* bank, float* x, int frames);
+
+void dspRadioBankScalar(DspRadioBank* bank, float* x, int frames);
+void dspPeakAbsScalar(const float* x, int frames, float* peak);
+
+/* End of block: coefficients arrive, and states too small to matter become zero (no denormals in silence). */
+void dspBiquadBankFinish(DspBiquadBank* bank);
+void dspRadioBankFinish(DspRadioBank* bank);
+
+/* Rational tanh fit, exact at +-3 and clamped beyond; what radioBank clips with. */
+static inline float dspSoftClip(float u)
+{
+    if (u > 3.0f) u = 3.0f;
+    if (u < -3.0f) u = -3.0f;
+    const float u2 = u * u;
+    return u * (27.0f + u2) / (27.0f + 9.0f * u2);
+}
+
+static inline uint32_t dspXorshift(uint32_t s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+#define DSP_NOISE_SCALE 4.656612873e-10f  /* 2^-31: int32 to [-1, 1) */
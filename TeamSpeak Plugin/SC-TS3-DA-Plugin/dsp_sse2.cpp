@@ -0,0 +1,223 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "dsp_impl.h"
+
+#if DSP_X86
+
+#include <emmintrin.h>
+
+static void toMonoSse2(const short* in, int frames, int channels, unsigned int mask, float* out)
+{
+    int i = 0;
+    if (channels == 2 && (mask & 3u) == 3u) {
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 4 <= frames; i += 4) {
+            /* 4 frames of L,R pairs; madd sums each pair into one int32 */
+            const __m128i v = _mm_loadu_si128((const __m128i*)(in + 2 * i));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_madd_epi16(v, ones)), half));
+        }
+    }
+    else if (channels == 1 && (mask & 1u)) {
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+            const __m128i sign = _mm_srai_epi16(v, 15);
+            _mm_storeu_ps(out + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, sign)));
+            _mm_storeu_ps(out + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, sign)));
+        }
+    }
+    dspToMonoScalar(in + (size_t)i * channels, frames - i, channels, mask, out + i);
+}
+
+static void panStereoSse2(const float* srcL, const float* srcR, int frames,
+                          float gL0, float gL1, float gR0, float gR1,
+                          short* out, int channels, int chL, int chR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    int i = 0;
+    if (channels == 2 && chL == 0 && chR == 1) {
+        const __m128 ramp = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        __m128 gL = _mm_add_ps(_mm_set1_ps(gL0), _mm_mul_ps(ramp, _mm_set1_ps(dL)));
+        __m128 gR = _mm_add_ps(_mm_set1_ps(gR0), _mm_mul_ps(ramp, _mm_set1_ps(dR)));
+        const __m128 stepL = _mm_set1_ps(4.0f * dL), stepR = _mm_set1_ps(4.0f * dR);
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i l0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(srcL + i), gL));
+            const __m128i r0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(srcR + i), gR));
+            gL = _mm_add_ps(gL, stepL);
+            gR = _mm_add_ps(gR, stepR);
+            const __m128i l1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(srcL + i + 4), gL));
+            const __m128i r1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(srcR + i + 4), gR));
+            gL = _mm_add_ps(gL, stepL);
+            gR = _mm_add_ps(gR, stepR);
+            /* packs saturates to int16; unpack interleaves L/R */
+            const __m128i l = _mm_packs_epi32(l0, l1);
+            const __m128i r = _mm_packs_epi32(r0, r1);
+            _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+        }
+    }
+    dspPanStereoScalar(srcL + i, srcR + i, frames - i,
+                       gL0 + dL * (float)i, gL1, gR0 + dR * (float)i, gR1,
+                       out + (size_t)i * channels, channels, chL, chR);
+}
+
+static void delayReadSse2(const float* ring, unsigned int mask, float start, float step, int frames, float* out)
+{
+    const __m128 vstep = _mm_set1_ps(step);
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 half = _mm_set1_ps(0.5f), oneHalf = _mm_set1_ps(1.5f), two = _mm_set1_ps(2.0f), twoHalf = _mm_set1_ps(2.5f);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 pos = _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(vstep, _mm_add_ps(_mm_set1_ps((float)i), lane)));
+        const __m128i base = _mm_cvttps_epi32(pos);  /* pos >= 0, so truncation is floor */
+        const __m128 t = _mm_sub_ps(pos, _mm_cvtepi32_ps(base));
+
+        /* no gather before AVX2: four taps per lane by hand */
+        alignas(16) int b[4];
+        _mm_store_si128((__m128i*)b, base);
+        const __m128 xm1 = _mm_set_ps(ring[(b[3] - 1) & mask], ring[(b[2] - 1) & mask], ring[(b[1] - 1) & mask], ring[(b[0] - 1) & mask]);
+        const __m128 x0 = _mm_set_ps(ring[b[3] & mask], ring[b[2] & mask], ring[b[1] & mask], ring[b[0] & mask]);
+        const __m128 x1 = _mm_set_ps(ring[(b[3] + 1) & mask], ring[(b[2] + 1) & mask], ring[(b[1] + 1) & mask], ring[(b[0] + 1) & mask]);
+        const __m128 x2 = _mm_set_ps(ring[(b[3] + 2) & mask], ring[(b[2] + 2) & mask], ring[(b[1] + 2) & mask], ring[(b[0] + 2) & mask]);
+
+        const __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(x1, xm1));
+        const __m128 c2 = _mm_sub_ps(_mm_add_ps(xm1, _mm_mul_ps(two, x1)), _mm_add_ps(_mm_mul_ps(twoHalf, x0), _mm_mul_ps(half, x2)));
+        const __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(x2, xm1)), _mm_mul_ps(oneHalf, _mm_sub_ps(x0, x1)));
+        const __m128 y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, t), c2), t), c1), t), x0);
+        _mm_storeu_ps(out + i, y);
+    }
+    dspDelayReadScalar(ring, mask, start + step * (float)i, step, frames - i, out + i);
+}
+
+static void panAccumulateSse2(const float* srcL, const float* srcR, int frames,
+                              float gL0, float gL1, float gR0, float gR1,
+                              float* busL, float* busR)
+{
+    if (frames <= 0) return;
+    const float dL = (gL1 - gL0) / (float)frames;
+    const float dR = (gR1 - gR0) / (float)frames;
+    const __m128 ramp = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    __m128 gL = _mm_add_ps(_mm_set1_ps(gL0), _mm_mul_ps(ramp, _mm_set1_ps(dL)));
+    __m128 gR = _mm_add_ps(_mm_set1_ps(gR0), _mm_mul_ps(ramp, _mm_set1_ps(dR)));
+    const __m128 stepL = _mm_set1_ps(4.0f * dL), stepR = _mm_set1_ps(4.0f * dR);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        _mm_storeu_ps(busL + i, _mm_add_ps(_mm_loadu_ps(busL + i), _mm_mul_ps(_mm_loadu_ps(srcL + i), gL)));
+        _mm_storeu_ps(busR + i, _mm_add_ps(_mm_loadu_ps(busR + i), _mm_mul_ps(_mm_loadu_ps(srcR + i), gR)));
+        gL = _mm_add_ps(gL, stepL);
+        gR = _mm_add_ps(gR, stepR);
+    }
+    dspPanAccumulateScalar(srcL + i, srcR + i, frames - i, gL0 + dL * (float)i, gL1, gR0 + dR * (float)i, gR1, busL + i, busR + i);
+}
+
+static void mixStereoSse2(const float* busL, const float* busR, int frames,
+                          short* out, int channels, int chL, int chR)
+{
+    int i = 0;
+    if (channels == 2 && chL == 0 && chR == 1) {
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 l = _mm_loadu_ps(busL + i), r = _mm_loadu_ps(busR + i);
+            const __m128i s = _mm_loadu_si128((const __m128i*)(out + 2 * i));
+            const __m128i sign = _mm_srai_epi16(s, 15);
+            const __m128 lo = _mm_add_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(s, sign)), _mm_unpacklo_ps(l, r));
+            const __m128 hi = _mm_add_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(s, sign)), _mm_unpackhi_ps(l, r));
+            _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi)));
+        }
+    }
+    dspMixStereoScalar(busL + i, busR + i, frames - i, out + (size_t)i * channels, channels, chL, chR);
+}
+
+static void biquadBankSse2(DspBiquadBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    const __m128 inv = _mm_set1_ps(1.0f / (float)frames);
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        /* two halves of four lanes; five coefficients, five ramps and two states stay in registers */
+        for (int h = 0; h < DSP_BANK_LANES; h += 4) {
+            __m128 c[DSP_COEFS], d[DSP_COEFS];
+            for (int k = 0; k < DSP_COEFS; k++) {
+                c[k] = _mm_load_ps(&bank->cur[k][s][h]);
+                d[k] = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&bank->target[k][s][h]), c[k]), inv);
+            }
+            __m128 z1 = _mm_load_ps(&bank->z1[s][h]), z2 = _mm_load_ps(&bank->z2[s][h]);
+            float* v = x + h;
+            for (int i = 0; i < frames; i++, v += DSP_BANK_LANES) {
+                for (int k = 0; k < DSP_COEFS; k++) c[k] = _mm_add_ps(c[k], d[k]);
+                const __m128 in = _mm_load_ps(v);
+                const __m128 y = _mm_add_ps(_mm_mul_ps(c[DSP_B0], in), z1);
+                z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(c[DSP_B1], in), _mm_mul_ps(c[DSP_A1], y)), z2);
+                z2 = _mm_sub_ps(_mm_mul_ps(c[DSP_B2], in), _mm_mul_ps(c[DSP_A2], y));
+                _mm_store_ps(v, y);
+            }
+            _mm_store_ps(&bank->z1[s][h], z1);
+            _mm_store_ps(&bank->z2[s][h], z2);
+        }
+    }
+    dspBiquadBankFinish(bank);
+}
+
+static void radioBankSse2(DspRadioBank* bank, float* x, int frames)
+{
+    if (frames <= 0) return;
+    const __m128 inv = _mm_set1_ps(1.0f / (float)frames);
+    const __m128 lim = _mm_set1_ps(3.0f), nlim = _mm_set1_ps(-3.0f);
+    const __m128 k27 = _mm_set1_ps(27.0f), k9 = _mm_set1_ps(9.0f), scale = _mm_set1_ps(DSP_NOISE_SCALE);
+    /* two halves of four lanes, the whole chain per sample in registers */
+    for (int h = 0; h < DSP_BANK_LANES; h += 4) {
+        __m128 c[DSP_COEFS][DSP_BANK_SECTIONS], z1[DSP_BANK_SECTIONS], z2[DSP_BANK_SECTIONS];
+        for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+            for (int k = 0; k < DSP_COEFS; k++) c[k][s] = _mm_load_ps(&bank->coef[k][s][h]);
+            z1[s] = _mm_load_ps(&bank->z1[s][h]);
+            z2[s] = _mm_load_ps(&bank->z2[s][h]);
+        }
+        const __m128 drive = _mm_load_ps(&bank->drive[h]), level = _mm_load_ps(&bank->level[h]);
+        __m128 noise = _mm_load_ps(&bank->noiseCur[h]);
+        const __m128 dn = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&bank->noiseTarget[h]), noise), inv);
+        __m128i rng = _mm_load_si128((const __m128i*)&bank->rng[h]);
+        float* v = x + h;
+        for (int i = 0; i < frames; i++, v += DSP_BANK_LANES) {
+            __m128 y = _mm_load_ps(v);
+            for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+                const __m128 in = y;
+                y = _mm_add_ps(_mm_mul_ps(c[DSP_B0][s], in), z1[s]);
+                z1[s] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(c[DSP_B1][s], in), _mm_mul_ps(c[DSP_A1][s], y)), z2[s]);
+                z2[s] = _mm_sub_ps(_mm_mul_ps(c[DSP_B2][s], in), _mm_mul_ps(c[DSP_A2][s], y));
+            }
+            rng = _mm_xor_si128(rng, _mm_slli_epi32(rng, 13));
+            rng = _mm_xor_si128(rng, _mm_srli_epi32(rng, 17));
+            rng = _mm_xor_si128(rng, _mm_slli_epi32(rng, 5));
+            noise = _mm_add_ps(noise, dn);
+            const __m128 u = _mm_max_ps(_mm_min_ps(_mm_mul_ps(y, drive), lim), nlim);
+            const __m128 u2 = _mm_mul_ps(u, u);
+            const __m128 clip = _mm_div_ps(_mm_mul_ps(u, _mm_add_ps(k27, u2)), _mm_add_ps(k27, _mm_mul_ps(k9, u2)));
+            const __m128 n = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(rng), scale), noise);
+            _mm_store_ps(v, _mm_add_ps(_mm_mul_ps(clip, level), n));
+        }
+        for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+            _mm_store_ps(&bank->z1[s][h], z1[s]);
+            _mm_store_ps(&bank->z2[s][h], z2[s]);
+        }
+        _mm_store_si128((__m128i*)&bank->rng[h], rng);
+    }
+    dspRadioBankFinish(bank);
+}
+
+static void peakAbsSse2(const float* x, int frames, float* peak)
+{
+    const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        _mm_storeu_ps(peak + i, _mm_max_ps(_mm_loadu_ps(peak + i), _mm_and_ps(_mm_loadu_ps(x + i), abs)));
+    }
+    dspPeakAbsScalar(x + i, frames - i, peak + i);
+}
+
+const DspKernels dspSse2Kernels = {
+    DSP_SSE2, toMonoSse2, panStereoSse2, delayReadSse2,
+    panAccumulateSse2, mixStereoSse2, biquadBankSse2,
+    radioBankSse2, peakAbsSse2,
+};
+
+#endif
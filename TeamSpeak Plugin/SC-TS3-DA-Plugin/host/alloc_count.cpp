@@ -0,0 +1,81 @@
+#include "alloc_count.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+#include <dlfcn.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+/* Initial-exec TLS in the executable: touching it never allocates, so it is safe in here. */
+static thread_local uint64_t threadAllocs = 0;
+static std::atomic<uint64_t> totalAllocs(0);
+
+static inline void counted()
+{
+    threadAllocs++;
+    totalAllocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+#define ALLOC_EXPORT extern "C" __attribute__((visibility("default")))
+
+ALLOC_EXPORT void* malloc(size_t size)
+{
+    counted();
+    return __libc_malloc(size);
+}
+
+ALLOC_EXPORT void* calloc(size_t n, size_t size)
+{
+    counted();
+    return __libc_calloc(n, size);
+}
+
+ALLOC_EXPORT void* realloc(void* p, size_t size)
+{
+    counted();
+    return __libc_realloc(p, size);
+}
+
+ALLOC_EXPORT void* aligned_alloc(size_t alignment, size_t size)
+{
+    counted();
+    return __libc_memalign(alignment, size);
+}
+
+ALLOC_EXPORT void* memalign(size_t alignment, size_t size)
+{
+    counted();
+    return __libc_memalign(alignment, size);
+}
+
+ALLOC_EXPORT int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1))) return EINVAL;
+    counted();
+    void* p = __libc_memalign(alignment, size);
+    if (!p && size) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+uint64_t allocCountThread()
+{
+    return threadAllocs;
+}
+
+uint64_t allocCountTotal()
+{
+    return totalAllocs.load(std::memory_order_relaxed);
+}
+
+bool allocCountHooked()
+{
+    return dlsym(RTLD_DEFAULT, "malloc") == (void*)&malloc;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+/*
+ * Heap allocation counting for the host harness. The host executable defines
+ * the malloc family itself (forwarding to glibc's __libc_* entry points) and
+ * exports them, so the plugin's malloc/calloc/realloc calls, and operator new
+ * through libstdc++, land here first. glibc only.
+ */
+
+#include <cstdint>
+
+/* Allocations made so far on the calling thread. */
+uint64_t allocCountThread();
+
+/* ...and across the whole process. */
+uint64_t allocCountTotal();
+
+/* False if the executable's allocator is not the one symbols resolve to (not exported), i.e. nothing is counted. */
+bool allocCountHooked();
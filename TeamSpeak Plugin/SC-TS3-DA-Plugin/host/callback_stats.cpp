@@ -0,0 +1,82 @@
+#include "callback_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+static const char* const names[HOST_CB_COUNT] = {
+    "onConnectStatusChangeEvent",
+    "currentServerConnectionChanged",
+    "onClientMoveEvent",
+    "onTalkStatusChangeEvent",
+    "onPluginCommandEvent",
+    "onCustom3dRolloffCalculationClientEvent",
+    "onEditPostProcessVoiceDataEvent",
+    "onEditMixedPlaybackVoiceDataEvent",
+};
+
+struct CallbackLog {
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t allocs;
+    uint64_t maxAllocs;
+    uint32_t ns[CALLBACK_SAMPLES];
+};
+
+static CallbackLog logs[HOST_CB_COUNT];
+
+void callbackStatsReset()
+{
+    for (int i = 0; i < HOST_CB_COUNT; i++) {
+        CallbackLog& l = logs[i];
+        l.calls = l.totalNs = l.maxNs = l.allocs = l.maxAllocs = 0;
+    }
+}
+
+void callbackRecord(HostCallback cb, uint64_t ns, uint64_t allocs)
+{
+    CallbackLog& l = logs[cb];
+    if (l.calls < CALLBACK_SAMPLES) l.ns[l.calls] = ns < UINT32_MAX ? (uint32_t)ns : UINT32_MAX;
+    l.calls++;
+    l.totalNs += ns;
+    if (ns > l.maxNs) l.maxNs = ns;
+    l.allocs += allocs;
+    if (allocs > l.maxAllocs) l.maxAllocs = allocs;
+}
+
+/* Nearest-rank percentile of the recorded samples; reorders `v`. */
+static double percentileUs(std::vector<uint32_t>& v, double p)
+{
+    if (v.empty()) return 0.0;
+    size_t k = (size_t)(p * (double)v.size());
+    if (k >= v.size()) k = v.size() - 1;
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k] * 1e-3;
+}
+
+void callbackSummary(HostCallback cb, CallbackSummary* out)
+{
+    const CallbackLog& l = logs[cb];
+    out->name = names[cb];
+    out->calls = l.calls;
+    out->maxUs = l.maxNs * 1e-3;
+    out->meanUs = l.calls ? (double)l.totalNs / (double)l.calls * 1e-3 : 0.0;
+    out->allocs = l.allocs;
+    out->maxAllocs = l.maxAllocs;
+    std::vector<uint32_t> v(l.ns, l.ns + (l.calls < CALLBACK_SAMPLES ? l.calls : CALLBACK_SAMPLES));
+    out->p50Us = percentileUs(v, 0.50);
+    out->p99Us = percentileUs(v, 0.99);
+}
+
+void callbackStatsPrint(FILE* f)
+{
+    fprintf(f, "  %-40s %9s %9s %9s %9s %9s %11s %10s\n", "callback", "calls", "p50 us", "p99 us", "max us", "mean us",
+        "allocs/call", "max allocs");
+    for (int i = 0; i < HOST_CB_COUNT; i++) {
+        CallbackSummary s;
+        callbackSummary((HostCallback)i, &s);
+        if (!s.calls) continue;
+        fprintf(f, "  %-40s %9llu %9.2f %9.2f %9.1f %9.2f %11.3f %10llu\n", s.name, (unsigned long long)s.calls,
+            s.p50Us, s.p99Us, s.maxUs, s.meanUs, (double)s.allocs / (double)s.calls, (unsigned long long)s.maxAllocs);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+/*
+ * What each ts3plugin_* callback costs the client thread that calls it: wall
+ * time inside the call and heap allocations made on that thread meanwhile
+ * (alloc_count.h), per call, so percentiles come out exact.
+ *
+ * Each callback kind is called from one host thread only (events from the
+ * script thread, audio from the playback thread), so every kind has a single
+ * writer. Read the summaries once the session is over.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "alloc_count.h"
+
+enum HostCallback {
+    HOST_CB_CONNECT_STATUS,
+    HOST_CB_SERVER_CHANGED,
+    HOST_CB_CLIENT_MOVE,
+    HOST_CB_TALK_STATUS,
+    HOST_CB_PLUGIN_COMMAND,
+    HOST_CB_ROLLOFF,
+    HOST_CB_POST_PROCESS,
+    HOST_CB_MIXED_PLAYBACK,
+    HOST_CB_COUNT
+};
+
+#define CALLBACK_SAMPLES (1u << 20)   /* per kind; calls past it count towards calls/max/allocs only */
+
+struct CallbackSummary {
+    const char* name;        /* ts3plugin_* entry point */
+    uint64_t    calls;
+    double      p50Us, p99Us, maxUs, meanUs;
+    uint64_t    allocs;      /* total over all calls */
+    uint64_t    maxAllocs;   /* in a single call */
+};
+
+void callbackStatsReset();
+void callbackRecord(HostCallback cb, uint64_t ns, uint64_t allocs);
+void callbackSummary(HostCallback cb, CallbackSummary* out);
+
+/* One line per callback that was called: calls, p50/p99/max/mean microseconds, allocations. */
+void callbackStatsPrint(FILE* f);
+
+static inline uint64_t callbackNowNs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/* Times the callback made inside its scope: `{ CallbackScope s(HOST_CB_X); plugin.onX(...); }`. */
+struct CallbackScope {
+    HostCallback cb;
+    uint64_t     allocs;
+    uint64_t     t0;
+
+    explicit CallbackScope(HostCallback which) : cb(which), allocs(allocCountThread()), t0(callbackNowNs()) {}
+    ~CallbackScope() { callbackRecord(cb, callbackNowNs() - t0, allocCountThread() - allocs); }
+};
@@ -0,0 +1,433 @@
+#include "host_driver.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "callback_stats.h"
+#include "mock_helper.h"
+#include "pose_channel.h"
+#include "timebase.h"
+#include "zones.h"
+
+#define HOST_PI 3.14159265358979
+
+struct HostConn {
+    std::atomic<uint64> sch;    /* 0 = free; read by the playback thread */
+    anyID               myID;
+    uint64              channel;
+};
+
+struct HostLocal {
+    bool     set;
+    char     zone[POSE_ZONE_LEN];
+    uint32_t zoneId;
+    double   pos[3];
+    double   vel[3];
+};
+
+static HostPlugin plugin;
+static HostConn conns[MOCK_MAX_CONNECTIONS];
+static HostPeer peers[HOST_MAX_PEERS];
+static HostLocal local;
+static bool fast = false;
+
+static std::atomic<uint64_t> statEvents(0);
+static std::atomic<uint64_t> statBlocks(0);
+static std::atomic<uint64_t> statVoices(0);
+static std::atomic<uint64_t> statCommands(0);
+
+/* ---------------- world ---------------- */
+
+static HostConn* findConn(uint64 sch)
+{
+    for (int i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+        if (sch && conns[i].sch.load(std::memory_order_relaxed) == sch) return &conns[i];
+    }
+    return NULL;
+}
+
+HostPeer* hostFindPeer(uint64 sch, anyID clientID)
+{
+    for (int i = 0; i < HOST_MAX_PEERS; i++) {
+        if (peers[i].live && peers[i].sch == sch && peers[i].clientID == clientID) return &peers[i];
+    }
+    return NULL;
+}
+
+static bool inOurChannel(const HostPeer& p)
+{
+    const HostConn* c = findConn(p.sch);
+    return c && p.channel == c->channel;
+}
+
+/* Distance as the client's 3D code would have it; unknown or another zone counts as across the room. */
+static float peerDistance(const HostPeer& p)
+{
+    if (!local.set || !p.posed || p.pose.zoneId != local.zoneId) return 10.0f;
+    const double dx = p.pose.x - local.pos[0], dy = p.pose.y - local.pos[1], dz = p.pose.z - local.pos[2];
+    return (float)std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static void refreshPeer(HostPeer* p)
+{
+    p->distance.store(peerDistance(*p), std::memory_order_relaxed);
+    p->audible.store(p->live && p->talking && inOurChannel(*p), std::memory_order_release);
+}
+
+/* ---------------- event thread ---------------- */
+
+static void connectStatus(uint64 sch, int status)
+{
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    if (!plugin.onConnectStatusChangeEvent) return;
+    CallbackScope s(HOST_CB_CONNECT_STATUS);
+    plugin.onConnectStatusChangeEvent(sch, status, ERROR_ok);
+}
+
+static void clientMove(uint64 sch, anyID clientID, uint64 oldChannel, uint64 newChannel, int visibility)
+{
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    if (!plugin.onClientMoveEvent) return;
+    CallbackScope s(HOST_CB_CLIENT_MOVE);
+    plugin.onClientMoveEvent(sch, clientID, oldChannel, newChannel, visibility, "");
+}
+
+void hostCommand(uint64 sch, anyID clientID, const char* text)
+{
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    statCommands.fetch_add(1, std::memory_order_relaxed);
+    if (!plugin.onPluginCommandEvent) return;
+    CallbackScope s(HOST_CB_PLUGIN_COMMAND);
+    plugin.onPluginCommandEvent(sch, HOST_PLUGIN_ID, text, clientID, "", "");
+}
+
+/* The peer's plugin encodes its pose like broadcast.cpp does: a keyframe, then deltas against it. */
+static void sendPeerPose(HostPeer* p, uint64_t nowUs)
+{
+    p->pose.sequence++;
+    p->pose.captureUs = nowUs;
+    char msg[PEER_WIRE_MAX_LEN];
+    size_t len = 0;
+    if (p->haveKey && nowUs - p->lastKeyUs < HOST_KEYFRAME_US) len = peerWireDelta(p->key, p->pose, msg, sizeof(msg));
+    if (!len) {
+        len = peerWireKeyframe(p->pose, p->nextTag, msg, sizeof(msg));
+        if (!len) return;
+        peerKeyFromPose(p->pose, p->nextTag, &p->key);
+        p->nextTag++;
+        p->haveKey = true;
+        p->lastKeyUs = nowUs;
+    }
+    /* Sent to its own channel; we only get it while we are in there too. */
+    if (inOurChannel(*p)) hostCommand(p->sch, p->clientID, msg);
+}
+
+static void publishLocal(uint64_t nowUs)
+{
+    if (local.set) mockHelperPublish(local.zone, local.pos[0], local.pos[1], local.pos[2], nowUs);
+}
+
+bool hostConnect(uint64 sch, anyID myID, uint64 channel, const char* nick)
+{
+    HostConn* c = findConn(sch);
+    for (int i = 0; !c && i < MOCK_MAX_CONNECTIONS; i++) {
+        if (!conns[i].sch.load(std::memory_order_relaxed)) c = &conns[i];
+    }
+    if (!c || !sch || !mockTs3Connect(sch, myID, channel, nick)) return false;
+    c->myID = myID;
+    c->channel = channel;
+    c->sch.store(sch, std::memory_order_release);
+    connectStatus(sch, STATUS_CONNECTING);
+    connectStatus(sch, STATUS_CONNECTION_ESTABLISHED);
+    return true;
+}
+
+void hostDisconnect(uint64 sch)
+{
+    HostConn* c = findConn(sch);
+    if (!c) return;
+    c->sch.store(0, std::memory_order_release);
+    for (int i = 0; i < HOST_MAX_PEERS; i++) {
+        if (peers[i].live && peers[i].sch == sch) {
+            peers[i].live = false;
+            refreshPeer(&peers[i]);
+        }
+    }
+    mockTs3Disconnect(sch);
+    connectStatus(sch, STATUS_DISCONNECTED);
+}
+
+void hostSetCurrent(uint64 sch)
+{
+    mockTs3SetCurrent(sch);
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    if (!plugin.currentServerConnectionChanged) return;
+    CallbackScope s(HOST_CB_SERVER_CHANGED);
+    plugin.currentServerConnectionChanged(sch);
+}
+
+bool hostJoin(uint64 sch, anyID clientID, uint64 channel, const char* nick)
+{
+    const HostConn* c = findConn(sch);
+    if (!c || clientID == c->myID) return false;
+    HostPeer* p = hostFindPeer(sch, clientID);
+    for (int i = 0; !p && i < HOST_MAX_PEERS; i++) {
+        if (!peers[i].live) p = &peers[i];
+    }
+    if (!p || !mockTs3AddClient(sch, clientID, channel, nick)) return false;
+    p->live = true;
+    p->sch = sch;
+    p->clientID = clientID;
+    p->channel = channel;
+    p->talking = false;
+    p->posed = false;
+    memset(&p->pose, 0, sizeof(p->pose));
+    p->haveKey = false;
+    p->nextTag = 0;
+    p->lastKeyUs = 0;
+    refreshPeer(p);
+    clientMove(sch, clientID, 0, channel, ENTER_VISIBILITY);
+    return true;
+}
+
+bool hostMove(uint64 sch, anyID clientID, uint64 channel)
+{
+    HostConn* c = findConn(sch);
+    if (!c || !mockTs3MoveClient(sch, clientID, channel)) return false;
+    uint64 old;
+    if (clientID == c->myID) {
+        old = c->channel;
+        c->channel = channel;
+        for (int i = 0; i < HOST_MAX_PEERS; i++) {
+            if (peers[i].live && peers[i].sch == sch) refreshPeer(&peers[i]);
+        }
+    }
+    else {
+        HostPeer* p = hostFindPeer(sch, clientID);
+        if (!p) return false;
+        old = p->channel;
+        p->channel = channel;
+        refreshPeer(p);
+    }
+    clientMove(sch, clientID, old, channel, RETAIN_VISIBILITY);
+    return true;
+}
+
+bool hostLeave(uint64 sch, anyID clientID)
+{
+    HostPeer* p = hostFindPeer(sch, clientID);
+    if (!p) return false;
+    p->live = false;
+    refreshPeer(p);
+    mockTs3RemoveClient(sch, clientID);
+    clientMove(sch, clientID, p->channel, 0, LEAVE_VISIBILITY);
+    return true;
+}
+
+bool hostProcessCommand(uint64 sch, const char* command)
+{
+    if (!plugin.processCommand) return false;
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    return plugin.processCommand(sch, command) == 0;
+}
+
+bool hostTalk(uint64 sch, anyID clientID, bool talking)
+{
+    HostPeer* p = hostFindPeer(sch, clientID);
+    if (!p) return false;
+    p->talking = talking;
+    refreshPeer(p);
+    statEvents.fetch_add(1, std::memory_order_relaxed);
+    if (plugin.onTalkStatusChangeEvent) {
+        CallbackScope s(HOST_CB_TALK_STATUS);
+        plugin.onTalkStatusChangeEvent(sch, talking ? STATUS_TALKING : STATUS_NOT_TALKING, 0, clientID);
+    }
+    return true;
+}
+
+bool hostPeerPose(uint64 sch, anyID clientID, const char* zone, const double pos[3], const double* vel)
+{
+    HostPeer* p = hostFindPeer(sch, clientID);
+    if (!p) return false;
+    const uint32_t zoneId = zoneIdFromName(zone);
+    if (!p->posed || p->pose.zoneId != zoneId) p->haveKey = false;
+    p->posed = true;
+    p->pose.zoneId = zoneId;
+    p->pose.zoneClass = (uint8_t)zoneClassify(zone);
+    p->pose.flags = vel ? POSE_HAS_VELOCITY : 0;
+    p->pose.x = pos[0];
+    p->pose.y = pos[1];
+    p->pose.z = pos[2];
+    p->pose.vx = vel ? (float)vel[0] : 0.0f;
+    p->pose.vy = vel ? (float)vel[1] : 0.0f;
+    p->pose.vz = vel ? (float)vel[2] : 0.0f;
+    refreshPeer(p);
+    sendPeerPose(p, monoNowUs());
+    return true;
+}
+
+void hostLocalPose(const char* zone, const double pos[3], const double vel[3])
+{
+    local.set = true;
+    snprintf(local.zone, sizeof(local.zone), "%s", zone);
+    local.zoneId = zoneIdFromName(zone);
+    memcpy(local.pos, pos, sizeof(local.pos));
+    memcpy(local.vel, vel, sizeof(local.vel));
+    for (int i = 0; i < HOST_MAX_PEERS; i++) {
+        if (peers[i].live) refreshPeer(&peers[i]);
+    }
+    publishLocal(monoNowUs());
+}
+
+/* ---------------- playback thread ---------------- */
+
+static std::atomic<uint64_t> blocksPlayed(0);
+static std::atomic<uint64_t> ticksDone(0);   /* fast mode: playback waits for the events of the block before */
+
+static void playBlocks(uint64_t blocks)
+{
+    static const unsigned int speakers[HOST_CHANNELS] = { SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT };
+    static short voice[HOST_BLOCK_FRAMES * HOST_CHANNELS];
+    static short mixed[HOST_BLOCK_FRAMES * HOST_CHANNELS];
+    static int acc[HOST_BLOCK_FRAMES * HOST_CHANNELS];
+    static double phase[HOST_MAX_PEERS];
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t b = 0; b < blocks; b++) {
+        if (!fast) std::this_thread::sleep_until(start + std::chrono::microseconds(b * HOST_BLOCK_US));
+        else while (ticksDone.load(std::memory_order_acquire) < b) std::this_thread::yield();
+        for (int ci = 0; ci < MOCK_MAX_CONNECTIONS; ci++) {
+            const uint64 sch = conns[ci].sch.load(std::memory_order_acquire);
+            if (!sch) continue;
+            memset(acc, 0, sizeof(acc));
+            for (int t = 0; t < HOST_MAX_PEERS; t++) {
+                HostPeer& p = peers[t];
+                if (!p.audible.load(std::memory_order_acquire) || p.sch != sch) continue;
+
+                /* A tone per talker, already in the output layout as the client hands it over. */
+                float volume = 1.0f;
+                if (plugin.onCustom3dRolloffCalculationClientEvent) {
+                    CallbackScope s(HOST_CB_ROLLOFF);
+                    plugin.onCustom3dRolloffCalculationClientEvent(sch, p.clientID, p.distance.load(std::memory_order_relaxed), &volume);
+                }
+                const double step = 2.0 * HOST_PI * (180.0 + 40.0 * (p.clientID % 16)) / HOST_RATE;
+                for (int i = 0; i < HOST_BLOCK_FRAMES; i++) {
+                    const short v = (short)(8000.0 * volume * std::sin(phase[t]));
+                    phase[t] += step;
+                    for (int c = 0; c < HOST_CHANNELS; c++) voice[i * HOST_CHANNELS + c] = v;
+                }
+                phase[t] = std::fmod(phase[t], 2.0 * HOST_PI);
+
+                unsigned int fill = (1u << HOST_CHANNELS) - 1;
+                if (plugin.onEditPostProcessVoiceDataEvent) {
+                    CallbackScope s(HOST_CB_POST_PROCESS);
+                    plugin.onEditPostProcessVoiceDataEvent(sch, p.clientID, voice, HOST_BLOCK_FRAMES, HOST_CHANNELS, speakers, &fill);
+                }
+                statVoices.fetch_add(1, std::memory_order_relaxed);
+                for (int i = 0; i < HOST_BLOCK_FRAMES; i++) {
+                    for (int c = 0; c < HOST_CHANNELS; c++) {
+                        if (fill & (1u << c)) acc[i * HOST_CHANNELS + c] += voice[i * HOST_CHANNELS + c];
+                    }
+                }
+            }
+            for (int i = 0; i < HOST_BLOCK_FRAMES * HOST_CHANNELS; i++) {
+                mixed[i] = (short)(acc[i] > 32767 ? 32767 : acc[i] < -32768 ? -32768 : acc[i]);
+            }
+            unsigned int fill = (1u << HOST_CHANNELS) - 1;
+            if (plugin.onEditMixedPlaybackVoiceDataEvent) {
+                CallbackScope s(HOST_CB_MIXED_PLAYBACK);
+                plugin.onEditMixedPlaybackVoiceDataEvent(sch, mixed, HOST_BLOCK_FRAMES, HOST_CHANNELS, speakers, &fill);
+            }
+        }
+        statBlocks.fetch_add(1, std::memory_order_relaxed);
+        blocksPlayed.store(b + 1, std::memory_order_release);
+    }
+}
+
+void hostRun(uint64_t ms, HostTickHook hook, void* ctx)
+{
+    const uint64_t blocks = (ms * 1000 + HOST_BLOCK_US - 1) / HOST_BLOCK_US;
+    blocksPlayed.store(0, std::memory_order_relaxed);
+    ticksDone.store(0, std::memory_order_relaxed);
+    std::thread playback(playBlocks, blocks);
+
+    /* Moves and poses keep step with the audio clock, one tick per block. */
+    const double dt = HOST_BLOCK_US * 1e-6;
+    for (uint64_t tick = 1; tick <= blocks; tick++) {
+        while (blocksPlayed.load(std::memory_order_acquire) < tick) {
+            if (fast) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        const uint64_t nowUs = monoNowUs();
+        for (int a = 0; a < 3; a++) local.pos[a] += local.vel[a] * dt;
+        for (int i = 0; i < HOST_MAX_PEERS; i++) {
+            HostPeer& p = peers[i];
+            if (!p.live || !p.posed) continue;
+            p.pose.x += p.pose.vx * dt;
+            p.pose.y += p.pose.vy * dt;
+            p.pose.z += p.pose.vz * dt;
+        }
+        if (hook) hook(tick, nowUs, ctx);
+        if (tick % HOST_LOCAL_EVERY == 0) publishLocal(nowUs);
+        for (int i = 0; i < HOST_MAX_PEERS; i++) {
+            HostPeer& p = peers[i];
+            if (!p.live || !p.posed) continue;
+            p.distance.store(peerDistance(p), std::memory_order_relaxed);
+            if ((tick + (uint64_t)i) % HOST_PEER_EVERY == 0) sendPeerPose(&p, nowUs);
+        }
+        ticksDone.store(tick, std::memory_order_release);
+    }
+    playback.join();
+}
+
+/* ---------------- session ---------------- */
+
+bool hostStart(const char* pluginPath, const char* dir, bool echoLog, char* err, size_t errLen)
+{
+    if (!hostPluginLoad(pluginPath, &plugin, err, errLen)) return false;
+    mockTs3Reset(dir);
+    mockTs3SetEcho(echoLog);
+    callbackStatsReset();
+    if (!mockHelperOpen()) fprintf(stderr, "warning: cannot create the pose channel, no local poses\n");
+
+    /* Same order as the client: functions, init, then the command id. */
+    struct TS3Functions funcs;
+    mockTs3Functions(&funcs);
+    plugin.setFunctionPointers(funcs);
+    if (plugin.init() != 0) {
+        snprintf(err, errLen, "plugin init failed");
+        hostPluginUnload(&plugin);
+        mockHelperClose();
+        return false;
+    }
+    if (plugin.registerPluginID) plugin.registerPluginID(HOST_PLUGIN_ID);
+    return true;
+}
+
+void hostStop()
+{
+    if (!plugin.handle) return;
+    plugin.shutdown();
+    hostPluginUnload(&plugin);
+    mockHelperClose();
+}
+
+const HostPlugin* hostPlugin()
+{
+    return &plugin;
+}
+
+void hostSetFast(bool on)
+{
+    fast = on;
+}
+
+void hostGetStats(HostStats* out)
+{
+    out->events = statEvents.load(std::memory_order_relaxed);
+    out->blocks = statBlocks.load(std::memory_order_relaxed);
+    out->voices = statVoices.load(std::memory_order_relaxed);
+    out->commands = statCommands.load(std::memory_order_relaxed);
+}
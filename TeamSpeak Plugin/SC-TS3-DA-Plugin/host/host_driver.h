@@ -0,0 +1,101 @@
+#pragma once
+
+/*
+ * One session of the host harness: the plugin (host_plugin.h), the world the
+ * mock SDK answers from (mock_ts3.h), what every remote client is doing, and
+ * the client's two callback threads.
+ *
+ * Events, poses and plugin commands are delivered on the thread calling in
+ * here (the client's event thread). hostRun() adds a playback thread for its
+ * duration that plays 48 kHz stereo in 10 ms blocks: post-process for every
+ * audible talker, then the mixed block, per connection. As in the client, a
+ * remote client is only heard, and its plugin commands only arrive, while it
+ * is in our channel.
+ *
+ * Every plugin callback goes through callback_stats.h.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "host_plugin.h"
+#include "mock_ts3.h"
+#include "peer_wire.h"
+#include "pose.h"
+
+#define HOST_RATE          48000
+#define HOST_BLOCK_FRAMES  480      /* 10 ms */
+#define HOST_BLOCK_US      10000ull
+#define HOST_CHANNELS      2
+#define HOST_MAX_PEERS     1024
+#define HOST_PEER_EVERY    10       /* blocks between a peer's poses: 100 ms */
+#define HOST_LOCAL_EVERY   3        /* blocks between our poses: 30 ms */
+#define HOST_KEYFRAME_US   2000000ull
+#define HOST_PLUGIN_ID     "scda_host"
+
+struct HostPeer {
+    bool     live;
+    uint64   sch;
+    anyID    clientID;
+    uint64   channel;
+    bool     talking;
+    bool     posed;      /* has a pose; it goes out every HOST_PEER_EVERY blocks while running */
+    Pose     pose;       /* position moves with the velocity while running */
+    PeerKey  key;        /* the peer plugin's broadcast state, as in broadcast.cpp */
+    bool     haveKey;
+    uint8_t  nextTag;
+    uint64_t lastKeyUs;
+
+    /* Read by the playback thread. */
+    std::atomic<bool>  audible;   /* talking in our channel */
+    std::atomic<float> distance;  /* what the client's 3D code would pass to the rolloff callback */
+};
+
+struct HostStats {
+    uint64_t events;        /* callbacks delivered on the event thread */
+    uint64_t blocks;        /* playback blocks */
+    uint64_t voices;        /* post-process calls */
+    uint64_t commands;      /* plugin commands delivered */
+};
+
+/* Called on the event thread once per block while running, after poses moved and before they go out. */
+typedef void (*HostTickHook)(uint64_t tick, uint64_t nowUs, void* ctx);
+
+/* Load the plugin, point it at the mock SDK and the pose channel, init it. */
+bool hostStart(const char* pluginPath, const char* dir, bool echoLog, char* err, size_t errLen);
+void hostStop();
+
+const HostPlugin* hostPlugin();
+
+/* Blocks back to back instead of every 10 ms, each after the event thread's tick for the one before. */
+void hostSetFast(bool fast);
+
+bool hostConnect(uint64 sch, anyID myID, uint64 channel, const char* nick);
+void hostDisconnect(uint64 sch);
+void hostSetCurrent(uint64 sch);
+
+/* `clientID` may be ourselves for move. */
+bool hostJoin(uint64 sch, anyID clientID, uint64 channel, const char* nick);
+bool hostMove(uint64 sch, anyID clientID, uint64 channel);
+bool hostLeave(uint64 sch, anyID clientID);
+bool hostTalk(uint64 sch, anyID clientID, bool talking);
+
+/* Set the peer's pose (vel may be NULL) and send it now. */
+bool hostPeerPose(uint64 sch, anyID clientID, const char* zone, const double pos[3], const double* vel);
+
+/* Our own pose through the pose channel, published now and every HOST_LOCAL_EVERY blocks while running. */
+void hostLocalPose(const char* zone, const double pos[3], const double vel[3]);
+
+/* A raw plugin command from `clientID`. */
+void hostCommand(uint64 sch, anyID clientID, const char* text);
+
+/* "/scda <command>" typed into `sch`'s chat tab; false if the plugin takes no commands. */
+bool hostProcessCommand(uint64 sch, const char* command);
+
+HostPeer* hostFindPeer(uint64 sch, anyID clientID);
+
+/* Play `ms` of audio; `hook` may be NULL. */
+void hostRun(uint64_t ms, HostTickHook hook, void* ctx);
+
+void hostGetStats(HostStats* out);
@@ -0,0 +1,57 @@
+#include "host_plugin.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <dlfcn.h>
+
+template <typename Fn>
+static bool bind(void* handle, const char* symbol, Fn* out)
+{
+    *out = (Fn)dlsym(handle, symbol);
+    return *out != NULL;
+}
+
+bool hostPluginLoad(const char* path, HostPlugin* out, char* err, size_t errLen)
+{
+    memset(out, 0, sizeof(*out));
+    /* Like the client: every plugin in its own namespace, symbols resolved up front. */
+    out->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!out->handle) {
+        snprintf(err, errLen, "%s", dlerror());
+        return false;
+    }
+
+    const char* missing = NULL;
+    if (!bind(out->handle, "ts3plugin_name", &out->name)) missing = "ts3plugin_name";
+    else if (!bind(out->handle, "ts3plugin_version", &out->version)) missing = "ts3plugin_version";
+    else if (!bind(out->handle, "ts3plugin_apiVersion", &out->apiVersion)) missing = "ts3plugin_apiVersion";
+    else if (!bind(out->handle, "ts3plugin_setFunctionPointers", &out->setFunctionPointers)) missing = "ts3plugin_setFunctionPointers";
+    else if (!bind(out->handle, "ts3plugin_init", &out->init)) missing = "ts3plugin_init";
+    else if (!bind(out->handle, "ts3plugin_shutdown", &out->shutdown)) missing = "ts3plugin_shutdown";
+    if (missing) {
+        snprintf(err, errLen, "%s: missing %s", path, missing);
+        hostPluginUnload(out);
+        return false;
+    }
+
+    bind(out->handle, "ts3plugin_registerPluginID", &out->registerPluginID);
+    bind(out->handle, "ts3plugin_commandKeyword", &out->commandKeyword);
+    bind(out->handle, "ts3plugin_processCommand", &out->processCommand);
+    bind(out->handle, "ts3plugin_currentServerConnectionChanged", &out->currentServerConnectionChanged);
+    bind(out->handle, "ts3plugin_onConnectStatusChangeEvent", &out->onConnectStatusChangeEvent);
+    bind(out->handle, "ts3plugin_onClientMoveEvent", &out->onClientMoveEvent);
+    bind(out->handle, "ts3plugin_onUpdateClientEvent", &out->onUpdateClientEvent);
+    bind(out->handle, "ts3plugin_onTalkStatusChangeEvent", &out->onTalkStatusChangeEvent);
+    bind(out->handle, "ts3plugin_onPluginCommandEvent", &out->onPluginCommandEvent);
+    bind(out->handle, "ts3plugin_onCustom3dRolloffCalculationClientEvent", &out->onCustom3dRolloffCalculationClientEvent);
+    bind(out->handle, "ts3plugin_onEditPostProcessVoiceDataEvent", &out->onEditPostProcessVoiceDataEvent);
+    bind(out->handle, "ts3plugin_onEditMixedPlaybackVoiceDataEvent", &out->onEditMixedPlaybackVoiceDataEvent);
+    return true;
+}
+
+void hostPluginUnload(HostPlugin* p)
+{
+    if (p->handle) dlclose(p->handle);
+    memset(p, 0, sizeof(*p));
+}
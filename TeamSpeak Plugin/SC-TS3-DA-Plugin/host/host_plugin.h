@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * The plugin shared object as the TeamSpeak client loads it: dlopen() and the
+ * exported ts3plugin_* entry points the host drives. Required entry points
+ * must resolve; optional ones stay NULL when the plugin does not export them.
+ */
+
+#include <cstddef>
+
+#include "teamspeak/public_definitions.h"
+#include "ts3_functions.h"
+
+struct HostPlugin {
+    void* handle;
+
+    /* required */
+    const char* (*name)();
+    const char* (*version)();
+    int         (*apiVersion)();
+    void        (*setFunctionPointers)(const struct TS3Functions funcs);
+    int         (*init)();
+    void        (*shutdown)();
+
+    /* optional */
+    void        (*registerPluginID)(const char* id);
+    const char* (*commandKeyword)();
+    int         (*processCommand)(uint64 sch, const char* command);
+    void        (*currentServerConnectionChanged)(uint64 sch);
+    void        (*onConnectStatusChangeEvent)(uint64 sch, int newStatus, unsigned int errorNumber);
+    void        (*onClientMoveEvent)(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* moveMessage);
+    void        (*onUpdateClientEvent)(uint64 sch, anyID clientID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier);
+    void        (*onTalkStatusChangeEvent)(uint64 sch, int status, int isReceivedWhisper, anyID clientID);
+    void        (*onPluginCommandEvent)(uint64 sch, const char* pluginName, const char* pluginCommand, anyID invokerClientID, const char* invokerName, const char* invokerUniqueIdentity);
+    void        (*onCustom3dRolloffCalculationClientEvent)(uint64 sch, anyID clientID, float distance, float* volume);
+    void        (*onEditPostProcessVoiceDataEvent)(uint64 sch, anyID clientID, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+    void        (*onEditMixedPlaybackVoiceDataEvent)(uint64 sch, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+};
+
+/* False with a reason in `err` if the object does not load or lacks a required entry point. */
+bool hostPluginLoad(const char* path, HostPlugin* out, char* err, size_t errLen);
+void hostPluginUnload(HostPlugin* p);
@@ -0,0 +1,73 @@
+#include "mock_helper.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pose_channel.h"
+#include "zones.h"
+
+static unsigned char* view = NULL;
+static uint64_t sequence = 0;
+
+bool mockHelperOpen()
+{
+    if (view) return true;
+    const int fd = shm_open(POSE_CHANNEL_NAME, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, POSE_CHANNEL_SIZE) != 0) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(NULL, POSE_CHANNEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    view = (unsigned char*)p;
+
+    /* A previous run's header and pose must not look valid while we rewrite them. */
+    SharedPoseHeader* h = (SharedPoseHeader*)view;
+    h->magic = 0;
+    SharedPoseSlot* slot = (SharedPoseSlot*)(view + sizeof(SharedPoseHeader));
+    slot->seq.store(0, std::memory_order_release);
+    h->version = POSE_CHANNEL_VERSION;
+    h->headerSize = sizeof(SharedPoseHeader);
+    h->slotOffset = sizeof(SharedPoseHeader);
+    h->slotSize = sizeof(SharedPoseSlot);
+    h->writerPid = (uint32_t)getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = POSE_CHANNEL_MAGIC;
+    sequence = 0;
+    return true;
+}
+
+void mockHelperClose()
+{
+    if (!view) return;
+    munmap(view, POSE_CHANNEL_SIZE);
+    shm_unlink(POSE_CHANNEL_NAME);
+    view = NULL;
+}
+
+void mockHelperPublish(const char* zone, double x, double y, double z, uint64_t captureUs)
+{
+    if (!view) return;
+    SharedPoseSlot* slot = (SharedPoseSlot*)(view + sizeof(SharedPoseHeader));
+    const uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->zoneId = zoneIdFromName(zone);
+    slot->sequence = ++sequence;
+    slot->captureUs = captureUs;
+    slot->x = x;
+    slot->y = y;
+    slot->z = z;
+    snprintf(slot->zone, POSE_ZONE_LEN, "%s", zone);
+
+    slot->seq.store(seq + 2, std::memory_order_release);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/*
+ * SCTS3DA.exe's side of the pose channel (pose_channel.h) for the host
+ * harness: creates the shared-memory region, writes the header and publishes
+ * poses with the same seqlock protocol as PoseChannel.cs, so the plugin's
+ * ingest thread sees a helper that is running.
+ *
+ * Single writer; call from one thread.
+ */
+
+#include <cstdint>
+
+bool mockHelperOpen();
+
+/* Unmaps and removes the region. */
+void mockHelperClose();
+
+/* Publish our pose, captured at `captureUs` (monoNowUs() domain). */
+void mockHelperPublish(const char* zone, double x, double y, double z, uint64_t captureUs);
@@ -0,0 +1,499 @@
+#include "mock_ts3.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "timebase.h"
+
+struct MockClient {
+    bool   live;
+    anyID  id;
+    uint64 channel;
+    char   nick[MOCK_NICK_LEN];
+};
+
+struct MockConnection {
+    uint64     sch;          /* 0 = free */
+    int        status;
+    anyID      myID;
+    MockClient clients[MOCK_MAX_CLIENTS];
+    uint16_t   index[65536];  /* client id -> clients[] slot + 1; lookups sit inside the timed callbacks */
+};
+
+static MockConnection conns[MOCK_MAX_CONNECTIONS];
+static uint64 currentSch = 0;
+static char basePath[MOCK_PATH_LEN];
+static std::atomic<bool> echo(false);
+static std::atomic<bool> showChat(false);
+
+static MockCall calls[MOCK_CALL_CAPACITY];
+static std::atomic<uint64_t> nextCall(0);
+static std::atomic<uint32_t> nextThread(0);
+static std::atomic<uint64_t> statAllocs(0);
+static std::atomic<uint64_t> statFrees(0);
+static std::atomic<uint64_t> statLogs(0);
+static std::atomic<uint64_t> statCommands(0);
+static std::atomic<uint64_t> statCommandBytes(0);
+
+static uint32_t threadIndex()
+{
+    static thread_local uint32_t index = UINT32_MAX;
+    if (index == UINT32_MAX) index = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+static void record(const char* fn, uint64 sch, uint64_t arg, const char* detail)
+{
+    const uint64_t tUs = monoNowUs();
+    const uint64_t i = nextCall.fetch_add(1, std::memory_order_relaxed);
+    if (i >= MOCK_CALL_CAPACITY) return;
+    MockCall& c = calls[i];
+    c.tUs = tUs;
+    c.fn = fn;
+    c.thread = threadIndex();
+    c.sch = sch;
+    c.arg = arg;
+    if (detail) snprintf(c.detail, sizeof(c.detail), "%s", detail);
+    else c.detail[0] = '\0';
+}
+
+/* Result buffers the plugin has to give back through freeMemory. */
+static char* allocString(const char* s)
+{
+    const size_t len = strlen(s) + 1;
+    char* out = (char*)malloc(len);
+    if (!out) return NULL;
+    memcpy(out, s, len);
+    statAllocs.fetch_add(1, std::memory_order_relaxed);
+    return out;
+}
+
+static void* allocArray(size_t bytes)
+{
+    void* out = calloc(1, bytes);
+    if (out) statAllocs.fetch_add(1, std::memory_order_relaxed);
+    return out;
+}
+
+static MockConnection* findConnection(uint64 sch)
+{
+    if (!sch) return NULL;
+    for (int i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+        if (conns[i].sch == sch) return &conns[i];
+    }
+    return NULL;
+}
+
+static MockClient* findClient(MockConnection* c, anyID clientID)
+{
+    if (!c || !c->index[clientID]) return NULL;
+    return &c->clients[c->index[clientID] - 1];
+}
+
+static void copyPath(char* path, size_t maxLen)
+{
+    if (!path || !maxLen) return;
+    strncpy(path, basePath, maxLen - 1);
+    path[maxLen - 1] = '\0';
+}
+
+/* ---------------- stubs ---------------- */
+
+static unsigned int getClientLibVersion(char** result)
+{
+    record("getClientLibVersion", 0, 0, NULL);
+    *result = allocString("3.6.2 (scda_host)");
+    return ERROR_ok;
+}
+
+static unsigned int freeMemory(void* pointer)
+{
+    record("freeMemory", 0, 0, NULL);
+    if (pointer) statFrees.fetch_add(1, std::memory_order_relaxed);
+    free(pointer);
+    return ERROR_ok;
+}
+
+static unsigned int logMessage(const char* msg, enum LogLevel severity, const char* channel, uint64 logID)
+{
+    record("logMessage", logID, (uint64_t)severity, msg);
+    statLogs.fetch_add(1, std::memory_order_relaxed);
+    if (echo.load(std::memory_order_relaxed)) fprintf(stderr, "[%s] %s\n", channel ? channel : "", msg ? msg : "");
+    return ERROR_ok;
+}
+
+static unsigned int systemset3DListenerAttributes(uint64 sch, const TS3_VECTOR* position, const TS3_VECTOR* forward, const TS3_VECTOR* up)
+{
+    char detail[MOCK_CALL_DETAIL];
+    snprintf(detail, sizeof(detail), "%.2f %.2f %.2f", position ? position->x : 0.0f,
+        position ? position->y : 0.0f, position ? position->z : 0.0f);
+    record("systemset3DListenerAttributes", sch, 0, detail);
+    return ERROR_ok;
+}
+
+static unsigned int channelset3DAttributes(uint64 sch, anyID clientID, const TS3_VECTOR* position)
+{
+    char detail[MOCK_CALL_DETAIL];
+    snprintf(detail, sizeof(detail), "%.2f %.2f %.2f", position ? position->x : 0.0f,
+        position ? position->y : 0.0f, position ? position->z : 0.0f);
+    record("channelset3DAttributes", sch, clientID, detail);
+    return ERROR_ok;
+}
+
+static unsigned int getClientID(uint64 sch, anyID* result)
+{
+    record("getClientID", sch, 0, NULL);
+    const MockConnection* c = findConnection(sch);
+    if (!c || c->status == STATUS_DISCONNECTED) return ERROR_not_connected;
+    *result = c->myID;
+    return ERROR_ok;
+}
+
+static unsigned int getClientSelfVariableAsString(uint64 sch, size_t flag, char** result)
+{
+    record("getClientSelfVariableAsString", sch, flag, NULL);
+    MockConnection* c = findConnection(sch);
+    const MockClient* me = findClient(c, c ? c->myID : 0);
+    if (!me) return ERROR_not_connected;
+    if (flag != CLIENT_NICKNAME) return ERROR_parameter_invalid;
+    *result = allocString(me->nick);
+    return ERROR_ok;
+}
+
+static unsigned int getClientVariableAsString(uint64 sch, anyID clientID, size_t flag, char** result)
+{
+    record("getClientVariableAsString", sch, clientID, NULL);
+    const MockClient* cl = findClient(findConnection(sch), clientID);
+    if (!cl) return ERROR_client_invalid_id;
+    if (flag != CLIENT_NICKNAME) return ERROR_parameter_invalid;
+    *result = allocString(cl->nick);
+    return ERROR_ok;
+}
+
+static unsigned int getClientList(uint64 sch, anyID** result)
+{
+    record("getClientList", sch, 0, NULL);
+    const MockConnection* c = findConnection(sch);
+    if (!c) return ERROR_not_connected;
+    int n = 0;
+    for (int i = 0; i < MOCK_MAX_CLIENTS; i++) n += c->clients[i].live;
+    anyID* out = (anyID*)allocArray((n + 1) * sizeof(anyID));
+    if (!out) return ERROR_parameter_invalid;
+    n = 0;
+    for (int i = 0; i < MOCK_MAX_CLIENTS; i++) {
+        if (c->clients[i].live) out[n++] = c->clients[i].id;
+    }
+    *result = out;
+    return ERROR_ok;
+}
+
+static unsigned int getChannelOfClient(uint64 sch, anyID clientID, uint64* result)
+{
+    record("getChannelOfClient", sch, clientID, NULL);
+    const MockClient* cl = findClient(findConnection(sch), clientID);
+    if (!cl) return ERROR_client_invalid_id;
+    *result = cl->channel;
+    return ERROR_ok;
+}
+
+static unsigned int getChannelVariableAsString(uint64 sch, uint64 channelID, size_t flag, char** result)
+{
+    record("getChannelVariableAsString", sch, channelID, NULL);
+    if (!findConnection(sch)) return ERROR_not_connected;
+    if (flag != CHANNEL_NAME) return ERROR_parameter_invalid;
+    char name[48];
+    snprintf(name, sizeof(name), "Channel %llu", (unsigned long long)channelID);
+    *result = allocString(name);
+    return ERROR_ok;
+}
+
+/* Channels are whatever someone is in. */
+static unsigned int getChannelList(uint64 sch, uint64** result)
+{
+    record("getChannelList", sch, 0, NULL);
+    const MockConnection* c = findConnection(sch);
+    if (!c) return ERROR_not_connected;
+    uint64* out = (uint64*)allocArray((MOCK_MAX_CLIENTS + 1) * sizeof(uint64));
+    if (!out) return ERROR_parameter_invalid;
+    int n = 0;
+    for (int i = 0; i < MOCK_MAX_CLIENTS; i++) {
+        if (!c->clients[i].live) continue;
+        int j = 0;
+        while (j < n && out[j] != c->clients[i].channel) j++;
+        if (j == n) out[n++] = c->clients[i].channel;
+    }
+    *result = out;
+    return ERROR_ok;
+}
+
+static unsigned int getServerConnectionHandlerList(uint64** result)
+{
+    record("getServerConnectionHandlerList", 0, 0, NULL);
+    uint64* out = (uint64*)allocArray((MOCK_MAX_CONNECTIONS + 1) * sizeof(uint64));
+    if (!out) return ERROR_parameter_invalid;
+    int n = 0;
+    for (int i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+        if (conns[i].sch) out[n++] = conns[i].sch;
+    }
+    *result = out;
+    return ERROR_ok;
+}
+
+static unsigned int getServerVariableAsString(uint64 sch, size_t flag, char** result)
+{
+    record("getServerVariableAsString", sch, flag, NULL);
+    const MockConnection* c = findConnection(sch);
+    if (!c || c->status != STATUS_CONNECTION_ESTABLISHED) return ERROR_not_connected;
+    char text[64];
+    if (flag == VIRTUALSERVER_NAME) snprintf(text, sizeof(text), "Mock server %llu", (unsigned long long)sch);
+    else if (flag == VIRTUALSERVER_WELCOMEMESSAGE) snprintf(text, sizeof(text), "Welcome to the scda host harness");
+    else return ERROR_parameter_invalid;
+    *result = allocString(text);
+    return ERROR_ok;
+}
+
+static unsigned int getConnectionStatus(uint64 sch, int* result)
+{
+    record("getConnectionStatus", sch, 0, NULL);
+    const MockConnection* c = findConnection(sch);
+    *result = c ? c->status : STATUS_DISCONNECTED;
+    return ERROR_ok;
+}
+
+static void getAppPath(char* path, size_t maxLen)
+{
+    record("getAppPath", 0, 0, NULL);
+    copyPath(path, maxLen);
+}
+
+static void getResourcesPath(char* path, size_t maxLen)
+{
+    record("getResourcesPath", 0, 0, NULL);
+    copyPath(path, maxLen);
+}
+
+static void getConfigPath(char* path, size_t maxLen)
+{
+    record("getConfigPath", 0, 0, NULL);
+    copyPath(path, maxLen);
+}
+
+static void getPluginPath(char* path, size_t maxLen, const char* pluginID)
+{
+    record("getPluginPath", 0, 0, pluginID);
+    copyPath(path, maxLen);
+}
+
+static uint64 getCurrentServerConnectionHandlerID()
+{
+    record("getCurrentServerConnectionHandlerID", currentSch, 0, NULL);
+    return currentSch;
+}
+
+static void printMessageToCurrentTab(const char* message)
+{
+    record("printMessageToCurrentTab", currentSch, 0, message);
+    if (showChat.load(std::memory_order_relaxed)) printf("  chat: %s\n", message ? message : "");
+}
+
+/* Goes nowhere: the host plays every remote client itself. */
+static void sendPluginCommand(uint64 sch, const char* pluginID, const char* command, int targetMode, const anyID* targetIDs, const char* returnCode)
+{
+    record("sendPluginCommand", sch, (uint64_t)targetMode, command);
+    statCommands.fetch_add(1, std::memory_order_relaxed);
+    if (command) statCommandBytes.fetch_add(strlen(command), std::memory_order_relaxed);
+}
+
+static unsigned int getClientDisplayName(uint64 sch, anyID clientID, char* result, size_t maxLen)
+{
+    record("getClientDisplayName", sch, clientID, NULL);
+    const MockClient* cl = findClient(findConnection(sch), clientID);
+    if (!cl) return ERROR_client_invalid_id;
+    if (!maxLen) return ERROR_parameter_invalid;
+    strncpy(result, cl->nick, maxLen - 1);
+    result[maxLen - 1] = '\0';
+    return ERROR_ok;
+}
+
+void mockTs3Functions(struct TS3Functions* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->getClientLibVersion = getClientLibVersion;
+    out->freeMemory = freeMemory;
+    out->logMessage = logMessage;
+    out->systemset3DListenerAttributes = systemset3DListenerAttributes;
+    out->channelset3DAttributes = channelset3DAttributes;
+    out->getClientID = getClientID;
+    out->getClientSelfVariableAsString = getClientSelfVariableAsString;
+    out->getClientVariableAsString = getClientVariableAsString;
+    out->getClientList = getClientList;
+    out->getChannelOfClient = getChannelOfClient;
+    out->getChannelVariableAsString = getChannelVariableAsString;
+    out->getChannelList = getChannelList;
+    out->getServerConnectionHandlerList = getServerConnectionHandlerList;
+    out->getServerVariableAsString = getServerVariableAsString;
+    out->getConnectionStatus = getConnectionStatus;
+    out->getAppPath = getAppPath;
+    out->getResourcesPath = getResourcesPath;
+    out->getConfigPath = getConfigPath;
+    out->getPluginPath = getPluginPath;
+    out->getCurrentServerConnectionHandlerID = getCurrentServerConnectionHandlerID;
+    out->printMessageToCurrentTab = printMessageToCurrentTab;
+    out->sendPluginCommand = sendPluginCommand;
+    out->getClientDisplayName = getClientDisplayName;
+}
+
+void mockTs3Reset(const char* dir)
+{
+    memset(conns, 0, sizeof(conns));
+    currentSch = 0;
+    snprintf(basePath, sizeof(basePath), "%s%s", dir, dir[0] && dir[strlen(dir) - 1] != '/' ? "/" : "");
+    nextCall.store(0, std::memory_order_relaxed);
+    nextThread.store(0, std::memory_order_relaxed);
+    statAllocs.store(0, std::memory_order_relaxed);
+    statFrees.store(0, std::memory_order_relaxed);
+    statLogs.store(0, std::memory_order_relaxed);
+    statCommands.store(0, std::memory_order_relaxed);
+    statCommandBytes.store(0, std::memory_order_relaxed);
+}
+
+void mockTs3SetEcho(bool on)
+{
+    echo.store(on, std::memory_order_relaxed);
+}
+
+void mockTs3SetChat(bool on)
+{
+    showChat.store(on, std::memory_order_relaxed);
+}
+
+/* ---------------- world ---------------- */
+
+bool mockTs3Connect(uint64 sch, anyID myID, uint64 channel, const char* nick)
+{
+    MockConnection* c = findConnection(sch);
+    for (int i = 0; !c && i < MOCK_MAX_CONNECTIONS; i++) {
+        if (!conns[i].sch) c = &conns[i];
+    }
+    if (!c || !sch) return false;
+    memset(c, 0, sizeof(*c));
+    c->sch = sch;
+    c->status = STATUS_CONNECTION_ESTABLISHED;
+    c->myID = myID;
+    if (!currentSch) currentSch = sch;
+    return mockTs3AddClient(sch, myID, channel, nick);
+}
+
+void mockTs3Disconnect(uint64 sch)
+{
+    MockConnection* c = findConnection(sch);
+    if (!c) return;
+    memset(c, 0, sizeof(*c));
+    if (currentSch == sch) currentSch = 0;
+}
+
+void mockTs3SetCurrent(uint64 sch)
+{
+    currentSch = sch;
+}
+
+uint64 mockTs3Current()
+{
+    return currentSch;
+}
+
+bool mockTs3AddClient(uint64 sch, anyID clientID, uint64 channel, const char* nick)
+{
+    MockConnection* c = findConnection(sch);
+    if (!c) return false;
+    MockClient* cl = findClient(c, clientID);
+    for (int i = 0; !cl && i < MOCK_MAX_CLIENTS; i++) {
+        if (!c->clients[i].live) cl = &c->clients[i];
+    }
+    if (!cl) return false;
+    c->index[clientID] = (uint16_t)(cl - c->clients + 1);
+    cl->live = true;
+    cl->id = clientID;
+    cl->channel = channel;
+    snprintf(cl->nick, sizeof(cl->nick), "%s", nick ? nick : "");
+    return true;
+}
+
+bool mockTs3MoveClient(uint64 sch, anyID clientID, uint64 channel)
+{
+    MockClient* cl = findClient(findConnection(sch), clientID);
+    if (!cl) return false;
+    cl->channel = channel;
+    return true;
+}
+
+void mockTs3RemoveClient(uint64 sch, anyID clientID)
+{
+    MockConnection* c = findConnection(sch);
+    MockClient* cl = findClient(c, clientID);
+    if (!cl) return;
+    cl->live = false;
+    c->index[clientID] = 0;
+}
+
+bool mockTs3ClientChannel(uint64 sch, anyID clientID, uint64* channel)
+{
+    const MockClient* cl = findClient(findConnection(sch), clientID);
+    if (!cl) return false;
+    *channel = cl->channel;
+    return true;
+}
+
+anyID mockTs3MyID(uint64 sch)
+{
+    const MockConnection* c = findConnection(sch);
+    return c ? c->myID : 0;
+}
+
+/* ---------------- recorder ---------------- */
+
+size_t mockTs3CallCount()
+{
+    const uint64_t n = nextCall.load(std::memory_order_acquire);
+    return (size_t)(n < MOCK_CALL_CAPACITY ? n : MOCK_CALL_CAPACITY);
+}
+
+const MockCall* mockTs3Call(size_t i)
+{
+    return i < mockTs3CallCount() ? &calls[i] : NULL;
+}
+
+void mockTs3GetStats(MockStats* out)
+{
+    const uint64_t n = nextCall.load(std::memory_order_relaxed);
+    out->calls = n;
+    out->dropped = n > MOCK_CALL_CAPACITY ? n - MOCK_CALL_CAPACITY : 0;
+    out->allocs = statAllocs.load(std::memory_order_relaxed);
+    out->frees = statFrees.load(std::memory_order_relaxed);
+    out->logs = statLogs.load(std::memory_order_relaxed);
+    out->commands = statCommands.load(std::memory_order_relaxed);
+    out->commandBytes = statCommandBytes.load(std::memory_order_relaxed);
+}
+
+bool mockTs3WriteCalls(const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "t_us,thread,function,sch,arg,detail\n");
+    const size_t n = mockTs3CallCount();
+    uint64_t t0 = n ? calls[0].tUs : 0;
+    for (size_t i = 1; i < n; i++) t0 = calls[i].tUs < t0 ? calls[i].tUs : t0;  /* threads race to the counter */
+    for (size_t i = 0; i < n; i++) {
+        const MockCall& c = calls[i];
+        fprintf(f, "%llu,%u,%s,%llu,%llu,\"", (unsigned long long)(c.tUs - t0), c.thread, c.fn,
+            (unsigned long long)c.sch, (unsigned long long)c.arg);
+        for (const char* p = c.detail; *p; p++) {
+            if (*p == '"') fputc('"', f);
+            fputc(*p == '\n' ? ' ' : *p, f);
+        }
+        fputs("\"\n", f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * The TeamSpeak client as seen from the plugin, for the Linux host harness
+ * (scda_host.cpp): a TS3Functions table answering from a small scripted world
+ * (connections, channels, clients) and recording every call with its
+ * monoNowUs() timestamp and calling thread.
+ *
+ * Only the functions plugin.cpp calls are filled in. The rest stay NULL so a
+ * new SDK call crashes the host at its first use instead of quietly returning
+ * garbage; stub it here when that happens.
+ *
+ * The world is changed by the host's script thread only, between callbacks.
+ * The plugin's own threads (ingest, log drain) only reach the recorder and
+ * functions that do not read the world (3D attributes, plugin commands, log),
+ * which are safe from any thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "teamspeak/public_definitions.h"
+#include "teamspeak/public_errors.h"
+#include "teamspeak/public_errors_rare.h"
+#include "teamspeak/public_rare_definitions.h"
+#include "ts3_functions.h"
+
+#define MOCK_MAX_CONNECTIONS  8
+#define MOCK_MAX_CLIENTS      1024         /* per connection, ourselves included */
+#define MOCK_NICK_LEN         32
+#define MOCK_PATH_LEN         256
+#define MOCK_CALL_CAPACITY    (1u << 18)   /* recorded calls; later ones are only counted */
+#define MOCK_CALL_DETAIL      88
+
+struct MockCall {
+    uint64_t    tUs;                       /* monoNowUs() on entry */
+    const char* fn;                        /* SDK function name */
+    uint32_t    thread;                    /* 0 = first thread seen calling in, usually the script */
+    uint64_t    sch;
+    uint64_t    arg;                       /* client/channel id, log level, ... as fits the call */
+    char        detail[MOCK_CALL_DETAIL];  /* message or command text, truncated */
+};
+
+struct MockStats {
+    uint64_t calls;
+    uint64_t dropped;       /* calls past MOCK_CALL_CAPACITY, counted but not recorded */
+    uint64_t allocs;        /* result buffers handed to the plugin */
+    uint64_t frees;         /* ...and given back through freeMemory */
+    uint64_t logs;
+    uint64_t commands;      /* sendPluginCommand */
+    uint64_t commandBytes;
+};
+
+/* Empty world, empty recorder; the path getters report `dir` (with a trailing slash). */
+void mockTs3Reset(const char* dir);
+
+/* Fill `out` with the stubs; everything the plugin does not use is NULL. */
+void mockTs3Functions(struct TS3Functions* out);
+
+/* Echo the plugin's log messages to stderr as they arrive. */
+void mockTs3SetEcho(bool echo);
+
+/* Print what the plugin writes to the chat tab on stdout as it arrives. */
+void mockTs3SetChat(bool show);
+
+/* ---- world (script thread) ---- */
+
+/* A connection with ourselves in `channel`, in state STATUS_CONNECTION_ESTABLISHED. */
+bool mockTs3Connect(uint64 sch, anyID myID, uint64 channel, const char* nick);
+void mockTs3Disconnect(uint64 sch);
+void mockTs3SetCurrent(uint64 sch);
+uint64 mockTs3Current();
+
+bool mockTs3AddClient(uint64 sch, anyID clientID, uint64 channel, const char* nick);
+bool mockTs3MoveClient(uint64 sch, anyID clientID, uint64 channel);
+void mockTs3RemoveClient(uint64 sch, anyID clientID);
+bool mockTs3ClientChannel(uint64 sch, anyID clientID, uint64* channel);
+anyID mockTs3MyID(uint64 sch);
+
+/* ---- recorder ---- */
+
+/* Recorded calls, in order; read only once the plugin's threads have stopped. */
+size_t mockTs3CallCount();
+const MockCall* mockTs3Call(size_t i);
+
+void mockTs3GetStats(MockStats* out);
+
+/* The recorded calls as CSV (t_us,thread,function,sch,arg,detail), times relative to the first. */
+bool mockTs3WriteCalls(const char* path);
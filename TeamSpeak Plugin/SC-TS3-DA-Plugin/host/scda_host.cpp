@@ -0,0 +1,317 @@
+/*
+ * Headless TeamSpeak stand-in for Linux: loads the plugin shared object, hands
+ * it the mock TS3Functions table (mock_ts3.h), plays the pose helper's side of
+ * the pose channel (mock_helper.h) and drives the plugin's callbacks from a
+ * script, the way the client would (host_driver.h).
+ *
+ *   scda_host [options] [script]   run `script`, or the built-in scene without one
+ *
+ *   --plugin <path>   plugin shared object (default: the one built alongside)
+ *   --dir <path>      what the app/config/plugin path getters report (default /tmp)
+ *   --calls <file>    every SDK call the plugin made, as CSV
+ *   --fast            play audio blocks back to back instead of every 10 ms
+ *   --echo            print the plugin's log as it arrives
+ *
+ * Script: one command per line, '#' starts a comment.
+ *
+ *   connect <sch> <myID> <channel> <nick>     connection established; the first one is current
+ *   disconnect <sch>
+ *   current <sch>                             switch the active server tab
+ *   join <sch> <clientID> <channel> <nick>    someone comes into view
+ *   move <sch> <clientID> <channel>
+ *   leave <sch> <clientID>
+ *   talk <sch> <clientID> on|off
+ *   peer <sch> <clientID> <zone> <x> <y> <z> [<vx> <vy> <vz>]
+ *                                             their plugin's pose: sent now, then every 100 ms while running
+ *   local <zone> <x> <y> <z> [<vx> <vy> <vz>] our pose through the pose channel: now, then every 30 ms
+ *   command <sch> <clientID> <text>           raw plugin command from that client
+ *   scda <sch> <text>                         "/scda <text>" typed into that server's tab
+ *   run <ms>                                  play 48 kHz stereo in 10 ms blocks on a playback thread;
+ *                                             poses move with their velocity and go out meanwhile
+ *   sleep <ms>
+ *
+ * Events, poses and commands are delivered on the script thread (the client's
+ * event thread); audio on a second thread, as in the client. Remote clients
+ * are heard, and their poses arrive, only while they are in our channel.
+ *
+ * Prints what the plugin writes to the chat tab as it arrives, then what every
+ * callback cost (callback_stats.h) and the SDK calls made.
+ *
+ * Build with CMake from the plugin directory (CMakeLists.txt); the harness is
+ * POSIX-only.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "callback_stats.h"
+#include "host_driver.h"
+#include "mock_ts3.h"
+#include "timebase.h"
+
+#ifndef SCDA_HOST_PLUGIN
+#define SCDA_HOST_PLUGIN "./SC-TS3-DA-Plugin.so"
+#endif
+
+#define HOST_MAX_TOKENS    12
+#define HOST_LINE_LEN      512
+
+/* ---------------- script ---------------- */
+
+/* Splits `line` in place; `restAt` is where the fourth token starts, for `command` text with blanks. */
+static int tokenize(char* line, char** tok, size_t* restAt)
+{
+    int n = 0;
+    char* p = line;
+    *restAt = 0;
+    while (n < HOST_MAX_TOKENS) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p || *p == '#' || *p == '\n' || *p == '\r') break;
+        if (n == 3) *restAt = (size_t)(p - line);
+        tok[n++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+        if (*p) *p++ = '\0';
+    }
+    return n;
+}
+
+static bool parseVec(char** tok, int n, int at, double out[3])
+{
+    for (int a = 0; a < 3; a++) {
+        if (at + a >= n) return false;
+        char* end;
+        out[a] = strtod(tok[at + a], &end);
+        if (*end) return false;
+    }
+    return true;
+}
+
+static bool execute(char* line, const char* where)
+{
+    char* tok[HOST_MAX_TOKENS];
+    size_t restAt;
+    char original[HOST_LINE_LEN];
+    snprintf(original, sizeof(original), "%s", line);
+    const int n = tokenize(line, tok, &restAt);
+    if (n == 0) return true;
+
+    const char* cmd = tok[0];
+    const uint64 sch = n > 1 ? strtoull(tok[1], NULL, 10) : 0;
+    const anyID id = n > 2 ? (anyID)strtoul(tok[2], NULL, 10) : 0;
+    bool ok = true;
+
+    if (strcmp(cmd, "connect") == 0 && n >= 5) {
+        ok = hostConnect(sch, id, strtoull(tok[3], NULL, 10), tok[4]);
+    }
+    else if (strcmp(cmd, "disconnect") == 0 && n >= 2) {
+        hostDisconnect(sch);
+    }
+    else if (strcmp(cmd, "current") == 0 && n >= 2) {
+        hostSetCurrent(sch);
+    }
+    else if (strcmp(cmd, "join") == 0 && n >= 5) {
+        ok = hostJoin(sch, id, strtoull(tok[3], NULL, 10), tok[4]);
+    }
+    else if (strcmp(cmd, "move") == 0 && n >= 4) {
+        ok = hostMove(sch, id, strtoull(tok[3], NULL, 10));
+    }
+    else if (strcmp(cmd, "leave") == 0 && n >= 3) {
+        ok = hostLeave(sch, id);
+    }
+    else if (strcmp(cmd, "talk") == 0 && n >= 4) {
+        ok = (strcmp(tok[3], "on") == 0 || strcmp(tok[3], "off") == 0) && hostTalk(sch, id, strcmp(tok[3], "on") == 0);
+    }
+    else if (strcmp(cmd, "peer") == 0 && n >= 7) {
+        double pos[3], vel[3];
+        ok = parseVec(tok, n, 4, pos) && (n < 8 || parseVec(tok, n, 7, vel))
+            && hostPeerPose(sch, id, tok[3], pos, n >= 8 ? vel : NULL);
+    }
+    else if (strcmp(cmd, "local") == 0 && n >= 5) {
+        double pos[3], vel[3] = { 0.0, 0.0, 0.0 };
+        ok = parseVec(tok, n, 2, pos) && (n < 6 || parseVec(tok, n, 5, vel));
+        if (ok) hostLocalPose(tok[1], pos, vel);
+    }
+    else if (strcmp(cmd, "command") == 0 && n >= 4) {
+        char* text = original + restAt;
+        char* end = text + strlen(text);
+        while (end > text && (end[-1] == '\n' || end[-1] == '\r')) *--end = '\0';
+        hostCommand(sch, id, text);
+    }
+    else if (strcmp(cmd, "scda") == 0 && n >= 3) {
+        char* text = original + (tok[2] - line);
+        char* end = text + strlen(text);
+        while (end > text && (end[-1] == '\n' || end[-1] == '\r')) *--end = '\0';
+        ok = hostProcessCommand(sch, text);
+    }
+    else if (strcmp(cmd, "run") == 0 && n >= 2) {
+        hostRun(strtoull(tok[1], NULL, 10), NULL, NULL);
+    }
+    else if (strcmp(cmd, "sleep") == 0 && n >= 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(strtoull(tok[1], NULL, 10)));
+    }
+    else {
+        fprintf(stderr, "%s: cannot parse: %s", where, original);
+        return false;
+    }
+    if (!ok) fprintf(stderr, "%s: failed: %s", where, original);
+    return ok;
+}
+
+/* Four crew around a Carrack's bridge, one in the hangar below, one joining from another channel. */
+static const char* builtinScript =
+    "connect 1 1 10 Host\n"
+    "local ANVL_Carrack_Bridge 0 0 0\n"
+    "join 1 2 10 Alice\n"
+    "join 1 3 10 Bob\n"
+    "join 1 4 10 Carol\n"
+    "join 1 5 20 Dave\n"
+    "peer 1 2 ANVL_Carrack_Bridge 3 4 0 0.8 0 0\n"
+    "peer 1 3 ANVL_Carrack_Bridge -6 2 0 0 -1.2 0\n"
+    "peer 1 4 Hangar_LorvilleS 40 -15 2\n"
+    "talk 1 2 on\n"
+    "run 1000\n"
+    "talk 1 3 on\n"
+    "talk 1 4 on\n"
+    "run 1000\n"
+    "talk 1 2 off\n"
+    "move 1 5 10\n"
+    "peer 1 5 ANVL_Carrack_Bridge 1 1 0\n"
+    "talk 1 5 on\n"
+    "run 1000\n"
+    "leave 1 3\n"
+    "run 500\n"
+    "scda 1 latency\n"
+    "disconnect 1\n";
+
+static bool runScript(FILE* f, const char* name)
+{
+    char line[HOST_LINE_LEN];
+    char where[HOST_LINE_LEN + 16];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        snprintf(where, sizeof(where), "%s:%d", name, ++lineNo);
+        if (!execute(line, where)) return false;
+    }
+    return true;
+}
+
+static bool runBuiltin()
+{
+    char line[HOST_LINE_LEN];
+    char where[32];
+    int lineNo = 0;
+    for (const char* p = builtinScript; *p;) {
+        const char* eol = strchr(p, '\n');
+        const size_t len = eol ? (size_t)(eol - p + 1) : strlen(p);
+        snprintf(line, sizeof(line), "%.*s", (int)len, p);
+        snprintf(where, sizeof(where), "builtin:%d", ++lineNo);
+        if (!execute(line, where)) return false;
+        p += len;
+    }
+    return true;
+}
+
+/* ---------------- report ---------------- */
+
+static void printCallSummary()
+{
+    /* SDK functions by call count; a handful of names, so a linear table is fine. */
+    struct Count { const char* fn; uint64_t n; };
+    Count counts[64];
+    int kinds = 0;
+    const size_t n = mockTs3CallCount();
+    for (size_t i = 0; i < n; i++) {
+        const char* fn = mockTs3Call(i)->fn;
+        int k = 0;
+        while (k < kinds && strcmp(counts[k].fn, fn) != 0) k++;
+        if (k == kinds) {
+            if (kinds == 64) continue;
+            counts[kinds].fn = fn;
+            counts[kinds++].n = 0;
+        }
+        counts[k].n++;
+    }
+    for (int i = 1; i < kinds; i++) {
+        for (int j = i; j > 0 && counts[j].n > counts[j - 1].n; j--) {
+            const Count t = counts[j];
+            counts[j] = counts[j - 1];
+            counts[j - 1] = t;
+        }
+    }
+    for (int i = 0; i < kinds; i++) printf("  %-36s %llu\n", counts[i].fn, (unsigned long long)counts[i].n);
+}
+
+int main(int argc, char** argv)
+{
+    const char* pluginPath = SCDA_HOST_PLUGIN;
+    const char* dir = "/tmp";
+    const char* callsPath = NULL;
+    const char* scriptPath = NULL;
+    bool echoLog = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) pluginPath = argv[++i];
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+        else if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc) callsPath = argv[++i];
+        else if (strcmp(argv[i], "--fast") == 0) hostSetFast(true);
+        else if (strcmp(argv[i], "--echo") == 0) echoLog = true;
+        else if (argv[i][0] != '-' && !scriptPath) scriptPath = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--plugin <so>] [--dir <path>] [--calls <csv>] [--fast] [--echo] [script]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    char err[512];
+    mockTs3SetChat(true);
+    if (!hostStart(pluginPath, dir, echoLog, err, sizeof(err))) {
+        fprintf(stderr, "cannot start plugin: %s\n", err);
+        return 1;
+    }
+    const HostPlugin* plugin = hostPlugin();
+    printf("%s %s (API %d)\n", plugin->name(), plugin->version(), plugin->apiVersion());
+
+    const uint64_t t0 = monoNowUs();
+    bool ok;
+    if (scriptPath) {
+        FILE* f = fopen(scriptPath, "r");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", scriptPath);
+            ok = false;
+        }
+        else {
+            ok = runScript(f, scriptPath);
+            fclose(f);
+        }
+    }
+    else {
+        ok = runBuiltin();
+    }
+    const uint64_t elapsedUs = monoNowUs() - t0;
+    hostStop();
+
+    HostStats hs;
+    hostGetStats(&hs);
+    MockStats ms;
+    mockTs3GetStats(&ms);
+    printf("script: %s in %.2f s, %llu events, %llu voice blocks, %llu post-process calls\n", ok ? "done" : "FAILED",
+        elapsedUs * 1e-6, (unsigned long long)hs.events, (unsigned long long)hs.blocks, (unsigned long long)hs.voices);
+    callbackStatsPrint(stdout);
+    printf("sdk: %llu calls (%llu not recorded), %llu log lines, %llu plugin commands (%llu bytes)\n",
+        (unsigned long long)ms.calls, (unsigned long long)ms.dropped, (unsigned long long)ms.logs,
+        (unsigned long long)ms.commands, (unsigned long long)ms.commandBytes);
+    printf("sdk: %llu buffers handed out, %llu freed\n", (unsigned long long)ms.allocs, (unsigned long long)ms.frees);
+    printCallSummary();
+
+    if (callsPath && !mockTs3WriteCalls(callsPath)) {
+        fprintf(stderr, "cannot write %s\n", callsPath);
+        ok = false;
+    }
+    if (ms.allocs != ms.frees) {
+        fprintf(stderr, "plugin leaked %llu SDK buffers\n", (unsigned long long)(ms.allocs - ms.frees));
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
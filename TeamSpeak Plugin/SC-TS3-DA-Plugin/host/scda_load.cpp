@@ -0,0 +1,419 @@
+/*
+ * Crowded-server load generator for Linux: N remote clients on one server,
+ * spread over a few channels, each walking or flying a scripted path, talking
+ * in bursts, hopping channels now and then and sending plugin commands (their
+ * SCDA poses every 100 ms, other plugins' chatter now and then), all driven
+ * into the plugin through the host harness (host_driver.h). Reports what each
+ * ts3plugin_* callback cost per call, p50/p99/max, and the heap allocations
+ * made inside it (callback_stats.h), for every N of a sweep.
+ *
+ *   scda_load [options]
+ *
+ *   --clients <list>   comma-separated crowd sizes to sweep (default 1,2,5,10,20,50,100,200,500)
+ *   --seconds <s>      audio played per crowd size (default 5)
+ *   --channels <n>     channels the crowd is spread over; we sit in the first (default 4)
+ *   --talk <f>         fraction of the time each client talks (default 0.15)
+ *   --seed <n>         paths, talk and hop pattern (default 1)
+ *   --fast             play audio blocks back to back instead of every 10 ms
+ *   --plugin <path>    plugin shared object (default: the one built alongside)
+ *   --dir <path>       what the app/config/plugin path getters report (default /tmp)
+ *
+ * Every crowd size runs in its own child process with a freshly loaded plugin,
+ * so nothing carries over between sweep points. The child prints its
+ * per-callback table; the parent ends with one line per crowd size.
+ *
+ * Times include the mock SDK's call recording (tens of ns per SDK call).
+ * With --fast the plugin's own threads (ingest, log drain) get less idle time
+ * between blocks than in the client, so they compete with playback more.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "alloc_count.h"
+#include "callback_stats.h"
+#include "host_driver.h"
+#include "mock_ts3.h"
+#include "timebase.h"
+
+#ifndef SCDA_HOST_PLUGIN
+#define SCDA_HOST_PLUGIN "./SC-TS3-DA-Plugin.so"
+#endif
+
+#define LOAD_MAX_POINTS    32
+#define LOAD_MAX_CLIENTS   (HOST_MAX_PEERS - 1)
+#define LOAD_MAX_CHANNELS  64
+#define LOAD_SCH           1
+#define LOAD_MY_ID         1
+#define LOAD_FIRST_CHANNEL 1
+#define LOAD_PI            3.14159265358979
+#define LOAD_HOP_TICKS     6000   /* mean blocks between a client's channel hops: 60 s */
+#define LOAD_CHATTER_TICKS 200    /* mean blocks between a client's foreign plugin commands: 2 s */
+
+struct LoadOptions {
+    int         clients[LOAD_MAX_POINTS];
+    int         points;
+    double      seconds;
+    int         channels;
+    double      talk;
+    uint32_t    seed;
+    const char* pluginPath;
+    const char* dir;
+};
+
+/* Where a client is and how it moves: a circle around `centre` in its zone, with a vertical bob for flyers. */
+struct LoadPath {
+    const char* zone;
+    double      centre[3];
+    double      radius;     /* metres */
+    double      omega;      /* rad/s, sign gives the direction */
+    double      phase;
+    double      bob;        /* metres of vertical swing */
+};
+
+struct LoadClient {
+    anyID     id;
+    HostPeer* peer;
+    LoadPath  path;
+    uint64_t  nextTalkTick;  /* toggles talking */
+    uint64_t  nextHopTick;
+    uint64_t  nextChatTick;
+};
+
+struct LoadSession {
+    const LoadOptions* opt;
+    LoadClient*        clients;
+    int                count;
+    uint32_t           rng;
+    uint64_t           hops;
+    uint64_t           chatter;
+};
+
+/* What a child sends back for the sweep table. */
+struct LoadResult {
+    int             clients;
+    bool            ok;
+    double          seconds;
+    HostStats       host;
+    CallbackSummary cb[HOST_CB_COUNT];
+    uint64_t        hops;
+    uint64_t        chatter;
+};
+
+/* ---------------- crowd ---------------- */
+
+static uint32_t loadRand(uint32_t* s)
+{
+    /* xorshift32: deterministic for a seed, good enough for a crowd. */
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static double loadUniform(uint32_t* s, double lo, double hi)
+{
+    return lo + (hi - lo) * (loadRand(s) >> 8) * (1.0 / 16777216.0);
+}
+
+/* Somewhere in the first `ticks`, for staggering. */
+static uint64_t loadWithin(uint32_t* s, double ticks)
+{
+    return 1 + (uint64_t)loadUniform(s, 0.0, ticks < 1.0 ? 1.0 : ticks);
+}
+
+static uint64_t loadTicks(uint32_t* s, double meanTicks)
+{
+    /* Half to one and a half times the mean, never zero. */
+    const double t = meanTicks * loadUniform(s, 0.5, 1.5);
+    return t < 1.0 ? 1 : (uint64_t)t;
+}
+
+/* Most of the crowd walks around the bridge we stand on, some are in a hangar, some fly. */
+static void makePath(uint32_t* s, LoadPath* p)
+{
+    const double kind = loadUniform(s, 0.0, 1.0);
+    double speed;
+    if (kind < 0.6) {
+        p->zone = "ANVL_Carrack_Bridge";
+        for (int a = 0; a < 2; a++) p->centre[a] = loadUniform(s, -15.0, 15.0);
+        p->centre[2] = 0.0;
+        p->radius = loadUniform(s, 1.0, 5.0);
+        speed = loadUniform(s, 0.5, 2.0);
+        p->bob = 0.0;
+    }
+    else if (kind < 0.8) {
+        p->zone = "Hangar_LorvilleS";
+        for (int a = 0; a < 2; a++) p->centre[a] = loadUniform(s, -50.0, 50.0);
+        p->centre[2] = 2.0;
+        p->radius = loadUniform(s, 3.0, 20.0);
+        speed = loadUniform(s, 1.0, 4.0);
+        p->bob = 0.0;
+    }
+    else {
+        p->zone = "Stanton_Space";
+        for (int a = 0; a < 3; a++) p->centre[a] = loadUniform(s, -5000.0, 5000.0);
+        p->radius = loadUniform(s, 200.0, 2000.0);
+        speed = loadUniform(s, 50.0, 300.0);
+        p->bob = loadUniform(s, 0.0, 100.0);
+    }
+    p->omega = speed / p->radius * (loadRand(s) & 1 ? 1.0 : -1.0);
+    p->phase = loadUniform(s, 0.0, 2.0 * LOAD_PI);
+}
+
+static void pathAt(const LoadPath& p, double t, double pos[3], double vel[3])
+{
+    const double a = p.omega * t + p.phase;
+    pos[0] = p.centre[0] + p.radius * std::cos(a);
+    pos[1] = p.centre[1] + p.radius * std::sin(a);
+    pos[2] = p.centre[2] + p.bob * std::sin(0.5 * a);
+    vel[0] = -p.radius * p.omega * std::sin(a);
+    vel[1] = p.radius * p.omega * std::cos(a);
+    vel[2] = 0.5 * p.bob * p.omega * std::cos(0.5 * a);
+}
+
+static uint64_t silenceTicks(LoadSession* s)
+{
+    /* Bursts average 2.5 s; the gaps are sized so each client talks `talk` of the time. */
+    const double burst = 250.0;
+    const double talk = s->opt->talk;
+    return loadTicks(&s->rng, talk >= 1.0 ? 1.0 : burst * (1.0 - talk) / (talk <= 0.0 ? 1e-9 : talk));
+}
+
+static void tick(uint64_t tick, uint64_t nowUs, void* ctx)
+{
+    LoadSession* s = (LoadSession*)ctx;
+    const double t = tick * (HOST_BLOCK_US * 1e-6);
+    for (int i = 0; i < s->count; i++) {
+        LoadClient& c = s->clients[i];
+        HostPeer* p = c.peer;
+
+        double pos[3], vel[3];
+        pathAt(c.path, t, pos, vel);
+        p->pose.x = pos[0];
+        p->pose.y = pos[1];
+        p->pose.z = pos[2];
+        p->pose.vx = (float)vel[0];
+        p->pose.vy = (float)vel[1];
+        p->pose.vz = (float)vel[2];
+
+        if (tick >= c.nextTalkTick && s->opt->talk > 0.0) {
+            const bool talking = !p->talking;
+            hostTalk(LOAD_SCH, c.id, talking);
+            c.nextTalkTick = tick + (talking ? loadTicks(&s->rng, 250.0) : silenceTicks(s));
+        }
+        if (tick >= c.nextHopTick) {
+            const uint64 channel = LOAD_FIRST_CHANNEL + loadRand(&s->rng) % (uint32_t)s->opt->channels;
+            if (channel != p->channel) {
+                hostMove(LOAD_SCH, c.id, channel);
+                s->hops++;
+            }
+            c.nextHopTick = tick + loadTicks(&s->rng, LOAD_HOP_TICKS);
+        }
+        if (tick >= c.nextChatTick) {
+            /* Another plugin's traffic: delivered to us too, and only while they share our channel. */
+            if (p->channel == LOAD_FIRST_CHANNEL) {
+                char text[96];
+                snprintf(text, sizeof(text), "OtherPlugin status %u %llu ready", (unsigned)c.id, (unsigned long long)nowUs);
+                hostCommand(LOAD_SCH, c.id, text);
+                s->chatter++;
+            }
+            c.nextChatTick = tick + loadTicks(&s->rng, LOAD_CHATTER_TICKS);
+        }
+    }
+}
+
+/* One sweep point, in the child: join the crowd, play, leave. */
+static bool runCrowd(const LoadOptions& opt, int count, LoadResult* out)
+{
+    static LoadClient clients[LOAD_MAX_CLIENTS];
+    memset(out, 0, sizeof(*out));
+    out->clients = count;
+
+    char err[512];
+    if (!hostStart(opt.pluginPath, opt.dir, false, err, sizeof(err))) {
+        fprintf(stderr, "cannot start plugin: %s\n", err);
+        return false;
+    }
+
+    LoadSession s;
+    s.opt = &opt;
+    s.clients = clients;
+    s.count = count;
+    s.rng = opt.seed ? opt.seed : 1u;
+    s.hops = 0;
+    s.chatter = 0;
+
+    bool ok = hostConnect(LOAD_SCH, LOAD_MY_ID, LOAD_FIRST_CHANNEL, "Load");
+    const double origin[3] = { 0.0, 0.0, 0.0 };
+    hostLocalPose("ANVL_Carrack_Bridge", origin, origin);
+    for (int i = 0; ok && i < count; i++) {
+        LoadClient& c = clients[i];
+        char nick[MOCK_NICK_LEN];
+        c.id = (anyID)(LOAD_MY_ID + 1 + i);
+        snprintf(nick, sizeof(nick), "Crowd%d", i + 1);
+        makePath(&s.rng, &c.path);
+        double pos[3], vel[3];
+        pathAt(c.path, 0.0, pos, vel);
+        ok = hostJoin(LOAD_SCH, c.id, LOAD_FIRST_CHANNEL + (uint64)(i % opt.channels), nick)
+            && hostPeerPose(LOAD_SCH, c.id, c.path.zone, pos, vel);
+        c.peer = hostFindPeer(LOAD_SCH, c.id);
+        /* Staggered so the crowd does not start talking, hopping or chattering in step. */
+        c.nextTalkTick = loadWithin(&s.rng, 250.0 + silenceTicks(&s));
+        c.nextHopTick = loadWithin(&s.rng, LOAD_HOP_TICKS);
+        c.nextChatTick = loadWithin(&s.rng, LOAD_CHATTER_TICKS);
+    }
+
+    const uint64_t t0 = monoNowUs();
+    if (ok) hostRun((uint64_t)(opt.seconds * 1000.0), tick, &s);
+    out->seconds = (monoNowUs() - t0) * 1e-6;
+
+    for (int i = 0; ok && i < count; i++) ok = hostLeave(LOAD_SCH, clients[i].id);
+    hostDisconnect(LOAD_SCH);
+    hostStop();
+
+    MockStats ms;
+    mockTs3GetStats(&ms);
+    if (ms.allocs != ms.frees) {
+        fprintf(stderr, "plugin leaked %llu SDK buffers\n", (unsigned long long)(ms.allocs - ms.frees));
+        ok = false;
+    }
+
+    hostGetStats(&out->host);
+    for (int cb = 0; cb < HOST_CB_COUNT; cb++) callbackSummary((HostCallback)cb, &out->cb[cb]);
+    out->hops = s.hops;
+    out->chatter = s.chatter;
+    out->ok = ok;
+
+    printf("\n--- %d clients: %.2f s, %llu events, %llu blocks, %llu post-process calls, %llu hops, %llu foreign commands%s\n",
+        count, out->seconds, (unsigned long long)out->host.events, (unsigned long long)out->host.blocks,
+        (unsigned long long)out->host.voices, (unsigned long long)out->hops, (unsigned long long)out->chatter,
+        ok ? "" : "  FAILED");
+    callbackStatsPrint(stdout);
+    return ok;
+}
+
+/* ---------------- sweep ---------------- */
+
+static bool runPoint(const LoadOptions& opt, int count, LoadResult* out)
+{
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        LoadResult r;
+        const bool ok = runCrowd(opt, count, &r);
+        fflush(stdout);
+        const ssize_t n = write(fds[1], &r, sizeof(r));
+        _exit(ok && n == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    size_t got = 0;
+    while (got < sizeof(*out)) {
+        const ssize_t n = read(fds[0], (char*)out + got, sizeof(*out) - got);
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == sizeof(*out) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void printSweep(const LoadResult* r, const bool* ok, int points)
+{
+    /* Playback is the budget that matters: everything the audio thread spent in the plugin per 10 ms block. */
+    printf("\nsweep (us; audio = rolloff + post-process + mixed per block, of a %llu us block)\n",
+        (unsigned long long)HOST_BLOCK_US);
+    printf("  %5s %7s %8s %8s  %8s %8s  %8s %8s  %8s %8s  %8s %8s  %9s\n", "N", "voices", "audio", "audio%",
+        "post p99", "max", "mix p99", "max", "cmd p99", "max", "move p99", "max", "allocs");
+    for (int i = 0; i < points; i++) {
+        const LoadResult& x = r[i];
+        if (!ok[i]) {
+            printf("  %5d  failed\n", x.clients);
+            continue;
+        }
+        const CallbackSummary& post = x.cb[HOST_CB_POST_PROCESS];
+        const CallbackSummary& mix = x.cb[HOST_CB_MIXED_PLAYBACK];
+        const CallbackSummary& cmd = x.cb[HOST_CB_PLUGIN_COMMAND];
+        const CallbackSummary& move = x.cb[HOST_CB_CLIENT_MOVE];
+        const CallbackSummary& roll = x.cb[HOST_CB_ROLLOFF];
+        const double blocks = x.host.blocks ? (double)x.host.blocks : 1.0;
+        const double audioUs = (roll.meanUs * roll.calls + post.meanUs * post.calls + mix.meanUs * mix.calls) / blocks;
+        uint64_t allocs = 0;
+        for (int cb = 0; cb < HOST_CB_COUNT; cb++) allocs += x.cb[cb].allocs;
+        printf("  %5d %7.1f %8.1f %7.1f%%  %8.1f %8.1f  %8.1f %8.1f  %8.1f %8.1f  %8.1f %8.1f  %9llu\n", x.clients,
+            x.host.voices / blocks, audioUs, 100.0 * audioUs / HOST_BLOCK_US, post.p99Us, post.maxUs, mix.p99Us, mix.maxUs,
+            cmd.p99Us, cmd.maxUs, move.p99Us, move.maxUs, (unsigned long long)allocs);
+    }
+}
+
+static bool parseClients(const char* list, LoadOptions* opt)
+{
+    opt->points = 0;
+    const char* p = list;
+    while (*p) {
+        char* end;
+        const long n = strtol(p, &end, 10);
+        if (end == p || n < 1 || n > LOAD_MAX_CLIENTS || opt->points == LOAD_MAX_POINTS) return false;
+        opt->clients[opt->points++] = (int)n;
+        p = end;
+        if (*p == ',') p++;
+        else if (*p) return false;
+    }
+    return opt->points > 0;
+}
+
+int main(int argc, char** argv)
+{
+    LoadOptions opt;
+    parseClients("1,2,5,10,20,50,100,200,500", &opt);
+    opt.seconds = 5.0;
+    opt.channels = 4;
+    opt.talk = 0.15;
+    opt.seed = 1;
+    opt.pluginPath = SCDA_HOST_PLUGIN;
+    opt.dir = "/tmp";
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) usage = !parseClients(argv[++i], &opt);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) opt.seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--channels") == 0 && i + 1 < argc) opt.channels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--talk") == 0 && i + 1 < argc) opt.talk = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) opt.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--fast") == 0) hostSetFast(true);
+        else if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) opt.pluginPath = argv[++i];
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) opt.dir = argv[++i];
+        else usage = true;
+    }
+    if (usage || opt.seconds <= 0.0 || opt.channels < 1 || opt.channels > LOAD_MAX_CHANNELS) {
+        fprintf(stderr, "usage: %s [--clients 1,10,100] [--seconds <s>] [--channels <n>] [--talk <f>] [--seed <n>]"
+            " [--fast] [--plugin <so>] [--dir <path>]\n", argv[0]);
+        return 2;
+    }
+    if (!allocCountHooked()) fprintf(stderr, "warning: malloc is not interposed (link with ENABLE_EXPORTS), allocations read 0\n");
+
+    static LoadResult results[LOAD_MAX_POINTS];
+    bool ok[LOAD_MAX_POINTS];
+    bool all = true;
+    for (int i = 0; i < opt.points; i++) {
+        ok[i] = runPoint(opt, opt.clients[i], &results[i]);
+        if (!ok[i]) results[i].clients = opt.clients[i];
+        all = all && ok[i];
+    }
+    printSweep(results, ok, opt.points);
+    return all ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "ingest.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "pose_channel.h"
+#include "spsc_ring.h"
+#include "timebase.h"
+#include "zones.h"
+
+/* 60 Hz producer vs a consumer draining every 10 ms: 16 slots is ample headroom. */
+#define INGEST_RING_SIZE      16
+#define INGEST_WAIT_MS        5
+/* Largest coordinate the HUD can sensibly show (system-scale, in metres). */
+#define INGEST_MAX_COORD_M    1.0e13
+#define INGEST_MAX_AGE_US     2000000ull
+#define INGEST_MAX_SKEW_US    100000ull
+
+static SpscRing<Pose, INGEST_RING_SIZE> ring;
+static std::thread worker;
+static std::atomic<bool> running(false);
+static IngestPoseHook poseHook = NULL;
+static IngestTickHook tickHook = NULL;
+
+static std::atomic<uint64_t> statFrames(0);
+static std::atomic<uint64_t> statRejected(0);
+static std::atomic<uint64_t> statDrained(0);
+static std::atomic<uint64_t> statCoalesced(0);
+
+/* Zone names only change on transitions, so classify once per zone. */
+static uint32_t classifiedZone = ZONE_ID_NONE;
+static ZoneClass classifiedClass = ZONE_CLASS_UNKNOWN;
+
+static bool coordOk(double v) { return std::isfinite(v) && std::fabs(v) <= INGEST_MAX_COORD_M; }
+
+/* Shared-memory slot -> Pose, rejecting anything a misread or a stale helper could produce. */
+static bool decodePose(const SharedPose& in, uint64_t nowUs, Pose* out)
+{
+    if (!coordOk(in.x) || !coordOk(in.y) || !coordOk(in.z)) return false;
+    if (in.zoneId == ZONE_ID_NONE || in.zoneId != zoneIdFromName(in.zone)) return false;
+    if (in.captureUs > nowUs + INGEST_MAX_SKEW_US) return false;
+    if (nowUs > in.captureUs && nowUs - in.captureUs > INGEST_MAX_AGE_US) return false;
+
+    if (in.zoneId != classifiedZone) {
+        classifiedZone = in.zoneId;
+        classifiedClass = zoneClassify(in.zone);
+    }
+
+    out->zoneId = in.zoneId;
+    out->zoneClass = (uint8_t)classifiedClass;
+    out->flags = 0;
+    out->sequence = in.sequence;
+    out->captureUs = in.captureUs;
+    out->receiveUs = nowUs;
+    out->x = in.x;
+    out->y = in.y;
+    out->z = in.z;
+    out->vx = out->vy = out->vz = 0.0f;
+    out->heading = 0.0f;
+    return true;
+}
+
+static void ingestLoop()
+{
+    uint64_t lastSequence = 0;
+    SharedPose raw;
+    Pose pose;
+
+    while (running.load(std::memory_order_acquire)) {
+        poseChannelWait(INGEST_WAIT_MS);
+
+        const uint64_t nowUs = monoNowUs();
+        if (poseChannelRead(&raw) && raw.sequence != lastSequence) {
+            lastSequence = raw.sequence;
+            statFrames.fetch_add(1, std::memory_order_relaxed);
+
+            if (decodePose(raw, nowUs, &pose)) {
+                ring.push(pose); /* counts its own overflows */
+                if (poseHook) poseHook(pose);
+            }
+            else {
+                statRejected.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (tickHook) tickHook(nowUs);
+    }
+}
+
+bool ingestStart(IngestPoseHook onPose, IngestTickHook onTick)
+{
+    if (running.exchange(true)) return true;
+    poseHook = onPose;
+    tickHook = onTick;
+    try {
+        worker = std::thread(ingestLoop);
+    }
+    catch (...) {
+        running.store(false);
+        return false;
+    }
+    return true;
+}
+
+void ingestStop()
+{
+    if (!running.exchange(false)) return;
+    if (worker.joinable()) worker.join();
+}
+
+bool ingestDrain(Pose* latest)
+{
+    uint64_t n = 0;
+    while (ring.pop(latest)) n++;
+    if (!n) return false;
+    statDrained.fetch_add(n, std::memory_order_relaxed);
+    statCoalesced.fetch_add(n - 1, std::memory_order_relaxed);
+    return true;
+}
+
+void ingestGetStats(IngestStats* out)
+{
+    out->frames = statFrames.load(std::memory_order_relaxed);
+    out->rejected = statRejected.load(std::memory_order_relaxed);
+    out->queued = ring.pushed();
+    out->overflows = ring.overflowed();
+    out->drained = statDrained.load(std::memory_order_relaxed);
+    out->coalesced = statCoalesced.load(std::memory_order_relaxed);
+    out->depth = ring.size();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+/*
+ * Pose ingest: a dedicated thread that watches the shared-memory pose channel,
+ * decodes and validates each new pose and hands it to TeamSpeak's callback
+ * side through a wait-free SPSC ring. Nothing on TeamSpeak's threads parses
+ * or validates; they only drain already-checked poses.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pose.h"
+
+struct IngestStats {
+    uint64_t frames;     /* new poses seen on the channel */
+    uint64_t rejected;   /* failed validation */
+    uint64_t queued;     /* pushed into the ring */
+    uint64_t overflows;  /* dropped because the ring was full */
+    uint64_t drained;    /* popped by the consumer */
+    uint64_t coalesced;  /* popped but superseded within the same drain */
+    size_t   depth;      /* current ring occupancy */
+};
+
+/* Called on the ingest thread for every pose that passed validation. */
+typedef void (*IngestPoseHook)(const Pose& pose);
+
+/* Called on the ingest thread every loop iteration, i.e. every few milliseconds. */
+typedef void (*IngestTickHook)(uint64_t nowUs);
+
+/* Start/stop the ingest thread. The pose channel must already be open. */
+bool ingestStart(IngestPoseHook onPose, IngestTickHook onTick);
+void ingestStop();
+
+/*
+ * Consumer side; call from a single TeamSpeak callback thread. Pops everything
+ * queued and keeps only the newest pose. Returns false if nothing was queued.
+ */
+bool ingestDrain(Pose* latest);
+
+void ingestGetStats(IngestStats* out);
@@ -0,0 +1,136 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "latency.h"
+
+#include <atomic>
+#include <cstdio>
+
+struct Histogram {
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> sumUs;
+    std::atomic<uint64_t> maxUs;
+};
+
+static Histogram stages[LATENCY_STAGES];
+
+static const char* const stageNames[LATENCY_STAGES] = {
+    "local receive",
+    "local apply",
+    "local audio",
+    "peer apply",
+    "peer audio",
+};
+
+/* Values below LATENCY_SUB_BUCKETS get a bucket each; above, each power of two is split in LATENCY_SUB_BUCKETS. */
+static int bucketOf(uint64_t us)
+{
+    if (us > LATENCY_MAX_US) us = LATENCY_MAX_US;
+    if (us < LATENCY_SUB_BUCKETS) return (int)us;
+    int msb = LATENCY_SUB_BITS;
+    while (us >> (msb + 1)) msb++;
+    const int shift = msb - LATENCY_SUB_BITS;
+    return LATENCY_SUB_BUCKETS * (shift + 1) + (int)((us >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+static uint64_t bucketLow(int b)
+{
+    if (b < LATENCY_SUB_BUCKETS) return (uint64_t)b;
+    const int shift = b / LATENCY_SUB_BUCKETS - 1;
+    return (uint64_t)(LATENCY_SUB_BUCKETS + b % LATENCY_SUB_BUCKETS) << shift;
+}
+
+static uint64_t bucketHigh(int b)
+{
+    if (b < LATENCY_SUB_BUCKETS) return (uint64_t)b;
+    return bucketLow(b) + (1ull << (b / LATENCY_SUB_BUCKETS - 1)) - 1;
+}
+
+void latencyRecord(LatencyStage stage, uint64_t us)
+{
+    Histogram& h = stages[stage];
+    h.buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = h.maxUs.load(std::memory_order_relaxed);
+    while (us > max && !h.maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+}
+
+const char* latencyStageName(LatencyStage stage)
+{
+    return stage >= 0 && stage < LATENCY_STAGES ? stageNames[stage] : "?";
+}
+
+/* Returns the total; `counts` gets the buckets. */
+static uint64_t snapshot(LatencyStage stage, uint64_t* counts)
+{
+    uint64_t total = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        counts[b] = stages[stage].buckets[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+    return total;
+}
+
+static uint64_t percentile(const uint64_t* counts, uint64_t total, double q)
+{
+    /* Smallest bucket whose cumulative count reaches q of the total. */
+    const uint64_t rank = (uint64_t)(q * (double)total + 0.999999);
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank && seen) return bucketHigh(b);
+    }
+    return 0;
+}
+
+void latencySummary(LatencyStage stage, LatencySummary* out)
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    const uint64_t total = snapshot(stage, counts);
+    out->count = total;
+    out->meanUs = total ? (double)stages[stage].sumUs.load(std::memory_order_relaxed) / (double)total : 0.0;
+    out->maxUs = total ? stages[stage].maxUs.load(std::memory_order_relaxed) : 0;
+    /* A bucket's upper bound can lie past the largest value actually seen. */
+    const uint64_t p[4] = {
+        percentile(counts, total, 0.50), percentile(counts, total, 0.90),
+        percentile(counts, total, 0.99), percentile(counts, total, 0.999),
+    };
+    out->p50Us = p[0] < out->maxUs ? p[0] : out->maxUs;
+    out->p90Us = p[1] < out->maxUs ? p[1] : out->maxUs;
+    out->p99Us = p[2] < out->maxUs ? p[2] : out->maxUs;
+    out->p999Us = p[3] < out->maxUs ? p[3] : out->maxUs;
+}
+
+void latencyReset()
+{
+    for (int s = 0; s < LATENCY_STAGES; s++) {
+        for (int b = 0; b < LATENCY_BUCKETS; b++) stages[s].buckets[b].store(0, std::memory_order_relaxed);
+        stages[s].sumUs.store(0, std::memory_order_relaxed);
+        stages[s].maxUs.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool latencyWriteFile(const char* path)
+{
+    FILE* f = NULL;
+#ifdef _WIN32
+    if (path && fopen_s(&f, path, "w") != 0) f = NULL;
+#else
+    if (path) f = fopen(path, "w");
+#endif
+    if (!f) return false;
+
+    fprintf(f, "stage,from_us,to_us,count,cumulative\n");
+    uint64_t counts[LATENCY_BUCKETS];
+    for (int s = 0; s < LATENCY_STAGES; s++) {
+        const uint64_t total = snapshot((LatencyStage)s, counts);
+        uint64_t seen = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            if (!counts[b]) continue;
+            seen += counts[b];
+            fprintf(f, "%s,%llu,%llu,%llu,%.6f\n", stageNames[s], (unsigned long long)bucketLow(b),
+                (unsigned long long)bucketHigh(b), (unsigned long long)counts[b], (double)seen / (double)total);
+        }
+    }
+    const bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
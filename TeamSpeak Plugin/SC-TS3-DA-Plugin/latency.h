@@ -0,0 +1,62 @@
+#pragma once
+
+/*
+ * Pose latency per pipeline stage, as HDR-style histograms: buckets are
+ * log-linear (LATENCY_SUB_BUCKETS per power of two, so any value is known to
+ * within 1/LATENCY_SUB_BUCKETS of itself) from 1 us to LATENCY_MAX_US.
+ * Recording is one relaxed atomic add per bucket plus max/sum updates; no
+ * locks, no allocation, safe from any thread. Readers take a bucket-by-bucket
+ * snapshot, so a summary taken while poses flow may be off by the few samples
+ * recorded during the copy.
+ *
+ * Our own poses carry the helper's capture time (same clock as monoNowUs(),
+ * see timebase.h), so their stages measure from the HUD frame grab. A peer's
+ * capture time is on the sender's clock, so peer stages measure from when
+ * its plugin command reached us.
+ */
+
+#include <cstdint>
+
+#define LATENCY_SUB_BITS     4
+#define LATENCY_SUB_BUCKETS  (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS     30                          /* ~18 minutes */
+#define LATENCY_MAX_US       ((1ull << LATENCY_MAX_BITS) - 1)
+#define LATENCY_BUCKETS      (LATENCY_SUB_BUCKETS * (LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1))
+#define LATENCY_DUMP_FILE    "scda_latency.csv"          /* in TeamSpeak's config directory */
+
+enum LatencyStage {
+    LATENCY_LOCAL_RECEIVE,   /* HUD capture -> ingest thread validated it */
+    LATENCY_LOCAL_APPLY,     /* HUD capture -> systemset3DListenerAttributes */
+    LATENCY_LOCAL_AUDIO,     /* HUD capture -> playback thread renders with it */
+    LATENCY_PEER_APPLY,      /* plugin command received -> channelset3DAttributes */
+    LATENCY_PEER_AUDIO,      /* plugin command received -> next voice block of that peer rendered with it */
+    LATENCY_STAGES
+};
+
+struct LatencySummary {
+    uint64_t count;
+    double   meanUs;
+    uint64_t p50Us, p90Us, p99Us, p999Us;   /* bucket upper bounds, capped at maxUs */
+    uint64_t maxUs;                         /* exact */
+};
+
+void latencyRecord(LatencyStage stage, uint64_t us);
+
+/* `nowUs - fromUs`; a stamp from the future (clock skew) counts as 0. */
+static inline void latencyStamp(LatencyStage stage, uint64_t fromUs, uint64_t nowUs)
+{
+    latencyRecord(stage, nowUs > fromUs ? nowUs - fromUs : 0);
+}
+
+const char* latencyStageName(LatencyStage stage);
+
+void latencySummary(LatencyStage stage, LatencySummary* out);
+
+/* Forget everything recorded so far. */
+void latencyReset();
+
+/*
+ * Every stage's non-empty buckets as CSV (stage,from_us,to_us,count,cumulative),
+ * for plotting the full distribution. Returns false if the file cannot be written.
+ */
+bool latencyWriteFile(const char* path);
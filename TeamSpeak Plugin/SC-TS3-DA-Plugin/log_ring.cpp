@@ -0,0 +1,258 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "log_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "spsc_ring.h"
+#include "teamspeak/public_definitions.h"
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+#define LOG_DRAIN_INTERVAL_MS  25
+#define LOG_BATCH_LEN          2048  /* one sink call */
+#define LOG_LINE_LEN           512
+/* Records that waited longer than this say so, since TeamSpeak stamps the write time. */
+#define LOG_LATE_US            100000ull
+
+/*
+ * Bounded MPSC queue after Vyukov: each cell's sequence says whose turn it
+ * is. seq == pos: free for the producer that claims `pos`; seq == pos + 1:
+ * committed, readable by the consumer.
+ */
+struct LogCell {
+    std::atomic<uint64_t> seq;
+    LogRecord rec;
+};
+
+struct LogCells {
+    LogCell cells[LOG_RING_SIZE];
+    LogCells()
+    {
+        for (uint64_t i = 0; i < LOG_RING_SIZE; i++) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+};
+
+static LogCells ring;
+alignas(SCDA_CACHELINE) static std::atomic<uint64_t> tail(0);  /* producers */
+alignas(SCDA_CACHELINE) static uint64_t head = 0;               /* drain thread */
+
+static uint64_t reportedDrops = 0;                              /* drain thread */
+
+static std::thread drainer;
+static std::atomic<bool> running(false);
+static LogSink logSink = NULL;
+
+static std::atomic<uint64_t> statRecords(0);
+static std::atomic<uint64_t> statDropped(0);
+static std::atomic<uint64_t> statWritten(0);
+static std::atomic<uint64_t> statBatches(0);
+
+/* ---- producers ---- */
+
+LogRecord* logRingBegin(uint64_t* ticket)
+{
+    uint64_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        LogCell& c = ring.cells[pos & (LOG_RING_SIZE - 1)];
+        const uint64_t seq = c.seq.load(std::memory_order_acquire);
+        const int64_t dif = (int64_t)(seq - pos);
+        if (dif == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                *ticket = pos;
+                return &c.rec;
+            }
+        }
+        else if (dif < 0) {
+            statDropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void logRingCommit(uint64_t ticket)
+{
+    ring.cells[ticket & (LOG_RING_SIZE - 1)].seq.store(ticket + 1, std::memory_order_release);
+    statRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+/* ---- drain thread ---- */
+
+static const char* convChars = "diouxXcsfFeEgGaA";
+
+/* printf one record into out; returns the length written. */
+static size_t formatRecord(const LogRecord& r, char* out, size_t cap)
+{
+    size_t n = 0;
+    int arg = 0;
+    const char* f = r.fmt;
+    while (*f && n + 1 < cap) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[n++] = '%';
+            f += 2;
+            continue;
+        }
+
+        /* Copy flags/width/precision, drop length modifiers, find the conversion. */
+        char spec[24];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && !strchr(convChars, *f)) {
+            if (!strchr("hlLqjzt", *f) && s < sizeof(spec) - 4) spec[s++] = *f;
+            f++;
+        }
+        if (!*f) break;
+        const char conv = *f++;
+
+        int w = 0;
+        if (arg >= r.nargs) {
+            w = snprintf(out + n, cap - n, "<?>");
+        }
+        else {
+            const uint8_t type = r.types[arg];
+            const uint64_t bits = r.args[arg].u;
+            arg++;
+            if (conv == 's') {
+                spec[s++] = 's';
+                spec[s] = '\0';
+                w = snprintf(out + n, cap - n, spec, type == LOG_ARG_STR ? r.text + bits : "<?>");
+            }
+            else if (strchr("fFeEgGaA", conv)) {
+                spec[s++] = conv;
+                spec[s] = '\0';
+                const double d = type == LOG_ARG_DOUBLE ? r.args[arg - 1].d
+                    : type == LOG_ARG_INT ? (double)(int64_t)bits : (double)bits;
+                w = snprintf(out + n, cap - n, spec, d);
+            }
+            else {
+                const uint64_t v = type == LOG_ARG_DOUBLE ? (uint64_t)(int64_t)r.args[arg - 1].d : bits;
+                if (conv == 'c') {
+                    spec[s++] = 'c';
+                    spec[s] = '\0';
+                    w = snprintf(out + n, cap - n, spec, (int)v);
+                }
+                else {
+                    spec[s++] = 'l';
+                    spec[s++] = 'l';
+                    spec[s++] = conv;
+                    spec[s] = '\0';
+                    if (conv == 'd' || conv == 'i') w = snprintf(out + n, cap - n, spec, (long long)(int64_t)v);
+                    else w = snprintf(out + n, cap - n, spec, (unsigned long long)v);
+                }
+            }
+        }
+        if (w < 0) break;
+        n += (size_t)w < cap - n ? (size_t)w : cap - n - 1;
+    }
+    out[n] = '\0';
+
+    const uint64_t nowUs = monoNowUs();
+    if (nowUs > r.timeUs + LOG_LATE_US && n + 1 < cap) {
+        const int w = snprintf(out + n, cap - n, " (%llu ms late)", (unsigned long long)((nowUs - r.timeUs) / 1000));
+        if (w > 0) n += (size_t)w < cap - n ? (size_t)w : cap - n - 1;
+    }
+    return n;
+}
+
+static void drainOnce()
+{
+    static char batch[LOG_BATCH_LEN];
+    static char line[LOG_LINE_LEN];
+    size_t len = 0;
+    int batchLevel = 0;
+    uint64_t batchSch = 0;
+
+    for (;;) {
+        /* Report drops in-band so they show up near the gap. */
+        const uint64_t drops = statDropped.load(std::memory_order_relaxed);
+
+        LogCell& c = ring.cells[head & (LOG_RING_SIZE - 1)];
+        const bool have = c.seq.load(std::memory_order_acquire) == head + 1;
+
+        size_t n = 0;
+        int level = 0;
+        uint64_t sch = 0;
+        if (drops != reportedDrops) {
+            n = (size_t)snprintf(line, sizeof(line), "log: %llu records dropped", (unsigned long long)(drops - reportedDrops));
+            reportedDrops = drops;
+            level = LogLevel_WARNING;
+        }
+        else if (have) {
+            n = formatRecord(c.rec, line, sizeof(line));
+            level = c.rec.level;
+            sch = c.rec.sch;
+            c.seq.store(head + LOG_RING_SIZE, std::memory_order_release);
+            head++;
+            statWritten.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            break;
+        }
+
+        if (len && (level != batchLevel || sch != batchSch || len + 1 + n + 1 > sizeof(batch))) {
+            logSink(batch, batchLevel, batchSch);
+            statBatches.fetch_add(1, std::memory_order_relaxed);
+            len = 0;
+        }
+        if (len) batch[len++] = '\n';
+        memcpy(batch + len, line, n + 1);
+        len += n;
+        batchLevel = level;
+        batchSch = sch;
+    }
+
+    if (len) {
+        logSink(batch, batchLevel, batchSch);
+        statBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void drainLoop()
+{
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#endif
+    while (running.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS));
+        drainOnce();
+    }
+}
+
+bool logRingStart(LogSink sink)
+{
+    if (running.exchange(true)) return true;
+    logSink = sink;
+    try {
+        drainer = std::thread(drainLoop);
+    }
+    catch (...) {
+        running.store(false);
+        return false;
+    }
+    return true;
+}
+
+void logRingStop()
+{
+    if (!running.exchange(false)) return;
+    if (drainer.joinable()) drainer.join();
+    drainOnce();
+}
+
+void logRingGetStats(LogRingStats* out)
+{
+    out->records = statRecords.load(std::memory_order_relaxed);
+    out->dropped = statDropped.load(std::memory_order_relaxed);
+    out->written = statWritten.load(std::memory_order_relaxed);
+    out->batches = statBatches.load(std::memory_order_relaxed);
+}
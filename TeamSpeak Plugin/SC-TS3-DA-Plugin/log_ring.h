@@ -0,0 +1,133 @@
+#pragma once
+
+/*
+ * Asynchronous log for hot callbacks. A producer reserves a fixed-size binary
+ * record in a bounded multi-producer ring, stores level, connection, capture
+ * time, the format string pointer and the raw arguments, and commits: no
+ * formatting, no locks, no SDK call. A low-priority drain thread formats the
+ * records later and hands them to the sink in batches (consecutive records
+ * for the same level and connection become one logMessage call).
+ *
+ * Format strings must be string literals (the pointer is stored, not the
+ * text). String arguments are copied into the record, LOG_TEXT_LEN bytes in
+ * total; anything longer is truncated. Conversions use printf syntax; length
+ * modifiers are ignored because the argument types are captured at the call.
+ * When the ring is full the record is dropped and counted.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "timebase.h"
+
+#define LOG_RING_SIZE   1024   /* records, power of two */
+#define LOG_MAX_ARGS    6
+#define LOG_TEXT_LEN    96
+
+enum LogArgType {
+    LOG_ARG_INT = 0,
+    LOG_ARG_UINT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STR,       /* offset into LogRecord::text */
+};
+
+struct LogRecord {
+    uint64_t    timeUs;
+    uint64_t    sch;
+    const char* fmt;
+    uint8_t     level;
+    uint8_t     nargs;
+    uint8_t     textLen;
+    uint8_t     types[LOG_MAX_ARGS];
+    union {
+        int64_t  i;
+        uint64_t u;
+        double   d;
+    } args[LOG_MAX_ARGS];
+    char        text[LOG_TEXT_LEN];
+};
+
+struct LogRingStats {
+    uint64_t records;   /* committed */
+    uint64_t dropped;   /* ring full */
+    uint64_t written;   /* formatted by the drain thread */
+    uint64_t batches;   /* sink calls */
+};
+
+/* Called on the drain thread with one or more newline-separated lines. */
+typedef void (*LogSink)(const char* msg, int level, uint64_t sch);
+
+bool logRingStart(LogSink sink);
+/* Stops the drain thread and writes out whatever is still queued. */
+void logRingStop();
+
+void logRingGetStats(LogRingStats* out);
+
+/* ---- producer side; use logRecord() below ---- */
+
+/* NULL if the ring is full (the drop is already counted). */
+LogRecord* logRingBegin(uint64_t* ticket);
+void       logRingCommit(uint64_t ticket);
+
+static inline void logPut(LogRecord* r, LogArgType t, uint64_t bits)
+{
+    r->types[r->nargs] = (uint8_t)t;
+    r->args[r->nargs++].u = bits;
+}
+
+static inline void logArg(LogRecord* r, int v)                { logPut(r, LOG_ARG_INT, (uint64_t)(int64_t)v); }
+static inline void logArg(LogRecord* r, long v)               { logPut(r, LOG_ARG_INT, (uint64_t)(int64_t)v); }
+static inline void logArg(LogRecord* r, long long v)          { logPut(r, LOG_ARG_INT, (uint64_t)(int64_t)v); }
+static inline void logArg(LogRecord* r, unsigned v)           { logPut(r, LOG_ARG_UINT, v); }
+static inline void logArg(LogRecord* r, unsigned short v)     { logPut(r, LOG_ARG_UINT, v); }
+static inline void logArg(LogRecord* r, unsigned long v)      { logPut(r, LOG_ARG_UINT, v); }
+static inline void logArg(LogRecord* r, unsigned long long v) { logPut(r, LOG_ARG_UINT, v); }
+static inline void logArg(LogRecord* r, double v)
+{
+    r->types[r->nargs] = LOG_ARG_DOUBLE;
+    r->args[r->nargs++].d = v;
+}
+static inline void logArg(LogRecord* r, const char* s)
+{
+    if (r->textLen >= LOG_TEXT_LEN) {
+        /* Text full: point at the previous string's terminator. */
+        logPut(r, LOG_ARG_STR, LOG_TEXT_LEN - 1);
+        return;
+    }
+    const size_t room = LOG_TEXT_LEN - 1 - r->textLen;
+    size_t n = 0;
+    if (s) {
+        while (n < room && s[n]) n++;
+        memcpy(r->text + r->textLen, s, n);
+    }
+    logPut(r, LOG_ARG_STR, r->textLen);
+    r->textLen = (uint8_t)(r->textLen + n);
+    r->text[r->textLen++] = '\0';
+}
+
+static inline void logArgs(LogRecord*) {}
+
+template <typename T, typename... Rest>
+static inline void logArgs(LogRecord* r, T v, Rest... rest)
+{
+    logArg(r, v);
+    logArgs(r, rest...);
+}
+
+template <typename... Args>
+static inline void logRecord(int level, uint64_t sch, const char* fmt, Args... args)
+{
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    uint64_t ticket;
+    LogRecord* r = logRingBegin(&ticket);
+    if (!r) return;
+    r->timeUs = monoNowUs();
+    r->sch = sch;
+    r->fmt = fmt;
+    r->level = (uint8_t)level;
+    r->nargs = 0;
+    r->textLen = 0;
+    logArgs(r, args...);
+    logRingCommit(ticket);
+}
@@ -0,0 +1,349 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "master.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "delay_pool.h"
+#include "dsp.h"
+#include "teamspeak/public_definitions.h"
+
+#define MASTER_RATE_HZ     48000.0f
+#define MASTER_RING        128               /* per channel, power of two, > MASTER_LOOKAHEAD */
+#define MASTER_MAX_FRAMES  DELAY_MAX_BLOCK
+#define MASTER_CONNECTIONS 4
+#define MASTER_CHUNK       32                /* compressor control period, samples */
+#define MASTER_FULL_SCALE  32768.0f
+
+static_assert((MASTER_RING & (MASTER_RING - 1)) == 0, "MASTER_RING must be a power of two");
+static_assert(MASTER_LOOKAHEAD < MASTER_RING, "look-ahead must fit the ring");
+
+/* Playback thread: one per server connection. */
+struct MasterState {
+    uint64_t     sch;
+    uint64_t     lastBlock;                  /* for eviction */
+    int          channels;
+    unsigned int speakers[MASTER_MAX_CHANNELS];
+    unsigned int ringMask;                   /* channels whose ring still holds audio */
+    uint32_t     pos;                        /* ring write position = samples processed */
+    float        ring[MASTER_MAX_CHANNELS][MASTER_RING];
+    /* Sliding minimum of the required gain (monotonic deque)... */
+    float        minVal[MASTER_RING];
+    uint32_t     minAt[MASTER_RING];
+    uint32_t     minHead, minTail;
+    /* ...box-averaged over the look-ahead... */
+    float        box[MASTER_RING];
+    double       boxSum;
+    /* ...and released. */
+    float        env;
+    float        compGrDb;
+};
+
+static MasterState states[MASTER_CONNECTIONS];
+static MasterState* cur = NULL;
+alignas(32) static float planeBuf[MASTER_MAX_CHANNELS][MASTER_MAX_FRAMES];
+static float* planes[MASTER_MAX_CHANNELS];
+alignas(32) static float peak[MASTER_MAX_FRAMES];
+alignas(32) static float compPeak[MASTER_MAX_FRAMES];
+alignas(32) static float gain[MASTER_MAX_FRAMES];
+static uint64_t blockCounter = 0;
+static std::chrono::steady_clock::time_point beginAt;
+static uint64_t beginNs = 0;
+
+static std::atomic<bool>  cfgLimiter(true);
+static std::atomic<float> cfgCeilingDb(-1.0f);
+static std::atomic<float> cfgReleaseMs(80.0f);
+static std::atomic<bool>  cfgCompressor(false);
+static std::atomic<float> cfgThresholdDb(-18.0f);
+static std::atomic<float> cfgRatio(3.0f);
+static std::atomic<float> cfgAttackMs(10.0f);
+static std::atomic<float> cfgCompReleaseMs(150.0f);
+static std::atomic<float> cfgMakeupDb(0.0f);
+
+static std::atomic<uint64_t> statBlocks(0);
+static std::atomic<uint64_t> statLimited(0);
+static std::atomic<uint64_t> statBypassed(0);
+static std::atomic<uint64_t> statResets(0);
+static std::atomic<float>    statMaxReduction(0.0f);
+static std::atomic<float>    statCompReduction(0.0f);
+
+/* Cost window; playback thread only. */
+static uint64_t costBlocks = 0;
+static uint64_t costTotalNs = 0;
+static uint64_t costMaxNs = 0;
+
+void masterDefaults(MasterConfig* out)
+{
+    out->limiter = true;
+    out->ceilingDb = -1.0f;
+    out->releaseMs = 80.0f;
+    out->compressor = false;
+    out->thresholdDb = -18.0f;
+    out->ratio = 3.0f;
+    out->attackMs = 10.0f;
+    out->compReleaseMs = 150.0f;
+    out->makeupDb = 0.0f;
+}
+
+void masterConfigure(const MasterConfig& cfg)
+{
+    cfgLimiter.store(cfg.limiter, std::memory_order_relaxed);
+    cfgCeilingDb.store(cfg.ceilingDb < 0.0f ? cfg.ceilingDb : 0.0f, std::memory_order_relaxed);
+    cfgReleaseMs.store(cfg.releaseMs > 1.0f ? cfg.releaseMs : 1.0f, std::memory_order_relaxed);
+    cfgCompressor.store(cfg.compressor, std::memory_order_relaxed);
+    cfgThresholdDb.store(cfg.thresholdDb, std::memory_order_relaxed);
+    cfgRatio.store(cfg.ratio >= 1.0f ? cfg.ratio : 1.0f, std::memory_order_relaxed);
+    cfgAttackMs.store(cfg.attackMs > 0.1f ? cfg.attackMs : 0.1f, std::memory_order_relaxed);
+    cfgCompReleaseMs.store(cfg.compReleaseMs > 1.0f ? cfg.compReleaseMs : 1.0f, std::memory_order_relaxed);
+    cfgMakeupDb.store(cfg.makeupDb, std::memory_order_relaxed);
+}
+
+void masterGetConfig(MasterConfig* out)
+{
+    out->limiter = cfgLimiter.load(std::memory_order_relaxed);
+    out->ceilingDb = cfgCeilingDb.load(std::memory_order_relaxed);
+    out->releaseMs = cfgReleaseMs.load(std::memory_order_relaxed);
+    out->compressor = cfgCompressor.load(std::memory_order_relaxed);
+    out->thresholdDb = cfgThresholdDb.load(std::memory_order_relaxed);
+    out->ratio = cfgRatio.load(std::memory_order_relaxed);
+    out->attackMs = cfgAttackMs.load(std::memory_order_relaxed);
+    out->compReleaseMs = cfgCompReleaseMs.load(std::memory_order_relaxed);
+    out->makeupDb = cfgMakeupDb.load(std::memory_order_relaxed);
+}
+
+static uint64_t nsSince(std::chrono::steady_clock::time_point t)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count();
+}
+
+static void resetState(MasterState* st, int channels, const unsigned int* speakers)
+{
+    memset(st->ring, 0, sizeof(st->ring));
+    st->channels = channels;
+    for (int ch = 0; ch < MASTER_MAX_CHANNELS; ch++) st->speakers[ch] = speakers && ch < channels ? speakers[ch] : 0;
+    st->ringMask = 0;
+    st->pos = 0;
+    st->minHead = st->minTail = 0;
+    for (int i = 0; i < MASTER_RING; i++) st->box[i] = 1.0f;
+    st->boxSum = MASTER_LOOKAHEAD;
+    st->env = 1.0f;
+    st->compGrDb = 0.0f;
+}
+
+static MasterState* stateFor(uint64_t sch, int channels, const unsigned int* speakers)
+{
+    MasterState* st = NULL;
+    MasterState* oldest = &states[0];
+    for (int i = 0; i < MASTER_CONNECTIONS; i++) {
+        if (states[i].sch == sch) st = &states[i];
+        if (states[i].lastBlock < oldest->lastBlock) oldest = &states[i];
+    }
+    if (!st) {
+        st = oldest;
+        st->sch = sch;
+        resetState(st, channels, speakers);
+    }
+    else {
+        bool same = st->channels == channels;
+        for (int ch = 0; same && ch < channels; ch++) same = st->speakers[ch] == (speakers ? speakers[ch] : 0);
+        if (!same) {
+            resetState(st, channels, speakers);
+            statResets.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    st->lastBlock = ++blockCounter;
+    return st;
+}
+
+bool masterBegin(uint64_t sch, const short* samples, int frames, int channels,
+                 const unsigned int* channelSpeakerArray, const unsigned int* channelFillMask)
+{
+    beginAt = std::chrono::steady_clock::now();
+    if (frames <= 0 || frames > MASTER_MAX_FRAMES || channels <= 0 || channels > MASTER_MAX_CHANNELS || !channelFillMask) {
+        statBypassed.fetch_add(1, std::memory_order_relaxed);
+        cur = NULL;
+        return false;
+    }
+    cur = stateFor(sch, channels, channelSpeakerArray);
+    for (int ch = 0; ch < channels; ch++) {
+        planes[ch] = planeBuf[ch];
+        float* p = planeBuf[ch];
+        if (*channelFillMask & (1u << ch)) {
+            for (int i = 0; i < frames; i++) p[i] = (float)samples[(size_t)i * channels + ch];
+        }
+        else {
+            memset(p, 0, (size_t)frames * sizeof(float));
+        }
+    }
+    beginNs = nsSince(beginAt);
+    return true;
+}
+
+float* const* masterPlanes()
+{
+    return planes;
+}
+
+/* Channels the compressor listens to: the front pair/centre, or headphones; everything if the layout says nothing. */
+static unsigned int compressorChannels(const MasterState* st)
+{
+    const unsigned int wanted = SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT | SPEAKER_FRONT_CENTER
+        | SPEAKER_HEADPHONES_LEFT | SPEAKER_HEADPHONES_RIGHT | SPEAKER_MONO;
+    unsigned int mask = 0;
+    for (int ch = 0; ch < st->channels; ch++) {
+        if (st->speakers[ch] & wanted) mask |= 1u << ch;
+    }
+    return mask ? mask : (st->channels >= 32 ? 0xFFFFFFFFu : (1u << st->channels) - 1);
+}
+
+/* Gain curve for one block: gain[i] for the sample leaving the ring at i. */
+static bool computeGain(MasterState* st, int frames, unsigned int fill)
+{
+    const DspKernels* k = dspKernels();
+    const bool limiter = cfgLimiter.load(std::memory_order_relaxed);
+    const bool compressor = cfgCompressor.load(std::memory_order_relaxed);
+    const float ceiling = MASTER_FULL_SCALE * std::pow(10.0f, cfgCeilingDb.load(std::memory_order_relaxed) / 20.0f);
+    const float release = 1.0f - std::exp(-1000.0f / (cfgReleaseMs.load(std::memory_order_relaxed) * MASTER_RATE_HZ));
+
+    memset(peak, 0, (size_t)frames * sizeof(float));
+    for (int ch = 0; ch < st->channels; ch++) {
+        if (fill & (1u << ch)) k->peakAbs(planes[ch], frames, peak);
+    }
+
+    /* Compressor: per-chunk gain from the dialogue channels, in dB. */
+    float compGain = 1.0f;
+    if (compressor) {
+        const unsigned int cm = compressorChannels(st) & fill;
+        memset(compPeak, 0, (size_t)frames * sizeof(float));
+        for (int ch = 0; ch < st->channels; ch++) {
+            if (cm & (1u << ch)) k->peakAbs(planes[ch], frames, compPeak);
+        }
+    }
+    const float threshold = cfgThresholdDb.load(std::memory_order_relaxed);
+    const float slope = 1.0f - 1.0f / cfgRatio.load(std::memory_order_relaxed);
+    const float attack = 1.0f - std::exp(-(float)MASTER_CHUNK * 1000.0f / (cfgAttackMs.load(std::memory_order_relaxed) * MASTER_RATE_HZ));
+    const float compRelease = 1.0f - std::exp(-(float)MASTER_CHUNK * 1000.0f / (cfgCompReleaseMs.load(std::memory_order_relaxed) * MASTER_RATE_HZ));
+    const float makeupDb = cfgMakeupDb.load(std::memory_order_relaxed);
+    if (!compressor) st->compGrDb = 0.0f;
+
+    const uint32_t m = MASTER_RING - 1;
+    bool limited = false;
+    float lowest = st->env;
+    for (int c0 = 0; c0 < frames; c0 += MASTER_CHUNK) {
+        const int c1 = c0 + MASTER_CHUNK < frames ? c0 + MASTER_CHUNK : frames;
+        if (compressor) {
+            float p = 1.0f;
+            for (int i = c0; i < c1; i++) if (compPeak[i] > p) p = compPeak[i];
+            const float over = 20.0f * std::log10(p / MASTER_FULL_SCALE) - threshold;
+            const float target = over > 0.0f ? over * slope : 0.0f;
+            st->compGrDb += (target > st->compGrDb ? attack : compRelease) * (target - st->compGrDb);
+            compGain = std::pow(10.0f, (makeupDb - st->compGrDb) / 20.0f);
+        }
+        for (int i = c0; i < c1; i++) {
+            float r = compGain;
+            if (limiter && peak[i] * r > ceiling) {
+                r = ceiling / peak[i];
+                limited = true;
+            }
+            /* Sliding minimum over the last MASTER_LOOKAHEAD + 1 requirements. */
+            const uint32_t n = st->pos + (uint32_t)i;
+            while (st->minTail != st->minHead && st->minVal[(st->minTail - 1) & m] >= r) st->minTail--;
+            st->minVal[st->minTail & m] = r;
+            st->minAt[st->minTail & m] = n;
+            st->minTail++;
+            while (n - st->minAt[st->minHead & m] > MASTER_LOOKAHEAD) st->minHead++;
+            const float mn = st->minVal[st->minHead & m];
+            /* Box average: reaches the minimum exactly when its sample leaves the ring. */
+            st->boxSum += mn - st->box[(n - MASTER_LOOKAHEAD) & m];
+            st->box[n & m] = mn;
+            const float target = (float)(st->boxSum * (1.0 / MASTER_LOOKAHEAD));
+            st->env = target < st->env ? target : st->env + release * (target - st->env);
+            gain[i] = st->env;
+            if (st->env < lowest) lowest = st->env;
+        }
+    }
+
+    /* The running sum picks up rounding; resynchronise it once per block. */
+    double sum = 0.0;
+    for (uint32_t j = 0; j < MASTER_LOOKAHEAD; j++) sum += st->box[(st->pos + (uint32_t)frames - 1 - j) & m];
+    st->boxSum = sum;
+
+    statCompReduction.store(st->compGrDb, std::memory_order_relaxed);
+    const float reduction = lowest < 1.0f ? -20.0f * std::log10(lowest) : 0.0f;
+    if (reduction > statMaxReduction.load(std::memory_order_relaxed)) statMaxReduction.store(reduction, std::memory_order_relaxed);
+    return limited;
+}
+
+void masterEnd(uint64_t sch, short* samples, int frames, int channels,
+               const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    MasterState* st = cur;
+    cur = NULL;
+    if (!st || st->sch != sch || st->channels != channels || !channelFillMask) return;
+
+    const unsigned int fill = *channelFillMask;
+    const unsigned int active = fill | st->ringMask;
+    if (active) {
+        if (computeGain(st, frames, fill)) statLimited.fetch_add(1, std::memory_order_relaxed);
+
+        /* Delay every active channel by the look-ahead and apply the common gain. */
+        const uint32_t m = MASTER_RING - 1;
+        for (int ch = 0; ch < channels; ch++) {
+            if (!(active & (1u << ch))) continue;
+            float* ring = st->ring[ch];
+            const float* in = planes[ch];
+            short* out = samples + ch;
+            uint32_t p = st->pos;
+            for (int i = 0; i < frames; i++, p++) {
+                /* Clamp with min/max and round through an offset: no data-dependent branches per sample. */
+                float y = ring[(p - MASTER_LOOKAHEAD) & m] * gain[i];
+                y = y < -32768.0f ? -32768.0f : y;
+                y = y > 32767.0f ? 32767.0f : y;
+                ring[p & m] = in[i];
+                out[(size_t)i * channels] = (short)((int)(y + 32768.5f) - 32768);
+            }
+        }
+        st->pos += (uint32_t)frames;
+        *channelFillMask = active;
+    }
+    else {
+        /* Silence in, silence still in the ring: keep the gain path in step without the work. */
+        st->pos += (uint32_t)frames;
+        st->minHead = st->minTail = 0;
+        for (int i = 0; i < MASTER_RING; i++) st->box[i] = 1.0f;
+        st->boxSum = MASTER_LOOKAHEAD;
+        st->env = 1.0f;
+    }
+    /* A block shorter than the look-ahead leaves older audio in the ring. */
+    st->ringMask = frames < MASTER_LOOKAHEAD ? active : fill;
+
+    const uint64_t ns = beginNs + nsSince(t0);
+    statBlocks.fetch_add(1, std::memory_order_relaxed);
+    costBlocks++;
+    costTotalNs += ns;
+    if (ns > costMaxNs) costMaxNs = ns;
+}
+
+void masterGetStats(MasterStats* out)
+{
+    out->blocks = statBlocks.load(std::memory_order_relaxed);
+    out->limited = statLimited.load(std::memory_order_relaxed);
+    out->bypassed = statBypassed.load(std::memory_order_relaxed);
+    out->resets = statResets.load(std::memory_order_relaxed);
+    out->maxReductionDb = statMaxReduction.load(std::memory_order_relaxed);
+    out->compReductionDb = statCompReduction.load(std::memory_order_relaxed);
+}
+
+void masterTakeCost(MasterCost* out)
+{
+    out->blocks = costBlocks;
+    out->avgUs = costBlocks ? (double)costTotalNs / (double)costBlocks * 1e-3 : 0.0;
+    out->maxUs = (double)costMaxNs * 1e-3;
+    costBlocks = 0;
+    costTotalNs = 0;
+    costMaxNs = 0;
+}
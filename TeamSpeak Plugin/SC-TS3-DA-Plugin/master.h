@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * Master bus for the mixed-playback callback: an optional bus compressor
+ * and a look-ahead brickwall limiter over every channel of the block, so a
+ * firefight's worth of overlapping voices no longer clips.
+ *
+ * The mixed block is taken into float planes first (masterBegin), the voice
+ * bus adds its busses there unsaturated, and masterEnd limits and writes
+ * back. The limiter delays its output by MASTER_LOOKAHEAD samples (a fixed
+ * latency through a per-channel ring) and computes one gain for all
+ * channels: a sliding minimum of the gain each sample needs, box-smoothed
+ * over the look-ahead so the gain is already down when the peak arrives,
+ * then released exponentially. Level detection is vectorised per channel
+ * (DspKernels::peakAbs).
+ *
+ * The layout comes from channelSpeakerArray: every channel feeds the
+ * limiter's detector, the compressor listens to the front or headphone
+ * channels only (an LFE or surround channel should not pump the dialogue).
+ * A layout change restarts the ring. Each server connection has its own
+ * state, since TeamSpeak mixes them separately.
+ *
+ * Playback thread only, apart from the stats/config accessors.
+ */
+
+#include <cstdint>
+
+#define MASTER_LOOKAHEAD   96     /* samples; 2 ms at 48 kHz, the added latency */
+#define MASTER_MAX_CHANNELS 32    /* channelFillMask width */
+
+struct MasterConfig {
+    bool  limiter;
+    float ceilingDb;        /* dBFS the limiter never exceeds */
+    float releaseMs;
+    bool  compressor;
+    float thresholdDb;      /* dBFS */
+    float ratio;
+    float attackMs;
+    float compReleaseMs;
+    float makeupDb;
+};
+
+struct MasterStats {
+    uint64_t blocks;
+    uint64_t limited;       /* blocks where the limiter took gain away */
+    uint64_t bypassed;      /* blocks too long or too wide to process */
+    uint64_t resets;        /* layout changes */
+    float    maxReductionDb;/* deepest limiter gain reduction seen */
+    float    compReductionDb; /* compressor, last block */
+};
+
+/* Cost since the previous call; playback thread (the mixed callback reports it periodically). */
+struct MasterCost {
+    uint64_t blocks;
+    double   avgUs;
+    double   maxUs;
+};
+
+void masterDefaults(MasterConfig* out);
+void masterConfigure(const MasterConfig& cfg);
+void masterGetConfig(MasterConfig* out);
+
+/*
+ * Start of the mixed callback: copy the filled channels into float planes
+ * (unfilled ones read as silence). False if the block cannot be processed;
+ * then nothing may be added to the planes and masterEnd() is not called.
+ */
+bool masterBegin(uint64_t sch, const short* samples, int frames, int channels,
+                 const unsigned int* channelSpeakerArray, const unsigned int* channelFillMask);
+
+/* The planes of the current block, MASTER_MAX_CHANNELS of them; add to channels you mark filled. */
+float* const* masterPlanes();
+
+/* End of the mixed callback: compress, limit and write the planes back as int16. */
+void masterEnd(uint64_t sch, short* samples, int frames, int channels,
+               const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+
+void masterGetStats(MasterStats* out);
+void masterTakeCost(MasterCost* out);
@@ -0,0 +1,191 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "occlusion.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "delay_pool.h"
+#include "dsp.h"
+#include "zones.h"
+
+#define OCCLUSION_RATE_HZ   48000.0f
+#define OCCLUSION_Q         0.7071f
+#define OCCLUSION_SMOOTH    0.35f    /* per-block approach to the new parameters */
+#define OCCLUSION_MAX_FRAMES DELAY_MAX_BLOCK
+
+static const float PI_F = 3.14159265f;
+
+/* Playback thread only. A voice's filter lives here between blocks and visits a bank lane for one pass. */
+struct OcclusionSlot {
+    uint64_t key;
+    bool     primed;
+    float    logCutoff;  /* smoothed in the log domain: equal steps per octave */
+    float    airDb;
+    float    coef[DSP_COEFS][DSP_BANK_SECTIONS];
+    float    z1[DSP_BANK_SECTIONS];
+    float    z2[DSP_BANK_SECTIONS];
+};
+
+static DspBiquadBank bank;
+static OcclusionSlot slotState[CLIENT_TABLE_CAPACITY];
+alignas(32) static float lanes[OCCLUSION_MAX_FRAMES * DSP_BANK_LANES];
+
+static std::atomic<uint64_t> statPasses(0);
+static std::atomic<uint64_t> statVoices(0);
+
+/* Cutoff for a wall between the listener's zone and a source in a zone of class `cls`. */
+static float wallCutoff(int cls)
+{
+    switch (cls) {
+    case ZONE_CLASS_SHIP:    return 700.0f;   /* hull */
+    case ZONE_CLASS_STATION: return 1000.0f;
+    case ZONE_CLASS_HANGAR:  return 1500.0f;  /* big doors, thin walls */
+    default:                 return 1200.0f;
+    }
+}
+
+void occlusionParams(const Pose& listener, const Pose& source, OcclusionParams* out)
+{
+    const float dx = (float)(source.x - listener.x);
+    const float dy = (float)(source.y - listener.y);
+    const float dz = (float)(source.z - listener.z);
+
+    if (source.zoneId != listener.zoneId) {
+        /* Different frames: the distance means nothing, only that something is in between. */
+        out->cutoffHz = wallCutoff(source.zoneClass);
+        out->airDb = 0.0f;
+        return;
+    }
+    out->cutoffHz = OCCLUSION_OPEN_HZ;
+    /* Suits carry voices in vacuum; no air to absorb anything. */
+    if (listener.zoneClass == ZONE_CLASS_SPACE) {
+        out->airDb = 0.0f;
+        return;
+    }
+    const float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+    const float cut = d * OCCLUSION_AIR_DB_PER_M;
+    out->airDb = -(cut < OCCLUSION_AIR_MAX_DB ? cut : OCCLUSION_AIR_MAX_DB);
+}
+
+/* RBJ cookbook low-pass and high-shelf (S = 1), normalised by a0. */
+static void designLowPass(float hz, float c[DSP_COEFS])
+{
+    const float w = 2.0f * PI_F * hz / OCCLUSION_RATE_HZ;
+    const float cw = std::cos(w), alpha = std::sin(w) / (2.0f * OCCLUSION_Q);
+    const float a0 = 1.0f + alpha;
+    c[DSP_B0] = (1.0f - cw) * 0.5f / a0;
+    c[DSP_B1] = (1.0f - cw) / a0;
+    c[DSP_B2] = c[DSP_B0];
+    c[DSP_A1] = -2.0f * cw / a0;
+    c[DSP_A2] = (1.0f - alpha) / a0;
+}
+
+static void designHighShelf(float hz, float db, float c[DSP_COEFS])
+{
+    const float A = std::pow(10.0f, db / 40.0f);
+    const float w = 2.0f * PI_F * hz / OCCLUSION_RATE_HZ;
+    const float cw = std::cos(w), alpha = std::sin(w) * 0.5f * 1.41421356f;
+    const float sa = 2.0f * std::sqrt(A) * alpha;
+    const float a0 = (A + 1.0f) - (A - 1.0f) * cw + sa;
+    c[DSP_B0] = A * ((A + 1.0f) + (A - 1.0f) * cw + sa) / a0;
+    c[DSP_B1] = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cw) / a0;
+    c[DSP_B2] = A * ((A + 1.0f) + (A - 1.0f) * cw - sa) / a0;
+    c[DSP_A1] = 2.0f * ((A - 1.0f) - (A + 1.0f) * cw) / a0;
+    c[DSP_A2] = ((A + 1.0f) - (A - 1.0f) * cw - sa) / a0;
+}
+
+/* Voice `st` into bank lane `lane`: coefficients ramp from where its last block ended to `c`. */
+static void setLane(int lane, int section, const OcclusionSlot& st, const float c[DSP_COEFS])
+{
+    for (int k = 0; k < DSP_COEFS; k++) {
+        bank.cur[k][section][lane] = st.coef[k][section];
+        bank.target[k][section][lane] = c[k];
+    }
+    bank.z1[section][lane] = st.z1[section];
+    bank.z2[section][lane] = st.z2[section];
+}
+
+void occlusionProcess(const int* slots, const uint64_t* keys, const OcclusionParams* params,
+                      float* const* blocks, int count, int frames)
+{
+    if (count <= 0 || frames <= 0 || frames > OCCLUSION_MAX_FRAMES) return;
+    const DspKernels* k = dspKernels();
+
+    /*
+     * Pack this cycle's voices densely into the bank, DSP_BANK_LANES at a
+     * time, whatever their slots: talkers are a few of the tracked clients
+     * and rarely neighbours in the table, and a pass costs the same for one
+     * lane as for all of them.
+     */
+    int next = 0;
+    while (next < count) {
+        int member[DSP_BANK_LANES];
+        int used = 0;
+        for (; next < count && used < DSP_BANK_LANES; next++) {
+            if (slots[next] < 0 || slots[next] >= CLIENT_TABLE_CAPACITY) continue;
+            const int i = next, lane = used++;
+            member[lane] = i;
+            OcclusionSlot& st = slotState[slots[i]];
+            const float logTarget = std::log(std::fmax(OCCLUSION_MIN_HZ, std::fmin(OCCLUSION_OPEN_HZ, params[i].cutoffHz)));
+            float lp[DSP_COEFS], shelf[DSP_COEFS];
+            if (!st.primed || st.key != keys[i]) {
+                st.key = keys[i];
+                st.primed = true;
+                st.logCutoff = logTarget;
+                st.airDb = params[i].airDb;
+                designLowPass(std::exp(st.logCutoff), lp);
+                designHighShelf(OCCLUSION_SHELF_HZ, st.airDb, shelf);
+                for (int c = 0; c < DSP_COEFS; c++) {
+                    st.coef[c][0] = lp[c];
+                    st.coef[c][1] = shelf[c];
+                }
+                for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) st.z1[sec] = st.z2[sec] = 0.0f;
+            }
+            else {
+                st.logCutoff += OCCLUSION_SMOOTH * (logTarget - st.logCutoff);
+                st.airDb += OCCLUSION_SMOOTH * (params[i].airDb - st.airDb);
+                designLowPass(std::exp(st.logCutoff), lp);
+                designHighShelf(OCCLUSION_SHELF_HZ, st.airDb, shelf);
+            }
+            setLane(lane, 0, st, lp);
+            setLane(lane, 1, st, shelf);
+
+            const float* src = blocks[i];
+            for (int f = 0; f < frames; f++) lanes[(size_t)f * DSP_BANK_LANES + lane] = src[f];
+            statVoices.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!used) break;
+
+        /* Spare lanes run silence through all-zero filters. */
+        for (int lane = used; lane < DSP_BANK_LANES; lane++) {
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) {
+                for (int c = 0; c < DSP_COEFS; c++) bank.cur[c][sec][lane] = bank.target[c][sec][lane] = 0.0f;
+                bank.z1[sec][lane] = bank.z2[sec][lane] = 0.0f;
+            }
+            for (int f = 0; f < frames; f++) lanes[(size_t)f * DSP_BANK_LANES + lane] = 0.0f;
+        }
+
+        k->biquadBank(&bank, lanes, frames);
+        statPasses.fetch_add(1, std::memory_order_relaxed);
+
+        for (int lane = 0; lane < used; lane++) {
+            const int i = member[lane];
+            OcclusionSlot& st = slotState[slots[i]];
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) {
+                for (int c = 0; c < DSP_COEFS; c++) st.coef[c][sec] = bank.cur[c][sec][lane];
+                st.z1[sec] = bank.z1[sec][lane];
+                st.z2[sec] = bank.z2[sec][lane];
+            }
+            float* dst = blocks[i];
+            for (int f = 0; f < frames; f++) dst[f] = lanes[(size_t)f * DSP_BANK_LANES + lane];
+        }
+    }
+}
+
+void occlusionGetStats(OcclusionStats* out)
+{
+    out->passes = statPasses.load(std::memory_order_relaxed);
+    out->voices = statVoices.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * Occlusion and air absorption for remote voices: per client a low-pass
+ * (walls between zones) followed by a high shelf (air over distance).
+ *
+ * Filter states are kept per client table slot; each cycle the voice bus
+ * hands over all of its talkers together and they are packed densely into
+ * DSP_BANK_LANES-wide structure-of-arrays banks, so one SIMD pass filters
+ * DSP_BANK_LANES talkers however far apart their slots are.
+ * Parameters are smoothed per block and coefficients ramp per sample, so a
+ * client walking through a door does not zipper.
+ *
+ * Playback thread only.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+#define OCCLUSION_OPEN_HZ      20000.0f  /* nothing in the way */
+#define OCCLUSION_MIN_HZ       200.0f
+#define OCCLUSION_SHELF_HZ     5000.0f
+#define OCCLUSION_AIR_DB_PER_M 0.08f     /* shelf cut per metre */
+#define OCCLUSION_AIR_MAX_DB   24.0f
+
+struct OcclusionParams {
+    float cutoffHz;         /* low-pass */
+    float airDb;            /* high-shelf gain, <= 0 */
+};
+
+struct OcclusionStats {
+    uint64_t passes;        /* bank passes (one SIMD pass over up to DSP_BANK_LANES clients) */
+    uint64_t voices;        /* client blocks filtered */
+};
+
+/* Filter targets for `source` as heard by `listener`. */
+void occlusionParams(const Pose& listener, const Pose& source, OcclusionParams* out);
+
+/*
+ * Filter `count` client blocks in place; blocks[i] belongs to slots[i] /
+ * keys[i] (clientTableKey, so a reused slot starts clean). Slots must be
+ * distinct.
+ */
+void occlusionProcess(const int* slots, const uint64_t* keys, const OcclusionParams* params,
+                      float* const* blocks, int count, int frames);
+
+void occlusionGetStats(OcclusionStats* out);
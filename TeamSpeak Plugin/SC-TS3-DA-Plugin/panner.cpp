@@ -0,0 +1,174 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "panner.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "dsp.h"
+#include "teamspeak/public_definitions.h"
+
+#define PANNER_SPEED_OF_SOUND 343.0f
+
+/* Playback thread only. */
+struct PannerState {
+    uint64_t key;
+    bool     primed;
+    float    gainL, gainR;
+    float    delayL, delayR;
+    float    commonDelay;
+};
+
+static PannerState states[CLIENT_TABLE_CAPACITY];
+
+alignas(32) static float mono[PANNER_MAX_FRAMES];
+alignas(32) static float earL[PANNER_MAX_FRAMES];
+alignas(32) static float earR[PANNER_MAX_FRAMES];
+
+static std::atomic<uint64_t> statBlocks(0);
+static std::atomic<uint64_t> statRendered(0);
+static std::atomic<uint64_t> statBypassed(0);
+static std::atomic<uint64_t> statNoLine(0);
+
+void pannerGeometry(const Pose& listener, const Pose& source, PannerParams* out)
+{
+    const float dx = (float)(source.x - listener.x);
+    const float dy = (float)(source.y - listener.y);
+    const float dz = (float)(source.z - listener.z);
+    const float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    out->gainL = out->gainR = 1.0f;
+    out->delayL = out->delayR = 0.0f;
+    out->commonDelay = 0.0f;
+    /* Other zones share no frame with us: centred (occlusion still muffles them). */
+    if (!(d >= PANNER_MIN_DIST_M) || source.zoneId != listener.zoneId) return;
+
+    /* Heading is clockwise from +y, z up: right = (cos h, -sin h, 0). */
+    const float h = (listener.flags & POSE_HAS_HEADING) ? listener.heading : 0.0f;
+    float s = (dx * std::cos(h) - dy * std::sin(h)) / d;  /* sin(azimuth), + = right */
+    if (s > 1.0f) s = 1.0f;
+    if (s < -1.0f) s = -1.0f;
+    const float a = std::fabs(s);
+
+    const float farGain = std::pow(10.0f, -PANNER_ILD_MAX_DB * a / 20.0f);
+    const float theta = std::asin(a);
+    const float delay = PANNER_HEAD_RADIUS / PANNER_SPEED_OF_SOUND * (theta + std::sin(theta)) * PANNER_RATE_HZ;
+
+    if (s >= 0.0f) {
+        out->gainL = farGain;
+        out->delayL = delay;
+    }
+    else {
+        out->gainR = farGain;
+        out->delayR = delay;
+    }
+}
+
+bool pannerFindPair(int channels, const unsigned int* speakers, int* chL, int* chR)
+{
+    *chL = *chR = -1;
+    if (!speakers) return false;
+    for (int c = 0; c < channels; c++) {
+        if (speakers[c] & SPEAKER_HEADPHONES_LEFT) *chL = c;
+        if (speakers[c] & SPEAKER_HEADPHONES_RIGHT) *chR = c;
+    }
+    if (*chL >= 0 && *chR >= 0) return true;
+    *chL = *chR = -1;
+    for (int c = 0; c < channels; c++) {
+        if (speakers[c] & SPEAKER_FRONT_LEFT) *chL = c;
+        if (speakers[c] & SPEAKER_FRONT_RIGHT) *chR = c;
+    }
+    return *chL >= 0 && *chR >= 0;
+}
+
+/*
+ * Shared by both outputs: the per-ear signals for one block (ITD and
+ * Doppler from the delay line, or the dry mono without one) and the state
+ * to ramp gains from. Advances the state to `params`.
+ */
+static void renderEars(int slot, uint64_t key, const PannerParams& params, const float* in, int frames,
+                       const float** outL, const float** outR, PannerState* prev)
+{
+    PannerState& st = states[slot];
+    if (!st.primed || st.key != key) {
+        st.key = key;
+        st.primed = true;
+        st.gainL = params.gainL;
+        st.gainR = params.gainR;
+        st.delayL = params.delayL;
+        st.delayR = params.delayR;
+        st.commonDelay = params.commonDelay;
+    }
+    *prev = st;
+
+    DelayLine* line = delayPoolGet(slot, key);
+    if (line) {
+        /* Both ears sit DELAY_MIN back so the near ear can still interpolate. */
+        const float c0 = DELAY_MIN + st.commonDelay, c1 = DELAY_MIN + params.commonDelay;
+        delayLineWrite(line, in, frames);
+        delayLineRead(line, c0 + st.delayL, c1 + params.delayL, frames, earL);
+        delayLineRead(line, c0 + st.delayR, c1 + params.delayR, frames, earR);
+        *outL = earL;
+        *outR = earR;
+    }
+    else {
+        statNoLine.fetch_add(1, std::memory_order_relaxed);
+        *outL = *outR = in;
+    }
+
+    st.gainL = params.gainL;
+    st.gainR = params.gainR;
+    st.delayL = params.delayL;
+    st.delayR = params.delayR;
+    st.commonDelay = params.commonDelay;
+}
+
+bool pannerRender(int slot, uint64_t key, const PannerParams& params,
+                  short* samples, int frames, int channels,
+                  const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    statBlocks.fetch_add(1, std::memory_order_relaxed);
+    int chL, chR;
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY || frames <= 0 || frames > PANNER_MAX_FRAMES
+        || channels > 32 || !channelFillMask || !*channelFillMask
+        || !pannerFindPair(channels, channelSpeakerArray, &chL, &chR)) {
+        statBypassed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const DspKernels* k = dspKernels();
+    k->toMono(samples, frames, channels, *channelFillMask, mono);
+    const float *l, *r;
+    PannerState prev;
+    renderEars(slot, key, params, mono, frames, &l, &r, &prev);
+    k->panStereo(l, r, frames, prev.gainL, params.gainL, prev.gainR, params.gainR, samples, channels, chL, chR);
+
+    /* Only the pair carries the voice now. */
+    *channelFillMask = (1u << chL) | (1u << chR);
+    statRendered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool pannerRenderBus(int slot, uint64_t key, const PannerParams& params,
+                     const float* in, int frames, float* busL, float* busR)
+{
+    statBlocks.fetch_add(1, std::memory_order_relaxed);
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY || frames <= 0 || frames > PANNER_MAX_FRAMES) {
+        statBypassed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const float *l, *r;
+    PannerState prev;
+    renderEars(slot, key, params, in, frames, &l, &r, &prev);
+    dspKernels()->panAccumulate(l, r, frames, prev.gainL, params.gainL, prev.gainR, params.gainR, busL, busR);
+    statRendered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void pannerGetStats(PannerStats* out)
+{
+    out->blocks = statBlocks.load(std::memory_order_relaxed);
+    out->rendered = statRendered.load(std::memory_order_relaxed);
+    out->bypassed = statBypassed.load(std::memory_order_relaxed);
+    out->noLine = statNoLine.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ * Plugin-side spatial panner for one client's voice block, run from
+ * ts3plugin_onEditPostProcessVoiceDataEvent on the playback thread.
+ *
+ * The block is folded to mono and re-rendered to the front left/right (or
+ * headphone) channels with an interaural level difference (far ear
+ * attenuated up to PANNER_ILD_MAX_DB) and time difference (far ear delayed,
+ * Woodworth spherical-head model). Distance attenuation stays with the
+ * custom rolloff; this only decides direction.
+ *
+ * The time difference is read from the client's pooled delay line
+ * (delay_pool.h) at fractional delays; a client without a line gets level
+ * differences only.
+ *
+ * Two outputs: in place into the client's own int16 block (direct path), or
+ * accumulated into float busses when the voice bus renders the whole cycle
+ * in the mixed callback.
+ *
+ * Per-client state is indexed by client table slot and owned by the
+ * playback thread; gains and delays ramp across each block, so parameter
+ * changes do not click.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "delay_pool.h"
+#include "pose.h"
+
+#define PANNER_RATE_HZ     48000
+#define PANNER_MAX_FRAMES  DELAY_MAX_BLOCK  /* larger blocks are passed through */
+#define PANNER_ILD_MAX_DB  8.0f
+#define PANNER_HEAD_RADIUS 0.0875f
+#define PANNER_MIN_DIST_M  0.25f  /* closer than this renders centred */
+
+struct PannerParams {
+    float gainL, gainR;     /* linear */
+    float delayL, delayR;   /* ITD in samples, one of them 0 */
+    float commonDelay;      /* both ears, samples (Doppler, see doppler.h) */
+};
+
+struct PannerStats {
+    uint64_t blocks;        /* pannerRender calls */
+    uint64_t rendered;
+    uint64_t bypassed;      /* layout without a stereo pair, or block too large */
+    uint64_t noLine;        /* rendered without ITD: no delay line for the client */
+};
+
+/* Direction of `source` as heard by `listener`; centred unless both share a zone frame. */
+void pannerGeometry(const Pose& listener, const Pose& source, PannerParams* out);
+
+/*
+ * Render `params` into an interleaved block in place. `key` identifies the
+ * client (clientTableKey) so a reused slot starts from fresh state. Returns
+ * false and leaves the block alone if the layout has no left/right pair.
+ */
+bool pannerRender(int slot, uint64_t key, const PannerParams& params,
+                  short* samples, int frames, int channels,
+                  const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+
+/* Render a mono block and add it to float busses (voice bus path). */
+bool pannerRenderBus(int slot, uint64_t key, const PannerParams& params,
+                     const float* in, int frames, float* busL, float* busR);
+
+/* Channel indices carrying the left/right pair, preferring headphones. */
+bool pannerFindPair(int channels, const unsigned int* speakers, int* chL, int* chR);
+
+void pannerGetStats(PannerStats* out);
@@ -0,0 +1,74 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "peer_pose.h"
+
+#include <atomic>
+
+#define PEER_POSE_READ_RETRIES 4
+
+struct alignas(64) PeerPoseSlot {
+    std::atomic<uint32_t> seq;  /* odd while writing */
+    bool     live;
+    uint16_t clientID;
+    uint64_t sch;
+    Pose     pose;
+};
+
+static PeerPoseSlot slots[CLIENT_TABLE_CAPACITY];
+
+static void writeSlot(int slot, bool live, uint64_t sch, uint16_t clientID, const Pose* pose)
+{
+    PeerPoseSlot& p = slots[slot];
+    const uint32_t s = p.seq.load(std::memory_order_relaxed);
+    p.seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    p.live = live;
+    p.sch = sch;
+    p.clientID = clientID;
+    if (pose) p.pose = *pose;
+    p.seq.store(s + 2, std::memory_order_release);
+}
+
+void peerPosePublish(int slot, uint64_t sch, uint16_t clientID, const Pose& pose)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return;
+    writeSlot(slot, true, sch, clientID, &pose);
+}
+
+void peerPoseRemove(int slot)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY || !slots[slot].live) return;
+    writeSlot(slot, false, slots[slot].sch, slots[slot].clientID, NULL);
+}
+
+void peerPoseRemoveConnection(uint64_t sch)
+{
+    for (int i = 0; i < CLIENT_TABLE_CAPACITY; i++) {
+        if (slots[i].live && slots[i].sch == sch) writeSlot(i, false, sch, slots[i].clientID, NULL);
+    }
+}
+
+uint32_t peerPoseSeq(int slot)
+{
+    return slots[slot].seq.load(std::memory_order_relaxed);
+}
+
+bool peerPoseRead(int slot, PeerPoseSnap* out)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return false;
+    const PeerPoseSlot& p = slots[slot];
+    for (int i = 0; i < PEER_POSE_READ_RETRIES; i++) {
+        const uint32_t s1 = p.seq.load(std::memory_order_acquire);
+        if (s1 & 1u) continue;
+        out->live = p.live;
+        out->sch = p.sch;
+        out->clientID = p.clientID;
+        out->pose = p.pose;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (p.seq.load(std::memory_order_relaxed) == s1) {
+            out->seq = s1;
+            return true;
+        }
+    }
+    return false;
+}
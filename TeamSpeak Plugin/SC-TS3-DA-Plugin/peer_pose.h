@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * Latest pose of every remote peer, per client table slot, for consumers on
+ * other threads (3D apply stage on the ingest thread, DSP on the audio
+ * thread). The client event thread is the only writer; each slot is a
+ * seqlock, so readers never block it and never see a torn pose.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+struct PeerPoseSnap {
+    uint32_t seq;        /* changes on every publish/remove */
+    bool     live;
+    uint16_t clientID;
+    uint64_t sch;
+    Pose     pose;
+};
+
+/* Event thread. */
+void peerPosePublish(int slot, uint64_t sch, uint16_t clientID, const Pose& pose);
+void peerPoseRemove(int slot);
+void peerPoseRemoveConnection(uint64_t sch);
+
+/* Any thread. peerPoseSeq() is a cheap "did anything change" check. */
+uint32_t peerPoseSeq(int slot);
+bool     peerPoseRead(int slot, PeerPoseSnap* out);
@@ -0,0 +1,280 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "peer_wire.h"
+
+#include <cstring>
+
+#include "pose_frame.h"
+
+/* Deltas larger than this are cheaper (and safer) as a keyframe. */
+#define PEER_DELTA_MAX_Q  (1 << 24)
+#define PEER_DT_UNIT_US   100
+
+static const char b64url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/* Inverse of b64url; 0xFF marks characters that cannot appear. */
+static const uint8_t b64urlInv[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255,
+     52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+    255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+     15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255,  63,
+    255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+     41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+/* Longest body a PEER_WIRE_MAX_LEN message can carry. */
+#define PEER_BODY_MAX  (((PEER_WIRE_MAX_LEN - 1 - PEER_WIRE_HEADER_LEN) * 3) / 4)
+
+/* ---- binary body builders ---- */
+
+static uint8_t* putVarint(uint8_t* p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint8_t* putZigzag(uint8_t* p, int64_t v)
+{
+    return putVarint(p, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+/* header + base64url(body) + NUL into out; 0 if it does not fit */
+static size_t finish(char type, const uint8_t* body, size_t n, char* out, size_t cap)
+{
+    const size_t len = PEER_WIRE_HEADER_LEN + (n * 4 + 2) / 3;
+    if (len + 1 > cap) return 0;
+
+    memcpy(out, PEER_WIRE_PREFIX, PEER_WIRE_PREFIX_LEN);
+    out[PEER_WIRE_PREFIX_LEN] = type;
+    char* o = out + PEER_WIRE_HEADER_LEN;
+
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+        uint32_t v = ((uint32_t)body[i] << 16) | ((uint32_t)body[i + 1] << 8) | body[i + 2];
+        *o++ = b64url[(v >> 18) & 63];
+        *o++ = b64url[(v >> 12) & 63];
+        *o++ = b64url[(v >> 6) & 63];
+        *o++ = b64url[v & 63];
+    }
+    if (n - i == 1) {
+        uint32_t v = (uint32_t)body[i] << 16;
+        *o++ = b64url[(v >> 18) & 63];
+        *o++ = b64url[(v >> 12) & 63];
+    }
+    else if (n - i == 2) {
+        uint32_t v = ((uint32_t)body[i] << 16) | ((uint32_t)body[i + 1] << 8);
+        *o++ = b64url[(v >> 18) & 63];
+        *o++ = b64url[(v >> 12) & 63];
+        *o++ = b64url[(v >> 6) & 63];
+    }
+    *o = '\0';
+    return len;
+}
+
+void peerKeyFromPose(const Pose& pose, uint8_t tag, PeerKey* key)
+{
+    const int shift = poseShiftFor(pose.x, pose.y, pose.z);
+    key->zoneId = pose.zoneId;
+    key->zoneClass = pose.zoneClass;
+    key->shift = (uint8_t)shift;
+    key->tag = tag;
+    key->sequence = pose.sequence;
+    key->captureUs = pose.captureUs;
+    key->q[0] = poseQuantise(pose.x, shift);
+    key->q[1] = poseQuantise(pose.y, shift);
+    key->q[2] = poseQuantise(pose.z, shift);
+}
+
+size_t peerWireKeyframe(const Pose& pose, uint8_t tag, char* out, size_t cap)
+{
+    uint8_t body[1 + POSE_FRAME_SIZE];
+    body[0] = tag;
+    poseFrameEncode(pose, body + 1);
+    body[1 + 1] |= POSE_KEYFRAME; /* flags byte of the frame */
+    return finish(PEER_WIRE_KEYFRAME, body, sizeof(body), out, cap);
+}
+
+size_t peerWireDelta(const PeerKey& key, const Pose& pose, char* out, size_t cap)
+{
+    if (pose.zoneId != key.zoneId || pose.sequence < key.sequence || pose.captureUs < key.captureUs) return 0;
+    if (poseShiftFor(pose.x, pose.y, pose.z) > key.shift) return 0;
+
+    const int64_t dx = (int64_t)poseQuantise(pose.x, key.shift) - key.q[0];
+    const int64_t dy = (int64_t)poseQuantise(pose.y, key.shift) - key.q[1];
+    const int64_t dz = (int64_t)poseQuantise(pose.z, key.shift) - key.q[2];
+    if (dx > PEER_DELTA_MAX_Q || dx < -PEER_DELTA_MAX_Q ||
+        dy > PEER_DELTA_MAX_Q || dy < -PEER_DELTA_MAX_Q ||
+        dz > PEER_DELTA_MAX_Q || dz < -PEER_DELTA_MAX_Q) {
+        return 0;
+    }
+
+    uint8_t body[48];
+    uint8_t* p = body;
+    const uint8_t flags = pose.flags & (POSE_HAS_VELOCITY | POSE_HAS_HEADING);
+    *p++ = key.tag;
+    *p++ = flags;
+    p = putVarint(p, pose.sequence - key.sequence);
+    p = putVarint(p, (pose.captureUs - key.captureUs) / PEER_DT_UNIT_US);
+    p = putZigzag(p, dx);
+    p = putZigzag(p, dy);
+    p = putZigzag(p, dz);
+    if (flags & POSE_HAS_VELOCITY) {
+        p = putZigzag(p, poseQuantVelocity(pose.vx));
+        p = putZigzag(p, poseQuantVelocity(pose.vy));
+        p = putZigzag(p, poseQuantVelocity(pose.vz));
+    }
+    if (flags & POSE_HAS_HEADING) {
+        uint16_t h = poseQuantHeading(pose.heading);
+        *p++ = (uint8_t)h;
+        *p++ = (uint8_t)(h >> 8);
+    }
+    return finish(PEER_WIRE_DELTA, body, (size_t)(p - body), out, cap);
+}
+
+/* ---- decoder ---- */
+
+static bool getVarint(const uint8_t** p, const uint8_t* end, uint64_t* v)
+{
+    uint64_t r = 0;
+    for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+        const uint8_t b = *(*p)++;
+        r |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool getZigzag(const uint8_t** p, const uint8_t* end, int64_t* v)
+{
+    uint64_t u;
+    if (!getVarint(p, end, &u)) return false;
+    *v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return true;
+}
+
+static inline uint32_t le32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* base64url after the header into body; returns body length or -1 */
+static int unpackBody(const char* s, uint8_t* body)
+{
+    int n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (int i = 0; s[i]; i++) {
+        if (i >= PEER_WIRE_MAX_LEN - 1 - PEER_WIRE_HEADER_LEN) return -1;
+        const uint8_t c = b64urlInv[(uint8_t)s[i]];
+        if (c == 0xFF) return -1;
+        acc = (acc << 6) | c;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            body[n++] = (uint8_t)(acc >> bits);
+        }
+    }
+    /* A lone trailing sextet cannot come from the encoder. */
+    return bits >= 6 ? -1 : n;
+}
+
+static PeerWireResult decodeKeyframe(const uint8_t* body, int n, uint64_t receiveUs, PeerWireState* state)
+{
+    Pose pose;
+    if (n != 1 + POSE_FRAME_SIZE || !poseFrameDecode(body + 1, POSE_FRAME_SIZE, &pose)) return PEER_WIRE_MALFORMED;
+
+    const uint8_t* f = body + 1;
+    PeerKey& key = state->key;
+    key.zoneId = pose.zoneId;
+    key.zoneClass = pose.zoneClass;
+    key.shift = f[3];
+    key.tag = body[0];
+    key.sequence = pose.sequence;
+    key.captureUs = pose.captureUs;
+    key.q[0] = (int32_t)le32(f + 12);
+    key.q[1] = (int32_t)le32(f + 16);
+    key.q[2] = (int32_t)le32(f + 20);
+    state->haveKey = true;
+
+    pose.receiveUs = receiveUs;
+    state->pose = pose;
+    return PEER_WIRE_OK;
+}
+
+static PeerWireResult decodeDelta(const uint8_t* body, int n, uint64_t receiveUs, PeerWireState* state)
+{
+    if (n < 2) return PEER_WIRE_MALFORMED;
+    const PeerKey& key = state->key;
+    if (!state->haveKey || body[0] != key.tag) return PEER_WIRE_NO_KEY;
+
+    const uint8_t* p = body + 2;
+    const uint8_t* end = body + n;
+    const uint8_t flags = body[1];
+    uint64_t dseq, dt;
+    int64_t d[3], v[3] = { 0, 0, 0 };  /* d becomes the absolute quantised position */
+    if (!getVarint(&p, end, &dseq) || !getVarint(&p, end, &dt)) return PEER_WIRE_MALFORMED;
+    for (int a = 0; a < 3; a++) {
+        if (!getZigzag(&p, end, &d[a]) || d[a] > PEER_DELTA_MAX_Q || d[a] < -PEER_DELTA_MAX_Q) return PEER_WIRE_MALFORMED;
+        d[a] += key.q[a];
+        if (d[a] > INT32_MAX || d[a] < INT32_MIN) return PEER_WIRE_MALFORMED;
+    }
+    if (flags & POSE_HAS_VELOCITY) {
+        for (int a = 0; a < 3; a++) {
+            if (!getZigzag(&p, end, &v[a]) || v[a] > INT16_MAX || v[a] < INT16_MIN) return PEER_WIRE_MALFORMED;
+        }
+    }
+    uint16_t heading = 0;
+    if (flags & POSE_HAS_HEADING) {
+        if (end - p < 2) return PEER_WIRE_MALFORMED;
+        heading = (uint16_t)(p[0] | (p[1] << 8));
+        p += 2;
+    }
+    if (p != end || dt > UINT32_MAX) return PEER_WIRE_MALFORMED;
+
+    Pose& pose = state->pose;
+    pose.zoneId = key.zoneId;
+    pose.zoneClass = key.zoneClass;
+    pose.flags = flags & (POSE_HAS_VELOCITY | POSE_HAS_HEADING);
+    pose.sequence = key.sequence + dseq;
+    pose.captureUs = key.captureUs + dt * PEER_DT_UNIT_US;
+    pose.receiveUs = receiveUs;
+    pose.x = poseDequantise((int32_t)d[0], key.shift);
+    pose.y = poseDequantise((int32_t)d[1], key.shift);
+    pose.z = poseDequantise((int32_t)d[2], key.shift);
+    pose.vx = poseDequantVelocity((int16_t)v[0]);
+    pose.vy = poseDequantVelocity((int16_t)v[1]);
+    pose.vz = poseDequantVelocity((int16_t)v[2]);
+    pose.heading = poseDequantHeading(heading);
+    return PEER_WIRE_OK;
+}
+
+PeerWireResult peerWireDecode(const char* msg, uint64_t receiveUs, PeerWireState* state)
+{
+    if (!peerWireIsOurs(msg)) return PEER_WIRE_FOREIGN;
+    const char type = msg[PEER_WIRE_PREFIX_LEN];
+
+    uint8_t body[PEER_BODY_MAX];
+    const int n = unpackBody(msg + PEER_WIRE_HEADER_LEN, body);
+    if (n < 0) return PEER_WIRE_MALFORMED;
+
+    return type == PEER_WIRE_KEYFRAME
+        ? decodeKeyframe(body, n, receiveUs, state)
+        : decodeDelta(body, n, receiveUs, state);
+}
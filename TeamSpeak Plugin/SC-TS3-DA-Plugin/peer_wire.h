@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * Peer position messages carried by sendPluginCommand.
+ *
+ * Every message is plain ASCII: a 6-character header followed by base64url
+ * (no padding), so it survives TeamSpeak's command escaping untouched.
+ *
+ *   "SCDA1K" <b64: tag u8, pose frame (POSE_FRAME_SIZE bytes)>
+ *   "SCDA1D" <b64: delta body>
+ *
+ * Keyframes carry a full pose frame plus an 8-bit tag. Deltas reference the
+ * last keyframe by tag and carry, in order:
+ *
+ *   u8      tag         keyframe this delta applies to
+ *   u8      flags       PoseFlags
+ *   varint  dseq        sequence - keyframe sequence
+ *   varint  dt          (captureUs - keyframe captureUs) / 100, i.e. 0.1 ms
+ *   zigzag  dx, dy, dz  quantised position minus the keyframe's, same posShift
+ *   zigzag  vx, vy, vz  dm/s                (POSE_HAS_VELOCITY)
+ *   u16     heading     as in the frame     (POSE_HAS_HEADING)
+ *
+ * so a peer standing in a ship interior costs ~20 characters per update
+ * instead of a 60+ character full-precision text position.
+ *
+ * The decoder is a single pass over the NUL-terminated command string with a
+ * fixed stack buffer: no allocation, no copies of the string, and anything
+ * that is not ours is turned away after comparing at most six characters.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pose.h"
+
+#define PEER_WIRE_PREFIX      "SCDA1"
+#define PEER_WIRE_PREFIX_LEN  5
+#define PEER_WIRE_HEADER_LEN  6
+#define PEER_WIRE_KEYFRAME    'K'
+#define PEER_WIRE_DELTA       'D'
+#define PEER_WIRE_MAX_LEN     96   /* longest message incl. NUL */
+
+/* What a receiver (or the sender) needs to remember about the last keyframe. */
+struct PeerKey {
+    uint32_t zoneId;
+    uint8_t  zoneClass;
+    uint8_t  shift;      /* posShift of the keyframe */
+    uint8_t  tag;
+    uint64_t sequence;
+    uint64_t captureUs;
+    int32_t  q[3];       /* quantised keyframe position */
+};
+
+void peerKeyFromPose(const Pose& pose, uint8_t tag, PeerKey* key);
+
+/* Encoders return the message length (excluding NUL), or 0 if it does not fit. */
+size_t peerWireKeyframe(const Pose& pose, uint8_t tag, char* out, size_t cap);
+
+/*
+ * Returns 0 when the pose cannot be expressed against `key` (zone change,
+ * moved too far, needs a larger posShift); the caller sends a keyframe then.
+ */
+size_t peerWireDelta(const PeerKey& key, const Pose& pose, char* out, size_t cap);
+
+enum PeerWireResult {
+    PEER_WIRE_OK = 0,
+    PEER_WIRE_FOREIGN,    /* not an SCDA1 message (another plugin, other version) */
+    PEER_WIRE_MALFORMED,  /* ours, but truncated, bad base64 or inconsistent */
+    PEER_WIRE_NO_KEY,     /* delta whose keyframe we never saw */
+};
+
+/* Receiver state for one remote client. Zero-initialise before first use. */
+struct PeerWireState {
+    PeerKey key;
+    bool    haveKey;
+    Pose    pose;         /* last decoded pose; receiveUs set by the decoder */
+};
+
+/* Cheap first check, before any per-client work is done for a message. */
+static inline bool peerWireIsOurs(const char* msg)
+{
+    for (int i = 0; i < PEER_WIRE_PREFIX_LEN; i++) {
+        if (msg[i] != PEER_WIRE_PREFIX[i]) return false;
+    }
+    return msg[PEER_WIRE_PREFIX_LEN] == PEER_WIRE_KEYFRAME || msg[PEER_WIRE_PREFIX_LEN] == PEER_WIRE_DELTA;
+}
+
+/*
+ * Decode `msg` against `state`. On PEER_WIRE_OK the key (for keyframes) and
+ * pose are updated in place; on any other result `state` is left untouched.
+ */
+PeerWireResult peerWireDecode(const char* msg, uint64_t receiveUs, PeerWireState* state);
@@ -0,0 +1,60 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "peers.h"
+
+#include <atomic>
+
+#include "client_table.h"
+
+static std::atomic<uint64_t> statMessages(0);
+static std::atomic<uint64_t> statKeyframes(0);
+static std::atomic<uint64_t> statDeltas(0);
+static std::atomic<uint64_t> statForeign(0);
+static std::atomic<uint64_t> statMalformed(0);
+static std::atomic<uint64_t> statNoKey(0);
+static std::atomic<uint64_t> statFull(0);
+
+PeerWireResult peersReceive(uint64_t sch, uint16_t clientID, const char* msg, uint64_t nowUs, int* slotOut)
+{
+    *slotOut = -1;
+    statMessages.fetch_add(1, std::memory_order_relaxed);
+    if (!peerWireIsOurs(msg)) {
+        statForeign.fetch_add(1, std::memory_order_relaxed);
+        return PEER_WIRE_FOREIGN;
+    }
+
+    bool created;
+    const int index = clientTableInsert(sch, clientID, &created);
+    ClientState* c = clientTableAt(index);
+    if (!c) {
+        /* Dropped like a delta without keyframe; it retries on the sender's next keyframe. */
+        statFull.fetch_add(1, std::memory_order_relaxed);
+        return PEER_WIRE_NO_KEY;
+    }
+
+    *slotOut = index;
+    const PeerWireResult r = peerWireDecode(msg, nowUs, &c->wire);
+    switch (r) {
+    case PEER_WIRE_OK:
+        c->havePose = true;
+        c->zoneClass.store(c->wire.pose.zoneClass, std::memory_order_relaxed);
+        if (msg[PEER_WIRE_PREFIX_LEN] == PEER_WIRE_KEYFRAME) statKeyframes.fetch_add(1, std::memory_order_relaxed);
+        else statDeltas.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case PEER_WIRE_MALFORMED: statMalformed.fetch_add(1, std::memory_order_relaxed); break;
+    case PEER_WIRE_NO_KEY:    statNoKey.fetch_add(1, std::memory_order_relaxed); break;
+    default:                  statForeign.fetch_add(1, std::memory_order_relaxed); break;
+    }
+    return r;
+}
+
+void peersGetStats(PeerStats* out)
+{
+    out->messages = statMessages.load(std::memory_order_relaxed);
+    out->keyframes = statKeyframes.load(std::memory_order_relaxed);
+    out->deltas = statDeltas.load(std::memory_order_relaxed);
+    out->foreign = statForeign.load(std::memory_order_relaxed);
+    out->malformed = statMalformed.load(std::memory_order_relaxed);
+    out->noKey = statNoKey.load(std::memory_order_relaxed);
+    out->full = statFull.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * Receive path for remote peers' positions sent over plugin commands. Called
+ * on TeamSpeak's client event thread; the work is a client table lookup plus
+ * peerWireDecode() straight into that client's entry, without allocating.
+ */
+
+#include <cstdint>
+
+#include "peer_wire.h"
+
+struct PeerStats {
+    uint64_t messages;   /* every plugin command seen */
+    uint64_t keyframes;
+    uint64_t deltas;
+    uint64_t foreign;    /* not ours; rejected before any lookup */
+    uint64_t malformed;
+    uint64_t noKey;      /* delta before its keyframe */
+    uint64_t full;       /* client table full */
+};
+
+/*
+ * Decode a plugin command from `clientID` into its client table entry,
+ * creating the entry if we somehow missed the client arriving. `slotOut`
+ * receives the entry index or -1.
+ */
+PeerWireResult peersReceive(uint64_t sch, uint16_t clientID, const char* msg, uint64_t nowUs, int* slotOut);
+
+void peersGetStats(PeerStats* out);
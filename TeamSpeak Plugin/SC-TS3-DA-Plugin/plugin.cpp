@@ -13,9 +13,11 @@
 #include <Windows.h>
 #endif
 
+#include <cstdarg>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <atomic>
 
 #include <assert.h>
 #include <stdio.h>
@@ -33,6 +35,34 @@
 /* Your projects plugin.h (exports) */
 #include "plugin.h"
 
+#include "apply3d.h"
+#include "broadcast.h"
+#include "client_table.h"
+#include "console.h"
+#include "ingest.h"
+#include "delay_pool.h"
+#include "doppler.h"
+#include "dsp.h"
+#include "latency.h"
+#include "log_ring.h"
+#include "master.h"
+#include "peer_wire.h"
+#include "peer_pose.h"
+#include "occlusion.h"
+#include "panner.h"
+#include "peers.h"
+#include "pose_channel.h"
+#include "pose_filter.h"
+#include "profile.h"
+#include "radio.h"
+#include "reverb.h"
+#include "rolloff.h"
+#include "send_scheduler.h"
+#include "spatial_hash.h"
+#include "timebase.h"
+#include "trajectory.h"
+#include "voice_bus.h"
+
 /* ===== Local defines (keep as in your working original) ===== */
 static struct TS3Functions ts3Functions;
 
@@ -41,7 +71,8 @@ static struct TS3Functions ts3Functions;
 #define snprintf sprintf_s
 #else
 #define _strcpy(dest, destSize, src) \
-    { strncpy(dest, src, destSize - 1); (dest)[destSize - 1] = '\0'; }
+    { size_t len_ = strlen(src); if (len_ >= (size_t)(destSize)) len_ = (size_t)(destSize) - 1; \
+      memcpy(dest, src, len_); (dest)[len_] = '\0'; }
 #endif
 
 #define PLUGIN_API_VERSION 26
@@ -55,6 +86,34 @@ static struct TS3Functions ts3Functions;
 
 static char* pluginID = NULL;
 
+/* Our own pose, owned by the playback thread (fed from the ingest ring). */
+static Pose listenerPose;
+static bool listenerValid = false;
+
+/* Zone class of our own pose; picks the rolloff curve for clients we have no pose for. */
+static std::atomic<uint8_t> listenerZoneClass(ZONE_CLASS_UNKNOWN);
+
+/*
+ * receiveUs of the pose each peer's last voice block was rendered with, and when that block ran;
+ * playback thread. A pose counts towards "peer audio" only if it arrived while the peer was talking,
+ * so one sent long before they keyed up does not read as latency.
+ */
+#define PEER_AUDIO_GAP_US 100000ull
+static uint64_t peerAudioPoseUs[CLIENT_TABLE_CAPACITY];
+static uint64_t peerAudioBlockUs[CLIENT_TABLE_CAPACITY];
+
+/* Master bus cost goes to the log this often; playback thread. */
+#define MASTER_COST_LOG_US 60000000ull
+static uint64_t masterCostLogUs = 0;
+
+/* Filtered peer positions by zone, keyed by client table slot; client event thread. */
+#define PEER_SPACE_CELL_M 100.0f
+static SpatialHash peerSpace;
+static_assert(CLIENT_TABLE_CAPACITY <= SPATIAL_MAX_ENTRIES, "every slot needs a spatial hash entry");
+
+/* Server connection our pose is broadcast on (0 = none); read by the ingest thread. */
+static std::atomic<uint64> broadcastSch(0);
+
 /* --------- logging helpers (no printf anywhere) --------- */
 static void logTS(uint64 sch, enum LogLevel lvl, const char* msg) {
     if (ts3Functions.logMessage) ts3Functions.logMessage(msg, lvl, "SC-DA", sch);
@@ -63,6 +122,9 @@ static void logInfo(const char* msg, uint64 sch = 0) { logTS(sch, LogLevel_INFO,
 static void logWarn(const char* msg, uint64 sch = 0) { logTS(sch, LogLevel_WARNING, msg); }
 static void logError(const char* msg, uint64 sch = 0) { logTS(sch, LogLevel_ERROR, msg); }
 
+/* Drain thread of the async log (log_ring.h); hot callbacks use logRecord() instead of the above. */
+static void logSinkTS(const char* msg, int level, uint64_t sch) { logTS(sch, (enum LogLevel)level, msg); }
+
 #ifdef _WIN32
 /* Helper: wchar_t -> UTF-8 (same as your original, but safer fallback) */
 static int wcharToUtf8(const wchar_t* str, char** result)
@@ -94,6 +156,131 @@ static void chatf(const char* fmt, ...) {
     ts3Functions.printMessageToCurrentTab(buf);
 }
 
+/* One finished line of /scda output. */
+static void chatLine(const char* line) {
+    if (ts3Functions.printMessageToCurrentTab) ts3Functions.printMessageToCurrentTab(line);
+}
+
+/* --------- pose plumbing --------- */
+
+/* Ingest thread: every validated local pose goes out to our channel and becomes the 3D listener. */
+static void onLocalPose(const Pose& pose)
+{
+    const uint64 sch = broadcastSch.load(std::memory_order_acquire);
+    latencyStamp(LATENCY_LOCAL_RECEIVE, pose.captureUs, pose.receiveUs);
+    listenerZoneClass.store(pose.zoneClass, std::memory_order_relaxed);
+    apply3dSetListener(sch, pose);
+    if (!sch || !pluginID || !ts3Functions.sendPluginCommand) return;
+
+    char msg[PEER_WIRE_MAX_LEN];
+    if (broadcastPose(pose, monoNowUs(), msg, sizeof(msg))) {
+        ts3Functions.sendPluginCommand(sch, pluginID, msg, PluginCommandTarget_CURRENT_CHANNEL, NULL, NULL);
+    }
+}
+
+static void apply3dClient(uint64_t sch, uint16_t clientID, const float pos[3])
+{
+    const TS3_VECTOR v = { pos[0], pos[1], pos[2] };
+    ts3Functions.channelset3DAttributes(sch, clientID, &v);
+}
+
+static void apply3dListener(uint64_t sch, const float pos[3], const float forward[3], const float up[3])
+{
+    const TS3_VECTOR p = { pos[0], pos[1], pos[2] };
+    const TS3_VECTOR f = { forward[0], forward[1], forward[2] };
+    const TS3_VECTOR u = { up[0], up[1], up[2] };
+    ts3Functions.systemset3DListenerAttributes(sch, &p, &f, &u);
+}
+
+static const Apply3dOps apply3dOps = { apply3dClient, apply3dListener };
+
+/* Ingest thread, every few ms: the 3D apply stage keeps its own fixed rate. */
+static void onIngestTick(uint64_t nowUs)
+{
+    apply3dTick(nowUs, apply3dOps);
+}
+
+/* --------- client tracking (event thread) --------- */
+
+static void refreshNickname(uint64 sch, ClientState* c)
+{
+    if (ts3Functions.getClientDisplayName(sch, c->clientID, c->nickname, CLIENT_NICK_LEN) != ERROR_ok) c->nickname[0] = '\0';
+}
+
+/* Table entry for the client, created (and named) on first sight; NULL if the table is full. */
+static ClientState* trackClient(uint64 sch, anyID clientID)
+{
+    bool created;
+    const int slot = clientTableInsert(sch, clientID, &created);
+    ClientState* c = clientTableAt(slot);
+    if (c && created) {
+        refreshNickname(sch, c);
+        delayPoolAcquire(slot, clientTableKey(sch, clientID));
+    }
+    return c;
+}
+
+static void forgetClient(uint64 sch, anyID clientID)
+{
+    const int slot = clientTableRemove(sch, clientID);
+    spatialHashRemove(&peerSpace, slot);
+    peerPoseRemove(slot);
+    delayPoolRelease(slot);
+}
+
+/* Everyone already visible when we connect; later arrivals come through the move events. */
+static void trackConnectionClients(uint64 sch)
+{
+    anyID* clients;
+    if (ts3Functions.getClientList(sch, &clients) != ERROR_ok) return;
+    for (anyID* c = clients; *c; c++) trackClient(sch, *c);
+    ts3Functions.freeMemory(clients);
+}
+
+/* Our client ID and channel on `sch`: cached, asked of the SDK (and cached) only on a miss. */
+static bool selfOn(uint64 sch, anyID* myID, uint64* myChannel)
+{
+    uint16_t id;
+    uint64_t channel;
+    if (clientTableSelf(sch, &id, &channel)) {
+        *myID = id;
+        *myChannel = channel;
+        return true;
+    }
+    if (ts3Functions.getClientID(sch, myID) != ERROR_ok) return false;
+    if (ts3Functions.getChannelOfClient(sch, *myID, myChannel) != ERROR_ok) *myChannel = 0;
+    clientTableSetSelf(sch, *myID, *myChannel);
+    return true;
+}
+
+/* Shared by every move/kick flavour. */
+static void clientMoved(uint64 sch, anyID clientID, uint64 newChannelID, int visibility)
+{
+    if (visibility == LEAVE_VISIBILITY) {
+        forgetClient(sch, clientID);
+        return;
+    }
+    trackClient(sch, clientID);
+
+    /* Someone arrived in our channel (or we moved): they need a keyframe before deltas mean anything. */
+    anyID myID;
+    uint64 myChannel;
+    if (!selfOn(sch, &myID, &myChannel)) return;
+    const bool self = clientID == myID;
+    if (self) clientTableSetSelf(sch, myID, newChannelID);
+    if (sch != broadcastSch.load(std::memory_order_relaxed)) return;
+    if (self || newChannelID == myChannel) broadcastRequestKeyframe();
+}
+
+/* Broadcast on `sch` if it is connected, otherwise stop broadcasting. */
+static void selectBroadcastConnection(uint64 sch)
+{
+    int status = STATUS_DISCONNECTED;
+    if (ts3Functions.getConnectionStatus(sch, &status) != ERROR_ok || status != STATUS_CONNECTION_ESTABLISHED) sch = 0;
+    broadcastSch.store(sch, std::memory_order_release);
+    if (sch) broadcastRequestKeyframe();
+}
+
 
 /*********************************** Required functions ************************************/
 
@@ -138,6 +325,7 @@ void ts3plugin_setFunctionPointers(const struct TS3Functions funcs)
 /* Called after loading the plugin. Return 0 on success. */
 int ts3plugin_init()
 {
+    PROFILE_SCOPE(PROFILE_INIT);
     char appPath[PATH_BUFSIZE] = { 0 };
     char resourcesPath[PATH_BUFSIZE] = { 0 };
     char configPath[PATH_BUFSIZE] = { 0 };
@@ -145,10 +333,12 @@ int ts3plugin_init()
     char buf[1024];
 
     logInfo("PLUGIN: init");
+    if (!logRingStart(logSinkTS)) logError("PLUGIN: could not start log thread");
 
     ts3Functions.getAppPath(appPath, PATH_BUFSIZE);
     ts3Functions.getResourcesPath(resourcesPath, PATH_BUFSIZE);
     ts3Functions.getConfigPath(configPath, PATH_BUFSIZE);
+    consoleInit(configPath);
     ts3Functions.getPluginPath(pluginPath, PATH_BUFSIZE, pluginID);
 
     snprintf(buf, sizeof(buf),
@@ -156,9 +346,32 @@ int ts3plugin_init()
         appPath, resourcesPath, configPath, pluginPath);
     logInfo(buf);
 
+    /* Rolloff curves: built-in defaults, optionally overridden from the config directory. */
+    char rolloffPath[PATH_BUFSIZE + 32];
+    char rolloffErr[160];
+    snprintf(rolloffPath, sizeof(rolloffPath), "%s%s", configPath, ROLLOFF_CONFIG_FILE);
+    if (!rolloffLoadFile(rolloffPath, rolloffErr, sizeof(rolloffErr))) {
+        snprintf(buf, sizeof(buf), "PLUGIN: %s: %s (using defaults)", rolloffPath, rolloffErr);
+        logWarn(buf);
+    }
+
+    spatialHashInit(&peerSpace, PEER_SPACE_CELL_M);
+
+    snprintf(buf, sizeof(buf), "PLUGIN: DSP kernels: %s", dspLevelName(dspKernels()->level));
+    logInfo(buf);
+
     chatf("[color=green][b]SC Directional Audio[/b] loaded and initialized.[/color]");
     chatf("[color=green]Version: %s[/color]", ts3plugin_version());
 
+    /* Pose channel from SCTS3DA.exe; the helper may start before or after us. */
+    if (poseChannelOpen()) {
+        logInfo(poseChannelAttached() ? "PLUGIN: pose channel open, helper attached"
+                                      : "PLUGIN: pose channel open, waiting for helper");
+        if (!ingestStart(onLocalPose, onIngestTick)) logError("PLUGIN: could not start ingest thread");
+    }
+    else {
+        logWarn("PLUGIN: could not open pose channel");
+    }
 
     return 0;
 }
@@ -168,6 +381,147 @@ void ts3plugin_shutdown()
 {
     logInfo("PLUGIN: shutdown");
 
+    {
+        PROFILE_SCOPE(PROFILE_SHUTDOWN);
+        profileTraceStop(NULL);
+        ingestStop();
+        poseChannelClose();
+        logRingStop();
+    }
+
+    IngestStats st;
+    ingestGetStats(&st);
+    char buf[256];
+    snprintf(buf, sizeof(buf), "PLUGIN: ingest frames=%llu rejected=%llu queued=%llu overflows=%llu drained=%llu coalesced=%llu",
+        (unsigned long long)st.frames, (unsigned long long)st.rejected, (unsigned long long)st.queued,
+        (unsigned long long)st.overflows, (unsigned long long)st.drained, (unsigned long long)st.coalesced);
+    logInfo(buf);
+
+    BroadcastStats bs;
+    broadcastGetStats(&bs);
+    snprintf(buf, sizeof(buf), "PLUGIN: broadcast keyframes=%llu deltas=%llu bytes=%llu",
+        (unsigned long long)bs.keyframes, (unsigned long long)bs.deltas, (unsigned long long)bs.bytes);
+    logInfo(buf);
+
+    SendSchedulerStats ss;
+    sendSchedulerGetStats(&ss);
+    snprintf(buf, sizeof(buf), "PLUGIN: scheduler sent=%llu error=%llu heartbeat=%llu forced=%llu suppressed=%llu throttled=%llu",
+        (unsigned long long)ss.sent, (unsigned long long)ss.errorSends, (unsigned long long)ss.heartbeats,
+        (unsigned long long)ss.forced, (unsigned long long)ss.suppressed, (unsigned long long)ss.throttled);
+    logInfo(buf);
+
+    Apply3dStats as;
+    apply3dGetStats(&as);
+    snprintf(buf, sizeof(buf), "PLUGIN: apply3d ticks=%llu client=%llu listener=%llu below=%llu rebases=%llu calls/s=%.1f",
+        (unsigned long long)as.ticks, (unsigned long long)as.clientCalls, (unsigned long long)as.listenerCalls,
+        (unsigned long long)as.belowThreshold, (unsigned long long)as.rebases, as.callsPerSec);
+    logInfo(buf);
+
+    ClientTableStats ts;
+    clientTableGetStats(&ts);
+    snprintf(buf, sizeof(buf), "PLUGIN: clients size=%zu/%zu inserts=%llu removes=%llu full=%llu maxprobe=%u",
+        ts.size, ts.capacity, (unsigned long long)ts.inserts, (unsigned long long)ts.removes, (unsigned long long)ts.full, ts.maxProbe);
+    logInfo(buf);
+
+    PeerStats ps;
+    peersGetStats(&ps);
+    snprintf(buf, sizeof(buf), "PLUGIN: peers messages=%llu keyframes=%llu deltas=%llu foreign=%llu malformed=%llu nokey=%llu full=%llu",
+        (unsigned long long)ps.messages, (unsigned long long)ps.keyframes, (unsigned long long)ps.deltas,
+        (unsigned long long)ps.foreign, (unsigned long long)ps.malformed, (unsigned long long)ps.noKey, (unsigned long long)ps.full);
+    logInfo(buf);
+
+    PannerStats pns;
+    pannerGetStats(&pns);
+    snprintf(buf, sizeof(buf), "PLUGIN: panner blocks=%llu rendered=%llu bypassed=%llu noline=%llu",
+        (unsigned long long)pns.blocks, (unsigned long long)pns.rendered, (unsigned long long)pns.bypassed, (unsigned long long)pns.noLine);
+    logInfo(buf);
+
+    DopplerStats ds;
+    dopplerGetStats(&ds);
+    snprintf(buf, sizeof(buf), "PLUGIN: doppler blocks=%llu shifted=%llu limited=%llu",
+        (unsigned long long)ds.blocks, (unsigned long long)ds.shifted, (unsigned long long)ds.limited);
+    logInfo(buf);
+
+    OcclusionStats os;
+    occlusionGetStats(&os);
+    VoiceBusStats vs;
+    voiceBusGetStats(&vs);
+    snprintf(buf, sizeof(buf), "PLUGIN: voice bus cycles=%llu voices=%llu fallbacks=%llu dropped=%llu max=%u filter passes=%llu",
+        (unsigned long long)vs.cycles, (unsigned long long)vs.voices, (unsigned long long)vs.fallbacks,
+        (unsigned long long)vs.dropped, vs.maxVoices, (unsigned long long)os.passes);
+    logInfo(buf);
+
+    MasterStats ms;
+    masterGetStats(&ms);
+    snprintf(buf, sizeof(buf), "PLUGIN: master blocks=%llu limited=%llu bypassed=%llu resets=%llu max reduction=%.1f dB",
+        (unsigned long long)ms.blocks, (unsigned long long)ms.limited, (unsigned long long)ms.bypassed,
+        (unsigned long long)ms.resets, ms.maxReductionDb);
+    logInfo(buf);
+
+    RadioStats ras;
+    radioGetStats(&ras);
+    snprintf(buf, sizeof(buf), "PLUGIN: radio voices=%llu passes=%llu switches=%llu key-ups=%llu tails=%llu",
+        (unsigned long long)ras.voices, (unsigned long long)ras.passes, (unsigned long long)ras.switches,
+        (unsigned long long)ras.keyUps, (unsigned long long)ras.tails);
+    logInfo(buf);
+
+    ReverbStats rs;
+    reverbGetStats(&rs);
+    snprintf(buf, sizeof(buf), "PLUGIN: reverb blocks=%llu idle=%llu sends=%llu preset changes=%llu zone=%s",
+        (unsigned long long)rs.blocks, (unsigned long long)rs.idle, (unsigned long long)rs.sends,
+        (unsigned long long)rs.presetChanges, zoneClassName((ZoneClass)rs.zoneClass));
+    logInfo(buf);
+
+    PoseFilterStats pfs;
+    poseFilterGetStats(&pfs);
+    snprintf(buf, sizeof(buf), "PLUGIN: pose filter updates=%llu rejected=%llu resets=%llu",
+        (unsigned long long)pfs.updates, (unsigned long long)pfs.rejected, (unsigned long long)pfs.resets);
+    logInfo(buf);
+
+    SpatialHashStats shs;
+    spatialHashGetStats(&peerSpace, &shs);
+    snprintf(buf, sizeof(buf), "PLUGIN: peer space entries=%d cells=%d inserts=%llu moves=%llu removes=%llu queries=%llu fallbacks=%llu max probe=%u",
+        shs.entries, shs.cells, (unsigned long long)shs.inserts, (unsigned long long)shs.moves,
+        (unsigned long long)shs.removes, (unsigned long long)shs.queries, (unsigned long long)shs.fallbacks, shs.maxProbe);
+    logInfo(buf);
+
+    TrajectoryStats trs;
+    trajectoryGetStats(&trs);
+    snprintf(buf, sizeof(buf), "PLUGIN: trajectory pushes=%llu resets=%llu interpolated=%llu extrapolated=%llu held=%llu blends=%llu",
+        (unsigned long long)trs.pushes, (unsigned long long)trs.resets, (unsigned long long)trs.interpolated,
+        (unsigned long long)trs.extrapolated, (unsigned long long)trs.held, (unsigned long long)trs.blends);
+    logInfo(buf);
+
+    DelayPoolStats dps;
+    delayPoolGetStats(&dps);
+    snprintf(buf, sizeof(buf), "PLUGIN: delay lines inuse=%u parked=%u acquired=%llu released=%llu exhausted=%llu",
+        dps.inUse, dps.parked, (unsigned long long)dps.acquired, (unsigned long long)dps.released, (unsigned long long)dps.exhausted);
+    logInfo(buf);
+
+    for (int s = 0; s < LATENCY_STAGES; s++) {
+        LatencySummary lat;
+        latencySummary((LatencyStage)s, &lat);
+        snprintf(buf, sizeof(buf), "PLUGIN: latency %s n=%llu mean=%.0fus p50=%lluus p99=%lluus p99.9=%lluus max=%lluus",
+            latencyStageName((LatencyStage)s), (unsigned long long)lat.count, lat.meanUs, (unsigned long long)lat.p50Us,
+            (unsigned long long)lat.p99Us, (unsigned long long)lat.p999Us, (unsigned long long)lat.maxUs);
+        logInfo(buf);
+    }
+
+    for (int i = 0; i < PROFILE_PROBES; i++) {
+        ProfileEntry pe;
+        profileGet((ProfileProbe)i, &pe);
+        if (!pe.calls) continue;
+        snprintf(buf, sizeof(buf), "PLUGIN: profile %s calls=%llu mean=%.2fus max=%.1fus", profileName((ProfileProbe)i),
+            (unsigned long long)pe.calls, (double)pe.totalNs * 1e-3 / pe.calls, (double)pe.maxNs * 1e-3);
+        logInfo(buf);
+    }
+
+    LogRingStats ls;
+    logRingGetStats(&ls);
+    snprintf(buf, sizeof(buf), "PLUGIN: log records=%llu dropped=%llu written=%llu batches=%llu",
+        (unsigned long long)ls.records, (unsigned long long)ls.dropped, (unsigned long long)ls.written, (unsigned long long)ls.batches);
+    logInfo(buf);
+
     if (pluginID) {
         free(pluginID);
         pluginID = NULL;
@@ -178,6 +532,7 @@ void ts3plugin_shutdown()
 
 void ts3plugin_registerPluginID(const char* id)
 {
+    PROFILE_SCOPE(PROFILE_REGISTER_PLUGIN_ID);
     const size_t sz = strlen(id) + 1;
     pluginID = (char*)malloc(sz * sizeof(char));
     _strcpy(pluginID, sz, id);
@@ -188,12 +543,23 @@ void ts3plugin_registerPluginID(const char* id)
 
 const char* ts3plugin_commandKeyword() { return "scda"; }
 
+/* "/scda <subcommand> ..." (console.h); the keyword is ours, so every command counts as handled. */
+int ts3plugin_processCommand(uint64 serverConnectionHandlerID, const char* command)
+{
+    PROFILE_SCOPE(PROFILE_PROCESS_COMMAND);
+    consoleExecute(command, chatLine);
+    return 0;
+}
+
 void ts3plugin_currentServerConnectionChanged(uint64 serverConnectionHandlerID)
 {
+    PROFILE_SCOPE(PROFILE_CURRENT_CONNECTION);
     char buf[256];
     snprintf(buf, sizeof(buf), "PLUGIN: currentServerConnectionChanged %llu",
         (unsigned long long)serverConnectionHandlerID);
     logInfo(buf, serverConnectionHandlerID);
+
+    selectBroadcastConnection(serverConnectionHandlerID);
 }
 
 /* Info panel title */
@@ -202,6 +568,7 @@ const char* ts3plugin_infoTitle() { return "Star Citizen Directional Audio info"
 /* Info panel content; set *data=NULL to ignore */
 void ts3plugin_infoData(uint64 sch, uint64 id, enum PluginItemType type, char** data)
 {
+    PROFILE_SCOPE(PROFILE_INFO_DATA);
     char* name;
 
     switch (type) {
@@ -245,6 +612,30 @@ int ts3plugin_requestAutoload() { return 0; }
 
 void ts3plugin_onConnectStatusChangeEvent(uint64 sch, int newStatus, unsigned int errorNumber)
 {
+    PROFILE_SCOPE(PROFILE_CONNECT_STATUS);
+    if (newStatus == STATUS_DISCONNECTED) {
+        uint64 expected = sch;
+        broadcastSch.compare_exchange_strong(expected, 0);
+        for (int i = 0; i < CLIENT_TABLE_CAPACITY; i++) {
+            const ClientState* c = clientTableAt(i);
+            if (c && c->sch == sch) spatialHashRemove(&peerSpace, i);
+        }
+        clientTableRemoveConnection(sch);
+        peerPoseRemoveConnection(sch);
+        delayPoolReleaseConnection(sch);
+    }
+    else if (newStatus == STATUS_CONNECTION_ESTABLISHED) {
+        PROFILE_SCOPE(PROFILE_CONNECT_CLIENTS);
+        anyID myID;
+        uint64 myChannel;
+        if (ts3Functions.getClientID(sch, &myID) == ERROR_ok) {
+            if (ts3Functions.getChannelOfClient(sch, myID, &myChannel) != ERROR_ok) myChannel = 0;
+            clientTableSetSelf(sch, myID, myChannel);
+        }
+        trackConnectionClients(sch);
+        if (sch == ts3Functions.getCurrentServerConnectionHandlerID()) selectBroadcastConnection(sch);
+    }
+
     if (newStatus == STATUS_CONNECTION_ESTABLISHED) {
         char* s;
         char  msg[1024];
@@ -296,22 +687,26 @@ void ts3plugin_onConnectStatusChangeEvent(uint64 sch, int newStatus, unsigned in
         logInfo(msg, sch);
         ts3Functions.freeMemory(s);
 
-        if (ts3Functions.getChannelList(sch, &ids) != ERROR_ok) {
-            ts3Functions.logMessage("Error getting channel list", LogLevel_ERROR, "Plugin", sch);
-            return;
-        }
-        logInfo("PLUGIN: Available channels:", sch);
-        for (i = 0; ids[i]; i++) {
-            if (ts3Functions.getChannelVariableAsString(sch, ids[i], CHANNEL_NAME, &s) != ERROR_ok) {
-                ts3Functions.logMessage("Error querying channel name", LogLevel_ERROR, "Plugin", sch);
-                ts3Functions.freeMemory(ids);
+        /* One string query per channel: the part that grows with the server. */
+        {
+            PROFILE_SCOPE(PROFILE_CONNECT_CHANNELS);
+            if (ts3Functions.getChannelList(sch, &ids) != ERROR_ok) {
+                ts3Functions.logMessage("Error getting channel list", LogLevel_ERROR, "Plugin", sch);
                 return;
             }
-            snprintf(msg, sizeof(msg), "PLUGIN: Channel ID = %llu, name = %s", (unsigned long long)ids[i], s);
-            logInfo(msg, sch);
-            ts3Functions.freeMemory(s);
+            logInfo("PLUGIN: Available channels:", sch);
+            for (i = 0; ids[i]; i++) {
+                if (ts3Functions.getChannelVariableAsString(sch, ids[i], CHANNEL_NAME, &s) != ERROR_ok) {
+                    ts3Functions.logMessage("Error querying channel name", LogLevel_ERROR, "Plugin", sch);
+                    ts3Functions.freeMemory(ids);
+                    return;
+                }
+                snprintf(msg, sizeof(msg), "PLUGIN: Channel ID = %llu, name = %s", (unsigned long long)ids[i], s);
+                logInfo(msg, sch);
+                ts3Functions.freeMemory(s);
+            }
+            ts3Functions.freeMemory(ids);
         }
-        ts3Functions.freeMemory(ids);
 
         if (ts3Functions.getServerConnectionHandlerList(&ids) != ERROR_ok) {
             ts3Functions.logMessage("Error getting server list", LogLevel_ERROR, "Plugin", sch);
@@ -335,10 +730,8 @@ void ts3plugin_onConnectStatusChangeEvent(uint64 sch, int newStatus, unsigned in
 
 int ts3plugin_onServerErrorEvent(uint64 sch, const char* errorMessage, unsigned int error, const char* returnCode, const char* extraMessage)
 {
-    char buf[512];
-    snprintf(buf, sizeof(buf), "PLUGIN: onServerErrorEvent %llu %s %u %s",
-        (unsigned long long)sch, errorMessage ? errorMessage : "", error, returnCode ? returnCode : "");
-    logWarn(buf, sch);
+    PROFILE_SCOPE(PROFILE_SERVER_ERROR);
+    logRecord(LogLevel_WARNING, sch, "PLUGIN: onServerErrorEvent %llu %s %u %s", sch, errorMessage, error, returnCode);
     if (returnCode) {
         return 1; /* tell client we handled it (same as your original) */
     }
@@ -347,6 +740,7 @@ int ts3plugin_onServerErrorEvent(uint64 sch, const char* errorMessage, unsigned
 
 int ts3plugin_onTextMessageEvent(uint64 sch, anyID targetMode, anyID toID, anyID fromID, const char* fromName, const char* fromUID, const char* message, int ffIgnored)
 {
+    PROFILE_SCOPE(PROFILE_TEXT_MESSAGE);
     if (ffIgnored) return 0;
     char buf[512];
     snprintf(buf, sizeof(buf), "PLUGIN: onTextMessageEvent %llu %d %d %s %s %d",
@@ -357,12 +751,187 @@ int ts3plugin_onTextMessageEvent(uint64 sch, anyID targetMode, anyID toID, anyID
 
 void ts3plugin_onTalkStatusChangeEvent(uint64 sch, int status, int isReceivedWhisper, anyID clientID)
 {
-    char name[512];
-    if (ts3Functions.getClientDisplayName(sch, clientID, name, 512) == ERROR_ok) {
-        char buf[600];
-        snprintf(buf, sizeof(buf), "--> %s %s talking", name, (status == STATUS_TALKING) ? "starts" : "stops");
-        logInfo(buf, sch);
+    PROFILE_SCOPE(PROFILE_TALK_STATUS);
+    ClientState* c = trackClient(sch, clientID);
+    if (!c) return;
+    c->talking = status == STATUS_TALKING;
+    c->whisper = isReceivedWhisper != 0;
+    radioTalkStatus(clientTableFind(sch, clientID), c->talking);
+    if (!c->nickname[0]) refreshNickname(sch, c);
+
+    logRecord(LogLevel_INFO, sch, "--> %s %s talking", c->nickname, c->talking ? "starts" : "stops");
+}
+
+/* Nickname changes (and other client variables) */
+void ts3plugin_onUpdateClientEvent(uint64 sch, anyID clientID, anyID invokerID, const char* invokerName, const char* invokerUniqueIdentifier)
+{
+    PROFILE_SCOPE(PROFILE_UPDATE_CLIENT);
+    ClientState* c = clientTableAt(clientTableFind(sch, clientID));
+    if (c) refreshNickname(sch, c);
+}
+
+void ts3plugin_onClientMoveEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* moveMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_MOVE);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientMoveSubscriptionEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_MOVE_SUBSCRIPTION);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientMoveTimeoutEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, const char* timeoutMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_MOVE_TIMEOUT);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientMoveMovedEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID moverID, const char* moverName, const char* moverUniqueIdentifier,
+    const char* moveMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_MOVE_MOVED);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientKickFromChannelEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID kickerID, const char* kickerName, const char* kickerUniqueIdentifier,
+    const char* kickMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_KICK_CHANNEL);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientKickFromServerEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID kickerID, const char* kickerName, const char* kickerUniqueIdentifier,
+    const char* kickMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_KICK_SERVER);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+void ts3plugin_onClientBanFromServerEvent(uint64 sch, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID kickerID, const char* kickerName, const char* kickerUniqueIdentifier, uint64 time,
+    const char* kickMessage)
+{
+    PROFILE_SCOPE(PROFILE_CLIENT_BAN);
+    clientMoved(sch, clientID, newChannelID, visibility);
+}
+
+/* Peer positions; called on the client event thread for every message, so nothing here allocates. */
+void ts3plugin_onPluginCommandEvent(uint64 sch, const char* pluginName, const char* pluginCommand, anyID invokerClientID, const char* invokerName, const char* invokerUniqueIdentity)
+{
+    PROFILE_SCOPE(PROFILE_PLUGIN_COMMAND);
+    if (!pluginCommand) return;
+
+    /* Our own broadcasts come back to us through the channel. */
+    anyID myID;
+    uint64 myChannel;
+    if (selfOn(sch, &myID, &myChannel) && invokerClientID == myID) return;
+
+    int slot;
+    if (peersReceive(sch, invokerClientID, pluginCommand, monoNowUs(), &slot) == PEER_WIRE_OK) {
+        /* OCR misreads stop here; wire.pose stays as decoded, deltas are relative to the keyframe anyway. */
+        const uint64_t key = clientTableKey(sch, invokerClientID);
+        Pose pose = clientTableAt(slot)->wire.pose;
+        if (!poseFilterApply(slot, key, &pose)) return;
+        trajectoryPush(slot, key, pose);
+        peerPosePublish(slot, sch, invokerClientID, pose);
+        const double pos[3] = { pose.x, pose.y, pose.z };
+        spatialHashUpdate(&peerSpace, slot, pose.zoneId, pos);
+    }
+}
+
+/* Audio thread, per client and block: table lookup only. */
+void ts3plugin_onCustom3dRolloffCalculationClientEvent(uint64 sch, anyID clientID, float distance, float* volume)
+{
+    PROFILE_SCOPE(PROFILE_ROLLOFF);
+    int zoneClass = listenerZoneClass.load(std::memory_order_relaxed);
+    const int slot = clientTableFind(sch, clientID);
+    /* Radio talkers arrive at full level; the radio chain sets their loudness. */
+    if (radioActive(slot, clientTableKey(sch, clientID))) {
+        *volume = 1.0f;
+        return;
     }
+    const ClientState* c = clientTableAt(slot);
+    if (c && c->zoneClass.load(std::memory_order_relaxed) != ZONE_CLASS_UNKNOWN) zoneClass = c->zoneClass.load(std::memory_order_relaxed);
+    *volume = rolloffGain(zoneClass, distance);
+}
+
+void ts3plugin_onCustom3dRolloffCalculationWaveEvent(uint64 sch, uint64 waveHandle, float distance, float* volume)
+{
+    PROFILE_SCOPE(PROFILE_ROLLOFF_WAVE);
+    *volume = rolloffGain(listenerZoneClass.load(std::memory_order_relaxed), distance);
 }
 
 /* Keep your remaining callbacks as-is or empty stubs */
+
+/*
+ * Playback thread, per talking client and ~10 ms block: the peer's position comes from its
+ * trajectory (interpolated between sparse poses), our own ILD/ITD, Doppler and occlusion
+ * replace TeamSpeak's panning, and the client's reverb send is set; crew out of earshot go
+ * through the radio chain instead. The voice is normally parked on the voice bus and rendered with
+ * everyone else's in the mixed callback; if it cannot be, it is panned in place without occlusion.
+ */
+void ts3plugin_onEditPostProcessVoiceDataEvent(uint64 sch, anyID clientID, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    PROFILE_SCOPE(PROFILE_POST_PROCESS);
+    if (!listenerValid) return;
+    const int slot = clientTableFind(sch, clientID);
+    PeerPoseSnap peer;
+    if (slot < 0 || !peerPoseRead(slot, &peer) || !peer.live || peer.sch != sch || peer.clientID != clientID) return;
+
+    const uint64_t key = clientTableKey(sch, clientID);
+    const uint64_t nowUs = monoNowUs();
+    if (peer.pose.receiveUs != peerAudioPoseUs[slot]) {
+        if (peer.pose.receiveUs >= peerAudioBlockUs[slot] && nowUs - peerAudioBlockUs[slot] < PEER_AUDIO_GAP_US) {
+            latencyStamp(LATENCY_PEER_AUDIO, peer.pose.receiveUs, nowUs);
+        }
+        peerAudioPoseUs[slot] = peer.pose.receiveUs;
+    }
+    peerAudioBlockUs[slot] = nowUs;
+    Pose source = peer.pose;
+    trajectoryEval(slot, key, nowUs, &source);
+    VoiceParams vp;
+    vp.radio = radioSelect(sch, slot, key, listenerPose, source);
+    if (vp.radio) {
+        if (!voiceBusCapture(sch, slot, key, vp, samples, sampleCount, channels, channelSpeakerArray, channelFillMask)) {
+            radioRender(slot, key, samples, sampleCount, channels, channelFillMask);
+        }
+        return;
+    }
+    pannerGeometry(listenerPose, source, &vp.pan);
+    vp.pan.commonDelay = dopplerAdvance(slot, key, listenerPose, source, sampleCount);
+    occlusionParams(listenerPose, source, &vp.occ);
+    vp.reverbLevel = reverbSendLevel(listenerPose, source);
+    if (!voiceBusCapture(sch, slot, key, vp, samples, sampleCount, channels, channelSpeakerArray, channelFillMask)) {
+        pannerRender(slot, key, vp.pan, samples, sampleCount, channels, channelSpeakerArray, channelFillMask);
+    }
+}
+
+/*
+ * Runs on the playback thread for every mixed block (~10 ms); only pops pre-validated poses.
+ * The block goes through the master bus: our voices are added unsaturated, then limited.
+ */
+void ts3plugin_onEditMixedPlaybackVoiceDataEvent(uint64 sch, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    PROFILE_SCOPE(PROFILE_MIXED_PLAYBACK);
+    if (ingestDrain(&listenerPose)) {
+        listenerValid = true;
+        latencyStamp(LATENCY_LOCAL_AUDIO, listenerPose.captureUs, monoNowUs());
+    }
+    if (listenerValid) reverbSetZoneClass(listenerPose.zoneClass);
+    const bool master = masterBegin(sch, samples, sampleCount, channels, channelSpeakerArray, channelFillMask);
+    voiceBusMix(sch, master ? masterPlanes() : NULL, sampleCount, channels, channelSpeakerArray, channelFillMask);
+    if (master) masterEnd(sch, samples, sampleCount, channels, channelSpeakerArray, channelFillMask);
+
+    const uint64_t nowUs = monoNowUs();
+    delayPoolAudioTick(nowUs);
+    if (nowUs >= masterCostLogUs) {
+        if (masterCostLogUs) {
+            MasterCost mc;
+            masterTakeCost(&mc);
+            logRecord(LogLevel_INFO, 0, "master: %llu blocks, %.1f us avg, %.1f us max per block",
+                mc.blocks, mc.avgUs, mc.maxUs);
+        }
+        masterCostLogUs = nowUs + MASTER_COST_LOG_US;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+ * In-plugin pose representation, independent of where it came from
+ * (shared-memory channel, peer plugin command, ...).
+ */
+
+#include <cstdint>
+
+enum PoseFlags {
+    POSE_HAS_VELOCITY = 0x01,
+    POSE_HAS_HEADING  = 0x02,
+    POSE_KEYFRAME     = 0x04,
+};
+
+struct Pose {
+    uint32_t zoneId;     /* zoneIdFromName(), ZONE_ID_NONE if unknown */
+    uint8_t  zoneClass;  /* ZoneClass */
+    uint8_t  flags;      /* PoseFlags */
+    uint64_t sequence;   /* producer's pose number */
+    uint64_t captureUs;  /* monoNowUs() when the HUD frame was grabbed */
+    uint64_t receiveUs;  /* monoNowUs() when the plugin picked it up */
+    double   x, y, z;    /* metres, zone-relative */
+    float    vx, vy, vz; /* m/s, valid with POSE_HAS_VELOCITY */
+    float    heading;    /* radians clockwise from +y, valid with POSE_HAS_HEADING */
+};
@@ -0,0 +1,125 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "pose_channel.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Bounded so the read stays wait-free even if the helper is mid-write. */
+#define POSE_READ_RETRIES 4
+
+#ifdef _WIN32
+static HANDLE mapping = NULL;
+static HANDLE readyEvent = NULL;
+#endif
+static const unsigned char* view = NULL;
+
+static const SharedPoseHeader* header() { return (const SharedPoseHeader*)view; }
+
+bool poseChannelOpen()
+{
+    if (view) return true;
+
+#ifdef _WIN32
+    /* CreateFileMapping opens the existing section when the helper got there first. */
+    mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, POSE_CHANNEL_SIZE, POSE_CHANNEL_NAME);
+    if (!mapping) return false;
+    view = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, POSE_CHANNEL_SIZE);
+    if (!view) {
+        CloseHandle(mapping);
+        mapping = NULL;
+        return false;
+    }
+    /* Optional: without it we fall back to polling. */
+    readyEvent = CreateEventW(NULL, FALSE, FALSE, POSE_READY_EVENT_NAME);
+#else
+    int fd = shm_open(POSE_CHANNEL_NAME, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size < POSE_CHANNEL_SIZE && ftruncate(fd, POSE_CHANNEL_SIZE) != 0)) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(NULL, POSE_CHANNEL_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    view = (const unsigned char*)p;
+#endif
+    return true;
+}
+
+void poseChannelClose()
+{
+    if (!view) return;
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    mapping = NULL;
+    if (readyEvent) {
+        CloseHandle(readyEvent);
+        readyEvent = NULL;
+    }
+#else
+    munmap((void*)view, POSE_CHANNEL_SIZE);
+#endif
+    view = NULL;
+}
+
+bool poseChannelAttached()
+{
+    if (!view) return false;
+    const SharedPoseHeader* h = header();
+    return h->magic == POSE_CHANNEL_MAGIC
+        && h->version == POSE_CHANNEL_VERSION
+        && h->slotOffset >= sizeof(SharedPoseHeader)
+        && h->slotSize == sizeof(SharedPoseSlot)
+        && h->slotOffset + h->slotSize <= POSE_CHANNEL_SIZE;
+}
+
+bool poseChannelRead(SharedPose* out)
+{
+    if (!poseChannelAttached()) return false;
+
+    const SharedPoseSlot* slot = (const SharedPoseSlot*)(view + header()->slotOffset);
+    for (int i = 0; i < POSE_READ_RETRIES; i++) {
+        uint32_t s1 = slot->seq.load(std::memory_order_acquire);
+        if (s1 & 1u) continue;
+        if (s1 == 0) return false; /* nothing published yet */
+
+        out->zoneId = slot->zoneId;
+        out->sequence = slot->sequence;
+        out->captureUs = slot->captureUs;
+        out->x = slot->x;
+        out->y = slot->y;
+        out->z = slot->z;
+        memcpy(out->zone, slot->zone, POSE_ZONE_LEN);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) == s1) {
+            out->zone[POSE_ZONE_LEN - 1] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+void poseChannelWait(unsigned timeoutMs)
+{
+#ifdef _WIN32
+    if (readyEvent) {
+        WaitForSingleObject(readyEvent, timeoutMs);
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs < 1 ? timeoutMs : 1));
+}
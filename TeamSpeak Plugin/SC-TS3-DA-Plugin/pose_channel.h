@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * Shared-memory pose channel: SCTS3DA.exe -> plugin.
+ *
+ * A fixed 4 KiB region holding a versioned header followed by one
+ * seqlock-protected pose slot. The helper is the only writer; the plugin maps
+ * the region read-only and takes wait-free snapshots, so reading the latest
+ * pose costs a handful of loads and no syscalls.
+ *
+ * Layout (little-endian, must match PoseChannel.cs):
+ *
+ *   0   SharedPoseHeader   64 bytes
+ *   64  SharedPoseSlot    128 bytes
+ *
+ * Seqlock protocol: the writer bumps `seq` to an odd value, writes the
+ * payload, then bumps it to the next even value. A reader that sees the same
+ * even `seq` before and after copying the payload has a consistent pose.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#define POSE_CHANNEL_MAGIC    0x41444353u /* "SCDA" */
+#define POSE_CHANNEL_VERSION  1
+#define POSE_CHANNEL_SIZE     4096
+#define POSE_ZONE_LEN         48
+
+#ifdef _WIN32
+#define POSE_CHANNEL_NAME     L"Local\\SCTS3DA.Pose"
+#define POSE_READY_EVENT_NAME L"Local\\SCTS3DA.PoseReady" /* auto-reset, set after each publish */
+#else
+#define POSE_CHANNEL_NAME     "/scts3da.pose"  /* -> /dev/shm/scts3da.pose */
+#endif
+
+struct SharedPoseHeader {
+    uint32_t magic;       /* POSE_CHANNEL_MAGIC once the writer has initialised */
+    uint16_t version;     /* POSE_CHANNEL_VERSION */
+    uint16_t headerSize;  /* sizeof(SharedPoseHeader) */
+    uint32_t slotOffset;  /* byte offset of SharedPoseSlot */
+    uint32_t slotSize;    /* sizeof(SharedPoseSlot) */
+    uint32_t writerPid;   /* helper process id, informational */
+    uint32_t reserved[11];
+};
+
+struct SharedPoseSlot {
+    std::atomic<uint32_t> seq;  /* seqlock counter, odd while the writer is mid-update */
+    uint32_t zoneId;            /* zoneIdFromName(zone) */
+    uint64_t sequence;          /* pose number, +1 per publish */
+    uint64_t captureUs;         /* monoNowUs() domain, taken when the HUD frame was grabbed */
+    double   x, y, z;           /* metres, zone-relative as shown on the HUD */
+    char     zone[POSE_ZONE_LEN]; /* UTF-8, NUL-terminated */
+    uint8_t  reserved[32];
+};
+
+static_assert(sizeof(SharedPoseHeader) == 64, "SharedPoseHeader layout is shared with SCTS3DA.exe");
+static_assert(sizeof(SharedPoseSlot) == 128, "SharedPoseSlot layout is shared with SCTS3DA.exe");
+static_assert(offsetof(SharedPoseSlot, x) == 24, "SharedPoseSlot layout is shared with SCTS3DA.exe");
+static_assert(offsetof(SharedPoseSlot, zone) == 48, "SharedPoseSlot layout is shared with SCTS3DA.exe");
+
+/* A consistent copy of the slot payload. */
+struct SharedPose {
+    uint32_t zoneId;
+    uint64_t sequence;
+    uint64_t captureUs;
+    double   x, y, z;
+    char     zone[POSE_ZONE_LEN];
+};
+
+/* Create-or-open the region. Safe to call before the helper is running. */
+bool poseChannelOpen();
+void poseChannelClose();
+
+/* True once the helper has written a valid header. */
+bool poseChannelAttached();
+
+/*
+ * Wait-free snapshot of the latest pose. Returns false if the helper is not
+ * attached, has not published yet, or kept the slot busy for every retry
+ * (the caller simply keeps its previous pose in that case).
+ */
+bool poseChannelRead(SharedPose* out);
+
+/*
+ * Block until the helper signals a publish or timeoutMs elapses. On platforms
+ * without the ready event this degrades to a short sleep (1 ms polling).
+ */
+void poseChannelWait(unsigned timeoutMs);
@@ -0,0 +1,198 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "pose_filter.h"
+
+#include <atomic>
+
+#include "zones.h"
+
+#define POSE_FILTER_DEFAULT_GATE    4.0f   /* ~99.9% of genuine poses pass with three axes */
+#define POSE_FILTER_DEFAULT_REJECTS 3
+
+/* Indexed by ZoneClass: how hard things accelerate there and how precisely the HUD shows it. */
+struct FilterNoise {
+    float accel;    /* white-noise acceleration, m/s^2 */
+    float vel;      /* velocity uncertainty at start, m/s */
+    float meas;     /* position reading, m */
+    float speed;    /* fastest plausible movement between two rejected readings, m/s */
+};
+
+static const FilterNoise noise[ZONE_CLASS_COUNT] = {
+    /* accel  vel     meas  speed */
+    { 8.0f,   30.0f,  1.0f, 300.0f },   /* unknown */
+    { 2.0f,   3.0f,   0.2f, 10.0f },    /* ship interior: on foot */
+    { 3.0f,   5.0f,   0.3f, 30.0f },    /* hangar */
+    { 2.0f,   3.0f,   0.3f, 10.0f },    /* station */
+    { 5.0f,   30.0f,  1.0f, 150.0f },   /* planet: on foot or driving, km readout */
+    { 30.0f,  300.0f, 1.0f, 1500.0f },  /* space: flying */
+};
+
+/* One axis: position, velocity and their covariance [pp pv; pv vv]. */
+struct AxisFilter {
+    double p;
+    double v;
+    double pp, pv, vv;
+};
+
+struct PoseFilterState {
+    uint64_t   key;
+    bool       live;
+    uint32_t   zoneId;
+    uint64_t   tUs;         /* captureUs of the last accepted pose */
+    int        rejects;     /* in a row, each consistent with the one before */
+    double     cand[3];     /* last rejected reading */
+    uint64_t   candUs;
+    AxisFilter axis[3];
+};
+
+static PoseFilterState states[CLIENT_TABLE_CAPACITY];
+
+static std::atomic<bool>  cfgEnabled(true);
+static std::atomic<float> cfgGateSigma(POSE_FILTER_DEFAULT_GATE);
+static std::atomic<int>   cfgMaxRejects(POSE_FILTER_DEFAULT_REJECTS);
+
+static std::atomic<uint64_t> statUpdates(0);
+static std::atomic<uint64_t> statRejected(0);
+static std::atomic<uint64_t> statResets(0);
+
+void poseFilterDefaults(PoseFilterConfig* out)
+{
+    out->enabled = true;
+    out->gateSigma = POSE_FILTER_DEFAULT_GATE;
+    out->maxRejects = POSE_FILTER_DEFAULT_REJECTS;
+}
+
+void poseFilterConfigure(const PoseFilterConfig& cfg)
+{
+    cfgEnabled.store(cfg.enabled, std::memory_order_relaxed);
+    cfgGateSigma.store(cfg.gateSigma > 1.0f ? cfg.gateSigma : 1.0f, std::memory_order_relaxed);
+    cfgMaxRejects.store(cfg.maxRejects > 0 ? cfg.maxRejects : 1, std::memory_order_relaxed);
+}
+
+void poseFilterGetConfig(PoseFilterConfig* out)
+{
+    out->enabled = cfgEnabled.load(std::memory_order_relaxed);
+    out->gateSigma = cfgGateSigma.load(std::memory_order_relaxed);
+    out->maxRejects = cfgMaxRejects.load(std::memory_order_relaxed);
+}
+
+static const FilterNoise& noiseFor(int zoneClass)
+{
+    return noise[(unsigned)zoneClass < ZONE_CLASS_COUNT ? zoneClass : ZONE_CLASS_UNKNOWN];
+}
+
+static void start(PoseFilterState* st, uint64_t key, const Pose& pose)
+{
+    const FilterNoise& n = noiseFor(pose.zoneClass);
+    const double pos[3] = { pose.x, pose.y, pose.z };
+    const float vel[3] = { pose.vx, pose.vy, pose.vz };
+    const bool haveVel = (pose.flags & POSE_HAS_VELOCITY) != 0;
+    st->key = key;
+    st->live = true;
+    st->zoneId = pose.zoneId;
+    st->tUs = pose.captureUs;
+    st->rejects = 0;
+    for (int a = 0; a < 3; a++) {
+        AxisFilter& f = st->axis[a];
+        f.p = pos[a];
+        f.v = haveVel ? vel[a] : 0.0;
+        f.pp = (double)n.meas * n.meas;
+        f.pv = 0.0;
+        f.vv = (double)n.vel * n.vel;
+    }
+    statResets.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void writeBack(const PoseFilterState& st, Pose* pose)
+{
+    pose->x = st.axis[0].p;
+    pose->y = st.axis[1].p;
+    pose->z = st.axis[2].p;
+    pose->vx = (float)st.axis[0].v;
+    pose->vy = (float)st.axis[1].v;
+    pose->vz = (float)st.axis[2].v;
+    pose->flags |= POSE_HAS_VELOCITY;
+}
+
+bool poseFilterApply(int slot, uint64_t key, Pose* pose)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY || !cfgEnabled.load(std::memory_order_relaxed)) return true;
+    PoseFilterState& st = states[slot];
+    statUpdates.fetch_add(1, std::memory_order_relaxed);
+    if (!st.live || st.key != key || st.zoneId != pose->zoneId
+        || pose->captureUs < st.tUs || pose->captureUs - st.tUs > POSE_FILTER_STALE_US) {
+        start(&st, key, *pose);
+        writeBack(st, pose);
+        return true;
+    }
+    if (pose->captureUs == st.tUs) {
+        writeBack(st, pose);
+        return true;
+    }
+
+    /* Predict every axis to the new capture time. */
+    const FilterNoise& n = noiseFor(pose->zoneClass);
+    const double dt = (double)(pose->captureUs - st.tUs) * 1e-6;
+    const double q = (double)n.accel * n.accel;
+    const double r = (double)n.meas * n.meas;
+    const double z[3] = { pose->x, pose->y, pose->z };
+    AxisFilter pred[3];
+    double y[3], s[3], d2 = 0.0;
+    for (int a = 0; a < 3; a++) {
+        const AxisFilter& f = st.axis[a];
+        AxisFilter& g = pred[a];
+        g.p = f.p + f.v * dt;
+        g.v = f.v;
+        g.pp = f.pp + 2.0 * f.pv * dt + f.vv * dt * dt + q * dt * dt * dt / 3.0;
+        g.pv = f.pv + f.vv * dt + q * dt * dt / 2.0;
+        g.vv = f.vv + q * dt;
+        y[a] = z[a] - g.p;
+        s[a] = g.pp + r;
+        d2 += y[a] * y[a] / s[a];
+    }
+
+    /*
+     * Gate: a misread digit lands metres to kilometres off the prediction. Rejected readings
+     * that agree with each other are a real move the filter missed; random misreads never do.
+     */
+    const double gate = cfgGateSigma.load(std::memory_order_relaxed);
+    if (d2 > gate * gate) {
+        statRejected.fetch_add(1, std::memory_order_relaxed);
+        bool consistent = false;
+        if (st.rejects > 0) {
+            const double reach = n.speed * (double)(pose->captureUs - st.candUs) * 1e-6 + 4.0 * n.meas;
+            double e2 = 0.0;
+            for (int a = 0; a < 3; a++) e2 += (z[a] - st.cand[a]) * (z[a] - st.cand[a]);
+            consistent = e2 <= reach * reach;
+        }
+        st.rejects = consistent ? st.rejects + 1 : 1;
+        for (int a = 0; a < 3; a++) st.cand[a] = z[a];
+        st.candUs = pose->captureUs;
+        if (st.rejects < cfgMaxRejects.load(std::memory_order_relaxed)) return false;
+        start(&st, key, *pose);
+        writeBack(st, pose);
+        return true;
+    }
+
+    for (int a = 0; a < 3; a++) {
+        const AxisFilter& g = pred[a];
+        AxisFilter& f = st.axis[a];
+        const double kp = g.pp / s[a], kv = g.pv / s[a];
+        f.p = g.p + kp * y[a];
+        f.v = g.v + kv * y[a];
+        f.pp = (1.0 - kp) * g.pp;
+        f.pv = (1.0 - kp) * g.pv;
+        f.vv = g.vv - kv * g.pv;
+    }
+    st.tUs = pose->captureUs;
+    st.rejects = 0;
+    writeBack(st, pose);
+    return true;
+}
+
+void poseFilterGetStats(PoseFilterStats* out)
+{
+    out->updates = statUpdates.load(std::memory_order_relaxed);
+    out->rejected = statRejected.load(std::memory_order_relaxed);
+    out->resets = statResets.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Denoising of peer positions read off the HUD by OCR. Each peer has a
+ * constant-velocity Kalman filter per axis (position, velocity; 2x2
+ * covariance), fixed-size and indexed by client table slot, run on every
+ * received pose before it reaches the trajectory and the spatial stages.
+ *
+ * Process and measurement noise depend on the zone class: people walk in
+ * ship interiors (small accelerations, HUD in metres with millimetres),
+ * ships and vehicles fly in space or over planets (large ones, HUD in km
+ * with a metre's resolution).
+ *
+ * A pose whose innovation is further than `gateSigma` standard deviations
+ * from the prediction (Mahalanobis, all three axes) is a misread and is
+ * dropped; after `maxRejects` in a row the filter believes the peer really
+ * did move (quantum travel, respawn) and restarts from the measurement. A
+ * zone change or a long silence restarts it too.
+ *
+ * The filter's velocity replaces the sender's (which is differentiated from
+ * the same noisy positions).
+ *
+ * Client event thread only, apart from the stats/config accessors.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+#define POSE_FILTER_STALE_US 2500000ull  /* silence after which the filter restarts */
+
+struct PoseFilterConfig {
+    bool  enabled;
+    float gateSigma;        /* innovation gate, standard deviations */
+    int   maxRejects;       /* consecutive rejections before restarting at the measurement */
+};
+
+struct PoseFilterStats {
+    uint64_t updates;       /* poses filtered */
+    uint64_t rejected;      /* ...dropped by the gate */
+    uint64_t resets;        /* filter (re)started: new peer, zone change, silence, rejects */
+};
+
+void poseFilterDefaults(PoseFilterConfig* out);
+void poseFilterConfigure(const PoseFilterConfig& cfg);
+void poseFilterGetConfig(PoseFilterConfig* out);
+
+/*
+ * Filter `pose` (the peer's newest) in place. False if the gate rejected it;
+ * the caller drops the pose then. Passes poses through untouched while the
+ * filter is disabled.
+ */
+bool poseFilterApply(int slot, uint64_t key, Pose* pose);
+
+void poseFilterGetStats(PoseFilterStats* out);
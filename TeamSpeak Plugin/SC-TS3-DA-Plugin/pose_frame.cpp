@@ -0,0 +1,119 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "pose_frame.h"
+
+#include <cmath>
+
+#define POSE_MAX_SHIFT   40
+#define POSE_Q_MAX       2147483647.0
+#define POSE_VEL_SCALE   10.0f                      /* dm/s */
+#define POSE_HEADING_Q   (65536.0f / 6.28318530718f)
+
+/* ---- little-endian byte access (host-order independent) ---- */
+
+static void put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t* p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+static void put64(uint8_t* p, uint64_t v) { put32(p, (uint32_t)v); put32(p + 4, (uint32_t)(v >> 32)); }
+static uint16_t get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t* p) { return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16); }
+static uint64_t get64(const uint8_t* p) { return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32); }
+
+int16_t poseQuantVelocity(float v)
+{
+    float q = v * POSE_VEL_SCALE;
+    if (!(q > -32767.0f)) return -32767; /* also catches NaN */
+    if (q > 32767.0f) return 32767;
+    return (int16_t)lrintf(q);
+}
+
+int poseShiftFor(double x, double y, double z)
+{
+    double m = std::fabs(x);
+    if (std::fabs(y) > m) m = std::fabs(y);
+    if (std::fabs(z) > m) m = std::fabs(z);
+    if (!(m * 100.0 >= POSE_Q_MAX)) return 0; /* the common case, also NaN */
+
+    /* cm = f * 2^e with f in [0.5, 1): cm >> (e - 31) fits in 31 bits */
+    int e;
+    std::frexp(m * 100.0, &e);
+    int shift = e - 31;
+    return shift > POSE_MAX_SHIFT ? POSE_MAX_SHIFT : shift;
+}
+
+/* Metres -> quantisation steps for a given shift; one ldexp per frame, not per axis. */
+static double quantScale(int shift) { return shift ? std::ldexp(100.0, -shift) : 100.0; }
+
+static int32_t quantiseScaled(double metres, double scale)
+{
+    double q = metres * scale;
+    if (!(q > -POSE_Q_MAX)) return -2147483647;
+    if (q > POSE_Q_MAX) return 2147483647;
+    return (int32_t)llrint(q);
+}
+
+int32_t poseQuantise(double metres, int shift)
+{
+    return quantiseScaled(metres, quantScale(shift));
+}
+
+double poseDequantise(int32_t q, int shift)
+{
+    return (double)q / quantScale(shift);
+}
+
+float poseDequantVelocity(int16_t q) { return (float)q / POSE_VEL_SCALE; }
+
+uint16_t poseQuantHeading(float radians) { return (uint16_t)(int32_t)lrintf(radians * POSE_HEADING_Q); }
+
+float poseDequantHeading(uint16_t q) { return (float)q / POSE_HEADING_Q; }
+
+void poseFrameEncode(const Pose& pose, uint8_t out[POSE_FRAME_SIZE])
+{
+    const int shift = poseShiftFor(pose.x, pose.y, pose.z);
+    const double scale = quantScale(shift);
+
+    out[0] = POSE_FRAME_VERSION;
+    out[1] = pose.flags;
+    out[2] = pose.zoneClass;
+    out[3] = (uint8_t)shift;
+    put32(out + 4, pose.zoneId);
+    put32(out + 8, (uint32_t)pose.sequence);
+    put32(out + 12, (uint32_t)quantiseScaled(pose.x, scale));
+    put32(out + 16, (uint32_t)quantiseScaled(pose.y, scale));
+    put32(out + 20, (uint32_t)quantiseScaled(pose.z, scale));
+
+    if (pose.flags & POSE_HAS_VELOCITY) {
+        put16(out + 24, (uint16_t)poseQuantVelocity(pose.vx));
+        put16(out + 26, (uint16_t)poseQuantVelocity(pose.vy));
+        put16(out + 28, (uint16_t)poseQuantVelocity(pose.vz));
+    }
+    else {
+        put16(out + 24, 0);
+        put16(out + 26, 0);
+        put16(out + 28, 0);
+    }
+
+    put16(out + 30, (pose.flags & POSE_HAS_HEADING) ? poseQuantHeading(pose.heading) : 0);
+
+    put64(out + 32, pose.captureUs);
+}
+
+bool poseFrameDecode(const uint8_t* in, size_t len, Pose* out)
+{
+    if (len < POSE_FRAME_SIZE || in[0] != POSE_FRAME_VERSION || in[3] > POSE_MAX_SHIFT) return false;
+
+    const double step = 1.0 / quantScale(in[3]);
+    out->flags = in[1];
+    out->zoneClass = in[2];
+    out->zoneId = get32(in + 4);
+    out->sequence = get32(in + 8);
+    out->x = (int32_t)get32(in + 12) * step;
+    out->y = (int32_t)get32(in + 16) * step;
+    out->z = (int32_t)get32(in + 20) * step;
+    out->vx = poseDequantVelocity((int16_t)get16(in + 24));
+    out->vy = poseDequantVelocity((int16_t)get16(in + 26));
+    out->vz = poseDequantVelocity((int16_t)get16(in + 28));
+    out->heading = poseDequantHeading(get16(in + 30));
+    out->captureUs = get64(in + 32);
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Compact binary pose frame: the one wire format every transport reuses
+ * (shared memory, peer plugin commands, recordings).
+ *
+ * Fixed 40 bytes, little-endian regardless of host:
+ *
+ *   off  type  field
+ *   0    u8    version     POSE_FRAME_VERSION
+ *   1    u8    flags       PoseFlags
+ *   2    u8    zoneClass   ZoneClass
+ *   3    u8    posShift    position unit is (1 cm << posShift)
+ *   4    u32   zoneId      interned zone name
+ *   8    u32   sequence    low 32 bits of the producer's pose number
+ *   12   i32   x, y, z     quantised position
+ *   24   i16   vx, vy, vz  velocity in dm/s, saturating (POSE_HAS_VELOCITY)
+ *   30   u16   heading     2*pi/65536 rad per step (POSE_HAS_HEADING)
+ *   32   u64   captureUs
+ *
+ * posShift is the smallest shift that fits all three axes, so anything within
+ * +-21 km of the zone origin keeps centimetre precision and system-scale
+ * coordinates degrade gracefully instead of overflowing.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pose.h"
+
+#define POSE_FRAME_VERSION 1
+#define POSE_FRAME_SIZE    40
+
+/* Encode into exactly POSE_FRAME_SIZE bytes. Never allocates. */
+void poseFrameEncode(const Pose& pose, uint8_t out[POSE_FRAME_SIZE]);
+
+/*
+ * Decode a frame. Returns false on short input, unknown version or a
+ * nonsensical posShift. receiveUs is left untouched.
+ */
+bool poseFrameDecode(const uint8_t* in, size_t len, Pose* out);
+
+/* Quantisation helpers shared with the delta encodings. */
+int      poseShiftFor(double x, double y, double z);
+int32_t  poseQuantise(double metres, int shift);
+double   poseDequantise(int32_t q, int shift);
+int16_t  poseQuantVelocity(float mps);
+float    poseDequantVelocity(int16_t q);
+uint16_t poseQuantHeading(float radians);
+float    poseDequantHeading(uint16_t q);
@@ -0,0 +1,415 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "profile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+static const char* const names[PROFILE_PROBES] = {
+    "init",
+    "shutdown",
+    "registerPluginID",
+    "processCommand",
+    "currentServerConnectionChanged",
+    "infoData",
+    "onConnectStatusChangeEvent",
+    "onConnectStatusChangeEvent/clients",
+    "onConnectStatusChangeEvent/channels",
+    "onServerErrorEvent",
+    "onTextMessageEvent",
+    "onTalkStatusChangeEvent",
+    "onUpdateClientEvent",
+    "onClientMoveEvent",
+    "onClientMoveSubscriptionEvent",
+    "onClientMoveTimeoutEvent",
+    "onClientMoveMovedEvent",
+    "onClientKickFromChannelEvent",
+    "onClientKickFromServerEvent",
+    "onClientBanFromServerEvent",
+    "onPluginCommandEvent",
+    "onCustom3dRolloffCalculationClientEvent",
+    "onCustom3dRolloffCalculationWaveEvent",
+    "onEditPostProcessVoiceDataEvent",
+    "onEditMixedPlaybackVoiceDataEvent",
+};
+
+const char* profileName(ProfileProbe probe)
+{
+    return probe >= 0 && probe < PROFILE_PROBES ? names[probe] : "?";
+}
+
+#if SCDA_PROFILE
+
+static_assert((PROFILE_TRACE_RING & (PROFILE_TRACE_RING - 1)) == 0, "PROFILE_TRACE_RING must be a power of two");
+
+#define PROFILE_COLLECT_MS  10
+#define PROFILE_CALIBRATE_NS 1000000ull   /* shortest span the tick rate is measured over */
+#define PROFILE_SLOT_IDLE_SEC 10          /* a slot without probes this long is free again */
+
+static inline uint64_t nowNs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct ProfileEvent {
+    uint64_t start;
+    uint64_t ticks;
+    uint32_t probe;
+};
+
+/* Written only by the owning thread; relaxed atomics so readers may look at any time. */
+struct ProfileCounter {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> maxTicks;
+};
+
+struct alignas(SCDA_CACHELINE) ProfileThread {
+    std::atomic<uint32_t> owner;        /* odd while a thread owns the slot; bumped on every claim and reclaim */
+    std::atomic<uint64_t> heartbeat;    /* ticks at the owner's last probe */
+    std::atomic<uint32_t> epoch;        /* resetEpoch the counters belong to */
+    ProfileCounter        counters[PROFILE_PROBES];
+    SpscRing<ProfileEvent, PROFILE_TRACE_RING> trace;
+
+    ProfileThread() : owner(0), heartbeat(0), epoch(0) {}
+};
+
+static ProfileThread threads[PROFILE_THREADS];
+alignas(SCDA_CACHELINE) static std::atomic<int> slotsUsed(0);   /* high-water mark */
+static std::atomic<uint32_t> resetEpoch(0);
+static std::atomic<bool> tracing(false);
+static std::atomic<uint64_t> statLostThreads(0);
+static std::atomic<uint64_t> statTraceDropped(0);
+
+/*
+ * The calling thread's slot + 1 (0 unclaimed, -1 none was free) and the owner
+ * value it claimed it with. Plain ints: a thread_local with a destructor
+ * registers an exit handler at first use, which allocates on the audio thread.
+ * Slots of threads that have gone quiet are taken back by reclaimIdleSlots().
+ * On ELF the variables also sit in static TLS: in a dlopen()ed module the
+ * default model allocates the thread's TLS block at its first access.
+ */
+#if defined(__GNUC__) && !defined(_WIN32)
+#define PROFILE_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define PROFILE_TLS
+#endif
+static thread_local int threadSlot PROFILE_TLS;
+static thread_local uint32_t threadOwner PROFILE_TLS;
+
+/* Tick rate anchor, taken when the plugin is loaded. */
+struct TickAnchor {
+    uint64_t ticks;
+    uint64_t ns;
+    TickAnchor() : ticks(profileTicks()), ns(nowNs()) {}
+};
+static const TickAnchor anchor;
+
+/* Capture state: UI thread (start/stop) and the collector while it runs. */
+static std::thread collector;
+static std::atomic<bool> collecting(false);
+static std::vector<ProfileEvent> captured;
+static std::vector<uint16_t> capturedThread;
+static std::atomic<uint64_t> capturedCount(0);
+static uint64_t traceOriginTicks = 0;
+
+static ProfileThread* claimSlot(uint64_t now)
+{
+    const int slot = threadSlot;
+    if (slot > 0) {
+        ProfileThread* t = &threads[slot - 1];
+        if (t->owner.load(std::memory_order_relaxed) == threadOwner) return t;
+        /* Reclaimed while this thread was idle: take a slot again. */
+    }
+    else if (slot < 0) {
+        return nullptr;
+    }
+
+    threadSlot = -1;
+    for (int i = 0; i < PROFILE_THREADS; i++) {
+        ProfileThread& t = threads[i];
+        uint32_t v = t.owner.load(std::memory_order_relaxed);
+        if (v & 1) continue;
+        /* Fresh heartbeat first, so a reclaimer that sees the claim also sees it. */
+        t.heartbeat.store(now, std::memory_order_relaxed);
+        if (!t.owner.compare_exchange_strong(v, v + 1, std::memory_order_acq_rel)) continue;
+        threadSlot = i + 1;
+        threadOwner = v + 1;
+        int used = slotsUsed.load(std::memory_order_relaxed);
+        while (used <= i && !slotsUsed.compare_exchange_weak(used, i + 1, std::memory_order_release)) {}
+        return &t;
+    }
+    statLostThreads.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void profileRecord(ProfileProbe probe, uint64_t startTicks, uint64_t ticks)
+{
+    const uint64_t now = startTicks + ticks;
+    ProfileThread* t = claimSlot(now);
+    if (!t) return;
+    t->heartbeat.store(now, std::memory_order_relaxed);
+
+    const uint32_t epoch = resetEpoch.load(std::memory_order_relaxed);
+    if (t->epoch.load(std::memory_order_relaxed) != epoch) {
+        for (int i = 0; i < PROFILE_PROBES; i++) {
+            t->counters[i].calls.store(0, std::memory_order_relaxed);
+            t->counters[i].ticks.store(0, std::memory_order_relaxed);
+            t->counters[i].maxTicks.store(0, std::memory_order_relaxed);
+        }
+        t->epoch.store(epoch, std::memory_order_release);
+    }
+
+    /* Single writer: plain load/store instead of locked read-modify-writes. */
+    ProfileCounter& c = t->counters[probe];
+    c.calls.store(c.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    c.ticks.store(c.ticks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    if (ticks > c.maxTicks.load(std::memory_order_relaxed)) c.maxTicks.store(ticks, std::memory_order_relaxed);
+
+    if (tracing.load(std::memory_order_relaxed)) {
+        ProfileEvent ev;
+        ev.start = startTicks;
+        ev.ticks = ticks;
+        ev.probe = (uint32_t)probe;
+        if (!t->trace.push(ev)) statTraceDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static int claimedSlots()
+{
+    return slotsUsed.load(std::memory_order_acquire);
+}
+
+/* Measured from load to now, so it sharpens the longer the plugin runs. */
+static double ticksPerNs()
+{
+#if PROFILE_RDTSC
+    uint64_t ns = nowNs();
+    while (ns - anchor.ns < PROFILE_CALIBRATE_NS) ns = nowNs();
+    const uint64_t ticks = profileTicks();
+    return (double)(ticks - anchor.ticks) / (double)(ns - anchor.ns);
+#else
+    return 1.0;
+#endif
+}
+
+/*
+ * Free the slots of threads that have not probed for PROFILE_SLOT_IDLE_SEC:
+ * TeamSpeak does not tell us when its threads exit. A thread that was only
+ * idle claims a slot again at its next probe; counts stay where they are.
+ */
+static void reclaimIdleSlots()
+{
+    const int64_t idle = (int64_t)(ticksPerNs() * PROFILE_SLOT_IDLE_SEC * 1e9);
+    const uint64_t now = profileTicks();
+    for (int i = 0, n = claimedSlots(); i < n; i++) {
+        ProfileThread& t = threads[i];
+        uint32_t v = t.owner.load(std::memory_order_acquire);
+        if (!(v & 1)) continue;
+        /* Signed: another core's counter may run slightly ahead of ours. */
+        if ((int64_t)(now - t.heartbeat.load(std::memory_order_relaxed)) < idle) continue;
+        t.owner.compare_exchange_strong(v, v + 1, std::memory_order_acq_rel);
+    }
+}
+
+void profileGet(ProfileProbe probe, ProfileEntry* out)
+{
+    const uint32_t epoch = resetEpoch.load(std::memory_order_relaxed);
+    uint64_t calls = 0, ticks = 0, maxTicks = 0;
+    for (int i = 0, n = claimedSlots(); i < n; i++) {
+        const ProfileThread& t = threads[i];
+        if (t.epoch.load(std::memory_order_acquire) != epoch) continue;   /* not cleared since the reset */
+        const ProfileCounter& c = t.counters[probe];
+        calls += c.calls.load(std::memory_order_relaxed);
+        ticks += c.ticks.load(std::memory_order_relaxed);
+        const uint64_t m = c.maxTicks.load(std::memory_order_relaxed);
+        if (m > maxTicks) maxTicks = m;
+    }
+    const double perNs = calls ? ticksPerNs() : 1.0;
+    out->calls = calls;
+    out->totalNs = (uint64_t)((double)ticks / perNs);
+    out->maxNs = (uint64_t)((double)maxTicks / perNs);
+}
+
+void profileGetStats(ProfileStats* out)
+{
+    reclaimIdleSlots();
+    int owned = 0;
+    for (int i = 0, n = claimedSlots(); i < n; i++) owned += threads[i].owner.load(std::memory_order_relaxed) & 1;
+    out->threads = owned;
+    out->lostThreads = statLostThreads.load(std::memory_order_relaxed);
+    out->ticksPerNs = ticksPerNs();
+    out->tracing = tracing.load(std::memory_order_relaxed);
+    out->traceEvents = capturedCount.load(std::memory_order_relaxed);
+    out->traceDropped = statTraceDropped.load(std::memory_order_relaxed);
+}
+
+void profileReset()
+{
+    resetEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool profileWriteFile(const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "probe,calls,total_us,mean_us,max_us\n");
+    for (int i = 0; i < PROFILE_PROBES; i++) {
+        ProfileEntry e;
+        profileGet((ProfileProbe)i, &e);
+        if (!e.calls) continue;
+        fprintf(f, "%s,%llu,%.3f,%.3f,%.3f\n", names[i], (unsigned long long)e.calls, (double)e.totalNs * 1e-3,
+            (double)e.totalNs * 1e-3 / e.calls, (double)e.maxNs * 1e-3);
+    }
+    return fclose(f) == 0;
+}
+
+/* ---- trace capture ---- */
+
+/* Collector thread while a capture runs, the UI thread once it has joined. */
+static void collectOnce()
+{
+    for (int i = 0, n = claimedSlots(); i < n; i++) {
+        ProfileEvent ev;
+        while (threads[i].trace.pop(&ev)) {
+            if (captured.size() >= PROFILE_TRACE_EVENTS) {
+                tracing.store(false, std::memory_order_relaxed);
+                statTraceDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            captured.push_back(ev);
+            capturedThread.push_back((uint16_t)i);
+        }
+    }
+    capturedCount.store(captured.size(), std::memory_order_relaxed);
+}
+
+static void collectLoop()
+{
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#endif
+    while (collecting.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(PROFILE_COLLECT_MS));
+        collectOnce();
+        reclaimIdleSlots();
+    }
+}
+
+bool profileTraceStart()
+{
+    if (collecting.load(std::memory_order_relaxed)) return false;
+
+    /* Leftovers from probes that were mid-flight when the last capture stopped. */
+    for (int i = 0, n = claimedSlots(); i < n; i++) {
+        ProfileEvent ev;
+        while (threads[i].trace.pop(&ev)) {}
+    }
+    try {
+        captured.clear();
+        capturedThread.clear();
+        captured.reserve(PROFILE_TRACE_EVENTS);
+        capturedThread.reserve(PROFILE_TRACE_EVENTS);
+    }
+    catch (...) {
+        return false;
+    }
+    capturedCount.store(0, std::memory_order_relaxed);
+    statTraceDropped.store(0, std::memory_order_relaxed);
+    traceOriginTicks = profileTicks();
+
+    collecting.store(true, std::memory_order_release);
+    try {
+        collector = std::thread(collectLoop);
+    }
+    catch (...) {
+        collecting.store(false);
+        return false;
+    }
+    tracing.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+static bool writeTrace(const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    const double perUs = ticksPerNs() * 1e3;
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"SC Directional Audio\"}}");
+
+    /* TeamSpeak's threads have no names we can see; call each after the probe it spent the most time in. */
+    uint64_t busiest[PROFILE_THREADS][PROFILE_PROBES] = {};
+    for (size_t k = 0; k < captured.size(); k++) busiest[capturedThread[k]][captured[k].probe] += captured[k].ticks;
+    for (int i = 0; i < PROFILE_THREADS; i++) {
+        int top = -1;
+        for (int p = 0; p < PROFILE_PROBES; p++) {
+            if (busiest[i][p] && (top < 0 || busiest[i][p] > busiest[i][top])) top = p;
+        }
+        if (top < 0) continue;
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d (%s)\"}}",
+            i, i, names[top]);
+    }
+    for (size_t k = 0; k < captured.size(); k++) {
+        const ProfileEvent& ev = captured[k];
+        /* Probes already open when the capture started begin slightly before the origin. */
+        const double ts = (double)(int64_t)(ev.start - traceOriginTicks) / perUs;
+        fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"ts3plugin\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            names[ev.probe], (unsigned)capturedThread[k], ts, (double)ev.ticks / perUs);
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+long profileTraceStop(const char* path)
+{
+    if (collecting.exchange(false)) {
+        tracing.store(false, std::memory_order_relaxed);
+        if (collector.joinable()) collector.join();
+        collectOnce();
+    }
+    if (!path) {
+        captured.clear();
+        capturedThread.clear();
+        return 0;
+    }
+    if (captured.empty() || !writeTrace(path)) return -1;
+    return (long)captured.size();
+}
+
+#else
+
+void profileRecord(ProfileProbe probe, uint64_t startTicks, uint64_t ticks) {}
+
+void profileGet(ProfileProbe probe, ProfileEntry* out)
+{
+    out->calls = 0;
+    out->totalNs = 0;
+    out->maxNs = 0;
+}
+
+void profileGetStats(ProfileStats* out)
+{
+    out->threads = 0;
+    out->lostThreads = 0;
+    out->ticksPerNs = 1.0;
+    out->tracing = false;
+    out->traceEvents = 0;
+    out->traceDropped = 0;
+}
+
+void profileReset() {}
+
+bool profileWriteFile(const char* path) { return false; }
+
+bool profileTraceStart() { return false; }
+
+long profileTraceStop(const char* path) { return -1; }
+
+#endif
@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+ * Scoped probes around the ts3plugin_* callbacks (and the slow parts inside
+ * them): calls, total and worst time per probe since start (or the last
+ * reset), plus an optional trace of every probe for chrome://tracing.
+ *
+ * PROFILE_SCOPE(PROFILE_X) at the top of a scope reads the cycle counter
+ * (RDTSC on x86, steady_clock elsewhere) on entry and exit. Each thread owns
+ * a cache-line aligned slot of counters that only it writes, so a probe is
+ * two counter reads, a few uncontended relaxed stores and, while a trace is
+ * being captured, one push into the thread's own SPSC ring. Summing the
+ * slots and converting cycles to time is left to the reader (the console,
+ * shutdown); a collector thread drains the trace rings only while a capture
+ * runs.
+ *
+ * Build with SCDA_PROFILE=0 and PROFILE_SCOPE expands to nothing; the query
+ * functions stay and report nothing, so callers need no #ifs.
+ *
+ * A thread takes a slot at its first probe. The per-thread state is a plain
+ * thread_local int, so the first probe on an audio thread allocates nothing;
+ * in exchange a slot is only freed once its thread has not probed for a while
+ * (the collector and the stats query look), and the next thread to come along
+ * continues the slot's counts (and trace track). TeamSpeak calls us from a
+ * handful of long-lived threads; threads beyond PROFILE_THREADS alive at once
+ * are counted as lost and not timed.
+ *
+ * On by default, also in release builds: a probe costs two counter reads and
+ * a few plain stores (see scda_load, which counts allocations per callback),
+ * and /scda profile is how a slow callback on a user's machine gets found.
+ */
+
+#include <cstdint>
+
+#ifndef SCDA_PROFILE
+#define SCDA_PROFILE 1
+#endif
+
+#define PROFILE_THREADS       16
+#define PROFILE_TRACE_RING    2048        /* events per thread between collector passes; power of two */
+#define PROFILE_TRACE_EVENTS  (1 << 18)   /* one capture; it stops itself when full */
+#define PROFILE_DUMP_FILE     "scda_profile.csv"   /* in TeamSpeak's config directory */
+#define PROFILE_TRACE_FILE    "scda_trace.json"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROFILE_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILE_RDTSC 0
+#include <chrono>
+#endif
+
+enum ProfileProbe {
+    PROFILE_INIT,
+    PROFILE_SHUTDOWN,
+    PROFILE_REGISTER_PLUGIN_ID,
+    PROFILE_PROCESS_COMMAND,
+    PROFILE_CURRENT_CONNECTION,
+    PROFILE_INFO_DATA,
+    PROFILE_CONNECT_STATUS,
+    PROFILE_CONNECT_CLIENTS,       /* inside onConnectStatusChangeEvent: tracking everyone already there */
+    PROFILE_CONNECT_CHANNELS,      /* inside onConnectStatusChangeEvent: logging the channel list */
+    PROFILE_SERVER_ERROR,
+    PROFILE_TEXT_MESSAGE,
+    PROFILE_TALK_STATUS,
+    PROFILE_UPDATE_CLIENT,
+    PROFILE_CLIENT_MOVE,
+    PROFILE_CLIENT_MOVE_SUBSCRIPTION,
+    PROFILE_CLIENT_MOVE_TIMEOUT,
+    PROFILE_CLIENT_MOVE_MOVED,
+    PROFILE_CLIENT_KICK_CHANNEL,
+    PROFILE_CLIENT_KICK_SERVER,
+    PROFILE_CLIENT_BAN,
+    PROFILE_PLUGIN_COMMAND,
+    PROFILE_ROLLOFF,
+    PROFILE_ROLLOFF_WAVE,
+    PROFILE_POST_PROCESS,
+    PROFILE_MIXED_PLAYBACK,
+    PROFILE_PROBES
+};
+
+/* Summed over all threads; nested probes include their children. */
+struct ProfileEntry {
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+};
+
+struct ProfileStats {
+    int      threads;        /* slots owned by a live thread */
+    uint64_t lostThreads;    /* threads that found no free slot */
+    double   ticksPerNs;     /* measured cycle counter rate; 1 without RDTSC */
+    bool     tracing;
+    uint64_t traceEvents;    /* collected by the current or last capture */
+    uint64_t traceDropped;   /* ring overflows plus events after the capture filled up */
+};
+
+/* Cycle counter the probes read; rdtsc is not serializing, which is fine at callback granularity. */
+static inline uint64_t profileTicks()
+{
+#if PROFILE_RDTSC
+    return __rdtsc();
+#else
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/* Probe exit: `ticks` elapsed since `startTicks` on the calling thread. */
+void profileRecord(ProfileProbe probe, uint64_t startTicks, uint64_t ticks);
+
+/* ts3plugin_* name of the callback, "callback/part" for probes inside one. */
+const char* profileName(ProfileProbe probe);
+
+void profileGet(ProfileProbe probe, ProfileEntry* out);
+void profileGetStats(ProfileStats* out);
+
+/* Forget everything recorded so far; each thread clears its own slot at its next probe. */
+void profileReset();
+
+/* CSV, one row per probe that ran (probe,calls,total_us,mean_us,max_us). False if it cannot be written. */
+bool profileWriteFile(const char* path);
+
+/*
+ * Start a trace capture: from now on every probe also logs its start and
+ * duration, and a collector thread gathers them. False if profiling is
+ * compiled out, a capture is already running or the thread cannot start.
+ */
+bool profileTraceStart();
+
+/*
+ * End the capture (if one runs) and write it as Chrome trace-event JSON, one
+ * track per thread. Returns the number of events written, -1 if `path`
+ * cannot be written or nothing was captured. `path` NULL just discards it.
+ */
+long profileTraceStop(const char* path);
+
+#if SCDA_PROFILE
+
+struct ProfileScope {
+    ProfileProbe probe;
+    uint64_t     t0;
+
+    explicit ProfileScope(ProfileProbe which) : probe(which), t0(profileTicks()) {}
+    ~ProfileScope() { profileRecord(probe, t0, profileTicks() - t0); }
+};
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b)  PROFILE_CAT2(a, b)
+#define PROFILE_SCOPE(probe) ProfileScope PROFILE_CAT(profileScope, __LINE__)(probe)
+
+#else
+
+#define PROFILE_SCOPE(probe) ((void)0)
+
+#endif
@@ -0,0 +1,323 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "radio.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "delay_pool.h"
+#include "dsp.h"
+#include "rolloff.h"
+#include "zones.h"
+
+#define RADIO_RATE_HZ     48000.0f
+#define RADIO_Q           0.7071f
+#define RADIO_DRIVE       (3.0f / 32768.0f)  /* full scale drives the clipper to its knee */
+#define RADIO_LEVEL       9000.0f
+#define RADIO_NOISE_BED   60.0f              /* int16 units */
+#define RADIO_BURST       2500.0f
+#define RADIO_BURST_SAMPLES 2880             /* 60 ms key-up static */
+#define RADIO_TAIL_SAMPLES  8640             /* 180 ms squelch tail */
+#define RADIO_TAIL_LP     0.3f               /* one-pole, takes the fizz off the tail */
+#define RADIO_WATCH_BLOCKS 200               /* mixes without a voice before we stop listening for edges */
+#define RADIO_MAX_FRAMES  DELAY_MAX_BLOCK
+
+static const float PI_F = 3.14159265f;
+
+/* Playback thread only. The chain's state lives here between blocks and visits a bank lane for one pass. */
+struct RadioSlot {
+    uint64_t key;
+    bool     primed;
+    bool     radio;
+    bool     chainReady;  /* chain state reset since the last switch to radio */
+    uint32_t seenTalk;    /* talkWord last acted on */
+    int      burstLeft;   /* samples */
+    float    z1[DSP_BANK_SECTIONS];
+    float    z2[DSP_BANK_SECTIONS];
+    float    noise;       /* noise amplitude the last block ended on */
+    uint32_t rng;
+};
+
+/* Talkers on the radio, for squelch tails after post-process stops calling. */
+struct Watch {
+    uint64_t sch;
+    uint64_t key;
+    int      slot;
+    uint32_t seenTalk;
+    int      idleBlocks;
+    int      tailLeft;
+    uint32_t rng;
+    float    lp;
+};
+
+static DspRadioBank bank;
+static RadioSlot slotState[CLIENT_TABLE_CAPACITY];
+static Watch watch[RADIO_MAX_WATCH];
+static int watchCount = 0;
+alignas(32) static float lanes[RADIO_MAX_FRAMES * DSP_BANK_LANES];
+alignas(32) static float mono[RADIO_MAX_FRAMES];
+static float bandPass[DSP_BANK_SECTIONS][DSP_COEFS];
+static bool designed = false;
+
+/* Published by the playback thread for the rolloff callback: key while on the radio, else 0. */
+static std::atomic<uint64_t> radioKey[CLIENT_TABLE_CAPACITY];
+/* Event thread: edge count << 1 | talking. */
+static std::atomic<uint32_t> talkWord[CLIENT_TABLE_CAPACITY];
+
+static std::atomic<uint64_t> statVoices(0);
+static std::atomic<uint64_t> statPasses(0);
+static std::atomic<uint64_t> statSwitches(0);
+static std::atomic<uint64_t> statKeyUps(0);
+static std::atomic<uint64_t> statTails(0);
+
+/* ---- event thread ---- */
+
+void radioTalkStatus(int slot, bool talking)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return;
+    const uint32_t w = talkWord[slot].load(std::memory_order_relaxed);
+    talkWord[slot].store((((w >> 1) + 1) << 1) | (talking ? 1u : 0u), std::memory_order_release);
+}
+
+/* ---- any thread ---- */
+
+bool radioActive(int slot, uint64_t key)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return false;
+    return key && radioKey[slot].load(std::memory_order_relaxed) == key;
+}
+
+/* ---- playback thread ---- */
+
+/* RBJ high-pass and low-pass; the same band for every lane. */
+static void designBand()
+{
+    const float fs[DSP_BANK_SECTIONS] = { RADIO_LOW_HZ, RADIO_HIGH_HZ };
+    for (int s = 0; s < DSP_BANK_SECTIONS; s++) {
+        const float w = 2.0f * PI_F * fs[s] / RADIO_RATE_HZ;
+        const float cw = std::cos(w), alpha = std::sin(w) / (2.0f * RADIO_Q);
+        const float a0 = 1.0f + alpha;
+        const float b1 = s == 0 ? -(1.0f + cw) : 1.0f - cw;
+        bandPass[s][DSP_B0] = std::fabs(b1) * 0.5f / a0;
+        bandPass[s][DSP_B1] = b1 / a0;
+        bandPass[s][DSP_B2] = bandPass[s][DSP_B0];
+        bandPass[s][DSP_A1] = -2.0f * cw / a0;
+        bandPass[s][DSP_A2] = (1.0f - alpha) / a0;
+    }
+    designed = true;
+}
+
+static void watchAdd(uint64_t sch, int slot, uint64_t key)
+{
+    for (int i = 0; i < watchCount; i++) {
+        if (watch[i].slot == slot) {
+            if (watch[i].key != key) {
+                watch[i].key = key;
+                watch[i].sch = sch;
+                watch[i].tailLeft = 0;
+                watch[i].seenTalk = talkWord[slot].load(std::memory_order_acquire);
+            }
+            watch[i].idleBlocks = 0;
+            return;
+        }
+    }
+    if (watchCount >= RADIO_MAX_WATCH) return;  /* squelch tails are a nicety */
+    Watch& w = watch[watchCount++];
+    w.sch = sch;
+    w.key = key;
+    w.slot = slot;
+    w.seenTalk = talkWord[slot].load(std::memory_order_acquire);
+    w.idleBlocks = 0;
+    w.tailLeft = 0;
+    w.rng = 0x9E3779B9u ^ (uint32_t)slot;
+    w.lp = 0.0f;
+}
+
+bool radioSelect(uint64_t sch, int slot, uint64_t key, const Pose& listener, const Pose& source)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return false;
+    RadioSlot& st = slotState[slot];
+    if (!st.primed || st.key != key) {
+        st.key = key;
+        st.primed = true;
+        st.radio = false;
+        st.chainReady = false;
+        st.seenTalk = talkWord[slot].load(std::memory_order_acquire);
+        st.burstLeft = 0;
+    }
+
+    bool radio;
+    if (source.zoneId != listener.zoneId) {
+        /* No shared air: a wall muffles, vacuum or a planet's worth of distance does not carry at all. */
+        radio = listener.zoneClass == ZONE_CLASS_SPACE || source.zoneClass == ZONE_CLASS_SPACE
+            || listener.zoneClass == ZONE_CLASS_PLANET || source.zoneClass == ZONE_CLASS_PLANET;
+    }
+    else {
+        const float dx = (float)(source.x - listener.x);
+        const float dy = (float)(source.y - listener.y);
+        const float dz = (float)(source.z - listener.z);
+        const int cls = source.zoneClass != ZONE_CLASS_UNKNOWN ? source.zoneClass : listener.zoneClass;
+        const float g = rolloffGain(cls, std::sqrt(dx * dx + dy * dy + dz * dz));
+        radio = g < (st.radio ? RADIO_LEAVE_GAIN : RADIO_ENTER_GAIN);
+    }
+
+    if (radio != st.radio) {
+        st.radio = radio;
+        st.chainReady = false;
+        radioKey[slot].store(radio ? key : 0, std::memory_order_relaxed);
+        statSwitches.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (radio) watchAdd(sch, slot, key);
+    return radio;
+}
+
+void radioProcess(const int* slots, const uint64_t* keys, float* const* blocks, int count, int frames)
+{
+    if (count <= 0 || frames <= 0 || frames > RADIO_MAX_FRAMES) return;
+    if (!designed) {
+        designBand();
+        for (int lane = 0; lane < DSP_BANK_LANES; lane++) {
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) {
+                for (int c = 0; c < DSP_COEFS; c++) bank.coef[c][sec][lane] = bandPass[sec][c];
+            }
+            bank.drive[lane] = RADIO_DRIVE;
+            bank.level[lane] = RADIO_LEVEL;
+        }
+    }
+    const DspKernels* k = dspKernels();
+
+    /* Packed DSP_BANK_LANES voices to a pass whatever their slots, as in occlusionProcess(). */
+    int next = 0;
+    while (next < count) {
+        int member[DSP_BANK_LANES];
+        int used = 0;
+        for (; next < count && used < DSP_BANK_LANES; next++) {
+            if (slots[next] < 0 || slots[next] >= CLIENT_TABLE_CAPACITY) continue;
+            const int i = next, lane = used++;
+            member[lane] = i;
+            RadioSlot& st = slotState[slots[i]];
+            if (!st.chainReady || st.key != keys[i]) {
+                for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) st.z1[sec] = st.z2[sec] = 0.0f;
+                st.noise = RADIO_NOISE_BED;
+                if (!st.rng) st.rng = 0x2545F491u * (uint32_t)(slots[i] + 1) | 1u;
+                st.chainReady = true;
+            }
+
+            const uint32_t w = talkWord[slots[i]].load(std::memory_order_acquire);
+            if (w != st.seenTalk) {
+                if (w & 1u) {
+                    st.burstLeft = RADIO_BURST_SAMPLES;
+                    statKeyUps.fetch_add(1, std::memory_order_relaxed);
+                }
+                st.seenTalk = w;
+            }
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) {
+                bank.z1[sec][lane] = st.z1[sec];
+                bank.z2[sec][lane] = st.z2[sec];
+            }
+            bank.noiseCur[lane] = st.noise;
+            bank.noiseTarget[lane] = st.burstLeft > 0 ? RADIO_BURST : RADIO_NOISE_BED;
+            bank.rng[lane] = st.rng;
+            st.burstLeft -= frames;
+
+            const float* src = blocks[i];
+            for (int f = 0; f < frames; f++) lanes[(size_t)f * DSP_BANK_LANES + lane] = src[f];
+            statVoices.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!used) break;
+
+        /* Spare lanes: silence in, no noise out. */
+        for (int lane = used; lane < DSP_BANK_LANES; lane++) {
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) bank.z1[sec][lane] = bank.z2[sec][lane] = 0.0f;
+            bank.noiseCur[lane] = bank.noiseTarget[lane] = 0.0f;
+            bank.rng[lane] = 1u;
+            for (int f = 0; f < frames; f++) lanes[(size_t)f * DSP_BANK_LANES + lane] = 0.0f;
+        }
+
+        k->radioBank(&bank, lanes, frames);
+        statPasses.fetch_add(1, std::memory_order_relaxed);
+
+        for (int lane = 0; lane < used; lane++) {
+            const int i = member[lane];
+            RadioSlot& st = slotState[slots[i]];
+            for (int sec = 0; sec < DSP_BANK_SECTIONS; sec++) {
+                st.z1[sec] = bank.z1[sec][lane];
+                st.z2[sec] = bank.z2[sec][lane];
+            }
+            st.noise = bank.noiseCur[lane];
+            st.rng = bank.rng[lane];
+            float* dst = blocks[i];
+            for (int f = 0; f < frames; f++) dst[f] = lanes[(size_t)f * DSP_BANK_LANES + lane];
+        }
+    }
+}
+
+void radioRender(int slot, uint64_t key, short* samples, int frames, int channels, const unsigned int* channelFillMask)
+{
+    if (!channelFillMask || !*channelFillMask || frames > RADIO_MAX_FRAMES || channels > 32) return;
+    const unsigned int mask = *channelFillMask;
+    dspKernels()->toMono(samples, frames, channels, mask, mono);
+    float* block = mono;
+    radioProcess(&slot, &key, &block, 1, frames);
+    for (int i = 0; i < frames; i++) {
+        short* f = samples + (size_t)i * channels;
+        const float m = mono[i];
+        const short v = m >= 32767.0f ? 32767 : m <= -32768.0f ? -32768 : (short)(m >= 0.0f ? m + 0.5f : m - 0.5f);
+        for (int ch = 0; ch < channels; ch++) {
+            if (mask & (1u << ch)) f[ch] = v;
+        }
+    }
+}
+
+bool radioTails(uint64_t sch, int frames, float* busL, float* busR)
+{
+    bool any = false;
+    int kept = 0;
+    for (int i = 0; i < watchCount; i++) {
+        Watch w = watch[i];
+        if (w.sch == sch) {
+            const RadioSlot& st = slotState[w.slot];
+            const uint32_t t = talkWord[w.slot].load(std::memory_order_acquire);
+            if (t != w.seenTalk) {
+                /* Let go of the key while still on the radio: squelch tail. */
+                if (!(t & 1u) && st.primed && st.key == w.key && st.radio) {
+                    w.tailLeft = RADIO_TAIL_SAMPLES;
+                    statTails.fetch_add(1, std::memory_order_relaxed);
+                }
+                w.seenTalk = t;
+            }
+            if (w.tailLeft > 0) {
+                /* Linear fade of filtered static; both ears, it is in the headset. */
+                const float step = RADIO_BURST / (float)RADIO_TAIL_SAMPLES;
+                float amp = step * (float)w.tailLeft;
+                const int n = frames < w.tailLeft ? frames : w.tailLeft;
+                for (int f = 0; f < n; f++) {
+                    w.rng ^= w.rng << 13;
+                    w.rng ^= w.rng >> 17;
+                    w.rng ^= w.rng << 5;
+                    w.lp += RADIO_TAIL_LP * ((float)(int32_t)w.rng * (1.0f / 2147483648.0f) - w.lp);
+                    const float s = w.lp * amp;
+                    busL[f] += s;
+                    busR[f] += s;
+                    amp -= step;
+                }
+                w.tailLeft -= n;
+                any = true;
+            }
+            if (++w.idleBlocks > RADIO_WATCH_BLOCKS && w.tailLeft <= 0) continue;
+        }
+        watch[kept++] = w;
+    }
+    watchCount = kept;
+    return any;
+}
+
+void radioGetStats(RadioStats* out)
+{
+    out->voices = statVoices.load(std::memory_order_relaxed);
+    out->passes = statPasses.load(std::memory_order_relaxed);
+    out->switches = statSwitches.load(std::memory_order_relaxed);
+    out->keyUps = statKeyUps.load(std::memory_order_relaxed);
+    out->tails = statTails.load(std::memory_order_relaxed);
+}
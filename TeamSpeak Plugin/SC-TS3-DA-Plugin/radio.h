@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+ * Ship-radio rendering for crew beyond earshot. A talker whose 3D rolloff
+ * would fade them out (or who is in another zone with no air in between:
+ * space, planet surface) is switched to radio: TeamSpeak gets full volume
+ * for them from the rolloff callback, and their voice runs through a
+ * band-pass, soft-clip and noise-bed chain and is mixed centred.
+ *
+ * The chain is one fused SIMD pass over DSP_BANK_LANES clients
+ * (DspRadioBank); chain state is kept per client table slot and each
+ * cycle's radio talkers are packed densely into the bank like the
+ * occlusion voices, so switching a client between 3D and radio only flips
+ * a flag. Squelch
+ * follows talk-status edges: a burst of static on key-up and a decaying
+ * tail once they stop, rendered from the mixed callback because TeamSpeak
+ * no longer calls post-process for a client that went quiet.
+ *
+ * Threads: radioTalkStatus() on the event thread, radioActive() from any
+ * audio callback, everything else on the playback thread.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+#define RADIO_ENTER_GAIN  0.05f    /* 3D rolloff gain below which a same-zone talker goes to radio */
+#define RADIO_LEAVE_GAIN  0.1f     /* ...and above which they come back; hysteresis */
+#define RADIO_LOW_HZ      300.0f
+#define RADIO_HIGH_HZ     3000.0f
+#define RADIO_MAX_WATCH   64       /* radio talkers whose squelch we follow at once */
+
+struct RadioStats {
+    uint64_t voices;        /* client blocks through the radio chain */
+    uint64_t passes;        /* radioBank passes */
+    uint64_t switches;      /* 3D <-> radio changes */
+    uint64_t keyUps;        /* squelch bursts */
+    uint64_t tails;         /* squelch tails */
+};
+
+/* Event thread: a client started or stopped talking. */
+void radioTalkStatus(int slot, bool talking);
+
+/* Any thread: is this client currently on the radio? */
+bool radioActive(int slot, uint64_t key);
+
+/* Post-process callback: decide 3D or radio for `source`, with hysteresis; true for radio. */
+bool radioSelect(uint64_t sch, int slot, uint64_t key, const Pose& listener, const Pose& source);
+
+/* Run the radio chain over `count` mono blocks in place; slots distinct, all selected for radio. */
+void radioProcess(const int* slots, const uint64_t* keys, float* const* blocks, int count, int frames);
+
+/* Fallback when the voice bus cannot take the block: radio chain in place, same signal on every filled channel. */
+void radioRender(int slot, uint64_t key, short* samples, int frames, int channels, const unsigned int* channelFillMask);
+
+/* Mixed callback: add squelch tails for this connection's radio talkers; true if anything was added. */
+bool radioTails(uint64_t sch, int frames, float* busL, float* busR);
+
+void radioGetStats(RadioStats* out);
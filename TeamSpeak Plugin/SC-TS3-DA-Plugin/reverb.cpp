@@ -0,0 +1,212 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "reverb.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "zones.h"
+
+static_assert((REVERB_LINE_LEN & (REVERB_LINE_LEN - 1)) == 0, "REVERB_LINE_LEN must be a power of two");
+static_assert((REVERB_PREDELAY_LEN & (REVERB_PREDELAY_LEN - 1)) == 0, "REVERB_PREDELAY_LEN must be a power of two");
+static_assert(REVERB_LINES == 8, "the feedback matrix is an 8x8 Hadamard");
+
+#define REVERB_RATE_HZ      48000.0f
+#define REVERB_SMOOTH       0.25f    /* per-block glide towards a new preset */
+#define REVERB_INPUT_GAIN   0.35f    /* per line */
+#define REVERB_SILENCE      0.5f     /* output peak below half an LSB counts as silent */
+#define REVERB_IDLE_BLOCKS  12       /* silent input blocks before the tail may stop; covers the pre-delay */
+#define REVERB_OTHER_ZONE   0.5f     /* send scale for talkers behind a wall */
+
+static const float PI_F = 3.14159265f;
+static const float HADAMARD_SCALE = 0.35355339f;  /* 1 / sqrt(8): keeps the matrix lossless */
+
+/* Mutually prime, 23..49 ms: dense echoes without audible flutter. */
+static const int lineLen[REVERB_LINES] = { 1117, 1277, 1429, 1601, 1783, 1951, 2143, 2357 };
+
+/* Indexed by ZoneClass. */
+static const ReverbPreset presets[ZONE_CLASS_COUNT] = {
+    /* rt60  damp     pre    send   crit   wet */
+    { 0.6f,  6000.0f, 10.0f, 0.12f, 6.0f,  0.5f },   /* unknown: a medium room */
+    { 0.45f, 3500.0f, 4.0f,  0.18f, 3.0f,  0.5f },   /* ship: small metal cabins */
+    { 2.2f,  5000.0f, 35.0f, 0.25f, 12.0f, 0.6f },   /* hangar */
+    { 1.2f,  7000.0f, 18.0f, 0.20f, 8.0f,  0.5f },   /* station halls */
+    { 0.3f,  8000.0f, 8.0f,  0.06f, 20.0f, 0.4f },   /* outdoors: a hint of ground reflection */
+    { 0.2f,  8000.0f, 0.0f,  0.0f,  1.0f,  0.0f },   /* space: nothing to reflect off */
+};
+
+/* Rows padded by a cache line so the eight same-index writes per sample do not 4K-alias. */
+static float lineBuf[REVERB_LINES][REVERB_LINE_LEN + 16];
+static float lowpass[REVERB_LINES];
+static float preBuf[REVERB_PREDELAY_LEN];
+static float input[REVERB_MAX_FRAMES];
+static uint32_t linePos = 0;
+static uint32_t prePos = 0;
+static int      inputFrames = 0;     /* 0: nothing sent this cycle */
+static uint64_t owner = 0;           /* connection whose mix runs the network */
+static bool     running = false;     /* buffers hold a tail */
+static int      silentBlocks = 0;
+
+static int      targetClass = -1;    /* -1 until the first reverbSetZoneClass() */
+static float    curRt60, curDampHz, curWet;
+static int      curPredelay = 0;     /* samples */
+
+static std::atomic<uint64_t> statBlocks(0);
+static std::atomic<uint64_t> statIdle(0);
+static std::atomic<uint64_t> statSends(0);
+static std::atomic<uint64_t> statPresetChanges(0);
+static std::atomic<uint8_t>  statZoneClass(ZONE_CLASS_UNKNOWN);
+
+static const ReverbPreset& presetFor(int zoneClass)
+{
+    return presets[(unsigned)zoneClass < ZONE_CLASS_COUNT ? zoneClass : ZONE_CLASS_UNKNOWN];
+}
+
+void reverbGetPreset(int zoneClass, ReverbPreset* out)
+{
+    *out = presetFor(zoneClass);
+}
+
+void reverbSetZoneClass(int zoneClass)
+{
+    if ((unsigned)zoneClass >= ZONE_CLASS_COUNT) zoneClass = ZONE_CLASS_UNKNOWN;
+    if (zoneClass == targetClass) return;
+    const ReverbPreset& p = presets[zoneClass];
+    if (targetClass < 0) {
+        curRt60 = p.rt60;
+        curDampHz = p.dampHz;
+        curWet = p.wet;
+        curPredelay = (int)(p.predelayMs * REVERB_RATE_HZ * 0.001f);
+    }
+    else {
+        statPresetChanges.fetch_add(1, std::memory_order_relaxed);
+    }
+    targetClass = zoneClass;
+    statZoneClass.store((uint8_t)zoneClass, std::memory_order_relaxed);
+}
+
+float reverbSendLevel(const Pose& listener, const Pose& source)
+{
+    const ReverbPreset& p = presetFor(listener.zoneClass);
+    if (source.zoneId != listener.zoneId) return p.send * REVERB_OTHER_ZONE;
+
+    /* The direct sound falls with distance, the room does not: far talkers sound wetter. */
+    const float dx = (float)(source.x - listener.x);
+    const float dy = (float)(source.y - listener.y);
+    const float dz = (float)(source.z - listener.z);
+    float r = std::sqrt(dx * dx + dy * dy + dz * dz) / p.criticalM;
+    if (r < 0.25f) r = 0.25f;
+    if (r > 2.0f) r = 2.0f;
+    return p.send * r;
+}
+
+void reverbSend(uint64_t sch, const float* block, int frames, float level)
+{
+    if (level <= 0.0f || frames <= 0 || frames > REVERB_MAX_FRAMES) return;
+    if (inputFrames && frames != inputFrames) return;
+    if (!inputFrames) {
+        memset(input, 0, (size_t)frames * sizeof(float));
+        inputFrames = frames;
+    }
+    for (int i = 0; i < frames; i++) input[i] += block[i] * level;
+    owner = sch;
+    statSends.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void clearNetwork()
+{
+    memset(lineBuf, 0, sizeof(lineBuf));
+    memset(lowpass, 0, sizeof(lowpass));
+    memset(preBuf, 0, sizeof(preBuf));
+}
+
+bool reverbRender(uint64_t sch, int frames, float* busL, float* busR)
+{
+    if (sch != owner || targetClass < 0) return false;
+    const bool haveInput = inputFrames == frames;
+    inputFrames = 0;
+    if (!haveInput && !running) {
+        statIdle.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (frames <= 0 || frames > REVERB_MAX_FRAMES) return false;
+    running = true;
+
+    /* Glide towards the preset; the pre-delay only moves while nobody feeds it, so it never jumps mid-word. */
+    const ReverbPreset& p = presets[targetClass];
+    curRt60 += REVERB_SMOOTH * (p.rt60 - curRt60);
+    curDampHz += REVERB_SMOOTH * (p.dampHz - curDampHz);
+    curWet += REVERB_SMOOTH * (p.wet - curWet);
+    if (!haveInput) curPredelay = (int)(p.predelayMs * REVERB_RATE_HZ * 0.001f);
+
+    float gain[REVERB_LINES];
+    for (int k = 0; k < REVERB_LINES; k++) {
+        gain[k] = std::pow(10.0f, -3.0f * (float)lineLen[k] / (REVERB_RATE_HZ * curRt60)) * HADAMARD_SCALE;
+    }
+    const float damp = 1.0f - std::exp(-2.0f * PI_F * curDampHz / REVERB_RATE_HZ);
+    const float wet = curWet * 0.5f;
+    const uint32_t lineMask = REVERB_LINE_LEN - 1, preMask = REVERB_PREDELAY_LEN - 1;
+
+    /* Locals: the bus pointers could alias the statics and force a reload every sample. */
+    float lp[REVERB_LINES];
+    memcpy(lp, lowpass, sizeof(lp));
+    uint32_t pos = linePos, pre = prePos;
+    const uint32_t predelay = (uint32_t)curPredelay;
+    float peak = 0.0f;
+    for (int i = 0; i < frames; i++) {
+        preBuf[pre & preMask] = haveInput ? input[i] : 0.0f;
+        const float x = preBuf[(pre - predelay) & preMask] * REVERB_INPUT_GAIN;
+        pre++;
+
+        float v[REVERB_LINES];
+        for (int k = 0; k < REVERB_LINES; k++) {
+            lp[k] += damp * (lineBuf[k][(pos - (uint32_t)lineLen[k]) & lineMask] - lp[k]);
+            v[k] = lp[k];
+        }
+        const float outL = v[0] - v[2] + v[4] - v[6];
+        const float outR = v[1] - v[3] + v[5] - v[7];
+        busL[i] += outL * wet;
+        busR[i] += outR * wet;
+        const float a = std::fabs(outL) + std::fabs(outR);
+        if (a > peak) peak = a;
+
+        for (int k = 0; k < REVERB_LINES; k++) v[k] *= gain[k];
+        /* Fast Walsh-Hadamard: 24 adds for the full 8x8 mix. */
+        const float a0 = v[0] + v[1], a1 = v[0] - v[1], a2 = v[2] + v[3], a3 = v[2] - v[3];
+        const float a4 = v[4] + v[5], a5 = v[4] - v[5], a6 = v[6] + v[7], a7 = v[6] - v[7];
+        const float b0 = a0 + a2, b1 = a1 + a3, b2 = a0 - a2, b3 = a1 - a3;
+        const float b4 = a4 + a6, b5 = a5 + a7, b6 = a4 - a6, b7 = a5 - a7;
+        const uint32_t w = pos & lineMask;
+        lineBuf[0][w] = b0 + b4 + x;
+        lineBuf[1][w] = b1 + b5 - x;
+        lineBuf[2][w] = b2 + b6 + x;
+        lineBuf[3][w] = b3 + b7 - x;
+        lineBuf[4][w] = b0 - b4 + x;
+        lineBuf[5][w] = b1 - b5 - x;
+        lineBuf[6][w] = b2 - b6 + x;
+        lineBuf[7][w] = b3 - b7 - x;
+        pos++;
+    }
+    memcpy(lowpass, lp, sizeof(lp));
+    linePos = pos;
+    prePos = pre;
+    statBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    /* Stop once the tail is inaudible, so a silent channel costs nothing. */
+    silentBlocks = haveInput ? 0 : silentBlocks + 1;
+    if (silentBlocks >= REVERB_IDLE_BLOCKS && peak * wet < REVERB_SILENCE) {
+        clearNetwork();
+        running = false;
+    }
+    return true;
+}
+
+void reverbGetStats(ReverbStats* out)
+{
+    out->blocks = statBlocks.load(std::memory_order_relaxed);
+    out->idle = statIdle.load(std::memory_order_relaxed);
+    out->sends = statSends.load(std::memory_order_relaxed);
+    out->presetChanges = statPresetChanges.load(std::memory_order_relaxed);
+    out->zoneClass = statZoneClass.load(std::memory_order_relaxed);
+}
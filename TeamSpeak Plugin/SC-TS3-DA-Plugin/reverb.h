@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+ * Shared room reverb: one 8-line feedback delay network for all talkers,
+ * tuned by the zone class of our own pose (a hangar rings, a ship cabin is
+ * small and dull, open space is dry).
+ *
+ * Talkers feed it through a per-client send level computed in the
+ * post-process callback and carried on the voice bus; the voice bus sums the
+ * filtered voices into the reverb input and adds the stereo return to its
+ * busses in the mixed callback. Cost is one network per block however many
+ * clients talk, and nothing at all once the tail has died away.
+ *
+ * The network runs in the mix of whichever connection sent to it last, so it
+ * advances once per playback cycle. All buffers are static and sized for the
+ * longest preset; nothing is allocated after load.
+ *
+ * Playback thread only, apart from the stats accessor.
+ */
+
+#include <cstdint>
+
+#include "pose.h"
+
+#define REVERB_LINES      8
+#define REVERB_LINE_LEN   4096      /* per line, power of two; longest line + headroom */
+#define REVERB_PREDELAY_LEN 4096    /* samples; ~85 ms at 48 kHz */
+#define REVERB_MAX_FRAMES 2048
+
+struct ReverbPreset {
+    float rt60;             /* seconds to decay by 60 dB, low frequencies */
+    float dampHz;           /* in-loop low-pass; highs die faster above it */
+    float predelayMs;
+    float send;             /* send level at the critical distance */
+    float criticalM;        /* distance where the send reaches `send` */
+    float wet;              /* return level */
+};
+
+struct ReverbStats {
+    uint64_t blocks;        /* blocks the network ran */
+    uint64_t idle;          /* mixes skipped because the tail had died away */
+    uint64_t sends;         /* voice blocks fed in */
+    uint64_t presetChanges;
+    uint8_t  zoneClass;     /* preset in use */
+};
+
+void reverbGetPreset(int zoneClass, ReverbPreset* out);
+
+/* Pick the preset for our own zone; parameters glide over a few blocks. */
+void reverbSetZoneClass(int zoneClass);
+
+/* Send level for `source` as heard by `listener`; 0 means dry. */
+float reverbSendLevel(const Pose& listener, const Pose& source);
+
+/* Add a mono voice block to this cycle's reverb input. */
+void reverbSend(uint64_t sch, const float* block, int frames, float level);
+
+/* Run the network for this connection's cycle and add its return to the busses; false if it did not run. */
+bool reverbRender(uint64_t sch, int frames, float* busL, float* busR);
+
+void reverbGetStats(ReverbStats* out);
@@ -0,0 +1,222 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "rolloff.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Table index = float bits >> 19: 8 exponent bits plus the top 4 mantissa
+ * bits, i.e. 16 linear sub-bins per octave. Covers 1/8 m .. 128 km.
+ */
+#define LUT_SHIFT      19
+#define LUT_MIN_M      0.125f
+#define LUT_OCTAVES    20
+#define LUT_BINS       (LUT_OCTAVES << (23 - LUT_SHIFT))
+#define LUT_FRAC_MASK  ((1u << LUT_SHIFT) - 1)
+#define LUT_FRAC_SCALE (1.0f / (float)(1u << LUT_SHIFT))
+
+#define ROLLOFF_FILE_MAX 8192
+
+struct RolloffTables {
+    float lut[ZONE_CLASS_COUNT][LUT_BINS + 1];
+};
+
+/* Double-buffered: bake into the inactive one, then flip. */
+static RolloffTables tables[2];
+static std::atomic<RolloffTables*> active(NULL);
+static RolloffCurve bakedCurves[ZONE_CLASS_COUNT];
+
+static const char* defaultCurves =
+    "unknown  ref=2    rolloff=1.0  fade=60    far=120\n"
+    "ship     ref=1.5  rolloff=1.2  fade=25    far=50\n"
+    "hangar   ref=2    rolloff=1.0  fade=50    far=100\n"
+    "station  ref=2    rolloff=1.0  fade=40    far=80\n"
+    "planet   ref=3    rolloff=1.0  fade=150   far=300\n"
+    "space    ref=5    rolloff=0.8  fade=2000  far=5000 floor=0.02\n";
+
+static inline uint32_t floatBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bitsFloat(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/* ---- curves ---- */
+
+float rolloffAnalytic(const RolloffCurve& c, float d)
+{
+    if (d <= c.refDist) return 1.0f;
+    if (d >= c.maxDist) return 0.0f;
+    float g = std::pow(c.refDist / d, c.rolloff);
+    if (g < c.minGain) g = c.minGain;
+    if (d > c.fadeDist) g *= 1.0f - std::log(d / c.fadeDist) / std::log(c.maxDist / c.fadeDist);
+    return g;
+}
+
+void rolloffDefaults(RolloffCurve curves[ZONE_CLASS_COUNT])
+{
+    for (int i = 0; i < ZONE_CLASS_COUNT; i++) {
+        curves[i].refDist = 2.0f;
+        curves[i].rolloff = 1.0f;
+        curves[i].fadeDist = 60.0f;
+        curves[i].maxDist = 120.0f;
+        curves[i].minGain = 0.0f;
+    }
+    char err[8];
+    rolloffParse(defaultCurves, curves, err, sizeof(err));
+}
+
+static int classByName(const char* s, size_t n)
+{
+    for (int i = 0; i < ZONE_CLASS_COUNT; i++) {
+        const char* name = zoneClassName((ZoneClass)i);
+        if (strlen(name) == n && strncmp(name, s, n) == 0) return i;
+    }
+    return -1;
+}
+
+static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool rolloffParse(const char* text, RolloffCurve curves[ZONE_CLASS_COUNT], char* err, size_t errLen)
+{
+    int line = 1;
+    const char* p = text;
+    while (*p) {
+        /* class name */
+        while (isSpace(*p)) p++;
+        if (*p == '#') while (*p && *p != '\n') p++;
+        if (*p == '\n' || !*p) {
+            if (*p) p++, line++;
+            continue;
+        }
+        const char* name = p;
+        while (*p && !isSpace(*p) && *p != '\n') p++;
+        const int cls = classByName(name, (size_t)(p - name));
+        if (cls < 0) {
+            snprintf(err, errLen, "line %d: unknown zone class '%.*s'", line, (int)(p - name), name);
+            return false;
+        }
+        RolloffCurve c = curves[cls];
+
+        /* key=value pairs */
+        for (;;) {
+            while (isSpace(*p)) p++;
+            if (!*p || *p == '\n' || *p == '#') break;
+            const char* key = p;
+            while (*p && *p != '=' && !isSpace(*p) && *p != '\n') p++;
+            const size_t keyLen = (size_t)(p - key);
+            if (*p != '=') {
+                snprintf(err, errLen, "line %d: expected key=value after '%.*s'", line, (int)keyLen, key);
+                return false;
+            }
+            p++;
+            char* end;
+            const float v = strtof(p, &end);
+            if (end == p || !std::isfinite(v)) {
+                snprintf(err, errLen, "line %d: bad number for '%.*s'", line, (int)keyLen, key);
+                return false;
+            }
+            p = end;
+
+            float* field =
+                keyLen == 3 && !strncmp(key, "ref", 3)     ? &c.refDist :
+                keyLen == 7 && !strncmp(key, "rolloff", 7) ? &c.rolloff :
+                keyLen == 4 && !strncmp(key, "fade", 4)    ? &c.fadeDist :
+                keyLen == 3 && !strncmp(key, "far", 3)     ? &c.maxDist :
+                keyLen == 5 && !strncmp(key, "floor", 5)   ? &c.minGain : NULL;
+            if (!field) {
+                snprintf(err, errLen, "line %d: unknown key '%.*s'", line, (int)keyLen, key);
+                return false;
+            }
+            *field = v;
+        }
+        if (*p == '#') while (*p && *p != '\n') p++;
+
+        if (!(c.refDist > 0.0f && c.refDist < c.maxDist && c.fadeDist >= c.refDist && c.fadeDist <= c.maxDist
+              && c.rolloff >= 0.0f && c.rolloff <= 8.0f && c.minGain >= 0.0f && c.minGain <= 1.0f)) {
+            snprintf(err, errLen, "line %d: need 0 < ref <= fade <= far, ref < far, 0 <= rolloff <= 8, 0 <= floor <= 1", line);
+            return false;
+        }
+        curves[cls] = c;
+    }
+    return true;
+}
+
+/* ---- tables ---- */
+
+void rolloffBake(const RolloffCurve curves[ZONE_CLASS_COUNT])
+{
+    RolloffTables* cur = active.load(std::memory_order_acquire);
+    RolloffTables* next = cur == &tables[0] ? &tables[1] : &tables[0];
+
+    const uint32_t base = floatBits(LUT_MIN_M) >> LUT_SHIFT;
+    for (int cls = 0; cls < ZONE_CLASS_COUNT; cls++) {
+        for (int i = 0; i <= LUT_BINS; i++) {
+            const float d = bitsFloat((base + (uint32_t)i) << LUT_SHIFT);
+            next->lut[cls][i] = rolloffAnalytic(curves[cls], d);
+        }
+    }
+    memcpy(bakedCurves, curves, sizeof(bakedCurves));
+    active.store(next, std::memory_order_release);
+}
+
+bool rolloffGetCurves(RolloffCurve curves[ZONE_CLASS_COUNT])
+{
+    if (!active.load(std::memory_order_acquire)) return false;
+    memcpy(curves, bakedCurves, sizeof(bakedCurves));
+    return true;
+}
+
+bool rolloffLoadFile(const char* path, char* err, size_t errLen)
+{
+    RolloffCurve curves[ZONE_CLASS_COUNT];
+    rolloffDefaults(curves);
+    err[0] = '\0';
+
+    bool ok = true;
+    FILE* f = NULL;
+#ifdef _WIN32
+    if (path && fopen_s(&f, path, "rb") != 0) f = NULL;
+#else
+    if (path) f = fopen(path, "rb");
+#endif
+    if (f) {
+        static char text[ROLLOFF_FILE_MAX + 1];
+        const size_t n = fread(text, 1, ROLLOFF_FILE_MAX, f);
+        fclose(f);
+        text[n] = '\0';
+        RolloffCurve parsed[ZONE_CLASS_COUNT];
+        memcpy(parsed, curves, sizeof(parsed));
+        ok = rolloffParse(text, parsed, err, errLen);
+        if (ok) memcpy(curves, parsed, sizeof(curves));
+    }
+    rolloffBake(curves);
+    return ok;
+}
+
+float rolloffGain(int zoneClass, float distance)
+{
+    const RolloffTables* t = active.load(std::memory_order_acquire);
+    if (!t) return 1.0f;
+    if ((unsigned)zoneClass >= ZONE_CLASS_COUNT) zoneClass = ZONE_CLASS_UNKNOWN;
+    const float* lut = t->lut[zoneClass];
+
+    /* NaN and anything below the table start land on the first entry. */
+    if (!(distance > LUT_MIN_M)) return lut[0];
+    const uint32_t bits = floatBits(distance);
+    const uint32_t i = (bits >> LUT_SHIFT) - (floatBits(LUT_MIN_M) >> LUT_SHIFT);
+    if (i >= LUT_BINS) return lut[LUT_BINS];
+    const float frac = (float)(bits & LUT_FRAC_MASK) * LUT_FRAC_SCALE;
+    return lut[i] + frac * (lut[i + 1] - lut[i]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+/*
+ * Distance rolloff for TeamSpeak's custom 3D rolloff callbacks, one curve per
+ * zone class (ship interiors and EVA want very different distances).
+ *
+ * Curves are written in a small line-based format, one class per line:
+ *
+ *   # class   parameters (metres / exponent / linear gain)
+ *   ship      ref=1.5 rolloff=1.2 fade=25 far=50
+ *   space     ref=5   rolloff=0.8 fade=2000 far=5000 floor=0.02
+ *
+ *   gain(d) = 1                               d <= ref
+ *           = max((ref / d)^rolloff, floor)   ref < d
+ *   then faded out linearly in log-distance from `fade` to `far`; 0 beyond.
+ *
+ * Classes not mentioned keep their built-in defaults. Curves are baked into
+ * lookup tables indexed straight from the float's bit pattern (16 bins per
+ * octave, linear interpolation), so the audio-thread lookup is a handful of
+ * integer ops and one multiply-add: no pow or log.
+ */
+
+#include <cstddef>
+
+#include "zones.h"
+
+#define ROLLOFF_CONFIG_FILE "scda_rolloff.cfg"   /* in TeamSpeak's config directory */
+
+/* Field names avoid `near`/`far`, which windows.h defines away. */
+struct RolloffCurve {
+    float refDist;   /* ref: full volume up to here */
+    float rolloff;   /* rolloff: inverse-distance exponent beyond ref */
+    float fadeDist;  /* fade: start of the fade-out */
+    float maxDist;   /* far: silent from here on */
+    float minGain;   /* floor: lowest gain before the fade */
+};
+
+void rolloffDefaults(RolloffCurve curves[ZONE_CLASS_COUNT]);
+
+/*
+ * Parse `text` on top of `curves`. Returns false and describes the first
+ * problem in `err` (with its line number); `curves` may be partly updated then.
+ */
+bool rolloffParse(const char* text, RolloffCurve curves[ZONE_CLASS_COUNT], char* err, size_t errLen);
+
+/* Reference implementation the tables are baked from. */
+float rolloffAnalytic(const RolloffCurve& c, float distance);
+
+/* Bake and publish new tables; safe while audio threads are reading. */
+void rolloffBake(const RolloffCurve curves[ZONE_CLASS_COUNT]);
+
+/* Curves behind the active tables; false if nothing has been baked yet. */
+bool rolloffGetCurves(RolloffCurve curves[ZONE_CLASS_COUNT]);
+
+/*
+ * Defaults, then `path` on top if it exists, then bake. Returns false (and
+ * bakes defaults) if the file has errors; a missing file is not an error.
+ */
+bool rolloffLoadFile(const char* path, char* err, size_t errLen);
+
+/* Audio thread. Falls back to the unknown-class curve for out-of-range classes. */
+float rolloffGain(int zoneClass, float distance);
@@ -0,0 +1,133 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "send_scheduler.h"
+
+#include <atomic>
+#include <cmath>
+
+#define SCHED_DEFAULT_MAX_ERROR_M   0.5f
+#define SCHED_DEFAULT_HEARTBEAT_US  1000000ull
+#define SCHED_DEFAULT_MIN_GAP_US    50000ull
+/* Velocity smoothing; OCR positions are noisy, raw finite differences are not usable. */
+#define SCHED_VEL_ALPHA             0.4f
+/* Gaps longer than this (OCR stalled, zone loading) restart the estimate. */
+#define SCHED_VEL_MAX_DT_US         1000000ull
+
+static std::atomic<float>    cfgMaxError(SCHED_DEFAULT_MAX_ERROR_M);
+static std::atomic<uint64_t> cfgHeartbeat(SCHED_DEFAULT_HEARTBEAT_US);
+static std::atomic<uint64_t> cfgMinGap(SCHED_DEFAULT_MIN_GAP_US);
+
+/* Ingest-thread state: previous observation for the velocity estimate... */
+static bool     havePrev = false;
+static Pose     prev;
+static float    vel[3] = { 0.0f, 0.0f, 0.0f };
+
+/* ...and what receivers currently extrapolate from. */
+static bool     haveSent = false;
+static Pose     sent;
+static uint64_t sentAtUs = 0;
+
+static std::atomic<uint64_t> statSent(0);
+static std::atomic<uint64_t> statErrorSends(0);
+static std::atomic<uint64_t> statHeartbeats(0);
+static std::atomic<uint64_t> statForced(0);
+static std::atomic<uint64_t> statSuppressed(0);
+static std::atomic<uint64_t> statThrottled(0);
+
+void sendSchedulerDefaults(SendSchedulerConfig* out)
+{
+    out->maxErrorM = SCHED_DEFAULT_MAX_ERROR_M;
+    out->heartbeatUs = SCHED_DEFAULT_HEARTBEAT_US;
+    out->minGapUs = SCHED_DEFAULT_MIN_GAP_US;
+}
+
+void sendSchedulerConfigure(const SendSchedulerConfig& cfg)
+{
+    cfgMaxError.store(cfg.maxErrorM > 0.0f ? cfg.maxErrorM : SCHED_DEFAULT_MAX_ERROR_M, std::memory_order_relaxed);
+    cfgHeartbeat.store(cfg.heartbeatUs, std::memory_order_relaxed);
+    cfgMinGap.store(cfg.minGapUs, std::memory_order_relaxed);
+}
+
+void sendSchedulerGetConfig(SendSchedulerConfig* out)
+{
+    out->maxErrorM = cfgMaxError.load(std::memory_order_relaxed);
+    out->heartbeatUs = cfgHeartbeat.load(std::memory_order_relaxed);
+    out->minGapUs = cfgMinGap.load(std::memory_order_relaxed);
+}
+
+void sendSchedulerObserve(Pose* pose)
+{
+    if (havePrev && prev.zoneId == pose->zoneId && pose->captureUs > prev.captureUs
+        && pose->captureUs - prev.captureUs <= SCHED_VEL_MAX_DT_US) {
+        const float dt = (float)(pose->captureUs - prev.captureUs) * 1e-6f;
+        vel[0] += SCHED_VEL_ALPHA * ((float)(pose->x - prev.x) / dt - vel[0]);
+        vel[1] += SCHED_VEL_ALPHA * ((float)(pose->y - prev.y) / dt - vel[1]);
+        vel[2] += SCHED_VEL_ALPHA * ((float)(pose->z - prev.z) / dt - vel[2]);
+    }
+    else {
+        vel[0] = vel[1] = vel[2] = 0.0f;
+    }
+    prev = *pose;
+    havePrev = true;
+
+    /* A helper that already knows its velocity wins over our estimate. */
+    if (!(pose->flags & POSE_HAS_VELOCITY)) {
+        pose->vx = vel[0];
+        pose->vy = vel[1];
+        pose->vz = vel[2];
+        pose->flags |= POSE_HAS_VELOCITY;
+    }
+}
+
+/* Distance between `pose` and where receivers think we are right now. */
+static double predictionError(const Pose& pose)
+{
+    const double dt = pose.captureUs > sent.captureUs ? (double)(pose.captureUs - sent.captureUs) * 1e-6 : 0.0;
+    const double ex = pose.x - (sent.x + sent.vx * dt);
+    const double ey = pose.y - (sent.y + sent.vy * dt);
+    const double ez = pose.z - (sent.z + sent.vz * dt);
+    return std::sqrt(ex * ex + ey * ey + ez * ez);
+}
+
+SendDecision sendSchedulerDecide(const Pose& pose, uint64_t nowUs, bool forceKeyframe)
+{
+    SendDecision d;
+    if (!haveSent || forceKeyframe || pose.zoneId != sent.zoneId) d = SEND_FORCED;
+    else if (predictionError(pose) > cfgMaxError.load(std::memory_order_relaxed)) d = SEND_ERROR;
+    else if (nowUs - sentAtUs >= cfgHeartbeat.load(std::memory_order_relaxed)) d = SEND_HEARTBEAT;
+    else d = SEND_SUPPRESS;
+
+    if (d == SEND_SUPPRESS) {
+        statSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return d;
+    }
+    if (haveSent && nowUs - sentAtUs < cfgMinGap.load(std::memory_order_relaxed)) {
+        statThrottled.fetch_add(1, std::memory_order_relaxed);
+        return SEND_THROTTLE;
+    }
+
+    switch (d) {
+    case SEND_ERROR:     statErrorSends.fetch_add(1, std::memory_order_relaxed); break;
+    case SEND_HEARTBEAT: statHeartbeats.fetch_add(1, std::memory_order_relaxed); break;
+    default:             statForced.fetch_add(1, std::memory_order_relaxed); break;
+    }
+    return d;
+}
+
+void sendSchedulerCommit(const Pose& pose, uint64_t nowUs)
+{
+    sent = pose;
+    sentAtUs = nowUs;
+    haveSent = true;
+    statSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void sendSchedulerGetStats(SendSchedulerStats* out)
+{
+    out->sent = statSent.load(std::memory_order_relaxed);
+    out->errorSends = statErrorSends.load(std::memory_order_relaxed);
+    out->heartbeats = statHeartbeats.load(std::memory_order_relaxed);
+    out->forced = statForced.load(std::memory_order_relaxed);
+    out->suppressed = statSuppressed.load(std::memory_order_relaxed);
+    out->throttled = statThrottled.load(std::memory_order_relaxed);
+}
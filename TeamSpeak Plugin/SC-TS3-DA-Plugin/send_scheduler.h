@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Outgoing pose scheduler. Receivers dead-reckon peers from the last pose we
+ * sent (position + velocity * elapsed), so there is no point sending while
+ * that prediction is still within `maxErrorM` of where we really are. An
+ * update goes out when the prediction drifts too far, when a keyframe is due,
+ * or when `heartbeatUs` passes without one; never faster than `minGapUs`.
+ *
+ * Single-threaded (ingest thread) apart from the stats/config accessors.
+ */
+
+#include <cstdint>
+
+#include "pose.h"
+
+struct SendSchedulerConfig {
+    float    maxErrorM;     /* dead-reckoning error that triggers a send */
+    uint64_t heartbeatUs;   /* longest silence while standing still */
+    uint64_t minGapUs;      /* rate cap */
+};
+
+struct SendSchedulerStats {
+    uint64_t sent;          /* all updates let through */
+    uint64_t errorSends;    /* ...because the prediction drifted */
+    uint64_t heartbeats;    /* ...because nothing was sent for heartbeatUs */
+    uint64_t forced;        /* ...because the broadcaster needed a keyframe */
+    uint64_t suppressed;    /* prediction still good enough */
+    uint64_t throttled;     /* would have sent, but inside minGapUs */
+};
+
+enum SendDecision {
+    SEND_SUPPRESS = 0,
+    SEND_THROTTLE,
+    SEND_ERROR,
+    SEND_HEARTBEAT,
+    SEND_FORCED,
+};
+
+void sendSchedulerDefaults(SendSchedulerConfig* out);
+void sendSchedulerConfigure(const SendSchedulerConfig& cfg);
+void sendSchedulerGetConfig(SendSchedulerConfig* out);
+
+/*
+ * Estimate our velocity from the pose history and store it in `pose`
+ * (setting POSE_HAS_VELOCITY), so receivers can dead-reckon with it.
+ */
+void sendSchedulerObserve(Pose* pose);
+
+/* Decide whether `pose` goes out now. */
+SendDecision sendSchedulerDecide(const Pose& pose, uint64_t nowUs, bool forceKeyframe);
+
+/* The pose was actually sent: it is now what receivers extrapolate from. */
+void sendSchedulerCommit(const Pose& pose, uint64_t nowUs);
+
+void sendSchedulerGetStats(SendSchedulerStats* out);
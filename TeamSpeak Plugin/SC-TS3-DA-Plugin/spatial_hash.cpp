@@ -0,0 +1,307 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "spatial_hash.h"
+
+#include <cmath>
+#include <cstring>
+
+static_assert((SPATIAL_CELLS & (SPATIAL_CELLS - 1)) == 0, "SPATIAL_CELLS must be a power of two");
+static_assert(SPATIAL_CELLS >= 2 * SPATIAL_MAX_ENTRIES, "every entry may need its own cell; keep the load <= 0.5");
+
+#define CELL_MASK      (SPATIAL_CELLS - 1)
+#define CELL_COORD_MAX 0x3FFFFFFF   /* far beyond any zone; keeps neighbour arithmetic in range */
+#define SCAN_CELLS     (SPATIAL_CELLS / 4)  /* queries covering more cells than this walk the buckets instead */
+
+static inline unsigned bucketOf(uint32_t zoneId, const int32_t c[3])
+{
+    uint64_t h = (uint64_t)zoneId * 0x9E3779B97F4A7C15ull;
+    h ^= (uint64_t)(uint32_t)c[0] * 0xC2B2AE3D27D4EB4Full;
+    h ^= (uint64_t)(uint32_t)c[1] * 0x165667B19E3779F9ull;
+    h ^= (uint64_t)(uint32_t)c[2] * 0x27D4EB2F165667C5ull;
+    h ^= h >> 29;
+    return (unsigned)((h * 0x9E3779B97F4A7C15ull) >> 40) & CELL_MASK;
+}
+
+static inline bool sameCell(const SpatialCell& s, uint32_t zoneId, const int32_t c[3])
+{
+    return s.zoneId == zoneId && s.cell[0] == c[0] && s.cell[1] == c[1] && s.cell[2] == c[2];
+}
+
+static inline int32_t cellCoord(const SpatialHash* h, double v)
+{
+    const double c = std::floor(v * h->invCell);
+    if (!(c > -CELL_COORD_MAX)) return -CELL_COORD_MAX;  /* also NaN */
+    if (c > CELL_COORD_MAX) return CELL_COORD_MAX;
+    return (int32_t)c;
+}
+
+/* Bucket holding (zone, cell), or -1. */
+static int findCell(const SpatialHash* h, uint32_t zoneId, const int32_t c[3])
+{
+    unsigned b = bucketOf(zoneId, c);
+    for (int n = 0; n < SPATIAL_CELLS; n++) {
+        const SpatialCell& s = h->cells[b];
+        if (!s.count) return -1;
+        if (sameCell(s, zoneId, c)) return (int)b;
+        b = (b + 1) & CELL_MASK;
+    }
+    return -1;
+}
+
+static void cellLink(SpatialHash* h, int id)
+{
+    SpatialEntry& e = h->entry[id];
+    unsigned b = bucketOf(e.zoneId, e.cell);
+    unsigned probe = 0;
+    for (; h->cells[b].count && !sameCell(h->cells[b], e.zoneId, e.cell); b = (b + 1) & CELL_MASK) probe++;
+    SpatialCell& s = h->cells[b];
+    if (!s.count) {
+        s.zoneId = e.zoneId;
+        memcpy(s.cell, e.cell, sizeof(s.cell));
+        s.head = -1;
+        h->stats.cells++;
+        for (int a = 0; a < 3; a++) {
+            if (e.cell[a] < h->lo[a]) h->lo[a] = e.cell[a];
+            if (e.cell[a] > h->hi[a]) h->hi[a] = e.cell[a];
+        }
+        if (probe > h->stats.maxProbe) h->stats.maxProbe = probe;
+    }
+    e.prev = -1;
+    e.next = s.head;
+    if (s.head >= 0) h->entry[s.head].prev = id;
+    s.head = id;
+    s.count++;
+}
+
+static void cellUnlink(SpatialHash* h, int id)
+{
+    SpatialEntry& e = h->entry[id];
+    const int b = findCell(h, e.zoneId, e.cell);
+    if (b < 0) return;
+    SpatialCell& s = h->cells[b];
+    if (e.prev >= 0) h->entry[e.prev].next = e.next;
+    else s.head = e.next;
+    if (e.next >= 0) h->entry[e.next].prev = e.prev;
+    if (--s.count) return;
+
+    /* Backward-shift deletion, as in the client table. */
+    unsigned hole = (unsigned)b;
+    unsigned j = hole;
+    for (;;) {
+        j = (j + 1) & CELL_MASK;
+        const SpatialCell& w = h->cells[j];
+        if (!w.count) break;
+        const unsigned home = bucketOf(w.zoneId, w.cell);
+        const bool stays = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+        if (!stays) {
+            h->cells[hole] = w;
+            hole = j;
+        }
+    }
+    h->cells[hole].count = 0;
+    h->stats.cells--;
+}
+
+void spatialHashInit(SpatialHash* h, float cellM)
+{
+    memset(h, 0, sizeof(*h));
+    h->cellM = cellM > 0.01f ? cellM : 0.01f;
+    h->invCell = 1.0 / h->cellM;
+    for (int a = 0; a < 3; a++) {
+        h->lo[a] = CELL_COORD_MAX;
+        h->hi[a] = -CELL_COORD_MAX;
+    }
+}
+
+void spatialHashUpdate(SpatialHash* h, int id, uint32_t zoneId, const double pos[3])
+{
+    if (id < 0 || id >= SPATIAL_MAX_ENTRIES) return;
+    SpatialEntry& e = h->entry[id];
+    int32_t c[3];
+    for (int a = 0; a < 3; a++) c[a] = cellCoord(h, pos[a]);
+    if (e.live && e.zoneId == zoneId && e.cell[0] == c[0] && e.cell[1] == c[1] && e.cell[2] == c[2]) {
+        memcpy(e.pos, pos, sizeof(e.pos));
+        h->stats.updates++;
+        return;
+    }
+    if (e.live) {
+        cellUnlink(h, id);
+        h->stats.moves++;
+    }
+    else {
+        h->stats.entries++;
+        h->stats.inserts++;
+    }
+    e.live = true;
+    e.zoneId = zoneId;
+    memcpy(e.cell, c, sizeof(e.cell));
+    memcpy(e.pos, pos, sizeof(e.pos));
+    cellLink(h, id);
+}
+
+void spatialHashRemove(SpatialHash* h, int id)
+{
+    if (id < 0 || id >= SPATIAL_MAX_ENTRIES || !h->entry[id].live) return;
+    cellUnlink(h, id);
+    h->entry[id].live = false;
+    h->stats.entries--;
+    h->stats.removes++;
+}
+
+static inline double dist2(const double a[3], const double b[3])
+{
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+/* Calls f(id, d2) for every entry of one occupied cell. */
+template <typename F>
+static inline void forCell(const SpatialHash* h, const SpatialCell& s, const double pos[3], F f)
+{
+    for (int id = s.head; id >= 0; id = h->entry[id].next) f(id, dist2(h->entry[id].pos, pos));
+}
+
+template <typename F>
+static inline void forCellAt(const SpatialHash* h, uint32_t zoneId, const int32_t c[3], const double pos[3], F f)
+{
+    const int b = findCell(h, zoneId, c);
+    if (b >= 0) forCell(h, h->cells[b], pos, f);
+}
+
+/* Every occupied cell of the zone within the cube lo..hi. */
+template <typename F>
+static void forOccupied(const SpatialHash* h, uint32_t zoneId, const int32_t lo[3], const int32_t hi[3], const double pos[3], F f)
+{
+    for (int b = 0; b < SPATIAL_CELLS; b++) {
+        const SpatialCell& s = h->cells[b];
+        if (!s.count || s.zoneId != zoneId) continue;
+        if (s.cell[0] < lo[0] || s.cell[0] > hi[0] || s.cell[1] < lo[1] || s.cell[1] > hi[1]
+            || s.cell[2] < lo[2] || s.cell[2] > hi[2]) continue;
+        forCell(h, s, pos, f);
+    }
+}
+
+int spatialHashRadius(SpatialHash* h, uint32_t zoneId, const double pos[3], float radius, int exclude,
+                      SpatialHit* out, int max)
+{
+    h->stats.queries++;
+    if (max <= 0 || !(radius >= 0.0f)) return 0;
+    int32_t lo[3], hi[3];
+    double span = 1.0;
+    for (int a = 0; a < 3; a++) {
+        lo[a] = cellCoord(h, pos[a] - radius);
+        hi[a] = cellCoord(h, pos[a] + radius);
+        if (lo[a] < h->lo[a]) lo[a] = h->lo[a];
+        if (hi[a] > h->hi[a]) hi[a] = h->hi[a];
+        if (lo[a] > hi[a]) return 0;
+        span *= (double)hi[a] - lo[a] + 1.0;
+    }
+
+    const double r2 = (double)radius * radius;
+    int n = 0;
+    auto take = [&](int id, double d2) {
+        if (d2 <= r2 && id != exclude && n < max) {
+            out[n].id = id;
+            out[n].dist = (float)std::sqrt(d2);
+            n++;
+        }
+    };
+    if (span > SCAN_CELLS) {
+        h->stats.fallbacks++;
+        forOccupied(h, zoneId, lo, hi, pos, take);
+        return n;
+    }
+    int32_t c[3];
+    for (c[0] = lo[0]; c[0] <= hi[0]; c[0]++) {
+        for (c[1] = lo[1]; c[1] <= hi[1]; c[1]++) {
+            for (c[2] = lo[2]; c[2] <= hi[2]; c[2]++) forCellAt(h, zoneId, c, pos, take);
+        }
+    }
+    return n;
+}
+
+int spatialHashNearest(SpatialHash* h, uint32_t zoneId, const double pos[3], int k, float maxRadius, int exclude,
+                       SpatialHit* out)
+{
+    h->stats.queries++;
+    if (k > SPATIAL_MAX_K) k = SPATIAL_MAX_K;
+    if (k <= 0 || !(maxRadius >= 0.0f) || !h->stats.cells) return 0;
+
+    /* Kept sorted by squared distance; k is small enough for insertion. */
+    double best[SPATIAL_MAX_K];
+    const double r2 = (double)maxRadius * maxRadius;
+    int n = 0;
+    auto take = [&](int id, double d2) {
+        if (d2 > r2 || id == exclude || (n == k && d2 >= best[n - 1])) return;
+        int i = n < k ? n++ : n - 1;
+        for (; i > 0 && best[i - 1] > d2; i--) {
+            best[i] = best[i - 1];
+            out[i] = out[i - 1];
+        }
+        best[i] = d2;
+        out[i].id = id;
+    };
+
+    int32_t center[3];
+    for (int a = 0; a < 3; a++) center[a] = cellCoord(h, pos[a]);
+    const double rings = std::ceil((double)maxRadius * h->invCell);
+    const int maxRing = rings < 1024.0 ? (int)rings : 1024;
+    for (int d = 0; d <= maxRing; d++) {
+        /* Shell d, clipped to where cells have ever been. */
+        int32_t lo[3], hi[3];
+        double volume = 1.0;
+        for (int a = 0; a < 3; a++) {
+            lo[a] = center[a] - d > h->lo[a] ? center[a] - d : h->lo[a];
+            hi[a] = center[a] + d < h->hi[a] ? center[a] + d : h->hi[a];
+            volume *= lo[a] <= hi[a] ? (double)hi[a] - lo[a] + 1.0 : 0.0;
+        }
+        /* Cheaper to walk the table than yet another shell of mostly empty cells. */
+        if (volume > SCAN_CELLS) {
+            h->stats.fallbacks++;
+            for (int a = 0; a < 3; a++) {
+                lo[a] = cellCoord(h, pos[a] - maxRadius);
+                hi[a] = cellCoord(h, pos[a] + maxRadius);
+            }
+            n = 0;
+            forOccupied(h, zoneId, lo, hi, pos, take);
+            break;
+        }
+        if (volume > 0.0) {
+            int32_t c[3];
+            for (c[0] = lo[0]; c[0] <= hi[0]; c[0]++) {
+                const bool edgeX = c[0] == center[0] - d || c[0] == center[0] + d;
+                for (c[1] = lo[1]; c[1] <= hi[1]; c[1]++) {
+                    if (edgeX || c[1] == center[1] - d || c[1] == center[1] + d) {
+                        for (c[2] = lo[2]; c[2] <= hi[2]; c[2]++) forCellAt(h, zoneId, c, pos, take);
+                        continue;
+                    }
+                    c[2] = center[2] - d;
+                    if (c[2] >= lo[2]) forCellAt(h, zoneId, c, pos, take);
+                    c[2] = center[2] + d;
+                    if (d && c[2] <= hi[2]) forCellAt(h, zoneId, c, pos, take);
+                }
+            }
+        }
+
+        /* The next shell is no closer than the nearest face of this cube that still has cells beyond it. */
+        double reach = -1.0;
+        for (int a = 0; a < 3; a++) {
+            if (center[a] - d > h->lo[a]) {
+                const double f = pos[a] - (double)(center[a] - d) * h->cellM;
+                if (reach < 0.0 || f < reach) reach = f;
+            }
+            if (center[a] + d < h->hi[a]) {
+                const double f = (double)(center[a] + d + 1) * h->cellM - pos[a];
+                if (reach < 0.0 || f < reach) reach = f;
+            }
+        }
+        if (reach < 0.0 || reach > maxRadius || (n == k && best[k - 1] <= reach * reach)) break;
+    }
+    for (int i = 0; i < n; i++) out[i].dist = (float)std::sqrt(best[i]);
+    return n;
+}
+
+void spatialHashGetStats(const SpatialHash* h, SpatialHashStats* out)
+{
+    *out = h->stats;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ * Uniform-grid spatial hash answering "who is within R metres" and "who are
+ * my k nearest" without scanning every client.
+ *
+ * Entries are small integer ids (client table slots in the plugin) with a
+ * zone id and a zone-relative position. Space is cut into cubes of `cellM`
+ * metres; the cells that hold anyone live in an open-addressing table keyed
+ * by (zone, cell), and each cell threads its entries through an intrusive
+ * doubly linked list, so moving within a cell is a store and moving to
+ * another cell is an unlink and a link, never a rebuild.
+ *
+ * Radius queries visit the cells overlapping the query cube; k-nearest
+ * queries visit shells of cells outward from the query's cell and stop once
+ * the k-th best is closer than the next shell can be. Either falls back to
+ * walking the whole cell table once the query would cover more cells than
+ * that costs.
+ *
+ * An instance is owned by one thread; nothing here is atomic. No allocation:
+ * the storage is the struct itself.
+ */
+
+#include <cstdint>
+
+#define SPATIAL_MAX_ENTRIES 1024
+#define SPATIAL_CELLS       2048     /* power of two, >= 2 * SPATIAL_MAX_ENTRIES */
+#define SPATIAL_MAX_K       64
+
+struct SpatialHit {
+    int   id;
+    float dist;
+};
+
+struct SpatialHashStats {
+    int      entries;
+    int      cells;         /* occupied */
+    uint64_t inserts;
+    uint64_t moves;         /* updates that changed cell or zone */
+    uint64_t updates;       /* ...that stayed in their cell */
+    uint64_t removes;
+    uint64_t queries;
+    uint64_t fallbacks;     /* queries that walked the occupied cells instead */
+    unsigned maxProbe;
+};
+
+struct SpatialEntry {
+    bool     live;
+    uint32_t zoneId;
+    int32_t  cell[3];
+    double   pos[3];
+    int      next, prev;    /* within the cell, -1 terminated */
+};
+
+struct SpatialCell {
+    int      count;         /* 0 = empty bucket */
+    uint32_t zoneId;
+    int32_t  cell[3];
+    int      head;
+};
+
+struct SpatialHash {
+    float            cellM;
+    double           invCell;
+    int32_t          lo[3], hi[3];  /* bounds of every cell ever occupied; queries clip to them */
+    SpatialEntry     entry[SPATIAL_MAX_ENTRIES];
+    SpatialCell      cells[SPATIAL_CELLS];
+    SpatialHashStats stats;
+};
+
+/* Empty the hash and set its cell size (about twice the typical query radius). */
+void spatialHashInit(SpatialHash* h, float cellM);
+
+/* Insert `id` or move it; ids outside [0, SPATIAL_MAX_ENTRIES) are ignored. */
+void spatialHashUpdate(SpatialHash* h, int id, uint32_t zoneId, const double pos[3]);
+void spatialHashRemove(SpatialHash* h, int id);
+
+/* Entries of `zoneId` within `radius` of `pos`, except `exclude` (-1: none), unordered; returns how many were written. */
+int spatialHashRadius(SpatialHash* h, uint32_t zoneId, const double pos[3], float radius, int exclude,
+                      SpatialHit* out, int max);
+
+/* Up to `k` (<= SPATIAL_MAX_K) nearest entries of `zoneId` within `maxRadius`, nearest first. */
+int spatialHashNearest(SpatialHash* h, uint32_t zoneId, const double pos[3], int k, float maxRadius, int exclude,
+                       SpatialHit* out);
+
+void spatialHashGetStats(const SpatialHash* h, SpatialHashStats* out);
@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ * Bounded wait-free single-producer / single-consumer ring.
+ *
+ * One thread may call push(), one (other) thread may call pop(). Neither side
+ * ever blocks or allocates: push() fails and counts an overflow when the ring
+ * is full, pop() fails when it is empty. Capacity must be a power of two.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#define SCDA_CACHELINE 64
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), overflows(0) {}
+
+    /* Producer side. */
+    bool push(const T& v)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Capacity) {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[t & (Capacity - 1)] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer side. */
+    bool pop(T* out)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        *out = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Approximate; safe to call from any thread. */
+    size_t size() const
+    {
+        const uint64_t t = tail.load(std::memory_order_acquire);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        return (size_t)(t - h);
+    }
+    uint64_t pushed() const { return tail.load(std::memory_order_relaxed); }
+    uint64_t overflowed() const { return overflows.load(std::memory_order_relaxed); }
+
+    static size_t capacity() { return Capacity; }
+
+private:
+    alignas(SCDA_CACHELINE) std::atomic<uint64_t> head;  /* written by consumer */
+    alignas(SCDA_CACHELINE) std::atomic<uint64_t> tail;  /* written by producer */
+    std::atomic<uint64_t> overflows;                      /* written by producer */
+    alignas(SCDA_CACHELINE) T items[Capacity];
+};
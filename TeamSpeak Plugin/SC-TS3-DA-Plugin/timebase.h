@@ -0,0 +1,19 @@
+#pragma once
+
+/*
+ * Monotonic microsecond clock shared by the plugin and SCTS3DA.exe.
+ *
+ * steady_clock is QueryPerformanceCounter on MSVC and CLOCK_MONOTONIC on
+ * Linux, which is the same clock .NET's Stopwatch.GetTimestamp() reads, so
+ * capture timestamps written by the helper can be compared directly with
+ * values taken here.
+ */
+
+#include <chrono>
+#include <cstdint>
+
+static inline uint64_t monoNowUs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,280 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "trajectory.h"
+
+#include <atomic>
+#include <cstring>
+
+#define TRAJ_READ_RETRIES       4
+#define TRAJ_DEFAULT_INTERVAL_US 50000ll   /* until a peer's own rate is known */
+#define TRAJ_JITTER_US          10000ll    /* playout margin over the update interval */
+#define TRAJ_OFFSET_CREEP_US    50ll       /* per pose; lets the clock offset follow drift */
+#define TRAJ_SNAP_M             5.0        /* corrections larger than this are a teleport: jump */
+
+struct TrajSample {
+    uint64_t tUs;        /* sender's captureUs */
+    double   pos[3];
+    float    vel[3];
+    uint8_t  flags;
+};
+
+struct alignas(64) TrajSlot {
+    std::atomic<uint32_t> seq;  /* odd while writing */
+    uint64_t   key;
+    uint32_t   zoneId;
+    int        count;
+    int        head;            /* newest at head - 1 */
+    int64_t    offsetUs;        /* our clock minus the sender's, fastest delivery seen */
+    int64_t    delayUs;         /* playout delay */
+    TrajSample s[TRAJ_HISTORY];
+    int64_t    intervalUs;      /* event thread only: smoothed update interval */
+};
+
+/* Playback thread's copy of a slot, oldest pose first, and what it last rendered. */
+struct TrajView {
+    uint32_t   seq;
+    uint64_t   key;
+    uint32_t   zoneId;
+    int        count;
+    int64_t    offsetUs;
+    int64_t    delayUs;
+    TrajSample s[TRAJ_HISTORY];
+    bool       haveOut;
+    uint64_t   outUs;
+    double     out[3];
+    float      outVel[3];
+    double     err[3];          /* correction being faded out */
+    uint64_t   errUs;
+};
+
+enum TrajKind { TRAJ_INTERPOLATED, TRAJ_EXTRAPOLATED, TRAJ_HELD };
+
+static TrajSlot slots[CLIENT_TABLE_CAPACITY];
+static TrajView views[CLIENT_TABLE_CAPACITY];
+
+static std::atomic<uint64_t> statPushes(0);
+static std::atomic<uint64_t> statResets(0);
+static std::atomic<uint64_t> statInterpolated(0);
+static std::atomic<uint64_t> statExtrapolated(0);
+static std::atomic<uint64_t> statHeld(0);
+static std::atomic<uint64_t> statBlends(0);
+
+void trajectoryPush(int slot, uint64_t key, const Pose& pose)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return;
+    TrajSlot& s = slots[slot];
+    const int64_t sampleOffset = (int64_t)(pose.receiveUs - pose.captureUs);
+    bool reset = s.key != key || s.count == 0 || s.zoneId != pose.zoneId;
+    int64_t offset = s.key == key ? s.offsetUs + TRAJ_OFFSET_CREEP_US : sampleOffset;
+    if (sampleOffset < offset) offset = sampleOffset;
+    int64_t interval = s.intervalUs;
+    if (!reset) {
+        const TrajSample& last = s.s[(s.head + TRAJ_HISTORY - 1) % TRAJ_HISTORY];
+        if (pose.captureUs <= last.tUs) return;
+        const uint64_t gap = pose.captureUs - last.tUs;
+        if (gap > TRAJ_STALE_US) reset = true;
+        /* Heartbeats of a peer standing still say nothing about how fast it updates while moving. */
+        else if (gap <= TRAJ_MAX_DELAY_US) interval += ((int64_t)gap - interval) / 4;
+    }
+    if (reset) {
+        if (s.key != key) interval = TRAJ_DEFAULT_INTERVAL_US;
+        statResets.fetch_add(1, std::memory_order_relaxed);
+    }
+    int64_t delay = interval + TRAJ_JITTER_US;
+    if (delay < (int64_t)TRAJ_MIN_DELAY_US) delay = (int64_t)TRAJ_MIN_DELAY_US;
+    if (delay > (int64_t)TRAJ_MAX_DELAY_US) delay = (int64_t)TRAJ_MAX_DELAY_US;
+
+    const uint32_t q = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(q + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (reset) s.count = s.head = 0;
+    s.key = key;
+    s.zoneId = pose.zoneId;
+    s.offsetUs = offset;
+    s.delayUs = delay;
+    TrajSample& n = s.s[s.head];
+    n.tUs = pose.captureUs;
+    n.pos[0] = pose.x;
+    n.pos[1] = pose.y;
+    n.pos[2] = pose.z;
+    n.vel[0] = pose.vx;
+    n.vel[1] = pose.vy;
+    n.vel[2] = pose.vz;
+    n.flags = pose.flags;
+    s.head = (s.head + 1) % TRAJ_HISTORY;
+    if (s.count < TRAJ_HISTORY) s.count++;
+    s.seq.store(q + 2, std::memory_order_release);
+    s.intervalUs = interval;
+    statPushes.fetch_add(1, std::memory_order_relaxed);
+}
+
+/* Copy the slot into `v` if it changed; false if the writer kept it busy (the old copy stays). */
+static bool refresh(int slot, TrajView* v)
+{
+    const TrajSlot& s = slots[slot];
+    const uint32_t q = s.seq.load(std::memory_order_acquire);
+    if (q == v->seq) return true;
+    for (int i = 0; i < TRAJ_READ_RETRIES; i++) {
+        const uint32_t q1 = i ? s.seq.load(std::memory_order_acquire) : q;
+        if (q1 & 1u) continue;
+        TrajView t;
+        t.key = s.key;
+        t.zoneId = s.zoneId;
+        t.count = s.count;
+        t.offsetUs = s.offsetUs;
+        t.delayUs = s.delayUs;
+        const int head = s.head;
+        if (t.count < 0 || t.count > TRAJ_HISTORY || head < 0 || head >= TRAJ_HISTORY) continue;
+        for (int k = 0; k < t.count; k++) t.s[k] = s.s[(head + TRAJ_HISTORY - t.count + k) % TRAJ_HISTORY];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != q1) continue;
+
+        v->seq = q1;
+        v->key = t.key;
+        v->zoneId = t.zoneId;
+        v->count = t.count;
+        v->offsetUs = t.offsetUs;
+        v->delayUs = t.delayUs;
+        memcpy(v->s, t.s, sizeof(TrajSample) * (size_t)t.count);
+        return true;
+    }
+    return false;
+}
+
+/* Tangent at pose k: the sender's velocity, else the Catmull-Rom slope through its neighbours. */
+static void tangent(const TrajView& v, int k, double m[3])
+{
+    const TrajSample& s = v.s[k];
+    if (s.flags & POSE_HAS_VELOCITY) {
+        for (int a = 0; a < 3; a++) m[a] = s.vel[a];
+        return;
+    }
+    const int lo = k > 0 ? k - 1 : k, hi = k + 1 < v.count ? k + 1 : k;
+    m[0] = m[1] = m[2] = 0.0;
+    if (lo == hi) return;
+    const double dt = (double)(v.s[hi].tUs - v.s[lo].tUs) * 1e-6;
+    for (int a = 0; a < 3; a++) m[a] = (v.s[hi].pos[a] - v.s[lo].pos[a]) / dt;
+}
+
+/* Position and velocity at sender time `t`. */
+static TrajKind evaluate(const TrajView& v, int64_t t, double pos[3], float vel[3])
+{
+    const TrajSample& newest = v.s[v.count - 1];
+    if (t >= (int64_t)newest.tUs) {
+        double m[3];
+        tangent(v, v.count - 1, m);
+        const int64_t ahead = t - (int64_t)newest.tUs;
+        const bool held = ahead > (int64_t)TRAJ_MAX_EXTRAP_US;
+        const double dt = (double)(held ? (int64_t)TRAJ_MAX_EXTRAP_US : ahead) * 1e-6;
+        for (int a = 0; a < 3; a++) {
+            pos[a] = newest.pos[a] + m[a] * dt;
+            vel[a] = held ? 0.0f : (float)m[a];
+        }
+        return held ? TRAJ_HELD : TRAJ_EXTRAPOLATED;
+    }
+    if (t <= (int64_t)v.s[0].tUs) {
+        for (int a = 0; a < 3; a++) {
+            pos[a] = v.s[0].pos[a];
+            vel[a] = 0.0f;
+        }
+        return TRAJ_HELD;
+    }
+
+    int k = v.count - 2;
+    while (k > 0 && (int64_t)v.s[k].tUs > t) k--;
+    const TrajSample& p0 = v.s[k];
+    const TrajSample& p1 = v.s[k + 1];
+    double m0[3], m1[3];
+    tangent(v, k, m0);
+    tangent(v, k + 1, m1);
+    const double h = (double)(p1.tUs - p0.tUs) * 1e-6;
+    const double u = (double)(t - (int64_t)p0.tUs) * 1e-6 / h;
+    const double u2 = u * u, u3 = u2 * u;
+    const double h00 = 2.0 * u3 - 3.0 * u2 + 1.0, h10 = u3 - 2.0 * u2 + u;
+    const double h01 = 3.0 * u2 - 2.0 * u3, h11 = u3 - u2;
+    const double d00 = 6.0 * (u2 - u), d10 = 3.0 * u2 - 4.0 * u + 1.0, d11 = 3.0 * u2 - 2.0 * u;
+    for (int a = 0; a < 3; a++) {
+        pos[a] = h00 * p0.pos[a] + h10 * h * m0[a] + h01 * p1.pos[a] + h11 * h * m1[a];
+        vel[a] = (float)(d00 * (p0.pos[a] - p1.pos[a]) / h + d10 * m0[a] + d11 * m1[a]);
+    }
+    return TRAJ_INTERPOLATED;
+}
+
+bool trajectoryEval(int slot, uint64_t key, uint64_t nowUs, Pose* pose)
+{
+    if (slot < 0 || slot >= CLIENT_TABLE_CAPACITY) return false;
+    TrajView& v = views[slot];
+    const uint32_t seen = v.seq;
+    const uint64_t prevKey = v.key;
+    const uint32_t prevZone = v.zoneId;
+    refresh(slot, &v);
+    if (v.key != key || v.count == 0 || v.zoneId != pose->zoneId) {
+        v.haveOut = false;
+        return false;
+    }
+    if (prevKey != key) v.haveOut = false;
+
+    const int64_t t = (int64_t)nowUs - v.offsetUs - v.delayUs;
+    double pos[3];
+    float vel[3];
+    const TrajKind kind = evaluate(v, t, pos, vel);
+
+    /* A new pose moved the curve under us: start from where we were heading and fade the difference. */
+    if (v.seq != seen && v.haveOut && v.zoneId == prevZone && nowUs >= v.outUs && nowUs - v.outUs < TRAJ_BLEND_US) {
+        const double dt = (double)(nowUs - v.outUs) * 1e-6;
+        double e2 = 0.0;
+        for (int a = 0; a < 3; a++) {
+            v.err[a] = v.out[a] + v.outVel[a] * dt - pos[a];
+            e2 += v.err[a] * v.err[a];
+        }
+        if (e2 < TRAJ_SNAP_M * TRAJ_SNAP_M) {
+            v.errUs = nowUs;
+            statBlends.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            v.errUs = 0;
+        }
+    }
+    else if (!v.haveOut || v.zoneId != prevZone) {
+        v.errUs = 0;
+    }
+    if (v.errUs && nowUs >= v.errUs && nowUs - v.errUs < TRAJ_BLEND_US) {
+        const double fade = 1.0 - (double)(nowUs - v.errUs) / (double)TRAJ_BLEND_US;
+        for (int a = 0; a < 3; a++) {
+            pos[a] += v.err[a] * fade;
+            vel[a] -= (float)(v.err[a] / ((double)TRAJ_BLEND_US * 1e-6));
+        }
+    }
+
+    v.haveOut = true;
+    v.outUs = nowUs;
+    for (int a = 0; a < 3; a++) {
+        v.out[a] = pos[a];
+        v.outVel[a] = vel[a];
+    }
+    pose->x = pos[0];
+    pose->y = pos[1];
+    pose->z = pos[2];
+    pose->vx = vel[0];
+    pose->vy = vel[1];
+    pose->vz = vel[2];
+    pose->flags |= POSE_HAS_VELOCITY;
+    pose->captureUs = (uint64_t)t;
+
+    switch (kind) {
+    case TRAJ_INTERPOLATED: statInterpolated.fetch_add(1, std::memory_order_relaxed); break;
+    case TRAJ_EXTRAPOLATED: statExtrapolated.fetch_add(1, std::memory_order_relaxed); break;
+    default:                statHeld.fetch_add(1, std::memory_order_relaxed); break;
+    }
+    return true;
+}
+
+void trajectoryGetStats(TrajectoryStats* out)
+{
+    out->pushes = statPushes.load(std::memory_order_relaxed);
+    out->resets = statResets.load(std::memory_order_relaxed);
+    out->interpolated = statInterpolated.load(std::memory_order_relaxed);
+    out->extrapolated = statExtrapolated.load(std::memory_order_relaxed);
+    out->held = statHeld.load(std::memory_order_relaxed);
+    out->blends = statBlends.load(std::memory_order_relaxed);
+}
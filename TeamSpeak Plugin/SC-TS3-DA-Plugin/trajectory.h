@@ -0,0 +1,57 @@
+#pragma once
+
+/*
+ * Audio-rate positions for remote peers. Poses arrive at 5-20 Hz (less while
+ * a peer stands still: the sender only updates when dead reckoning drifts),
+ * audio blocks every 10 ms; rendering each block from the latest pose makes
+ * a moving talker jump by a metre at a time.
+ *
+ * Every peer keeps its last TRAJ_HISTORY poses, timestamped on the sender's
+ * clock. Their offset to ours is the smallest (receiveUs - captureUs) seen,
+ * i.e. the fastest delivery, creeping upward slowly so clock drift cannot
+ * pin it. Blocks are rendered a short playout delay in the past (about one
+ * update interval, measured per peer), where the history usually brackets
+ * the render time: the position is a cubic Hermite between the two poses,
+ * with the sender's velocities (or Catmull-Rom slopes) as tangents. When the
+ * next pose is late the newest one is dead-reckoned forward for at most
+ * TRAJ_MAX_EXTRAP_US and then held. When a new pose disagrees with what was
+ * being rendered, the difference is faded out over TRAJ_BLEND_US instead of
+ * jumping.
+ *
+ * The event thread pushes (one seqlock per slot, as in peer_pose.h); the
+ * playback thread evaluates from its own copy, refreshed only when the slot's
+ * sequence changes, so neither ever waits for the other.
+ */
+
+#include <cstdint>
+
+#include "client_table.h"
+#include "pose.h"
+
+#define TRAJ_HISTORY        4
+#define TRAJ_MIN_DELAY_US   20000ull    /* playout delay bounds */
+#define TRAJ_MAX_DELAY_US   150000ull
+#define TRAJ_MAX_EXTRAP_US  250000ull   /* dead reckoning past the newest pose, then hold */
+#define TRAJ_BLEND_US       100000ull   /* correction fade after a surprising update */
+#define TRAJ_STALE_US       2500000ull  /* a gap longer than this restarts the history (heartbeats are 1 s) */
+
+struct TrajectoryStats {
+    uint64_t pushes;
+    uint64_t resets;        /* history restarted: new client, zone change, long gap */
+    uint64_t interpolated;  /* evaluations between two poses */
+    uint64_t extrapolated;  /* ...past the newest pose, within TRAJ_MAX_EXTRAP_US */
+    uint64_t held;          /* ...beyond it, or before the oldest */
+    uint64_t blends;        /* corrections faded in */
+};
+
+/* Event thread: a new pose for `slot`. Duplicates and older poses are ignored. */
+void trajectoryPush(int slot, uint64_t key, const Pose& pose);
+
+/*
+ * Playback thread: replace the position (and velocity and captureUs) of
+ * `pose`, the peer's latest, with the trajectory's at `nowUs`. False if there
+ * is no history for this client; `pose` is left untouched then.
+ */
+bool trajectoryEval(int slot, uint64_t key, uint64_t nowUs, Pose* pose);
+
+void trajectoryGetStats(TrajectoryStats* out);
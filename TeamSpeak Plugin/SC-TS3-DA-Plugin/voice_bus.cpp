@@ -0,0 +1,165 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "voice_bus.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "dsp.h"
+
+struct Voice {
+    uint64_t        sch;
+    uint32_t        age;    /* mixed blocks since capture */
+    int             slot;
+    uint64_t        key;
+    VoiceParams     params;
+};
+
+static Voice voices[VOICE_BUS_MAX_VOICES];
+/* Indexed by voice; a voice keeps its block while it waits for its connection's mix. */
+alignas(32) static float monoBlocks[VOICE_BUS_MAX_VOICES][PANNER_MAX_FRAMES];
+static int blockOf[VOICE_BUS_MAX_VOICES];
+static bool blockUsed[VOICE_BUS_MAX_VOICES];
+alignas(32) static float busL[PANNER_MAX_FRAMES];
+alignas(32) static float busR[PANNER_MAX_FRAMES];
+static int voiceCount = 0;
+static int mixFrames = 0;   /* size of the last mixed block; 0 until the first one */
+
+static std::atomic<uint64_t> statCycles(0);
+static std::atomic<uint64_t> statVoices(0);
+static std::atomic<uint64_t> statFallbacks(0);
+static std::atomic<uint64_t> statDropped(0);
+static std::atomic<uint32_t> statMaxVoices(0);
+
+bool voiceBusCapture(uint64_t sch, int slot, uint64_t key, const VoiceParams& params,
+                     short* samples, int frames, int channels,
+                     const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    if (frames != mixFrames || frames > PANNER_MAX_FRAMES || voiceCount >= VOICE_BUS_MAX_VOICES
+        || channels > 32 || !channelFillMask || !*channelFillMask) {
+        statFallbacks.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    /* One voice per slot and cycle; a repeat means the cycle boundary was missed. */
+    for (int i = 0; i < voiceCount; i++) {
+        if (voices[i].slot == slot) {
+            statFallbacks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    int b = 0;
+    while (blockUsed[b]) b++;  /* voiceCount < max, so one is free */
+    blockUsed[b] = true;
+    blockOf[voiceCount] = b;
+    Voice& v = voices[voiceCount];
+    v.sch = sch;
+    v.age = 0;
+    v.slot = slot;
+    v.key = key;
+    v.params = params;
+    dspKernels()->toMono(samples, frames, channels, *channelFillMask, monoBlocks[b]);
+    voiceCount++;
+
+    /* We mix it ourselves. */
+    *channelFillMask = 0;
+    return true;
+}
+
+/* Take this connection's voices out of the list; age and expire everyone else's. */
+static int collect(uint64_t sch, int frames, Voice* mine, float** blocks)
+{
+    int n = 0, kept = 0;
+    for (int i = 0; i < voiceCount; i++) {
+        Voice& v = voices[i];
+        const int b = blockOf[i];
+        if (v.sch == sch && frames == mixFrames) {
+            mine[n] = v;
+            blocks[n] = monoBlocks[b];
+            blockUsed[b] = false;  /* still valid until the next capture */
+            n++;
+        }
+        else if (v.sch == sch || ++v.age > VOICE_BUS_MAX_AGE) {
+            blockUsed[b] = false;
+            statDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            blockOf[kept] = b;
+            voices[kept++] = v;
+        }
+    }
+    voiceCount = kept;
+    return n;
+}
+
+void voiceBusMix(uint64_t sch, float* const* planes, int frames, int channels,
+                 const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
+{
+    Voice mine[VOICE_BUS_MAX_VOICES];
+    float* blocks[VOICE_BUS_MAX_VOICES];
+    const int n = collect(sch, frames, mine, blocks);
+    mixFrames = frames;
+    if (!planes || !channelFillMask || frames > PANNER_MAX_FRAMES) return;
+
+    /* Spatial voices fill the arrays from the front, radio voices from the back. */
+    int slots[VOICE_BUS_MAX_VOICES];
+    uint64_t keys[VOICE_BUS_MAX_VOICES];
+    OcclusionParams occ[VOICE_BUS_MAX_VOICES];
+    float* sorted[VOICE_BUS_MAX_VOICES];
+    const VoiceParams* params[VOICE_BUS_MAX_VOICES];
+    int ns = 0, nr = 0;
+    for (int i = 0; i < n; i++) {
+        const int j = mine[i].params.radio ? n - 1 - nr++ : ns++;
+        slots[j] = mine[i].slot;
+        keys[j] = mine[i].key;
+        occ[j] = mine[i].params.occ;
+        sorted[j] = blocks[i];
+        params[j] = &mine[i].params;
+    }
+    if (ns) occlusionProcess(slots, keys, occ, sorted, ns, frames);
+    if (nr) radioProcess(slots + ns, keys + ns, sorted + ns, nr, frames);
+
+    /* Sends are post-filter: a talker behind a wall excites our room already muffled. */
+    for (int i = 0; i < ns; i++) reverbSend(sch, sorted[i], frames, params[i]->reverbLevel);
+
+    memset(busL, 0, (size_t)frames * sizeof(float));
+    memset(busR, 0, (size_t)frames * sizeof(float));
+    for (int i = 0; i < ns; i++) pannerRenderBus(slots[i], keys[i], params[i]->pan, sorted[i], frames, busL, busR);
+    /* The radio is in the headset: centred, -3 dB per ear. */
+    for (int i = ns; i < n; i++) dspKernels()->panAccumulate(sorted[i], sorted[i], frames, 0.7071f, 0.7071f, 0.7071f, 0.7071f, busL, busR);
+    bool wet = reverbRender(sch, frames, busL, busR);
+    if (radioTails(sch, frames, busL, busR)) wet = true;
+    if (!n && !wet) return;
+
+    /* No stereo pair (mono device): fold the busses onto the first channel. */
+    int chL, chR;
+    if (!pannerFindPair(channels, channelSpeakerArray, &chL, &chR)) {
+        chL = chR = 0;
+        for (int i = 0; i < frames; i++) {
+            busL[i] *= 0.5f;
+            busR[i] *= 0.5f;
+        }
+    }
+    /* Unsaturated: the master limiter decides what reaches int16. chL may equal chR. */
+    float* outL = planes[chL];
+    float* outR = planes[chR];
+    for (int i = 0; i < frames; i++) {
+        outL[i] += busL[i];
+        outR[i] += busR[i];
+    }
+    *channelFillMask |= (1u << chL) | (1u << chR);
+
+    if (!n) return;
+    statCycles.fetch_add(1, std::memory_order_relaxed);
+    statVoices.fetch_add((uint64_t)n, std::memory_order_relaxed);
+    if ((uint32_t)n > statMaxVoices.load(std::memory_order_relaxed)) statMaxVoices.store((uint32_t)n, std::memory_order_relaxed);
+}
+
+void voiceBusGetStats(VoiceBusStats* out)
+{
+    out->cycles = statCycles.load(std::memory_order_relaxed);
+    out->voices = statVoices.load(std::memory_order_relaxed);
+    out->fallbacks = statFallbacks.load(std::memory_order_relaxed);
+    out->dropped = statDropped.load(std::memory_order_relaxed);
+    out->maxVoices = statMaxVoices.load(std::memory_order_relaxed);
+}
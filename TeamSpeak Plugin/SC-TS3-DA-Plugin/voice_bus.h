@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * Renders all spatialised talkers of a playback cycle together.
+ *
+ * TeamSpeak calls the post-process callback once per client, which is too
+ * narrow for the per-client filter banks (one SIMD pass covers several
+ * clients). So each talker's block is folded to mono and parked here with
+ * its parameters, and the client is removed from TeamSpeak's own mix (fill
+ * mask cleared); the mixed-playback callback that follows on the same thread
+ * then filters every parked voice, pans it into float busses, feeds the
+ * shared reverb and adds the result to the master bus planes (master.h),
+ * unsaturated, ahead of the limiter. Voices on the radio
+ * take the radio chain instead and are mixed centred and dry.
+ *
+ * Each server connection has its own mixed block, so voices are tagged with
+ * their connection and rendered by that connection's mix; a voice no mix
+ * claimed within VOICE_BUS_MAX_AGE mixed blocks is dropped. A voice is only
+ * captured when its block size matches the last mixed block, otherwise the
+ * caller renders it directly (no occlusion) as before.
+ *
+ * Playback thread only.
+ */
+
+#include <cstdint>
+
+#include "occlusion.h"
+#include "panner.h"
+#include "radio.h"
+#include "reverb.h"
+
+#define VOICE_BUS_MAX_VOICES 64   /* per cycle; more talkers fall back to the direct path */
+#define VOICE_BUS_MAX_AGE    8    /* mixed blocks */
+
+/* Everything post-process decided about a voice. */
+struct VoiceParams {
+    PannerParams    pan;
+    OcclusionParams occ;
+    float           reverbLevel;
+    bool            radio;      /* radioSelect() said so: pan, occ and reverbLevel unused */
+};
+
+struct VoiceBusStats {
+    uint64_t cycles;        /* mixed blocks that had voices */
+    uint64_t voices;        /* voices rendered through the bus */
+    uint64_t fallbacks;     /* capture refused: size mismatch or bus full */
+    uint64_t dropped;       /* captured, then never mixed or the block size changed */
+    uint32_t maxVoices;     /* most voices in one cycle */
+};
+
+/* Post-process callback: park the block, true if the caller must not render it itself. */
+bool voiceBusCapture(uint64_t sch, int slot, uint64_t key, const VoiceParams& params,
+                     short* samples, int frames, int channels,
+                     const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+
+/*
+ * Mixed-playback callback: render everything parked this cycle, plus the
+ * reverb tail, into `planes` (one float plane per channel) and mark the
+ * channels used in the fill mask. With planes NULL the cycle's voices are
+ * only collected and discarded.
+ */
+void voiceBusMix(uint64_t sch, float* const* planes, int frames, int channels,
+                 const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
+
+void voiceBusGetStats(VoiceBusStats* out);
@@ -0,0 +1,128 @@
+#include "pch.h"  // first line in every .cpp
+
+#include "zones.h"
+
+#include <cstddef>
+
+uint32_t zoneIdFromName(const char* name)
+{
+    if (!name) return ZONE_ID_NONE;
+
+    while (*name == ' ' || *name == '\t') name++;
+    const char* end = name;
+    for (const char* p = name; *p; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') end = p + 1;
+    }
+    if (end == name) return ZONE_ID_NONE;
+
+    uint32_t h = 2166136261u;
+    for (const char* p = name; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 'A' && c <= 'Z') c = (unsigned char)(c - 'A' + 'a');
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h ? h : 1u; /* keep 0 reserved for "no zone" */
+}
+
+static inline char lowerAscii(char c)
+{
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static inline bool isAlnum(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/* Does `hay` start with `needle`, case-insensitively? Returns the end of the match or NULL. */
+static const char* matchAt(const char* hay, const char* needle)
+{
+    for (; *needle; hay++, needle++) {
+        if (!*hay || lowerAscii(*hay) != *needle) return NULL;
+    }
+    return hay;
+}
+
+/*
+ * Case-insensitive match of a lower-case ASCII needle: anywhere in `hay`, or
+ * with `token` only at the start of a word ("_", space and the like separate
+ * words) and followed by '_', the way the game spells manufacturer and
+ * location codes (ANVL_Carrack, RR_HUR_L1).
+ */
+static bool matches(const char* hay, const char* needle, bool token)
+{
+    for (const char* p = hay; *p; p++) {
+        if (token && p > hay && isAlnum(p[-1])) continue;
+        const char* end = matchAt(p, needle);
+        if (end && (!token || *end == '_')) return true;
+    }
+    return false;
+}
+
+/*
+ * First match wins, so more specific names go first (a hangar aboard a
+ * station is a hangar). Places come before ships: ship zones are named after
+ * the manufacturer code, and short codes like "crus" or "argo" also turn up
+ * inside place names (OOC_Stanton_2_Crusader), so they only count as a whole
+ * leading token.
+ */
+static const struct {
+    const char* needle;
+    ZoneClass   cls;
+    bool        token;
+} zoneRules[] = {
+    { "hangar",    ZONE_CLASS_HANGAR,  false },
+    { "station",   ZONE_CLASS_STATION, false },
+    { "rr",        ZONE_CLASS_STATION, true },   /* rest stops: RR_HUR_L1 etc. */
+    { "olisar",    ZONE_CLASS_STATION, false },
+    { "everus",    ZONE_CLASS_STATION, false },
+    { "baijini",   ZONE_CLASS_STATION, false },
+    { "tressler",  ZONE_CLASS_STATION, false },
+    { "seraphim",  ZONE_CLASS_STATION, false },
+    { "area18",    ZONE_CLASS_PLANET,  false },
+    { "lorville",  ZONE_CLASS_PLANET,  false },
+    { "orison",    ZONE_CLASS_PLANET,  false },
+    { "babbage",   ZONE_CLASS_PLANET,  false },
+    { "outpost",   ZONE_CLASS_PLANET,  false },
+    { "ooc",       ZONE_CLASS_PLANET,  true },
+    { "stanton",   ZONE_CLASS_SPACE,   false },
+    { "pyro",      ZONE_CLASS_SPACE,   false },
+    { "space",     ZONE_CLASS_SPACE,   false },
+    { "aegs",      ZONE_CLASS_SHIP,    true },
+    { "anvl",      ZONE_CLASS_SHIP,    true },
+    { "argo",      ZONE_CLASS_SHIP,    true },
+    { "banu",      ZONE_CLASS_SHIP,    true },
+    { "cnou",      ZONE_CLASS_SHIP,    true },
+    { "crus",      ZONE_CLASS_SHIP,    true },
+    { "drak",      ZONE_CLASS_SHIP,    true },
+    { "espr",      ZONE_CLASS_SHIP,    true },
+    { "krig",      ZONE_CLASS_SHIP,    true },
+    { "misc",      ZONE_CLASS_SHIP,    true },
+    { "mrai",      ZONE_CLASS_SHIP,    true },
+    { "orig",      ZONE_CLASS_SHIP,    true },
+    { "rsi",       ZONE_CLASS_SHIP,    true },
+    { "tmbl",      ZONE_CLASS_SHIP,    true },
+    { "xnaa",      ZONE_CLASS_SHIP,    true },
+};
+
+ZoneClass zoneClassify(const char* name)
+{
+    if (!name || !*name) return ZONE_CLASS_UNKNOWN;
+    for (size_t i = 0; i < sizeof(zoneRules) / sizeof(zoneRules[0]); i++) {
+        if (matches(name, zoneRules[i].needle, zoneRules[i].token)) return zoneRules[i].cls;
+    }
+    return ZONE_CLASS_UNKNOWN;
+}
+
+const char* zoneClassName(ZoneClass c)
+{
+    switch (c) {
+    case ZONE_CLASS_SHIP:    return "ship";
+    case ZONE_CLASS_HANGAR:  return "hangar";
+    case ZONE_CLASS_STATION: return "station";
+    case ZONE_CLASS_PLANET:  return "planet";
+    case ZONE_CLASS_SPACE:   return "space";
+    default:                 return "unknown";
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * Zone naming shared between SCTS3DA.exe and the plugin.
+ *
+ * The OCR helper reports the HUD "Zone:" string verbatim. Everything past the
+ * helper refers to a zone by a 32-bit id so that poses stay fixed-size; the id
+ * is FNV-1a over the trimmed, ASCII-lower-cased name (see PoseChannel.cs for
+ * the C# twin, which must stay byte-for-byte identical).
+ */
+
+#include <cstdint>
+
+#define ZONE_ID_NONE 0u
+
+/* Coarse acoustic class of a zone; travels with every pose frame. */
+enum ZoneClass {
+    ZONE_CLASS_UNKNOWN = 0,
+    ZONE_CLASS_SHIP,      /* ship interior */
+    ZONE_CLASS_HANGAR,
+    ZONE_CLASS_STATION,   /* stations, rest stops */
+    ZONE_CLASS_PLANET,    /* planetary surface, cities, outposts */
+    ZONE_CLASS_SPACE,     /* open space / EVA */
+    ZONE_CLASS_COUNT
+};
+
+uint32_t  zoneIdFromName(const char* name);
+ZoneClass zoneClassify(const char* name);
+const char* zoneClassName(ZoneClass c);